@@ -26,12 +26,28 @@
 #import <Foundation/Foundation.h>
 #import <UIKit/UIKit.h>
 #import <CoreGraphics/CoreGraphics.h>
+#import "IMImojiImageResampler.h"
 
 @interface UIImage (UIImageExtensions)
 
+/**
+ * Resizes with Lanczos when shrinking and bilinear otherwise. dstSize is measured along the axes of the underlying
+ * CGImage, before imageOrientation is applied, and drawn at the receiver's scale: the result is dstSize multiplied by
+ * self.scale pixels with a scale of 1, and always upright. Returns the receiver when dstSize matches its CGImage.
+ */
 - (UIImage *)im_resizedImageToSize:(CGSize)dstSize;
 
+- (UIImage *)im_resizedImageToSize:(CGSize)dstSize
+                            filter:(IMImojiImageResamplerFilter)filter;
+
+/**
+ * Fits the image within boundingSize keeping its aspect ratio, with the same scale handling as im_resizedImageToSize:
+ */
 - (UIImage *)im_resizedImageToFitInSize:(CGSize)boundingSize
                          scaleIfSmaller:(BOOL)scale;
 
+- (UIImage *)im_resizedImageToFitInSize:(CGSize)boundingSize
+                         scaleIfSmaller:(BOOL)scale
+                                 filter:(IMImojiImageResamplerFilter)filter;
+
 @end
@@ -25,6 +25,9 @@
 
 #import "UIImage+Extensions.h"
 
+// downscales are decoded at no more than this many times the destination size before resampling
+static NSUInteger const IMImageResizeDecodeOversampling = 2;
+
 @implementation UIImage (UIImageExtensions)
 
 - (void)transform:(CGAffineTransform *)transform andSize:(CGSize *)size forOrientation:(UIImageOrientation)orientation {
@@ -102,6 +105,14 @@
 
 
 - (UIImage *)im_resizedImageToSize:(CGSize)dstSize {
+    CGImageRef imgRef = self.CGImage;
+    BOOL shrinking = dstSize.width * dstSize.height * self.scale * self.scale < CGImageGetWidth(imgRef) * CGImageGetHeight(imgRef);
+
+    return [self im_resizedImageToSize:dstSize
+                                filter:shrinking ? IMImojiImageResamplerFilterLanczos : IMImojiImageResamplerFilterBilinear];
+}
+
+- (UIImage *)im_resizedImageToSize:(CGSize)dstSize filter:(IMImojiImageResamplerFilter)filter {
     CGImageRef imgRef = self.CGImage;
     // the below values are regardless of orientation : for UIImages from Camera, width>height (landscape)
     CGSize srcSize = CGSizeMake(CGImageGetWidth(imgRef), CGImageGetHeight(imgRef)); // not equivalent to self.size (which is dependant on the imageOrientation)!
@@ -111,92 +122,115 @@
         return self;
     }
 
-    CGFloat scaleRatio = dstSize.width / srcSize.width;
-    UIImageOrientation orient = self.imageOrientation;
-    CGAffineTransform transform = CGAffineTransformIdentity;
-    switch (orient) {
-
+    IMImojiImageResamplerOrientation orientation;
+    switch (self.imageOrientation) {
         case UIImageOrientationUp: //EXIF = 1
-            transform = CGAffineTransformIdentity;
+            orientation = IMImojiImageResamplerOrientationUp;
             break;
-
         case UIImageOrientationUpMirrored: //EXIF = 2
-            transform = CGAffineTransformMakeTranslation(srcSize.width, 0.0);
-            transform = CGAffineTransformScale(transform, -1.0, 1.0);
+            orientation = IMImojiImageResamplerOrientationUpMirrored;
             break;
-
         case UIImageOrientationDown: //EXIF = 3
-            transform = CGAffineTransformMakeTranslation(srcSize.width, srcSize.height);
-            transform = CGAffineTransformRotate(transform, M_PI);
+            orientation = IMImojiImageResamplerOrientationDown;
             break;
-
         case UIImageOrientationDownMirrored: //EXIF = 4
-            transform = CGAffineTransformMakeTranslation(0.0, srcSize.height);
-            transform = CGAffineTransformScale(transform, 1.0, -1.0);
+            orientation = IMImojiImageResamplerOrientationDownMirrored;
             break;
-
         case UIImageOrientationLeftMirrored: //EXIF = 5
-            dstSize = CGSizeMake(dstSize.height, dstSize.width);
-            transform = CGAffineTransformMakeTranslation(srcSize.height, srcSize.width);
-            transform = CGAffineTransformScale(transform, -1.0, 1.0);
-            transform = CGAffineTransformRotate(transform, 3.0 * M_PI_2);
+            orientation = IMImojiImageResamplerOrientationLeftMirrored;
             break;
-
-        case UIImageOrientationLeft: //EXIF = 6
-            dstSize = CGSizeMake(dstSize.height, dstSize.width);
-            transform = CGAffineTransformMakeTranslation(0.0, srcSize.width);
-            transform = CGAffineTransformRotate(transform, 3.0 * M_PI_2);
+        case UIImageOrientationRight: //EXIF = 6
+            orientation = IMImojiImageResamplerOrientationRight;
             break;
-
         case UIImageOrientationRightMirrored: //EXIF = 7
-            dstSize = CGSizeMake(dstSize.height, dstSize.width);
-            transform = CGAffineTransformMakeScale(-1.0, 1.0);
-            transform = CGAffineTransformRotate(transform, M_PI_2);
+            orientation = IMImojiImageResamplerOrientationRightMirrored;
             break;
-
-        case UIImageOrientationRight: //EXIF = 8
-            dstSize = CGSizeMake(dstSize.height, dstSize.width);
-            transform = CGAffineTransformMakeTranslation(srcSize.height, 0.0);
-            transform = CGAffineTransformRotate(transform, M_PI_2);
+        case UIImageOrientationLeft: //EXIF = 8
+            orientation = IMImojiImageResamplerOrientationLeft;
             break;
-
         default:
             [NSException raise:NSInternalInconsistencyException format:@"Invalid image orientation"];
+            return nil;
+    }
 
+    // dstSize is drawn at the scale of the receiver and the result has a scale of 1, as when this was drawn through a
+    // UIKit image context of dstSize at self.scale
+    CGFloat scale = self.scale > 0 ? self.scale : 1.0f;
+    size_t srcWidth = (size_t) srcSize.width, srcHeight = (size_t) srcSize.height;
+    size_t dstWidth = (size_t) lround(dstSize.width * scale), dstHeight = (size_t) lround(dstSize.height * scale);
+    if (!imgRef || srcWidth == 0 || srcHeight == 0 || dstWidth == 0 || dstHeight == 0) {
+        return nil;
     }
 
-    /////////////////////////////////////////////////////////////////////////////
-    // The actual resize: draw the image on a new context, applying a transform matrix
-    UIGraphicsBeginImageContextWithOptions(dstSize, NO, self.scale);
+    // large downscales are decoded straight to a smaller bitmap, CoreGraphics reduces the image while drawing it so a
+    // full size copy of a camera image never has to be held. the resampler filters the remaining factor of two
+    size_t decodeWidth = MIN(srcWidth, dstWidth * IMImageResizeDecodeOversampling);
+    size_t decodeHeight = MIN(srcHeight, dstHeight * IMImageResizeDecodeOversampling);
 
-    CGContextRef context = UIGraphicsGetCurrentContext();
+    // the resampler writes the result upright, so the axes swap for the rotated orientations
+    if (orientation >= IMImojiImageResamplerOrientationLeftMirrored) {
+        size_t swap = dstWidth;
+        dstWidth = dstHeight;
+        dstHeight = swap;
+    }
 
+    /////////////////////////////////////////////////////////////////////////////
+    // The actual resize: decode into a premultiplied RGBA buffer and resample it off the UIKit graphics stack, which
+    // keeps this safe to call from background threads
+    CGBitmapInfo bitmapInfo = kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big;
+    NSMutableData *decodedPixels = [NSMutableData dataWithLength:decodeWidth * decodeHeight * 4];
+    NSMutableData *dstPixels = [NSMutableData dataWithLength:dstWidth * dstHeight * 4];
+    if (!decodedPixels || !dstPixels) {
+        return nil;
+    }
+
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(decodedPixels.mutableBytes, decodeWidth, decodeHeight, 8, decodeWidth * 4, colorSpace, bitmapInfo);
     if (!context) {
+        CGColorSpaceRelease(colorSpace);
         return nil;
     }
 
-    if (orient == UIImageOrientationRight || orient == UIImageOrientationLeft) {
-        CGContextScaleCTM(context, -scaleRatio, scaleRatio);
-        CGContextTranslateCTM(context, -srcSize.height, 0);
-    } else {
-        CGContextScaleCTM(context, scaleRatio, -scaleRatio);
-        CGContextTranslateCTM(context, 0, -srcSize.height);
+    CGContextSetBlendMode(context, kCGBlendModeCopy);
+    CGContextSetInterpolationQuality(context, kCGInterpolationHigh);
+    CGContextDrawImage(context, CGRectMake(0, 0, decodeWidth, decodeHeight), imgRef);
+    CGContextRelease(context);
+
+    IMImojiImageResamplerStatus status = IMImojiImageResamplerResize(decodedPixels.bytes, decodeWidth, decodeHeight, decodeWidth * 4,
+            dstPixels.mutableBytes, dstWidth, dstHeight, dstWidth * 4,
+            filter, orientation);
+    if (status != IMImojiImageResamplerStatusSuccess) {
+        CGColorSpaceRelease(colorSpace);
+        return nil;
     }
 
-    CGContextConcatCTM(context, transform);
+    CGDataProviderRef provider = CGDataProviderCreateWithCFData((__bridge CFDataRef) dstPixels);
+    CGImageRef resizedRef = CGImageCreate(dstWidth, dstHeight, 8, 32, dstWidth * 4, colorSpace, bitmapInfo, provider, NULL, false, kCGRenderingIntentDefault);
+    CGDataProviderRelease(provider);
+    CGColorSpaceRelease(colorSpace);
+
+    if (!resizedRef) {
+        return nil;
+    }
 
-    // we use srcSize (and not dstSize) as the size to specify is in user space (and we use the CTM to apply a scaleRatio)
-    CGContextDrawImage(UIGraphicsGetCurrentContext(), CGRectMake(0, 0, srcSize.width, srcSize.height), imgRef);
-    UIImage *resizedImage = UIGraphicsGetImageFromCurrentImageContext();
-    UIGraphicsEndImageContext();
+    UIImage *resizedImage = [UIImage imageWithCGImage:resizedRef
+                                                scale:1.0
+                                          orientation:UIImageOrientationUp];
+    CGImageRelease(resizedRef);
 
-    return [UIImage imageWithCGImage:resizedImage.CGImage
-                               scale:1.0
-                         orientation:resizedImage.imageOrientation];
+    return resizedImage;
 }
 
 
 - (UIImage *)im_resizedImageToFitInSize:(CGSize)boundingSize scaleIfSmaller:(BOOL)scale {
+    return [self im_resizedImageToSize:[self im_sizeToFitInSize:boundingSize scaleIfSmaller:scale]];
+}
+
+- (UIImage *)im_resizedImageToFitInSize:(CGSize)boundingSize scaleIfSmaller:(BOOL)scale filter:(IMImojiImageResamplerFilter)filter {
+    return [self im_resizedImageToSize:[self im_sizeToFitInSize:boundingSize scaleIfSmaller:scale] filter:filter];
+}
+
+- (CGSize)im_sizeToFitInSize:(CGSize)boundingSize scaleIfSmaller:(BOOL)scale {
     // get the image size (independant of imageOrientation)
     CGImageRef imgRef = self.CGImage;
     CGSize srcSize = CGSizeMake(CGImageGetWidth(imgRef), CGImageGetHeight(imgRef)); // not equivalent to self.size (which depends on the imageOrientation)!
@@ -234,7 +268,7 @@
         }
     }
 
-    return [self im_resizedImageToSize:dstSize];
+    return dstSize;
 }
 
 @end
@@ -0,0 +1,148 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+@class IMImojiObject;
+@class IMImojiObjectRenderingOptions;
+
+/**
+* @abstract An in memory LRU cache of rendered Imoji images owned by an IMImojiSession. Entries are keyed by the
+* Imoji identifier and the resolved rendering options used to render it. The cache holds two tiers: decoded images
+* bounded by their decoded byte cost and the encoded image bytes they were created from, which are cheaper to hold and
+* can be decoded again without a network request once the decoded image has been evicted.
+*/
+@interface IMImojiImageCache : NSObject
+
+/**
+* @abstract Creates an image cache.
+* @param totalCostLimit Maximum number of decoded bytes to hold before evicting the least recently used images.
+* @param encodedCostLimit Maximum number of encoded bytes to hold before evicting the least recently used data.
+*/
+- (nonnull instancetype)initWithTotalCostLimit:(NSUInteger)totalCostLimit
+                              encodedCostLimit:(NSUInteger)encodedCostLimit;
+
+/**
+* @abstract Maximum number of decoded image bytes held by the cache. Setting this to 0 disables the decoded tier.
+*/
+@property NSUInteger totalCostLimit;
+
+/**
+* @abstract Maximum number of encoded image bytes held by the cache. Setting this to 0 disables the encoded tier.
+*/
+@property NSUInteger encodedCostLimit;
+
+/**
+* @abstract Number of decoded image bytes currently held by the cache.
+*/
+@property(readonly) NSUInteger totalCost;
+
+/**
+* @abstract Number of encoded image bytes currently held by the cache.
+*/
+@property(readonly) NSUInteger encodedCost;
+
+/**
+* @abstract Number of lookups satisfied by a decoded image. Each call to imageForImoji:renderingOptions: or
+* imageDataForImoji:renderingOptions: counts as one lookup, the peek methods are not counted.
+*/
+@property(readonly) NSUInteger hitCount;
+
+/**
+* @abstract Number of lookups satisfied by encoded image bytes after the decoded image was not found.
+*/
+@property(readonly) NSUInteger encodedHitCount;
+
+/**
+* @abstract Number of lookups that were not satisfied by either tier.
+*/
+@property(readonly) NSUInteger missCount;
+
+/**
+* @abstract Number of entries removed from either tier to stay within the cost limits.
+*/
+@property(readonly) NSUInteger evictionCount;
+
+/**
+* @abstract Gets a decoded image for an Imoji and the resolved rendering options used to render it. When the decoded
+* image isn't held the lookup is counted as an encoded hit or a miss depending on whether the encoded tier has it.
+*/
+- (nullable UIImage *)imageForImoji:(nonnull IMImojiObject *)imoji
+                   renderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions;
+
+/**
+* @abstract Gets a decoded image without updating the statistics or how recently the image was used.
+*/
+- (nullable UIImage *)peekImageForImoji:(nonnull IMImojiObject *)imoji
+                       renderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions;
+
+/**
+* @abstract Stores a decoded image for an Imoji and the resolved rendering options used to render it.
+*/
+- (void)setImage:(nonnull UIImage *)image
+        forImoji:(nonnull IMImojiObject *)imoji
+renderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions;
+
+/**
+* @abstract Gets the encoded image bytes for an Imoji and the resolved rendering options used to render it.
+*/
+- (nullable NSData *)imageDataForImoji:(nonnull IMImojiObject *)imoji
+                      renderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions;
+
+/**
+* @abstract Gets the encoded image bytes without updating the statistics or how recently the bytes were used.
+*/
+- (nullable NSData *)peekImageDataForImoji:(nonnull IMImojiObject *)imoji
+                          renderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions;
+
+/**
+* @abstract Stores the encoded image bytes for an Imoji and the resolved rendering options used to render it.
+*/
+- (void)setImageData:(nonnull NSData *)imageData
+            forImoji:(nonnull IMImojiObject *)imoji
+    renderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions;
+
+/**
+* @abstract Removes all decoded images while keeping the encoded tier. Called automatically on memory warnings.
+*/
+- (void)removeAllImages;
+
+/**
+* @abstract Removes all decoded images and encoded image bytes from the cache.
+*/
+- (void)removeAllObjects;
+
+/**
+* @abstract Resets the hit, miss and eviction counters to 0.
+*/
+- (void)resetStatistics;
+
+/**
+* @abstract The number of bytes an image occupies once it has been decoded.
+*/
++ (NSUInteger)costForImage:(nonnull UIImage *)image;
+
+@end
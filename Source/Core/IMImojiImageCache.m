@@ -0,0 +1,435 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <YYImage/YYImage.h>
+#import "IMImojiImageCache.h"
+#import "IMImojiObject.h"
+#import "IMImojiObjectRenderingOptions.h"
+
+@interface IMImojiImageCacheKey : NSObject <NSCopying>
+
+@property(nonatomic, copy, readonly) NSString *identifier;
+@property(nonatomic, copy, readonly) IMImojiObjectRenderingOptions *renderingOptions;
+
+@end
+
+@implementation IMImojiImageCacheKey {
+    NSUInteger _hash;
+}
+
+- (instancetype)initWithIdentifier:(NSString *)identifier renderingOptions:(IMImojiObjectRenderingOptions *)renderingOptions {
+    self = [super init];
+    if (self) {
+        // copy the options so mutations made by the caller after the lookup don't change the key
+        _identifier = [identifier copy];
+        _renderingOptions = [renderingOptions copy];
+        _hash = _identifier.hash * 31u + _renderingOptions.hash;
+    }
+
+    return self;
+}
+
+- (BOOL)isEqual:(id)other {
+    if (other == self)
+        return YES;
+    if (!other || ![[other class] isEqual:[self class]])
+        return NO;
+
+    IMImojiImageCacheKey *key = other;
+    return _hash == key->_hash &&
+            [self.identifier isEqualToString:key.identifier] &&
+            [self.renderingOptions isEqual:key.renderingOptions];
+}
+
+- (NSUInteger)hash {
+    return _hash;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    // immutable
+    return self;
+}
+
+@end
+
+@interface IMImojiImageCacheNode : NSObject {
+@package
+    __unsafe_unretained IMImojiImageCacheNode *_previous;
+    __unsafe_unretained IMImojiImageCacheNode *_next;
+    IMImojiImageCacheKey *_key;
+    id _value;
+    NSUInteger _cost;
+}
+@end
+
+@implementation IMImojiImageCacheNode
+@end
+
+/**
+* A single cost bounded LRU list. The dictionary retains the nodes, the linked list orders them from most recently
+* used (head) to least recently used (tail). Not thread safe, IMImojiImageCache serializes access.
+*/
+@interface IMImojiImageCacheTier : NSObject {
+@package
+    NSMutableDictionary *_nodes;
+    __unsafe_unretained IMImojiImageCacheNode *_head;
+    __unsafe_unretained IMImojiImageCacheNode *_tail;
+    NSUInteger _totalCost;
+    NSUInteger _costLimit;
+}
+@end
+
+@implementation IMImojiImageCacheTier
+
+- (instancetype)initWithCostLimit:(NSUInteger)costLimit {
+    self = [super init];
+    if (self) {
+        _nodes = [NSMutableDictionary new];
+        _costLimit = costLimit;
+    }
+
+    return self;
+}
+
+- (id)objectForKey:(IMImojiImageCacheKey *)key {
+    IMImojiImageCacheNode *node = _nodes[key];
+    if (!node) {
+        return nil;
+    }
+
+    [self bringNodeToHead:node];
+    return node->_value;
+}
+
+- (id)peekObjectForKey:(IMImojiImageCacheKey *)key {
+    IMImojiImageCacheNode *node = _nodes[key];
+    return node ? node->_value : nil;
+}
+
+- (NSUInteger)setObject:(id)object forKey:(IMImojiImageCacheKey *)key cost:(NSUInteger)cost {
+    IMImojiImageCacheNode *node = _nodes[key];
+    if (node) {
+        _totalCost = _totalCost - node->_cost + cost;
+        node->_value = object;
+        node->_cost = cost;
+        [self bringNodeToHead:node];
+    } else {
+        node = [IMImojiImageCacheNode new];
+        node->_key = key;
+        node->_value = object;
+        node->_cost = cost;
+        _nodes[key] = node;
+        _totalCost += cost;
+        [self insertNodeAtHead:node];
+    }
+
+    return [self trimToCost:_costLimit];
+}
+
+- (NSUInteger)trimToCost:(NSUInteger)costLimit {
+    NSUInteger evicted = 0;
+    while (_tail && _totalCost > costLimit) {
+        IMImojiImageCacheNode *node = _tail;
+        _totalCost -= node->_cost;
+        [self unlinkNode:node];
+        [_nodes removeObjectForKey:node->_key];
+        evicted++;
+    }
+
+    return evicted;
+}
+
+- (void)removeAllObjects {
+    _head = _tail = nil;
+    _totalCost = 0;
+    [_nodes removeAllObjects];
+}
+
+- (void)insertNodeAtHead:(IMImojiImageCacheNode *)node {
+    node->_previous = nil;
+    node->_next = _head;
+    if (_head) {
+        _head->_previous = node;
+    }
+    _head = node;
+
+    if (!_tail) {
+        _tail = node;
+    }
+}
+
+- (void)bringNodeToHead:(IMImojiImageCacheNode *)node {
+    if (_head == node) {
+        return;
+    }
+
+    [self unlinkNode:node];
+    [self insertNodeAtHead:node];
+}
+
+- (void)unlinkNode:(IMImojiImageCacheNode *)node {
+    if (node->_previous) {
+        node->_previous->_next = node->_next;
+    }
+    if (node->_next) {
+        node->_next->_previous = node->_previous;
+    }
+    if (_head == node) {
+        _head = node->_next;
+    }
+    if (_tail == node) {
+        _tail = node->_previous;
+    }
+
+    node->_previous = node->_next = nil;
+}
+
+@end
+
+@implementation IMImojiImageCache {
+    IMImojiImageCacheTier *_images;
+    IMImojiImageCacheTier *_imageData;
+    NSUInteger _hitCount;
+    NSUInteger _encodedHitCount;
+    NSUInteger _missCount;
+    NSUInteger _evictionCount;
+}
+
+- (instancetype)init {
+    return [self initWithTotalCostLimit:0 encodedCostLimit:0];
+}
+
+- (instancetype)initWithTotalCostLimit:(NSUInteger)totalCostLimit
+                      encodedCostLimit:(NSUInteger)encodedCostLimit {
+    self = [super init];
+    if (self) {
+        _images = [[IMImojiImageCacheTier alloc] initWithCostLimit:totalCostLimit];
+        _imageData = [[IMImojiImageCacheTier alloc] initWithCostLimit:encodedCostLimit];
+
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(removeAllImages)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+    }
+
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+#pragma mark Limits and Statistics
+
+- (NSUInteger)totalCostLimit {
+    @synchronized (self) {
+        return _images->_costLimit;
+    }
+}
+
+- (void)setTotalCostLimit:(NSUInteger)totalCostLimit {
+    @synchronized (self) {
+        _images->_costLimit = totalCostLimit;
+        _evictionCount += [_images trimToCost:totalCostLimit];
+    }
+}
+
+- (NSUInteger)encodedCostLimit {
+    @synchronized (self) {
+        return _imageData->_costLimit;
+    }
+}
+
+- (void)setEncodedCostLimit:(NSUInteger)encodedCostLimit {
+    @synchronized (self) {
+        _imageData->_costLimit = encodedCostLimit;
+        _evictionCount += [_imageData trimToCost:encodedCostLimit];
+    }
+}
+
+- (NSUInteger)totalCost {
+    @synchronized (self) {
+        return _images->_totalCost;
+    }
+}
+
+- (NSUInteger)encodedCost {
+    @synchronized (self) {
+        return _imageData->_totalCost;
+    }
+}
+
+- (NSUInteger)hitCount {
+    @synchronized (self) {
+        return _hitCount;
+    }
+}
+
+- (NSUInteger)encodedHitCount {
+    @synchronized (self) {
+        return _encodedHitCount;
+    }
+}
+
+- (NSUInteger)missCount {
+    @synchronized (self) {
+        return _missCount;
+    }
+}
+
+- (NSUInteger)evictionCount {
+    @synchronized (self) {
+        return _evictionCount;
+    }
+}
+
+- (void)resetStatistics {
+    @synchronized (self) {
+        _hitCount = _encodedHitCount = _missCount = _evictionCount = 0;
+    }
+}
+
+#pragma mark Decoded Images
+
+- (UIImage *)imageForImoji:(IMImojiObject *)imoji
+          renderingOptions:(IMImojiObjectRenderingOptions *)renderingOptions {
+    IMImojiImageCacheKey *key = [[IMImojiImageCacheKey alloc] initWithIdentifier:imoji.identifier
+                                                                renderingOptions:renderingOptions];
+
+    @synchronized (self) {
+        UIImage *image = [_images objectForKey:key];
+        if (image) {
+            _hitCount++;
+        } else if ([_imageData peekObjectForKey:key]) {
+            // the caller goes on to decode the encoded bytes, which is where the lookup is satisfied
+            _encodedHitCount++;
+        } else {
+            _missCount++;
+        }
+
+        return image;
+    }
+}
+
+- (UIImage *)peekImageForImoji:(IMImojiObject *)imoji
+              renderingOptions:(IMImojiObjectRenderingOptions *)renderingOptions {
+    IMImojiImageCacheKey *key = [[IMImojiImageCacheKey alloc] initWithIdentifier:imoji.identifier
+                                                                renderingOptions:renderingOptions];
+
+    @synchronized (self) {
+        return [_images peekObjectForKey:key];
+    }
+}
+
+- (void)setImage:(UIImage *)image
+        forImoji:(IMImojiObject *)imoji
+renderingOptions:(IMImojiObjectRenderingOptions *)renderingOptions {
+    NSUInteger cost = [IMImojiImageCache costForImage:image];
+    IMImojiImageCacheKey *key = [[IMImojiImageCacheKey alloc] initWithIdentifier:imoji.identifier
+                                                                renderingOptions:renderingOptions];
+
+    @synchronized (self) {
+        // don't flush the whole tier for an image that could never fit
+        if (cost > _images->_costLimit) {
+            return;
+        }
+
+        _evictionCount += [_images setObject:image forKey:key cost:cost];
+    }
+}
+
+- (void)removeAllImages {
+    @synchronized (self) {
+        [_images removeAllObjects];
+    }
+}
+
+#pragma mark Encoded Images
+
+- (NSData *)imageDataForImoji:(IMImojiObject *)imoji
+             renderingOptions:(IMImojiObjectRenderingOptions *)renderingOptions {
+    IMImojiImageCacheKey *key = [[IMImojiImageCacheKey alloc] initWithIdentifier:imoji.identifier
+                                                                renderingOptions:renderingOptions];
+
+    @synchronized (self) {
+        NSData *data = [_imageData objectForKey:key];
+        if (data) {
+            _encodedHitCount++;
+        } else {
+            _missCount++;
+        }
+
+        return data;
+    }
+}
+
+- (NSData *)peekImageDataForImoji:(IMImojiObject *)imoji
+                 renderingOptions:(IMImojiObjectRenderingOptions *)renderingOptions {
+    IMImojiImageCacheKey *key = [[IMImojiImageCacheKey alloc] initWithIdentifier:imoji.identifier
+                                                                renderingOptions:renderingOptions];
+
+    @synchronized (self) {
+        return [_imageData peekObjectForKey:key];
+    }
+}
+
+- (void)setImageData:(NSData *)imageData
+            forImoji:(IMImojiObject *)imoji
+    renderingOptions:(IMImojiObjectRenderingOptions *)renderingOptions {
+    IMImojiImageCacheKey *key = [[IMImojiImageCacheKey alloc] initWithIdentifier:imoji.identifier
+                                                                renderingOptions:renderingOptions];
+
+    @synchronized (self) {
+        if (imageData.length > _imageData->_costLimit) {
+            return;
+        }
+
+        _evictionCount += [_imageData setObject:[imageData copy] forKey:key cost:imageData.length];
+    }
+}
+
+- (void)removeAllObjects {
+    @synchronized (self) {
+        [_images removeAllObjects];
+        [_imageData removeAllObjects];
+    }
+}
+
+#pragma mark Cost
+
++ (NSUInteger)costForImage:(UIImage *)image {
+    CGImageRef imageRef = image.CGImage;
+    NSUInteger cost = imageRef ? CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef) :
+            (NSUInteger) (image.size.width * image.scale * image.size.height * image.scale * 4);
+
+    // animated images retain their source data in order to decode the remaining frames on demand
+    if ([image isKindOfClass:[YYImage class]]) {
+        cost += ((YYImage *) image).animatedImageData.length;
+    }
+
+    return cost;
+}
+
+@end
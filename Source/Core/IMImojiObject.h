@@ -91,7 +91,10 @@ typedef NS_ENUM(NSUInteger, IMImojiObjectLicenseStyle) {
 @property(nonatomic) IMImojiObjectLicenseStyle licenseStyle;
 
 /**
- * @abstract Gets a download URL for an Imoji given the requested rendering options
+ * @abstract Gets a download URL for an Imoji given the requested rendering options. When targetSize or aspectRatio is
+ * set, the smallest published image covering the target size at the screen scale is returned and is expected to be
+ * resized and padded locally. A custom rendered URL is returned when no published image is large enough, and always
+ * for animated formats, whose frames are not resized locally.
  */
 - (nullable NSURL *)getUrlForRenderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions;
 
@@ -27,6 +27,30 @@
 #import <UIKit/UIKit.h>
 #import "IMImojiObject.h"
 
+// published render sizes from smallest to largest, the enum values aren't ordered by size
+static IMImojiObjectRenderSize const IMImojiObjectPublishedRenderSizes[] = {
+        IMImojiObjectRenderSizeThumbnail,
+        IMImojiObjectRenderSize320,
+        IMImojiObjectRenderSize512,
+        IMImojiObjectRenderSizeFullResolution
+};
+
+@interface IMImojiObject ()
+
+- (nullable NSURL *)variantUrlForRenderSize:(IMImojiObjectRenderSize)renderSize
+                                borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                                imageFormat:(IMImojiObjectImageFormat)imageFormat;
+
+- (CGSize)variantDimensionsForRenderSize:(IMImojiObjectRenderSize)renderSize
+                             borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                             imageFormat:(IMImojiObjectImageFormat)imageFormat;
+
+- (NSUInteger)variantFileSizeForRenderSize:(IMImojiObjectRenderSize)renderSize
+                               borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                               imageFormat:(IMImojiObjectImageFormat)imageFormat;
+
+@end
+
 @implementation IMImojiObject {
 
 }
@@ -88,39 +112,110 @@
 
 - (nullable NSURL *)getUrlForRenderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions {
     if (renderingOptions.aspectRatio || renderingOptions.targetSize) {
-        return [self generateImageUrlWithRenderingOptions:renderingOptions];
+        // published variants are shared with every other request and cached by the CDN, the session resizes and pads
+        // them locally. only ask the render service for a one-off image when none of them will do
+        NSURL *url = [self publishedVariantUrlForRenderingOptions:renderingOptions];
+        return url ? url : [self generateImageUrlWithRenderingOptions:renderingOptions];
+    }
+
+    return [self variantUrlWithFallbackForRenderingOptions:renderingOptions];
+}
+
+- (nullable NSURL *)publishedVariantUrlForRenderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions {
+    BOOL animated = renderingOptions.imageFormat == IMImojiObjectImageFormatAnimatedGif ||
+            renderingOptions.imageFormat == IMImojiObjectImageFormatAnimatedWebp;
+
+    // animated frames are drawn as downloaded, only the render service can size or pad them
+    if (animated && (renderingOptions.aspectRatio || renderingOptions.targetSize)) {
+        return nil;
+    }
+
+    if (!renderingOptions.targetSize) {
+        return [self variantUrlWithFallbackForRenderingOptions:renderingOptions];
+    }
+
+    CGSize targetSize = [renderingOptions.targetSize CGSizeValue];
+    CGFloat requiredPixelSize = MAX(targetSize.width, targetSize.height) * [UIScreen mainScreen].scale;
+
+    NSMutableArray *imageFormats = [NSMutableArray arrayWithObject:@(renderingOptions.imageFormat)];
+    if (renderingOptions.imageFormat == IMImojiObjectImageFormatWebP) {
+        [imageFormats addObject:@(IMImojiObjectImageFormatPNG)];
+    }
+
+    NSURL *selectedUrl = nil;
+    NSUInteger selectedFileSize = 0;
+    CGFloat selectedPixelSize = 0;
+
+    for (NSNumber *imageFormat in imageFormats) {
+        for (size_t i = 0; i < sizeof(IMImojiObjectPublishedRenderSizes) / sizeof(IMImojiObjectPublishedRenderSizes[0]); i++) {
+            IMImojiObjectRenderSize renderSize = IMImojiObjectPublishedRenderSizes[i];
+            IMImojiObjectImageFormat format = (IMImojiObjectImageFormat) imageFormat.unsignedIntegerValue;
+            NSURL *url = [self variantUrlForRenderSize:renderSize borderStyle:renderingOptions.borderStyle imageFormat:format];
+            if (!url) {
+                continue;
+            }
+
+            // variants without reported dimensions can't be checked against the target size
+            CGSize dimensions = [self variantDimensionsForRenderSize:renderSize borderStyle:renderingOptions.borderStyle imageFormat:format];
+            CGFloat pixelSize = MAX(dimensions.width, dimensions.height);
+            if (pixelSize < requiredPixelSize || pixelSize <= 0) {
+                continue;
+            }
+
+            NSUInteger fileSize = [self variantFileSizeForRenderSize:renderSize borderStyle:renderingOptions.borderStyle imageFormat:format];
+            if (fileSize > 0 && renderingOptions.maximumFileSize && fileSize > renderingOptions.maximumFileSize.unsignedLongLongValue) {
+                continue;
+            }
+
+            // fewest bytes wins, compare pixels instead when the server didn't report both file sizes
+            BOOL smaller = fileSize > 0 && selectedFileSize > 0 ? fileSize < selectedFileSize : pixelSize < selectedPixelSize;
+            if (!selectedUrl || smaller) {
+                selectedUrl = url;
+                selectedFileSize = fileSize;
+                selectedPixelSize = pixelSize;
+            }
+        }
     }
 
+    return selectedUrl;
+}
+
+- (nullable NSURL *)variantUrlWithFallbackForRenderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions {
     BOOL findFallback = YES;
     IMImojiObjectRenderSize imageSize = renderingOptions.renderSize;
     while (findFallback) {
-        IMImojiObjectRenderingOptions *options = [IMImojiObjectRenderingOptions optionsWithRenderSize:imageSize
-                                                                                          borderStyle:renderingOptions.borderStyle
-                                                                                          imageFormat:renderingOptions.imageFormat];
-        id url = self.urls[options];
-
-        if (renderingOptions.maximumFileSize) {
-            NSNumber *size = self.fileSizes[options];
-            
+        NSURL *url = [self variantUrlForRenderSize:imageSize
+                                       borderStyle:renderingOptions.borderStyle
+                                       imageFormat:renderingOptions.imageFormat];
+
+        if (url && renderingOptions.maximumFileSize) {
+            NSUInteger size = [self variantFileSizeForRenderSize:imageSize
+                                                     borderStyle:renderingOptions.borderStyle
+                                                     imageFormat:renderingOptions.imageFormat];
+
             // avoid the URL if the file size is larger than requested
-            if ([size isKindOfClass:[NSNumber class]] &&
-                    size.longLongValue > renderingOptions.maximumFileSize.longLongValue) {
+            if (size > 0 && size > renderingOptions.maximumFileSize.unsignedLongLongValue) {
                 url = nil;
             }
         }
 
-        if (url && [url isKindOfClass:[NSURL class]]) {
+        if (url) {
             return url;
         }
 
-        // fallback to PNG format, the contents are the same when returned to the caller
+        // fallback to the other still format, the contents are the same when returned to the caller. locally created
+        // imojis may only have WebP variants
         if (renderingOptions.imageFormat == IMImojiObjectImageFormatWebP) {
-            url = self.urls[[IMImojiObjectRenderingOptions optionsWithRenderSize:imageSize
-                                                                     borderStyle:renderingOptions.borderStyle
-                                                                     imageFormat:IMImojiObjectImageFormatPNG]];
+            url = [self variantUrlForRenderSize:imageSize
+                                    borderStyle:renderingOptions.borderStyle
+                                    imageFormat:IMImojiObjectImageFormatPNG];
+        } else if (renderingOptions.imageFormat == IMImojiObjectImageFormatPNG) {
+            url = [self variantUrlForRenderSize:imageSize
+                                    borderStyle:renderingOptions.borderStyle
+                                    imageFormat:IMImojiObjectImageFormatWebP];
         }
 
-        if (url && [url isKindOfClass:[NSURL class]]) {
+        if (url) {
             return url;
         }
 
@@ -148,9 +243,38 @@
 }
 
 - (CGSize)getImageDimensionsForRenderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions {
-    id imageDimension = self.imageDimensions[[IMImojiObjectRenderingOptions optionsWithRenderSize:renderingOptions.renderSize
-                                                                                      borderStyle:renderingOptions.borderStyle
-                                                                                      imageFormat:renderingOptions.imageFormat]];
+    return [self variantDimensionsForRenderSize:renderingOptions.renderSize
+                                    borderStyle:renderingOptions.borderStyle
+                                    imageFormat:renderingOptions.imageFormat];
+}
+
+- (NSUInteger)getFileSizeForRenderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions {
+    return [self variantFileSizeForRenderSize:renderingOptions.renderSize
+                                  borderStyle:renderingOptions.borderStyle
+                                  imageFormat:renderingOptions.imageFormat];
+}
+
+#pragma mark Variant Lookups
+
+// Subclasses holding their variants in a more compact form override these three lookups, the public accessors and
+// fallback logic above are built entirely on top of them.
+
+- (NSURL *)variantUrlForRenderSize:(IMImojiObjectRenderSize)renderSize
+                       borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                       imageFormat:(IMImojiObjectImageFormat)imageFormat {
+    id url = self.urls[[IMImojiObjectRenderingOptions optionsWithRenderSize:renderSize
+                                                                borderStyle:borderStyle
+                                                                imageFormat:imageFormat]];
+
+    return [url isKindOfClass:[NSURL class]] ? url : nil;
+}
+
+- (CGSize)variantDimensionsForRenderSize:(IMImojiObjectRenderSize)renderSize
+                             borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                             imageFormat:(IMImojiObjectImageFormat)imageFormat {
+    id imageDimension = self.imageDimensions[[IMImojiObjectRenderingOptions optionsWithRenderSize:renderSize
+                                                                                      borderStyle:borderStyle
+                                                                                      imageFormat:imageFormat]];
 
     if (imageDimension && [imageDimension isKindOfClass:[NSValue class]]) {
         return ((NSValue *) imageDimension).CGSizeValue;
@@ -159,10 +283,12 @@
     return CGSizeZero;
 }
 
-- (NSUInteger)getFileSizeForRenderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions {
-    id fileSize = self.fileSizes[[IMImojiObjectRenderingOptions optionsWithRenderSize:renderingOptions.renderSize
-                                                                          borderStyle:renderingOptions.borderStyle
-                                                                          imageFormat:renderingOptions.imageFormat]];
+- (NSUInteger)variantFileSizeForRenderSize:(IMImojiObjectRenderSize)renderSize
+                               borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                               imageFormat:(IMImojiObjectImageFormat)imageFormat {
+    id fileSize = self.fileSizes[[IMImojiObjectRenderingOptions optionsWithRenderSize:renderSize
+                                                                          borderStyle:borderStyle
+                                                                          imageFormat:imageFormat]];
 
     if (fileSize && [fileSize isKindOfClass:[NSNumber class]]) {
         return ((NSNumber *) fileSize).unsignedIntegerValue;
@@ -30,6 +30,15 @@
 #import "IMImojiResultSetMetadata.h"
 
 @class IMImojiObject, IMImojiSessionStoragePolicy;
+@class IMImojiImageCache;
+@class IMImojiImageDiskCache;
+@class BFTask;
+@class IMImojiDownloadScheduler;
+@class IMImojiResultCache;
+@class IMImojiCategorySnapshotStore;
+@class IMImojiLookupBatcher;
+@class IMImojiAnalyticsBuffer;
+@class IMImojiRetryPolicy;
 @protocol IMImojiSessionDelegate;
 @class IMCategoryFetchOptions;
 
@@ -148,6 +157,26 @@ typedef NS_ENUM(NSUInteger, IMImojiCollectionType) {
             IMImojiCollectionTypeAll
 };
 
+/**
+* @abstract Priority used for scheduling the image downloads of a render request
+*/
+typedef NS_ENUM(NSUInteger, IMImojiSessionDownloadPriority) {
+    /**
+    * @abstract The imoji is currently on screen. This is the default for all render requests
+    */
+            IMImojiSessionDownloadPriorityVisible,
+
+    /**
+    * @abstract The imoji is about to become visible, for instance the next row in a scrolling list
+    */
+            IMImojiSessionDownloadPriorityNearVisible,
+
+    /**
+    * @abstract The imoji is not expected to be displayed soon
+    */
+            IMImojiSessionDownloadPriorityPrefetch
+};
+
 /**
 * @abstract Callback used for triggering when the server has loaded a result set
 * @param metadata Result set metadata for the request.
@@ -163,6 +192,14 @@ typedef void (^IMImojiSessionResultSetResponseCallback)(IMImojiResultSetMetadata
 */
 typedef void (^IMImojiSessionImojiFetchedResponseCallback)(IMImojiObject *__nullable imoji, NSUInteger index, NSError *__nullable error);
 
+/**
+* @abstract Callback used for delivering an entire result set at once
+* @param metadata Result set metadata for the request.
+* @param imojis The fetched IMImojiObject's ordered by their position in the result set
+* @param error An error with code equal to an IMImojiSessionErrorCode value or nil if the request succeeded
+*/
+typedef void (^IMImojiSessionImojiBatchResponseCallback)(IMImojiResultSetMetadata *__nullable metadata, NSArray<IMImojiObject *> *__nullable imojis, NSError *__nullable error);
+
 /**
 * @abstract Callback used for generic asynchronous requests
 * @param imojiCategories An array of IMImojiCategoryObject's
@@ -221,6 +258,23 @@ typedef void (^IMImojiSessionImojiAttributionResponseCallback)(NSDictionary *__n
 @private
     IMImojiSessionState _sessionState;
     NSURLSession *_urlSession;
+    NSURLSession *_analyticsURLSession;
+    IMImojiImageDiskCache *_imageDiskCache;
+    IMImojiImageDiskCache *_exportDiskCache;
+    IMImojiImageDiskCache *_stickerDiskCache;
+    NSMutableDictionary *_imageDownloads;
+    IMImojiDownloadScheduler *_downloadScheduler;
+    NSMutableDictionary *_prefetchOperations;
+    NSUInteger _prefetchedBytes;
+    IMImojiResultCache *_resultCache;
+    IMImojiCategorySnapshotStore *_categorySnapshots;
+    NSCache *_imojiMetadataCache;
+    IMImojiLookupBatcher *_imojiLookupBatcher;
+    IMImojiAnalyticsBuffer *_analyticsBuffer;
+    NSCache *_attributionCache;
+    NSMutableDictionary *_attributionRequests;
+    IMImojiRetryPolicy *_retryPolicy;
+    BFTask *_authenticationTask;
 }
 
 /**
@@ -255,6 +309,20 @@ typedef void (^IMImojiSessionImojiAttributionResponseCallback)(NSDictionary *__n
  */
 @property(nonatomic, readonly, nonnull) IMImojiSessionStoragePolicy *storagePolicy;
 
+/**
+ * @abstract In memory cache of rendered Imoji images used by renderImoji:options:callback:. The cost limits are
+ * initialized from the storage policy and can be adjusted at any time. Exposes hit, miss and eviction statistics.
+ */
+@property(nonatomic, readonly, nonnull) IMImojiImageCache *imageCache;
+
+/**
+ * @abstract Search and featured results are decoded as they are received from the server. When set to YES,
+ * imojiResponseCallback is called for each imoji as soon as it has been decoded and resultSetResponseCallback is
+ * called once the entire response has been read, after the last imoji. When NO, the default, resultSetResponseCallback
+ * is called before any imojiResponseCallback once the entire response has been read.
+ */
+@property(nonatomic) BOOL deliversResultsIncrementally;
+
 @end
 
 /**
@@ -338,6 +406,41 @@ typedef void (^IMImojiSessionImojiAttributionResponseCallback)(NSDictionary *__n
 - (nonnull NSOperation *)fetchImojisByIdentifiers:(nonnull NSArray *)imojiObjectIdentifiers
                           fetchedResponseCallback:(nonnull IMImojiSessionImojiFetchedResponseCallback)fetchedResponseCallback;
 
+/**
+* @abstract Searches the imojis database with a given search term and delivers the entire result set in a single
+* callback. Results are decoded in the background.
+* @param searchTerm Search term to find imojis with. If nil or empty, the server will typically returned the featured set of imojis (this is subject to change).
+* @param offset The result offset from a previous search. This may be nil.
+* @param contributingImojiId An optional imoji identifier to include alongside the results.
+* @param numberOfResults Number of results to fetch. This can be nil.
+* @param batchResponseCallback Callback triggered with all of the results or if an error occurred.
+* @return An operation reference that can be used to cancel the request.
+*/
+- (nonnull NSOperation *)searchImojisWithTerm:(nullable NSString *)searchTerm
+                                       offset:(nullable NSNumber *)offset
+                          contributingImojiId:(nullable NSString *)contributingImojiId
+                              numberOfResults:(nullable NSNumber *)numberOfResults
+                        batchResponseCallback:(nonnull IMImojiSessionImojiBatchResponseCallback)batchResponseCallback;
+
+/**
+* @abstract Gets a random set of featured imojis and delivers them in a single callback. Results are decoded in the
+* background.
+* @param numberOfResults Number of results to fetch. This can be nil.
+* @param batchResponseCallback Callback triggered with all of the results or if an error occurred.
+* @return An operation reference that can be used to cancel the request.
+*/
+- (nonnull NSOperation *)getFeaturedImojisWithNumberOfResults:(nullable NSNumber *)numberOfResults
+                                        batchResponseCallback:(nonnull IMImojiSessionImojiBatchResponseCallback)batchResponseCallback;
+
+/**
+* @abstract Gets corresponding IMImojiObject's for one or more imoji identifiers and delivers them in a single callback.
+* @param imojiObjectIdentifiers An array of NSString's representing the identifiers of the imojis to fetch
+* @param batchResponseCallback Callback triggered with all of the fetched imojis or if an error occurred.
+* @return An operation reference that can be used to cancel the request.
+*/
+- (nonnull NSOperation *)fetchImojisByIdentifiers:(nonnull NSArray *)imojiObjectIdentifiers
+                            batchResponseCallback:(nonnull IMImojiSessionImojiBatchResponseCallback)batchResponseCallback;
+
 /**
  * @abstract Searches the imojis database with a complete sentence. The service performs keyword parsing to find best matched imojis.
  * @param sentence Full sentence to parse.
@@ -391,6 +494,51 @@ typedef void (^IMImojiSessionImojiAttributionResponseCallback)(NSDictionary *__n
 - (nonnull NSOperation *)renderImojiAsMSSticker:(nonnull IMImojiObject *)imoji
                                         options:(nonnull IMImojiObjectRenderingOptions *)options
                                        callback:(nonnull IMImojiSessionMSStickerResponseCallback)callback;
+
+/**
+ * @abstract Renders and stores the sticker files used by renderImojiAsMSSticker:options:callback: in the background,
+ * so that a messaging extension can later hand out stickers for these imojis without any rendering. Files are kept
+ * with the other exported images within the storage policy's exportDiskCacheSize. Imojis that already have a sticker
+ * file for the options are skipped. Only a few imojis are rendered at a time, downloads are made at prefetch priority.
+ * @param imojis The imojis to prepare sticker files for.
+ * @param options Set of options the stickers will be rendered with.
+ * @return An operation reference that can be used to cancel the preparation.
+ */
+- (nonnull NSOperation *)prepareStickerFilesForImojis:(nonnull NSArray<IMImojiObject *> *)imojis
+                                              options:(nonnull IMImojiObjectRenderingOptions *)options;
+
+/**
+ * @abstract Changes the download priority of a pending render request. Downloads are started by priority and then most
+ * recently requested first, so lowering the priority of imojis that scrolled off screen lets visible ones load first.
+ * When several render requests share a download, the highest priority among them is used.
+ * @param priority The new priority.
+ * @param operation An operation returned by one of the render methods.
+ */
+- (void)setDownloadPriority:(IMImojiSessionDownloadPriority)priority
+         forRenderOperation:(nonnull NSOperation *)operation;
+
+/**
+ * @abstract Downloads imojis ahead of display so that later calls to renderImoji:options:callback: are served from
+ * the encoded memory and disk caches without a network request, e.g. for the next page of search results or the preview imojis of related
+ * categories. Images are only downloaded, they are decoded once rendered. Prefetches are downloaded after visible
+ * render requests. Imojis are prefetched in order until the storage policy's prefetchByteBudget is used up by the
+ * prefetches still in flight, including those of earlier calls; the remaining ones are skipped.
+ * @param imojis The imojis to prefetch, in the order they are expected to be displayed.
+ * @param options Set of options the imojis will be rendered with.
+ * @return An operation reference that can be used to cancel all prefetches started by this call.
+ */
+- (nonnull NSOperation *)prefetchImojis:(nonnull NSArray<IMImojiObject *> *)imojis
+                                options:(nonnull IMImojiObjectRenderingOptions *)options;
+
+/**
+ * @abstract Cancels prefetches for the given imojis, e.g. once the user has scrolled in the other direction. Render
+ * requests for the same imojis are not affected.
+ * @param imojis The imojis to stop prefetching.
+ * @param options Set of options the imojis were prefetched with.
+ */
+- (void)cancelPrefetchingImojis:(nonnull NSArray<IMImojiObject *> *)imojis
+                        options:(nonnull IMImojiObjectRenderingOptions *)options;
+
 @end
 
 @interface IMImojiSession (CollectionManagement)
@@ -438,7 +586,8 @@ typedef void (^IMImojiSessionImojiAttributionResponseCallback)(NSDictionary *__n
  * @param tags An array of NSString tags or nil if there are none
  * @param beginUploadCallback Called once the uploading of the image has started. A temporary Imoji is passed back
  * to the caller which can be used as a filler while the upload is taking place.
- * @param finishUploadCallback Called once the save operation is complete
+ * @param finishUploadCallback Called once the save operation is complete. Only called when uploadsCreatedImojis is
+ * set on the storage policy of the session.
  * @return An operation reference that can be used to cancel the request.
  */
 - (nonnull NSOperation *)createImojiWithRawImage:(nonnull UIImage *)image
@@ -491,7 +640,8 @@ typedef void (^IMImojiSessionImojiAttributionResponseCallback)(NSDictionary *__n
 @interface IMImojiSession (Attribution)
 
 /**
-* @abstract Gets attribution information for a set of IMImoji identifiers.
+* @abstract Gets attribution information for a set of IMImoji identifiers. Attribution is cached for the lifetime
+* of the session, only identifiers that were not fetched before are sent to the server.
 * @param imojiObjectIdentifiers An array of NSString's representing the identifiers of the imojis to fetch.
 * @param callback Callback triggered with attribution results when available.
 * @return An operation reference that can be used to cancel the request.
@@ -33,16 +33,49 @@
 #import "NSDictionary+Utils.h"
 #import "IMMutableImojiObject.h"
 #import "UIImage+Extensions.h"
+#import "NSString+Utils.h"
 #import "IMImojiSession+Private.h"
 #import "IMMutableCategoryAttribution.h"
 #import "IMCategoryFetchOptions.h"
+#import "IMImojiImageCache.h"
+#import "IMImojiImageDiskCache.h"
+#import "IMImojiStreamingURLSessionDelegate.h"
+#import "IMImojiDownloadScheduler.h"
+#import "IMImojiCancellationToken.h"
+#import "IMImojiResultCache.h"
+#import "IMImojiCategorySnapshotStore.h"
+#import "IMImojiConditionalResponse.h"
+#import "IMImojiLookupBatcher.h"
+#import "IMImojiAnalyticsBuffer.h"
+#import "IMImojiRetryPolicy.h"
+#import "IMImojiGIFEncoder.h"
+#import "BFTask+Utils.h"
 
 #if IMMessagesFrameworkSupported
 #import <Messages/Messages.h>
-#import "BFTask+Utils.h"
 #endif
 
 NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
+NSUInteger const IMImojiSessionResultCacheCountLimit = 64;
+NSUInteger const IMImojiSessionImojiMetadataCacheCountLimit = 500;
+NSTimeInterval const IMImojiSessionImojiLookupBatchInterval = 0.02;
+NSUInteger const IMImojiSessionImojiLookupMaximumBatchSize = 50;
+NSUInteger const IMImojiSessionAnalyticsBufferCapacity = 500;
+NSUInteger const IMImojiSessionAttributionCacheCountLimit = 500;
+int const IMImojiSessionNumberOfRetriesForImageUpload = 3;
+NSTimeInterval const IMImojiSessionRetryInitialBackoffInterval = 0.5;
+NSTimeInterval const IMImojiSessionRetryMaximumBackoffInterval = 30.0;
+NSUInteger const IMImojiSessionRetryFailureThreshold = 5;
+NSTimeInterval const IMImojiSessionRetryCircuitOpenInterval = 30.0;
+NSUInteger const IMImojiSessionGIFPaletteSampleFrameCount = 8;
+NSUInteger const IMImojiSessionEstimatedThumbnailFileSize = 32 * 1024;
+NSUInteger const IMImojiSessionEstimatedFullResolutionFileSize = 512 * 1024;
+NSUInteger const IMImojiSessionEstimatedAnimatedFileSizeMultiplier = 4;
+NSUInteger const IMImojiSessionStickerPreparationConcurrency = 2;
+
+static int IMImojiSessionWriteGIFBytes(void *context, const uint8_t *bytes, size_t length) {
+    return fwrite(bytes, 1, length, (FILE *) context) == length;
+}
 
 @implementation IMImojiSession
 
@@ -69,47 +102,110 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
 - (void)setupWithStoragePolicy:(IMImojiSessionStoragePolicy *)storagePolicy {
     _sessionState = IMImojiSessionStateNotConnected;
     _storagePolicy = storagePolicy;
-
-    self->_urlSession = [NSURLSession sessionWithConfiguration:[_storagePolicy generateURLSessionConfiguration]];
+    _imageCache = [[IMImojiImageCache alloc] initWithTotalCostLimit:storagePolicy.imageMemoryCacheSize
+                                                   encodedCostLimit:storagePolicy.encodedImageMemoryCacheSize];
+
+    self->_urlSession = [NSURLSession sessionWithConfiguration:[_storagePolicy generateURLSessionConfiguration]
+                                                      delegate:[IMImojiStreamingURLSessionDelegate new]
+                                                 delegateQueue:nil];
+    self->_imageDiskCache = [[IMImojiImageDiskCache alloc] initWithPath:[_storagePolicy.cachePath.path stringByAppendingPathComponent:@"imoji-images"]
+                                                              sizeLimit:_storagePolicy.imageDiskCacheSize];
+    self->_exportDiskCache = [[IMImojiImageDiskCache alloc] initWithPath:[_storagePolicy.cachePath.path stringByAppendingPathComponent:@"imoji-exports"]
+                                                               sizeLimit:_storagePolicy.exportDiskCacheSize];
+    // sticker file paths are handed out to the messages framework, keep them around while it may use them without
+    // holding on to every other export
+    self->_stickerDiskCache = [[IMImojiImageDiskCache alloc] initWithPath:[_storagePolicy.cachePath.path stringByAppendingPathComponent:@"imoji-stickers"]
+                                                                sizeLimit:_storagePolicy.exportDiskCacheSize];
+    self->_stickerDiskCache.minimumAge = _storagePolicy.stickerFileLifetime;
+    self->_imageDownloads = [NSMutableDictionary new];
+    self->_downloadScheduler = [[IMImojiDownloadScheduler alloc] initWithMaximumConcurrentDownloads:_storagePolicy.maximumConcurrentImageDownloads];
+    self->_retryPolicy = [[IMImojiRetryPolicy alloc] initWithInitialBackoffInterval:IMImojiSessionRetryInitialBackoffInterval
+                                                             maximumBackoffInterval:IMImojiSessionRetryMaximumBackoffInterval
+                                                                   failureThreshold:IMImojiSessionRetryFailureThreshold
+                                                                circuitOpenInterval:IMImojiSessionRetryCircuitOpenInterval];
+    self->_prefetchOperations = [NSMutableDictionary new];
+    self->_resultCache = [[IMImojiResultCache alloc] initWithCountLimit:IMImojiSessionResultCacheCountLimit
+                                                             maximumAge:_storagePolicy.resultCacheMaximumAge];
+    self->_categorySnapshots = [[IMImojiCategorySnapshotStore alloc] initWithPath:[_storagePolicy.persistentPath.path stringByAppendingPathComponent:@"imoji-categories"]];
+    self->_imojiMetadataCache = [NSCache new];
+    self->_imojiMetadataCache.countLimit = IMImojiSessionImojiMetadataCacheCountLimit;
+    self->_attributionCache = [NSCache new];
+    self->_attributionCache.countLimit = IMImojiSessionAttributionCacheCountLimit;
+    self->_attributionRequests = [NSMutableDictionary new];
+
+    __weak IMImojiSession *weakSelf = self;
+    self->_imojiLookupBatcher = [[IMImojiLookupBatcher alloc] initWithBatchInterval:IMImojiSessionImojiLookupBatchInterval
+                                                                  maximumBatchSize:IMImojiSessionImojiLookupMaximumBatchSize
+                                                                        fetchBlock:^BFTask *(NSArray<NSString *> *identifiers) {
+                                                                            return [weakSelf fetchImojiObjectsWithIdentifiers:identifiers];
+                                                                        }];
+
+    // usage events travel on their own low priority session so they never hold up connections used by image downloads
+    NSURLSessionConfiguration *analyticsConfiguration = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+    analyticsConfiguration.HTTPMaximumConnectionsPerHost = 1;
+    analyticsConfiguration.networkServiceType = NSURLNetworkServiceTypeBackground;
+    analyticsConfiguration.URLCache = nil;
+    self->_analyticsURLSession = [NSURLSession sessionWithConfiguration:analyticsConfiguration];
+    self->_analyticsBuffer = [[IMImojiAnalyticsBuffer alloc] initWithPath:[_storagePolicy.persistentPath.path stringByAppendingPathComponent:@"imoji-analytics.plist"]
+                                                                 capacity:IMImojiSessionAnalyticsBufferCapacity
+                                                          flushEventCount:_storagePolicy.analyticsFlushEventCount
+                                                            flushInterval:_storagePolicy.analyticsFlushInterval
+                                                                sendBlock:^BFTask *(NSArray<NSDictionary *> *events) {
+                                                                    IMImojiSession *strongSelf = weakSelf;
+                                                                    if (!strongSelf) {
+                                                                        return [BFTask taskWithResult:@0];
+                                                                    }
+
+                                                                    return [strongSelf runValidatedGetTasksWithPath:@"/analytics/imoji/sent"
+                                                                                                      parameterSets:events
+                                                                                                         URLSession:strongSelf->_analyticsURLSession];
+                                                                }];
 
     [self readAuthenticationCredentials];
 }
 
+- (void)dealloc {
+    // sessions with a delegate retain it until they are invalidated
+    [self->_urlSession finishTasksAndInvalidate];
+    [self->_analyticsURLSession finishTasksAndInvalidate];
+}
+
 - (BFTask *)downloadImojiContents:(IMMutableImojiObject *)imoji
                   renderingOtions:(IMImojiObjectRenderingOptions *)renderingOptions
                 cancellationToken:cancellationToken {
-    __block BFTaskCompletionSource *taskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
-    [[self validateSession] continueWithExecutor:[BFExecutor mainThreadExecutor] withBlock:^id(BFTask *task) {
-        if (task.error) {
-            taskCompletionSource.error = task.error;
-        } else {
-            if (!imoji.urls) {
-                taskCompletionSource.error = [NSError errorWithDomain:IMImojiSessionErrorDomain
-                                                                 code:IMImojiSessionErrorCodeImojiDoesNotExist
-                                                             userInfo:@{
-                                                                     NSLocalizedDescriptionKey : [NSString stringWithFormat:@"unable to download imoji %@", imoji.identifier]
-                                                             }];
-            } else {
-                [[self downloadImojiImageAsync:imoji
-                              renderingOptions:renderingOptions
-                                    imojiIndex:0
-                             cancellationToken:cancellationToken] continueWithExecutor:[BFExecutor mainThreadExecutor]
-                                                                             withBlock:^id(BFTask *downloadTask) {
-                                                                                 if (downloadTask.error) {
-                                                                                     taskCompletionSource.error = downloadTask.error;
-                                                                                 } else {
-                                                                                     taskCompletionSource.result = downloadTask.result;
-                                                                                 }
-
-                                                                                 return nil;
-                                                                             }];
-            }
-        }
+    NSURL *url = [imoji getUrlForRenderingOptions:renderingOptions];
+    if (!url) {
+        return [BFTask taskWithError:[NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                         code:IMImojiSessionErrorCodeImojiDoesNotExist
+                                                     userInfo:@{
+                                                             NSLocalizedDescriptionKey : [NSString stringWithFormat:@"unable to download imoji %@", imoji.identifier]
+                                                     }]];
+    }
 
-        return nil;
+    return [[[self validateSessionForImoji:imoji url:url renderingOptions:renderingOptions] continueWithSuccessBlock:^id(BFTask *task) {
+        return [self downloadImojiImageAsync:imoji
+                            renderingOptions:renderingOptions
+                                  imojiIndex:0
+                           cancellationToken:cancellationToken];
+    }] continueWithExecutor:[BFExecutor mainThreadExecutor] withBlock:^id(BFTask *task) {
+        return task;
     }];
+}
+
+- (BFTask *)validateSessionForImoji:(IMMutableImojiObject *)imoji
+                                url:(NSURL *)url
+                   renderingOptions:(IMImojiObjectRenderingOptions *)renderingOptions {
+    return [BFTask im_concurrentBackgroundTaskWithBlock:^id(BFTask *task) {
+        // images that are already local need no network at all, so only validate the session (which may have to renew
+        // an expired token) when the image actually has to be fetched
+        if (url.isFileURL ||
+                [self.imageCache peekImageDataForImoji:imoji renderingOptions:renderingOptions] ||
+                [self->_imageDiskCache containsDataForURL:url]) {
+            return nil;
+        }
 
-    return taskCompletionSource.task;
+        return [self validateSession];
+    }];
 }
 
 #pragma mark Public Methods
@@ -139,24 +235,31 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
         parameters[@"licenseStyles"] = options.licenseStyles;
     }
 
-    [[self runValidatedGetTaskWithPath:@"/imoji/categories/fetch"
-                         andParameters:parameters]
-            continueWithExecutor:[BFExecutor mainThreadExecutor] withBlock:^id(BFTask *getTask) {
-        NSDictionary *results = getTask.result;
+    NSString *cacheKey = [IMImojiResultCache keyForPath:@"/imoji/categories/fetch" parameters:parameters];
+    NSTimeInterval timeToLive = self.storagePolicy.categoriesCacheTimeToLive;
+    BOOL stale = NO;
+    NSArray *cachedCategories = timeToLive > 0 ? [self->_resultCache objectForKey:cacheKey timeToLive:timeToLive stale:&stale] : nil;
 
-        __block NSError *error;
-        [self validateServerResponse:results error:&error];
-        if (error) {
-            callback(nil, error);
-        } else {
-            NSArray *categories = results[@"categories"];
-            if (callback) {
-                if ([categories isEqual:[NSNull null]]) {
-                    callback(nil, nil);
-                } else {
-                    callback([self readCategories:categories], nil);
-                }
-            }
+    BFTask *categoriesTask;
+    if (cachedCategories) {
+        categoriesTask = [BFTask taskWithResult:cachedCategories];
+
+        // hand out the stale categories right away, the refreshed ones are picked up by the next request
+        if (stale && [self->_resultCache beginRefreshForKey:cacheKey]) {
+            [[self fetchCategoriesWithParameters:parameters cacheKey:cacheKey cancellationToken:nil] continueWithBlock:^id(BFTask *task) {
+                [self->_resultCache endRefreshForKey:cacheKey];
+                return nil;
+            }];
+        }
+    } else if (timeToLive > 0) {
+        categoriesTask = [self loadCategorySnapshotWithParameters:parameters cacheKey:cacheKey cancellationToken:cancellationToken];
+    } else {
+        categoriesTask = [self fetchCategoriesWithParameters:parameters cacheKey:cacheKey cancellationToken:cancellationToken];
+    }
+
+    [categoriesTask continueWithExecutor:[BFExecutor mainThreadExecutor] withBlock:^id(BFTask *task) {
+        if (callback && !cancellationToken.cancelled) {
+            callback(task.result, task.error);
         }
 
         return nil;
@@ -165,6 +268,97 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
     return cancellationToken;
 }
 
+- (BFTask *)fetchCategoriesWithParameters:(NSDictionary *)parameters
+                                 cacheKey:(NSString *)cacheKey
+                        cancellationToken:(NSOperation *)cancellationToken {
+    return [BFTask im_concurrentBackgroundTaskWithBlock:^id(BFTask *task) {
+        // revalidate against the persisted snapshot so an unchanged category tree only costs a 304. Snapshots are kept
+        // even when categories aren't cached in memory, revalidating is always cheaper than downloading the tree again
+        BOOL cachesCategories = self.storagePolicy.categoriesCacheTimeToLive > 0;
+        IMImojiCategorySnapshot *snapshot = [self->_categorySnapshots snapshotForKey:cacheKey];
+
+        return [[self runValidatedConditionalGetTaskWithPath:@"/imoji/categories/fetch"
+                                                  parameters:parameters
+                                                   entityTag:snapshot.entityTag
+                                                lastModified:snapshot.lastModified
+                                           cancellationToken:cancellationToken]
+                continueWithExecutor:[BFTask im_concurrentBackgroundExecutor] withBlock:^id(BFTask *getTask) {
+            if (getTask.cancelled) {
+                return [BFTask cancelledTask];
+            }
+
+            if (getTask.error) {
+                return [BFTask taskWithError:getTask.error];
+            }
+
+            IMImojiConditionalResponse *response = getTask.result;
+            if (response.notModified) {
+                NSArray *cachedCategories = [self->_resultCache objectForKey:cacheKey timeToLive:DBL_MAX stale:nil];
+                if (cachedCategories) {
+                    [self->_resultCache setObject:cachedCategories forKey:cacheKey];
+                    return cachedCategories;
+                }
+            }
+
+            NSDictionary *results = response.notModified ? snapshot.results : response.results;
+
+            NSError *error;
+            [self validateServerResponse:results error:&error];
+            if (error) {
+                return [BFTask taskWithError:error];
+            }
+
+            if (!response.notModified) {
+                [self->_categorySnapshots storeResults:results
+                                             entityTag:response.entityTag
+                                          lastModified:response.lastModified
+                                                forKey:cacheKey];
+            }
+
+            NSArray *categories = [self readCategoriesFromResults:results];
+            if (cachesCategories) {
+                [self->_resultCache setObject:categories forKey:cacheKey];
+            }
+
+            return categories;
+        }];
+    }];
+}
+
+- (BFTask *)loadCategorySnapshotWithParameters:(NSDictionary *)parameters
+                                      cacheKey:(NSString *)cacheKey
+                             cancellationToken:(NSOperation *)cancellationToken {
+    return [BFTask im_concurrentBackgroundTaskWithBlock:^id(BFTask *task) {
+        IMImojiCategorySnapshot *snapshot = [self->_categorySnapshots snapshotForKey:cacheKey];
+        if (!snapshot || ![self validateServerResponse:snapshot.results error:nil]) {
+            return [self fetchCategoriesWithParameters:parameters cacheKey:cacheKey cancellationToken:cancellationToken];
+        }
+
+        // show the categories from the previous launch right away and revalidate them for the next request
+        NSArray *categories = [self readCategoriesFromResults:snapshot.results];
+        [self->_resultCache setObject:categories forKey:cacheKey];
+
+        if ([self->_resultCache beginRefreshForKey:cacheKey]) {
+            [[self fetchCategoriesWithParameters:parameters cacheKey:cacheKey cancellationToken:nil] continueWithBlock:^id(BFTask *refreshTask) {
+                [self->_resultCache endRefreshForKey:cacheKey];
+                return nil;
+            }];
+        }
+
+        return categories;
+    }];
+}
+
+- (NSArray *)readCategoriesFromResults:(NSDictionary *)results {
+    NSArray *categories = results[@"categories"];
+    if (![categories isKindOfClass:[NSArray class]]) {
+        return @[];
+    }
+
+    // decoding category previews builds an imoji object per preview, keep it off the main thread
+    return [self readCategories:categories];
+}
+
 - (NSOperation *)searchImojisWithTerm:(NSString *)searchTerm
                                offset:(NSNumber *)offset
                       numberOfResults:(NSNumber *)numberOfResults
@@ -179,6 +373,36 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
                       numberOfResults:(NSNumber *)numberOfResults
             resultSetResponseCallback:(IMImojiSessionResultSetResponseCallback)resultSetResponseCallback
                 imojiResponseCallback:(IMImojiSessionImojiFetchedResponseCallback)imojiResponseCallback {
+    return [self searchImojisWithTerm:searchTerm
+                               offset:offset
+                  contributingImojiId:contributingImojiId
+                      numberOfResults:numberOfResults
+            resultSetResponseCallback:resultSetResponseCallback
+                imojiResponseCallback:imojiResponseCallback
+                batchResponseCallback:nil];
+}
+
+- (NSOperation *)searchImojisWithTerm:(NSString *)searchTerm
+                               offset:(NSNumber *)offset
+                  contributingImojiId:(NSString *)contributingImojiId
+                      numberOfResults:(NSNumber *)numberOfResults
+                batchResponseCallback:(IMImojiSessionImojiBatchResponseCallback)batchResponseCallback {
+    return [self searchImojisWithTerm:searchTerm
+                               offset:offset
+                  contributingImojiId:contributingImojiId
+                      numberOfResults:numberOfResults
+            resultSetResponseCallback:nil
+                imojiResponseCallback:nil
+                batchResponseCallback:batchResponseCallback];
+}
+
+- (NSOperation *)searchImojisWithTerm:(NSString *)searchTerm
+                               offset:(NSNumber *)offset
+                  contributingImojiId:(NSString *)contributingImojiId
+                      numberOfResults:(NSNumber *)numberOfResults
+            resultSetResponseCallback:(IMImojiSessionResultSetResponseCallback)resultSetResponseCallback
+                imojiResponseCallback:(IMImojiSessionImojiFetchedResponseCallback)imojiResponseCallback
+                batchResponseCallback:(IMImojiSessionImojiBatchResponseCallback)batchResponseCallback {
     __block NSOperation *cancellationToken = self.cancellationTokenOperation;
 
     if (numberOfResults && numberOfResults.integerValue <= 0) {
@@ -199,24 +423,12 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
         parameters[@"contributingImojiId"] = contributingImojiId;
     }
 
-    [[self runValidatedGetTaskWithPath:@"/imoji/search" andParameters:parameters] continueWithExecutor:[BFExecutor mainThreadExecutor] withBlock:^id(BFTask *getTask) {
-        NSDictionary *results = getTask.result;
-
-        NSError *error;
-        [self validateServerResponse:results error:&error];
-        if (error) {
-            resultSetResponseCallback(nil, error);
-        } else {
-            [self handleImojiFetchResponse:[self convertServerDataSetToImojiArray:results]
-                         relatedSearchTerm:[results im_checkedStringForKey:@"followupSearchTerm"]
-                         relatedCategories:[self readCategories:[results im_checkedArrayForKey:@"relatedCategories" defaultValue:@[]]]
-                         cancellationToken:cancellationToken
-                    searchResponseCallback:resultSetResponseCallback
-                     imojiResponseCallback:imojiResponseCallback];
-        }
-
-        return nil;
-    }];
+    [self fetchImojiResultSetWithPath:@"/imoji/search"
+                           parameters:parameters
+                    cancellationToken:cancellationToken
+            resultSetResponseCallback:resultSetResponseCallback
+                imojiResponseCallback:imojiResponseCallback
+                batchResponseCallback:batchResponseCallback];
 
     return cancellationToken;
 }
@@ -224,6 +436,24 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
 - (NSOperation *)getFeaturedImojisWithNumberOfResults:(NSNumber *)numberOfResults
                             resultSetResponseCallback:(IMImojiSessionResultSetResponseCallback)resultSetResponseCallback
                                 imojiResponseCallback:(IMImojiSessionImojiFetchedResponseCallback)imojiResponseCallback {
+    return [self getFeaturedImojisWithNumberOfResults:numberOfResults
+                            resultSetResponseCallback:resultSetResponseCallback
+                                imojiResponseCallback:imojiResponseCallback
+                                batchResponseCallback:nil];
+}
+
+- (NSOperation *)getFeaturedImojisWithNumberOfResults:(NSNumber *)numberOfResults
+                                batchResponseCallback:(IMImojiSessionImojiBatchResponseCallback)batchResponseCallback {
+    return [self getFeaturedImojisWithNumberOfResults:numberOfResults
+                            resultSetResponseCallback:nil
+                                imojiResponseCallback:nil
+                                batchResponseCallback:batchResponseCallback];
+}
+
+- (NSOperation *)getFeaturedImojisWithNumberOfResults:(NSNumber *)numberOfResults
+                            resultSetResponseCallback:(IMImojiSessionResultSetResponseCallback)resultSetResponseCallback
+                                imojiResponseCallback:(IMImojiSessionImojiFetchedResponseCallback)imojiResponseCallback
+                                batchResponseCallback:(IMImojiSessionImojiBatchResponseCallback)batchResponseCallback {
     __block NSOperation *cancellationToken = self.cancellationTokenOperation;
 
     id numResultsValue;
@@ -237,46 +467,48 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
             @"numResults" : numResultsValue
     }];
 
-    [[self runValidatedGetTaskWithPath:@"/imoji/featured/fetch" andParameters:parameters] continueWithExecutor:[BFExecutor mainThreadExecutor] withBlock:^id(BFTask *getTask) {
-        if (cancellationToken.cancelled) {
-            return [BFTask cancelledTask];
-        }
-
-        if (getTask.error) {
-            resultSetResponseCallback(nil, getTask.error);
-            return nil;
-        }
-
-        NSDictionary *results = getTask.result;
-        NSError *error;
-        [self validateServerResponse:results error:&error];
-
-        if (error) {
-            resultSetResponseCallback(nil, error);
-        } else {
-            [self handleImojiFetchResponse:[self convertServerDataSetToImojiArray:results]
-                         relatedSearchTerm:[results im_checkedStringForKey:@"followupSearchTerm"]
-                         relatedCategories:[self readCategories:[results im_checkedArrayForKey:@"relatedCategories" defaultValue:@[]]]
-                         cancellationToken:cancellationToken
-                    searchResponseCallback:resultSetResponseCallback
-                     imojiResponseCallback:imojiResponseCallback];
-        }
-
-        return nil;
-    }];
+    [self fetchImojiResultSetWithPath:@"/imoji/featured/fetch"
+                           parameters:parameters
+                    cancellationToken:cancellationToken
+            resultSetResponseCallback:resultSetResponseCallback
+                imojiResponseCallback:imojiResponseCallback
+                batchResponseCallback:batchResponseCallback];
 
     return cancellationToken;
 }
 
 - (NSOperation *)fetchImojisByIdentifiers:(NSArray *)imojiObjectIdentifiers
                   fetchedResponseCallback:(IMImojiSessionImojiFetchedResponseCallback)fetchedResponseCallback {
+    return [self fetchImojisByIdentifiers:imojiObjectIdentifiers
+                  fetchedResponseCallback:fetchedResponseCallback
+                    batchResponseCallback:nil];
+}
+
+- (NSOperation *)fetchImojisByIdentifiers:(NSArray *)imojiObjectIdentifiers
+                    batchResponseCallback:(IMImojiSessionImojiBatchResponseCallback)batchResponseCallback {
+    return [self fetchImojisByIdentifiers:imojiObjectIdentifiers
+                  fetchedResponseCallback:nil
+                    batchResponseCallback:batchResponseCallback];
+}
+
+- (NSOperation *)fetchImojisByIdentifiers:(NSArray *)imojiObjectIdentifiers
+                  fetchedResponseCallback:(IMImojiSessionImojiFetchedResponseCallback)fetchedResponseCallback
+                    batchResponseCallback:(IMImojiSessionImojiBatchResponseCallback)batchResponseCallback {
     __block NSOperation *cancellationToken = self.cancellationTokenOperation;
+    void (^errorCallback)(NSError *) = ^(NSError *error) {
+        if (batchResponseCallback) {
+            batchResponseCallback(nil, nil, error);
+        } else {
+            fetchedResponseCallback(nil, NSUIntegerMax, error);
+        }
+    };
+
     if (!imojiObjectIdentifiers || imojiObjectIdentifiers.count == 0) {
-        fetchedResponseCallback(nil, NSUIntegerMax, [NSError errorWithDomain:IMImojiSessionErrorDomain
-                                                                        code:IMImojiSessionErrorCodeInvalidArgument
-                                                                    userInfo:@{
-                                                                            NSLocalizedDescriptionKey : @"imojiObjectIdentifiers is either nil or empty"
-                                                                    }]);
+        errorCallback([NSError errorWithDomain:IMImojiSessionErrorDomain
+                                          code:IMImojiSessionErrorCodeInvalidArgument
+                                      userInfo:@{
+                                              NSLocalizedDescriptionKey : @"imojiObjectIdentifiers is either nil or empty"
+                                      }]);
         return cancellationToken;
     }
     BOOL validArray = YES;
@@ -288,11 +520,11 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
     }
 
     if (!validArray) {
-        fetchedResponseCallback(nil, NSUIntegerMax, [NSError errorWithDomain:IMImojiSessionErrorDomain
-                                                                        code:IMImojiSessionErrorCodeInvalidArgument
-                                                                    userInfo:@{
-                                                                            NSLocalizedDescriptionKey : @"imojiObjectIdentifiers must contain NSString objects only"
-                                                                    }]);
+        errorCallback([NSError errorWithDomain:IMImojiSessionErrorDomain
+                                          code:IMImojiSessionErrorCodeInvalidArgument
+                                      userInfo:@{
+                                              NSLocalizedDescriptionKey : @"imojiObjectIdentifiers must contain NSString objects only"
+                                      }]);
         return cancellationToken;
     }
 
@@ -300,32 +532,32 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
             @"ids" : [imojiObjectIdentifiers componentsJoinedByString:@","]
     }];
 
-    [[self runValidatedPostTaskWithPath:@"/imoji/fetchMultiple" andParameters:parameters] continueWithExecutor:[BFExecutor mainThreadExecutor] withBlock:^id(BFTask *getTask) {
-        if (cancellationToken.cancelled) {
-            return [BFTask cancelledTask];
-        }
+    [self handleImojiResultSetTask:[self runValidatedPostTaskWithPath:@"/imoji/fetchMultiple" parameters:parameters cancellationToken:cancellationToken]
+                      imojiObjects:nil
+                 cancellationToken:cancellationToken
+         resultSetResponseCallback:nil
+             imojiResponseCallback:fetchedResponseCallback
+             batchResponseCallback:batchResponseCallback];
 
-        NSDictionary *results = getTask.result;
-        NSError *error;
-        [self validateServerResponse:results error:&error];
+    return cancellationToken;
+}
 
-        if (error) {
-            fetchedResponseCallback(nil, NSUIntegerMax, error);
-        } else {
-            NSMutableArray *imojiObjects = [NSMutableArray arrayWithArray:[self convertServerDataSetToImojiArray:results]];
+- (BFTask *)fetchImojiObjectsWithIdentifiers:(NSArray<NSString *> *)identifiers {
+    return [[self runValidatedPostTaskWithPath:@"/imoji/fetchMultiple" andParameters:@{
+            @"ids" : [identifiers componentsJoinedByString:@","]
+    }] continueWithExecutor:[BFTask im_concurrentBackgroundExecutor] withBlock:^id(BFTask *task) {
+        if (task.error) {
+            return task;
+        }
 
-            [self handleImojiFetchResponse:imojiObjects
-                         relatedSearchTerm:[results im_checkedStringForKey:@"followupSearchTerm"]
-                         relatedCategories:[self readCategories:[results im_checkedArrayForKey:@"relatedCategories" defaultValue:@[]]]
-                         cancellationToken:cancellationToken
-                    searchResponseCallback:nil
-                     imojiResponseCallback:fetchedResponseCallback];
+        NSError *error;
+        if (![self validateServerResponse:task.result error:&error]) {
+            return [BFTask taskWithError:error];
         }
 
-        return nil;
+        // decoding adds the imojis to the metadata cache
+        return [self convertServerDataSetToImojiArray:task.result];
     }];
-
-    return cancellationToken;
 }
 
 - (NSOperation *)searchImojisWithSentence:(NSString *)sentence
@@ -343,24 +575,12 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
             @"numResults" : numberOfResults != nil ? numberOfResults : [NSNull null]
     }];
 
-    [[self runValidatedGetTaskWithPath:@"/imoji/search" andParameters:parameters] continueWithExecutor:[BFExecutor mainThreadExecutor] withBlock:^id(BFTask *getTask) {
-        NSDictionary *results = getTask.result;
-
-        NSError *error;
-        [self validateServerResponse:results error:&error];
-        if (error) {
-            resultSetResponseCallback(nil, error);
-        } else {
-            [self handleImojiFetchResponse:[self convertServerDataSetToImojiArray:results]
-                         relatedSearchTerm:[results im_checkedStringForKey:@"followupSearchTerm"]
-                         relatedCategories:[self readCategories:[results im_checkedArrayForKey:@"relatedCategories" defaultValue:@[]]]
-                         cancellationToken:cancellationToken
-                    searchResponseCallback:resultSetResponseCallback
-                     imojiResponseCallback:imojiResponseCallback];
-        }
-
-        return nil;
-    }];
+    [self fetchImojiResultSetWithPath:@"/imoji/search"
+                           parameters:parameters
+                    cancellationToken:cancellationToken
+            resultSetResponseCallback:resultSetResponseCallback
+                imojiResponseCallback:imojiResponseCallback
+                batchResponseCallback:nil];
 
     return cancellationToken;
 }
@@ -418,28 +638,12 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
             break;
     }
 
-    [[self runValidatedGetTaskWithPath:@"/user/imoji/fetch" andParameters:params] continueWithExecutor:[BFExecutor mainThreadExecutor] withBlock:^id(BFTask *getTask) {
-        if (cancellationToken.cancelled) {
-            return [BFTask cancelledTask];
-        }
-
-        NSDictionary *results = getTask.result;
-        NSError *error;
-        [self validateServerResponse:results error:&error];
-
-        if (error) {
-            resultSetResponseCallback(nil, error);
-        } else {
-            [self handleImojiFetchResponse:[self convertServerDataSetToImojiArray:results]
-                         relatedSearchTerm:[results im_checkedStringForKey:@"followupSearchTerm"]
-                         relatedCategories:[self readCategories:[results im_checkedArrayForKey:@"relatedCategories" defaultValue:@[]]]
-                         cancellationToken:cancellationToken
-                    searchResponseCallback:resultSetResponseCallback
-                     imojiResponseCallback:imojiResponseCallback];
-        }
-
-        return nil;
-    }];
+    [self handleImojiResultSetTask:[self runValidatedGetTaskWithPath:@"/user/imoji/fetch" parameters:params cancellationToken:cancellationToken]
+                      imojiObjects:nil
+                 cancellationToken:cancellationToken
+         resultSetResponseCallback:resultSetResponseCallback
+             imojiResponseCallback:imojiResponseCallback
+             batchResponseCallback:nil];
 
     return cancellationToken;
 }
@@ -452,10 +656,11 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
                      beginUploadCallback:(nonnull IMImojiSessionCreationResponseCallback)beginUploadCallback
                     finishUploadCallback:(nonnull IMImojiSessionCreationResponseCallback)finishUploadCallback {
     NSOperation *cancellationToken = self.cancellationTokenOperation;
+    BOOL uploadsImage = self.storagePolicy.uploadsCreatedImojis;
 
     __block NSString *imojiId;
     __block IMImojiObject *localImoji;
-    [[self createLocalImojiWithRawImage:image
+    [[[[self createLocalImojiWithRawImage:image
                              borderedImage:borderedImage
                                       tags:tags]
             continueWithExecutor:[BFExecutor mainThreadExecutor] withBlock:^id(BFTask *task) {
@@ -476,6 +681,68 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
                 return [self runValidatedPostTaskWithPath:@"/imoji/create" andParameters:@{
                         @"tags" : tags != nil ? tags : [NSNull null]
                 }];
+            }] continueWithExecutor:[BFTask im_concurrentBackgroundExecutor] withBlock:^id(BFTask *task) {
+                if (task.error || !uploadsImage) {
+                    return task;
+                }
+
+                NSDictionary *response = task.result;
+                NSError *error;
+                if (![self validateServerResponse:response error:&error]) {
+                    return [BFTask taskWithError:error];
+                }
+
+                NSString *createdImojiId;
+                NSURL *uploadUrl = [self readUploadUrlFromCreateResponse:response imojiId:&createdImojiId];
+                if (!uploadUrl) {
+                    return [BFTask taskWithError:[NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                                     code:IMImojiSessionErrorCodeServerError
+                                                                 userInfo:@{
+                                                                         NSLocalizedDescriptionKey : @"Invalid response from /imoji/create"
+                                                                 }]];
+                }
+
+                imojiId = createdImojiId;
+
+                // stream the file the creation pipeline already encoded for the local copy instead of encoding again,
+                // it was written as PNG or WebP depending on the storage policy
+                IMImojiObjectRenderingOptions *rawImageOptions = [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeFullResolution
+                                                                                                          borderStyle:IMImojiObjectBorderStyleNone
+                                                                                                          imageFormat:IMImojiObjectImageFormatPNG];
+                NSURL *rawImageUrl = localImoji.urls[rawImageOptions];
+                if (!rawImageUrl) {
+                    rawImageOptions.imageFormat = IMImojiObjectImageFormatWebP;
+                    rawImageUrl = localImoji.urls[rawImageOptions];
+                }
+
+                if (!rawImageUrl.isFileURL || ![[NSFileManager defaultManager] fileExistsAtPath:rawImageUrl.path]) {
+                    return [self uploadImageInBackgroundWithRetries:image
+                                                          uploadUrl:uploadUrl
+                                                         retryCount:IMImojiSessionNumberOfRetriesForImageUpload
+                                                  cancellationToken:cancellationToken];
+                }
+
+                return [self uploadImageFileInBackgroundWithRetries:rawImageUrl
+                                                          uploadUrl:uploadUrl
+                                                         retryCount:IMImojiSessionNumberOfRetriesForImageUpload
+                                                  cancellationToken:cancellationToken];
+            }] continueWithExecutor:[BFExecutor mainThreadExecutor] withBlock:^id(BFTask *task) {
+                if (cancellationToken.cancelled || !localImoji || !uploadsImage) {
+                    return nil;
+                }
+
+                if (task.error) {
+                    finishUploadCallback(nil, task.error);
+                } else {
+                    [self fetchImojisByIdentifiers:@[imojiId]
+                           fetchedResponseCallback:^(IMImojiObject *imoji, NSUInteger index, NSError *error) {
+                               if (!cancellationToken.cancelled) {
+                                   finishUploadCallback(imoji, error);
+                               }
+                           }];
+                }
+
+                return nil;
             }];
 
     return cancellationToken;
@@ -547,14 +814,12 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
         originIdentifier = [originIdentifier substringToIndex:40];
     }
 
-    [[self runValidatedGetTaskWithPath:@"/analytics/imoji/sent" andParameters:@{
-            @"imojiId" : imojiIdentifier,
-            @"originIdentifier" : originIdentifier ? originIdentifier : [NSNull null]
-    }]
-            continueWithExecutor:[BFExecutor mainThreadExecutor]
-                       withBlock:^id(BFTask *task) {
-                           return nil;
-                       }];
+    NSMutableDictionary *event = [NSMutableDictionary dictionaryWithObject:imojiIdentifier forKey:@"imojiId"];
+    if (originIdentifier) {
+        event[@"originIdentifier"] = originIdentifier;
+    }
+
+    [self->_analyticsBuffer recordEvent:event];
 }
 
 #pragma mark Attribution
@@ -588,42 +853,176 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
         return cancellationToken;
     }
 
-    NSMutableDictionary *parameters = [NSMutableDictionary dictionaryWithDictionary:@{
-            @"imojiIds" : [imojiObjectIdentifiers componentsJoinedByString:@","]
+    // serve what is cached, join requests already in flight for other identifiers and only ask the server for the rest
+    NSMutableDictionary *attribution = [NSMutableDictionary dictionary];
+    NSMutableArray *pendingTasks = [NSMutableArray array];
+    NSMutableArray *missingIdentifiers = [NSMutableArray array];
+
+    @synchronized (self->_attributionRequests) {
+        for (NSString *imojiIdentifier in [NSOrderedSet orderedSetWithArray:imojiObjectIdentifiers]) {
+            id cachedAttribution = [self->_attributionCache objectForKey:imojiIdentifier];
+            BFTask *pendingTask = self->_attributionRequests[imojiIdentifier];
+
+            if (cachedAttribution) {
+                if (cachedAttribution != [NSNull null]) {
+                    attribution[imojiIdentifier] = cachedAttribution;
+                }
+            } else if (pendingTask) {
+                if (![pendingTasks containsObject:pendingTask]) {
+                    [pendingTasks addObject:pendingTask];
+                }
+            } else {
+                [missingIdentifiers addObject:imojiIdentifier];
+            }
+        }
+
+        if (missingIdentifiers.count > 0) {
+            BFTask *fetchTask = [self fetchAttributionForIdentifiers:missingIdentifiers];
+            [pendingTasks addObject:fetchTask];
+
+            for (NSString *imojiIdentifier in missingIdentifiers) {
+                self->_attributionRequests[imojiIdentifier] = fetchTask;
+            }
+        }
+    }
+
+    [[BFTask taskForCompletionOfAllTasks:pendingTasks] continueWithExecutor:[BFExecutor mainThreadExecutor]
+                                                                  withBlock:^id(BFTask *task) {
+                                                                      if (cancellationToken.cancelled) {
+                                                                          return [BFTask cancelledTask];
+                                                                      }
+
+                                                                      NSError *error;
+                                                                      for (BFTask *pendingTask in pendingTasks) {
+                                                                          if (pendingTask.error) {
+                                                                              error = pendingTask.error;
+                                                                              break;
+                                                                          }
+
+                                                                          // other requests may carry identifiers this caller did not ask for
+                                                                          NSDictionary *fetchedAttribution = pendingTask.result;
+                                                                          for (NSString *imojiIdentifier in imojiObjectIdentifiers) {
+                                                                              id fetched = fetchedAttribution[imojiIdentifier];
+                                                                              if ([fetched isKindOfClass:[NSError class]]) {
+                                                                                  error = fetched;
+                                                                                  break;
+                                                                              } else if (fetched) {
+                                                                                  attribution[imojiIdentifier] = fetched;
+                                                                              }
+                                                                          }
+
+                                                                          if (error) {
+                                                                              break;
+                                                                          }
+                                                                      }
+
+                                                                      if (error) {
+                                                                          callback(nil, error);
+                                                                      } else {
+                                                                          callback([NSDictionary dictionaryWithDictionary:attribution], nil);
+                                                                      }
+
+                                                                      return nil;
+                                                                  }];
+
+    return cancellationToken;
+}
+
+/**
+ * Resolves to the attribution of imojiIdentifiers keyed by identifier. When the request for several identifiers fails,
+ * each of them is requested once on its own, identifiers that still fail map to the NSError of their request.
+ */
+- (BFTask *)fetchAttributionForIdentifiers:(NSArray<NSString *> *)imojiIdentifiers {
+    return [[[self requestAttributionForIdentifiers:imojiIdentifiers] continueWithBlock:^id(BFTask *task) {
+        if (!task.error || imojiIdentifiers.count == 1) {
+            return task;
+        }
+
+        // one bad identifier shouldn't fail everyone waiting on the batch
+        NSMutableArray *retryTasks = [NSMutableArray arrayWithCapacity:imojiIdentifiers.count];
+        for (NSString *imojiIdentifier in imojiIdentifiers) {
+            [retryTasks addObject:[self requestAttributionForIdentifiers:@[imojiIdentifier]]];
+        }
+
+        return [[BFTask taskForCompletionOfAllTasks:retryTasks] continueWithBlock:^id(BFTask *retriesTask) {
+            NSMutableDictionary *attribution = [NSMutableDictionary dictionary];
+            [imojiIdentifiers enumerateObjectsUsingBlock:^(NSString *imojiIdentifier, NSUInteger idx, BOOL *stop) {
+                BFTask *retryTask = retryTasks[idx];
+                if (retryTask.error) {
+                    attribution[imojiIdentifier] = retryTask.error;
+                } else {
+                    [attribution addEntriesFromDictionary:retryTask.result];
+                }
+            }];
+
+            return [NSDictionary dictionaryWithDictionary:attribution];
+        }];
+    }] continueWithExecutor:[BFTask im_concurrentBackgroundExecutor] withBlock:^id(BFTask *task) {
+        NSDictionary *attribution = task.result;
+
+        @synchronized (self->_attributionRequests) {
+            for (NSString *imojiIdentifier in imojiIdentifiers) {
+                [self->_attributionRequests removeObjectForKey:imojiIdentifier];
+
+                // remember stickers without attribution as well so they aren't requested again
+                if (!task.error && ![attribution[imojiIdentifier] isKindOfClass:[NSError class]]) {
+                    [self->_attributionCache setObject:attribution[imojiIdentifier] ?: [NSNull null]
+                                                forKey:imojiIdentifier];
+                }
+            }
+        }
+
+        return task;
     }];
+}
 
-    [[self runValidatedGetTaskWithPath:@"/imoji/attribution" andParameters:parameters]
-            continueWithExecutor:[BFExecutor mainThreadExecutor]
-                       withBlock:^id(BFTask *getTask) {
-                           if (cancellationToken.cancelled) {
-                               return [BFTask cancelledTask];
-                           }
+- (BFTask *)requestAttributionForIdentifiers:(NSArray<NSString *> *)imojiIdentifiers {
+    NSDictionary *parameters = @{
+            @"imojiIds" : [imojiIdentifiers componentsJoinedByString:@","]
+    };
 
+    return [[self runValidatedGetTaskWithPath:@"/imoji/attribution" andParameters:parameters]
+            continueWithExecutor:[BFTask im_concurrentBackgroundExecutor]
+                       withBlock:^id(BFTask *getTask) {
+                           NSError *error = getTask.error;
                            NSDictionary *results = getTask.result;
-                           NSError *error;
-                           [self validateServerResponse:results error:&error];
+                           if (!error) {
+                               [self validateServerResponse:results error:&error];
+                           }
 
                            NSMutableDictionary *converted = [NSMutableDictionary dictionary];
-                           if ([results[@"attribution"] isKindOfClass:[NSDictionary class]]) {
+                           if (!error && [results[@"attribution"] isKindOfClass:[NSDictionary class]]) {
                                NSDictionary *attributionMap = results[@"attribution"];
+                               // stickers from the same pack share one attribution, only read it once per pack
+                               NSMutableDictionary *packAttribution = [NSMutableDictionary dictionary];
+
                                for (NSString *imojiId in [attributionMap allKeys]) {
-                                   converted[imojiId] = [self readAttribution:attributionMap[imojiId]];
+                                   NSDictionary *attributionDictionary = attributionMap[imojiId];
+                                   if (![attributionDictionary isKindOfClass:[NSDictionary class]]) {
+                                       continue;
+                                   }
+
+                                   NSString *packIdentifier = [attributionDictionary im_checkedStringForKey:@"packId"];
+                                   IMCategoryAttribution *attribution = packIdentifier ? packAttribution[packIdentifier] : nil;
+                                   if (!attribution) {
+                                       attribution = [self readAttribution:attributionDictionary];
+                                       if (packIdentifier) {
+                                           packAttribution[packIdentifier] = attribution;
+                                       }
+                                   }
+
+                                   converted[imojiId] = attribution;
                                }
                            }
 
                            if (error) {
-                               callback(nil, error);
-                           } else {
-                               callback([NSDictionary dictionaryWithDictionary:converted], nil);
+                               return [BFTask taskWithError:error];
                            }
 
-                           return nil;
+                           return [NSDictionary dictionaryWithDictionary:converted];
                        }];
-
-    return cancellationToken;
 }
 
-
 #pragma mark Rendering
 
 - (NSOperation *)renderImoji:(IMImojiObject *)imoji
@@ -642,17 +1041,34 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
 
         return cancellationToken;
     } else if (![imoji isKindOfClass:[IMMutableImojiObject class]]) {
-        [self fetchImojisByIdentifiers:@[imoji.identifier]
-               fetchedResponseCallback:^(IMImojiObject *internalImoji, NSUInteger index, NSError *error) {
-                   if (cancellationToken.cancelled) {
-                       return;
-                   }
-
-                   [self renderImoji:(IMMutableImojiObject *) internalImoji
-                             options:options
-                            callback:callback
-                   cancellationToken:cancellationToken];
-               }];
+        // imojis restored from NSCoding only carry their identifier, look up their image urls in batches with other
+        // renders issued around the same time
+        IMMutableImojiObject *cachedImoji = [self->_imojiMetadataCache objectForKey:imoji.identifier];
+        if (cachedImoji) {
+            [self renderImoji:cachedImoji
+                      options:options
+                     callback:callback
+            cancellationToken:cancellationToken];
+
+            return cancellationToken;
+        }
+
+        [[self->_imojiLookupBatcher lookupIdentifier:imoji.identifier] continueWithExecutor:[BFExecutor mainThreadExecutor] withBlock:^id(BFTask *task) {
+            if (cancellationToken.cancelled) {
+                return nil;
+            }
+
+            if (task.error || !task.result) {
+                callback(nil, task.error);
+            } else {
+                [self renderImoji:task.result
+                          options:options
+                         callback:callback
+                cancellationToken:cancellationToken];
+            }
+
+            return nil;
+        }];
     } else {
         [self renderImoji:(IMMutableImojiObject *) imoji
                   options:options callback:callback
@@ -665,83 +1081,250 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
 - (nonnull NSOperation *)renderImojiForExport:(nonnull IMImojiObject *)imoji
                                       options:(nonnull IMImojiObjectRenderingOptions *)options
                                      callback:(nonnull IMImojiSessionExportedImageResponseCallback)callback {
-    return [self renderImoji:imoji options:options callback:^(UIImage *image, NSError *error) {
-
+    __block NSOperation *cancellationToken;
+    cancellationToken = [self renderImoji:imoji options:options callback:^(UIImage *image, NSError *error) {
         if (error) {
             callback(nil, nil, nil, error);
+            return;
+        }
+
+        // conversion streams to disk on a background executor and the result is kept for the next export
+        [[self exportImage:image forImoji:imoji options:options cancellationToken:cancellationToken]
+                continueWithExecutor:[BFExecutor mainThreadExecutor]
+                           withBlock:^id(BFTask *task) {
+                               if (task.cancelled || cancellationToken.cancelled) {
+                                   return nil;
+                               }
+
+                               if (task.error) {
+                                   callback(image, nil, nil, task.error);
+                               } else {
+                                   callback(image, task.result[0], task.result[1], nil);
+                               }
+
+                               return nil;
+                           }];
+    }];
+
+    return cancellationToken;
+}
+
+- (BFTask *)exportImage:(UIImage *)image
+               forImoji:(IMImojiObject *)imoji
+                options:(IMImojiObjectRenderingOptions *)options
+      cancellationToken:(NSOperation *)cancellationToken {
+    return [BFTask im_concurrentBackgroundTaskWithBlock:^id(BFTask *task) {
+        if (cancellationToken.cancelled) {
+            return [BFTask cancelledTask];
+        }
+
+        BOOL animated = imoji.supportsAnimation && options.renderAnimatedIfSupported;
+        if (animated && ![image isKindOfClass:[YYImage class]]) {
+            return [BFTask taskWithError:[NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                             code:IMImojiSessionErrorCodeImojiRenderingUnavailable
+                                                         userInfo:@{
+                                                                 NSLocalizedDescriptionKey : @"Unsupported animated image! Only YYImage references are currently supported."
+                                                         }]];
+        }
+
+        YYImage *yyImage = animated ? (YYImage *) image : nil;
+        if (yyImage && yyImage.animatedImageType == YYImageTypeGIF) {
+            return @[yyImage.animatedImageData, (NSString *) kUTTypeGIF];
+        }
+
+        if (yyImage && yyImage.animatedImageType != YYImageTypeWebP) {
+            return [BFTask taskWithError:[NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                             code:IMImojiSessionErrorCodeImojiRenderingUnavailable
+                                                         userInfo:@{
+                                                                 NSLocalizedDescriptionKey : [NSString stringWithFormat:@"Unsupported YYImageType %@", @(yyImage.animatedImageType)]
+                                                         }]];
+        }
+
+        NSString *typeIdentifier = yyImage ? (NSString *) kUTTypeGIF : (NSString *) kUTTypePNG;
+        NSURL *exportKey = [self exportKeyForImoji:imoji options:options extension:yyImage ? @"gif" : @"png"];
+
+        NSData *exportedData = [self->_exportDiskCache dataForURL:exportKey];
+        if (exportedData) {
+            return @[exportedData, typeIdentifier];
+        }
+
+        if (!yyImage) {
+            exportedData = UIImagePNGRepresentation(image);
+            if (exportedData) {
+                NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"%@.png", [NSString im_stringWithRandomUUID]]]];
+                if (![exportedData writeToURL:fileURL options:NSDataWritingAtomic error:nil]) {
+                    return @[exportedData, typeIdentifier];
+                }
+
+                // stored before returning so sticker files can be handed out straight from the store
+                return [[self moveFileAtURL:fileURL toExportStoreForURL:exportKey] continueWithBlock:^id(BFTask *moveTask) {
+                    if (![moveTask.result boolValue]) {
+                        [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+                    }
+
+                    return @[exportedData, typeIdentifier];
+                }];
+            }
         } else {
-            NSData *attachmentData = nil;
-            NSError *exportError = nil;
-            NSString *typeIdentifier = nil;
-
-            if (imoji.supportsAnimation && options.renderAnimatedIfSupported) {
-                if ([image isKindOfClass:[YYImage class]]) {
-                    YYImage *yyImage = (YYImage *) image;
-
-                    if (yyImage.animatedImageType == YYImageTypeGIF) {
-                        attachmentData = yyImage.animatedImageData;
-                        typeIdentifier = (NSString *) kUTTypeGIF;
-                    } else if (yyImage.animatedImageType == YYImageTypeWebP) {
-                        // YYImage animatedImageData gives back the full webp data which is unusable for exporting
-                        // manually convert it here using a simple method to convert animated frames to NSData adapted from:
-                        // https://github.com/mattt/AnimatedGIFImageSerialization/blob/master/AnimatedGIFImageSerialization/AnimatedGIFImageSerialization.m
-
-                        NSUInteger frameCount = yyImage.animatedImageFrameCount;
-                        NSMutableData *mutableData = [NSMutableData data];
-                        CGImageDestinationRef destination =
-                                CGImageDestinationCreateWithData((__bridge CFMutableDataRef) mutableData, kUTTypeGIF, frameCount, NULL);
-
-                        NSDictionary *imageProperties = @{(__bridge NSString *) kCGImagePropertyGIFDictionary : @{
-                                (__bridge NSString *) kCGImagePropertyGIFLoopCount : @(yyImage.animatedImageLoopCount)
-                        }};
-                        CGImageDestinationSetProperties(destination, (__bridge CFDictionaryRef) imageProperties);
-
-                        for (NSUInteger i = 0; i < frameCount; i++) {
-                            NSDictionary *frameProperties = @{(__bridge NSString *) kCGImagePropertyGIFDictionary : @{
-                                    (__bridge NSString *) kCGImagePropertyGIFUnclampedDelayTime : @([yyImage animatedImageDurationAtIndex:i]),
-                                    (__bridge NSString *) kCGImagePropertyGIFDelayTime : @([yyImage animatedImageDurationAtIndex:i])
-                            }};
-                            CGImageDestinationAddImage(destination, [[yyImage animatedImageFrameAtIndex:i] CGImage], (__bridge CFDictionaryRef) frameProperties);
-                        }
-
-                        BOOL success = CGImageDestinationFinalize(destination);
-                        CFRelease(destination);
-
-                        if (!success) {
-                            exportError = [NSError errorWithDomain:IMImojiSessionErrorDomain
-                                                              code:IMImojiSessionErrorCodeImojiRenderingUnavailable
-                                                          userInfo:@{
-                                                                  NSLocalizedDescriptionKey : @"Unable to export WEBP to GIF"
-                                                          }];
-                        } else {
-                            attachmentData = mutableData;
-                            typeIdentifier = (NSString *) kUTTypeGIF;
-                        }
-
-                    } else {
-                        exportError = [NSError errorWithDomain:IMImojiSessionErrorDomain
-                                                          code:IMImojiSessionErrorCodeImojiRenderingUnavailable
-                                                      userInfo:@{
-                                                              NSLocalizedDescriptionKey : [NSString stringWithFormat:@"Unsupported YYImageType %@", @(yyImage.animatedImageType)]
-                                                      }];
+            NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"%@.gif", [NSString im_stringWithRandomUUID]]]];
+
+            if ([self writeGIFFromAnimatedImage:yyImage toURL:fileURL cancellationToken:cancellationToken]) {
+                return [[self moveFileAtURL:fileURL toExportStoreForURL:exportKey] continueWithBlock:^id(BFTask *moveTask) {
+                    // read back memory mapped from the store, falling back to the temporary file if it didn't fit
+                    NSData *gifData = [moveTask.result boolValue] ? [self->_exportDiskCache dataForURL:exportKey] : [NSData dataWithContentsOfURL:fileURL];
+                    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+
+                    if (cancellationToken.cancelled) {
+                        return [BFTask cancelledTask];
                     }
-                } else {
-                    exportError = [NSError errorWithDomain:IMImojiSessionErrorDomain
-                                                      code:IMImojiSessionErrorCodeImojiRenderingUnavailable
-                                                  userInfo:@{
-                                                          NSLocalizedDescriptionKey : @"Unsupported animated image! Only YYImage references are currently supported."
-                                                  }];
-                }
-            } else {
-                attachmentData = UIImagePNGRepresentation(image);
-                typeIdentifier = (NSString *) kUTTypePNG;
+
+                    if (gifData) {
+                        return @[gifData, typeIdentifier];
+                    }
+
+                    return [BFTask taskWithError:[NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                                     code:IMImojiSessionErrorCodeImojiRenderingUnavailable
+                                                                 userInfo:@{
+                                                                         NSLocalizedDescriptionKey : @"Unable to export WEBP to GIF"
+                                                                 }]];
+                }];
             }
 
-            callback(image, attachmentData, typeIdentifier, exportError);
+            [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+
+            if (cancellationToken.cancelled) {
+                return [BFTask cancelledTask];
+            }
         }
+
+        return [BFTask taskWithError:[NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                         code:IMImojiSessionErrorCodeImojiRenderingUnavailable
+                                                     userInfo:@{
+                                                             NSLocalizedDescriptionKey : yyImage ? @"Unable to export WEBP to GIF" : @"Unable to export PNG"
+                                                     }]];
     }];
 }
 
+- (BFTask *)moveFileAtURL:(NSURL *)fileURL toExportStoreForURL:(NSURL *)exportKey {
+    BFTaskCompletionSource *moveTaskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+    [self->_exportDiskCache moveFileAtURL:fileURL
+                            toStoreForURL:exportKey
+                               completion:^(BOOL moved) {
+                                   [moveTaskCompletionSource setResult:@(moved)];
+                               }];
+
+    return moveTaskCompletionSource.task;
+}
+
+- (BOOL)writeGIFFromAnimatedImage:(YYImage *)yyImage
+                            toURL:(NSURL *)fileURL
+                cancellationToken:(NSOperation *)cancellationToken {
+    // YYImage animatedImageData gives back the full webp data which is unusable for exporting. Frames are drawn one at
+    // a time into a single RGBA buffer and streamed through the native encoder, which only writes what changed
+    NSUInteger frameCount = yyImage.animatedImageFrameCount;
+    size_t width = 0, height = 0;
+    @autoreleasepool {
+        CGImageRef firstFrame = frameCount > 0 ? [yyImage animatedImageFrameAtIndex:0].CGImage : NULL;
+        width = firstFrame ? CGImageGetWidth(firstFrame) : 0;
+        height = firstFrame ? CGImageGetHeight(firstFrame) : 0;
+    }
+
+    if (width == 0 || height == 0 || width > UINT16_MAX || height > UINT16_MAX) {
+        return NO;
+    }
+
+    size_t bytesPerRow = width * 4;
+    NSMutableData *pixels = [NSMutableData dataWithLength:bytesPerRow * height];
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(pixels.mutableBytes, width, height, 8, bytesPerRow, colorSpace,
+            kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
+    CGColorSpaceRelease(colorSpace);
+    if (!context) {
+        return NO;
+    }
+
+    FILE *file = fopen(fileURL.fileSystemRepresentation, "wb");
+    if (!file) {
+        CGContextRelease(context);
+        return NO;
+    }
+
+    IMImojiGIFEncoderOptions options;
+    IMImojiGIFEncoderGetDefaultOptions(&options);
+    options.premultipliedAlpha = 1;
+    options.loopCount = (int) MIN(yyImage.animatedImageLoopCount, (NSUInteger) UINT16_MAX);
+
+    IMImojiGIFEncoder *encoder = IMImojiGIFEncoderCreate((uint16_t) width, (uint16_t) height, &options, IMImojiSessionWriteGIFBytes, file);
+    CGRect bounds = CGRectMake(0, 0, width, height);
+    BOOL success = encoder != NULL;
+
+    // a few evenly spaced frames are enough for the shared palette and keep the extra decoding cheap
+    NSUInteger sampleCount = MIN(frameCount, IMImojiSessionGIFPaletteSampleFrameCount);
+    for (NSUInteger i = 0; success && i < sampleCount; i++) {
+        success = !cancellationToken.cancelled &&
+                [self drawFrameAtIndex:i * frameCount / sampleCount ofAnimatedImage:yyImage inContext:context bounds:bounds] &&
+                IMImojiGIFEncoderAddPaletteSample(encoder, pixels.mutableBytes, bytesPerRow) == IMImojiGIFEncoderStatusSuccess;
+    }
+
+    for (NSUInteger i = 0; success && i < frameCount; i++) {
+        // most viewers slow delays under 2 hundredths of a second down to 10, so clamp rather than let them
+        long delay = lround([yyImage animatedImageDurationAtIndex:i] * 100.0);
+        delay = MAX(2, MIN(delay, (long) UINT16_MAX));
+
+        success = !cancellationToken.cancelled &&
+                [self drawFrameAtIndex:i ofAnimatedImage:yyImage inContext:context bounds:bounds] &&
+                IMImojiGIFEncoderAddFrame(encoder, pixels.mutableBytes, bytesPerRow, (uint16_t) delay) == IMImojiGIFEncoderStatusSuccess;
+    }
+
+    success = success && IMImojiGIFEncoderFinish(encoder) == IMImojiGIFEncoderStatusSuccess;
+
+    IMImojiGIFEncoderDestroy(encoder);
+    CGContextRelease(context);
+    success = fclose(file) == 0 && success;
+
+    if (!success) {
+        [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+    }
+
+    return success;
+}
+
+- (BOOL)drawFrameAtIndex:(NSUInteger)index
+         ofAnimatedImage:(YYImage *)yyImage
+               inContext:(CGContextRef)context
+                  bounds:(CGRect)bounds {
+    // decoded frames are released as soon as they've been drawn
+    @autoreleasepool {
+        CGImageRef frame = [yyImage animatedImageFrameAtIndex:index].CGImage;
+        if (!frame) {
+            return NO;
+        }
+
+        CGContextClearRect(context, bounds);
+        CGContextDrawImage(context, bounds, frame);
+        return YES;
+    }
+}
+
+- (NSURL *)exportKeyForImoji:(IMImojiObject *)imoji
+                     options:(IMImojiObjectRenderingOptions *)options
+                   extension:(NSString *)extension {
+    NSString *optionsKey = [NSString stringWithFormat:@"%@-%@-%@-%@-%@-%@-%@",
+                                                      @(options.renderSize),
+                                                      @(options.borderStyle),
+                                                      @(options.imageFormat),
+                                                      @(options.renderAnimatedIfSupported),
+                                                      options.targetSize ? NSStringFromCGSize(options.targetSize.CGSizeValue) : @"",
+                                                      options.aspectRatio ? NSStringFromCGSize(options.aspectRatio.CGSizeValue) : @"",
+                                                      options.maximumFileSize ?: @""];
+
+    // only used as a key for the export store, the store hashes it into a file name
+    return [NSURL URLWithString:[NSString stringWithFormat:@"imoji-export://%@/%@.%@",
+                                                           [imoji.identifier im_md5],
+                                                           [optionsKey im_md5],
+                                                           extension]];
+}
+
 - (nonnull NSOperation *)renderImojiAsMSSticker:(nonnull IMImojiObject *)imoji
                                         options:(nonnull IMImojiObjectRenderingOptions *)options
                                        callback:(nonnull IMImojiSessionMSStickerResponseCallback)callback {
@@ -754,17 +1337,20 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
         return self.cancellationTokenOperation;
     }
 
-    __block NSURL *url = [NSURL fileURLWithPath:[NSString stringWithFormat:@"%@%@-%@.%@",
-                                                                   NSTemporaryDirectory(),
-                                                                   imoji.identifier,
-                                                                   @(options.hash),
-                                                                   imoji.supportsAnimation ? @"gif" : @"png"
-    ]];
-    __block void (^stickerCallback)() = ^{
-        NSError *stickerError;
-        MSSticker *sticker = [[MSSticker alloc] initWithContentsOfFileURL:url
-                                                     localizedDescription:imoji.identifier
-                                                                    error:&stickerError];
+    __block NSOperation *cancellationToken = self.cancellationTokenOperation;
+    void (^stickerCallback)(NSString *, NSError *) = ^(NSString *filePath, NSError *error) {
+        if (cancellationToken.cancelled) {
+            return;
+        }
+
+        NSError *stickerError = error;
+        MSSticker *sticker = nil;
+        if (filePath) {
+            sticker = [[MSSticker alloc] initWithContentsOfFileURL:[NSURL fileURLWithPath:filePath]
+                                              localizedDescription:imoji.identifier
+                                                             error:&stickerError];
+        }
+
         dispatch_async(dispatch_get_main_queue(), ^{
             if (stickerError) {
                 callback(nil, stickerError);
@@ -774,37 +1360,143 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
         });
     };
 
-    if ([[NSFileManager defaultManager] fileExistsAtPath:url.path]) {
-        [BFTask im_concurrentBackgroundTaskWithBlock:^id(BFTask *task) {
-            stickerCallback();
+    [BFTask im_concurrentBackgroundTaskWithBlock:^id(BFTask *task) {
+        NSString *storedFilePath = [self->_stickerDiskCache storedFilePathForURL:[self stickerFileKeyForImoji:imoji options:options]];
+        if (storedFilePath) {
+            stickerCallback(storedFilePath, nil);
+        } else if (!cancellationToken.cancelled) {
+            NSOperation *renderOperation = [self writeStickerFileForImoji:imoji options:options callback:stickerCallback];
+            [IMImojiCancellationToken addCancellationHandler:^{
+                [renderOperation cancel];
+            }                                    toOperation:cancellationToken];
+        }
+
+        return nil;
+    }];
+
+    return cancellationToken;
+#else
+    [[NSException exceptionWithName:@"imoji runtime exception"
+                            reason:@"MSSticker rendering only supported with iOS 10 SDK and higher"
+                          userInfo:nil] raise];
+    
+    return self.cancellationTokenOperation;
+#endif
+}
+
+- (nonnull NSOperation *)prepareStickerFilesForImojis:(nonnull NSArray<IMImojiObject *> *)imojis
+                                              options:(nonnull IMImojiObjectRenderingOptions *)options {
+    IMImojiCancellationToken *preparationToken = [IMImojiCancellationToken cancellationToken];
+
+    // a few imojis at a time, each one downloads, decodes and possibly converts a full animation to GIF
+    NSArray *imojisToPrepare = [imojis copy];
+    NSUInteger laneCount = MIN(IMImojiSessionStickerPreparationConcurrency, imojisToPrepare.count);
+    for (NSUInteger lane = 0; lane < laneCount; lane++) {
+        [self prepareStickerFilesForImojis:imojisToPrepare
+                                 fromIndex:lane
+                                    stride:laneCount
+                                   options:options
+                          preparationToken:preparationToken];
+    }
+
+    return preparationToken;
+}
+
+- (BFTask *)prepareStickerFilesForImojis:(NSArray<IMImojiObject *> *)imojis
+                               fromIndex:(NSUInteger)index
+                                  stride:(NSUInteger)stride
+                                 options:(IMImojiObjectRenderingOptions *)options
+                        preparationToken:(IMImojiCancellationToken *)preparationToken {
+    if (index >= imojis.count || preparationToken.cancelled) {
+        return [BFTask taskWithResult:nil];
+    }
+
+    return [[BFTask im_concurrentBackgroundTaskWithBlock:^id(BFTask *task) {
+        IMImojiObject *imoji = imojis[index];
+        if ([self->_stickerDiskCache containsDataForURL:[self stickerFileKeyForImoji:imoji options:options]]) {
             return nil;
+        }
+
+        BFTaskCompletionSource *stickerTaskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+        NSOperation *renderOperation = [self writeStickerFileForImoji:imoji
+                                                              options:options
+                                                             callback:^(NSString *filePath, NSError *error) {
+                                                                 [stickerTaskCompletionSource trySetResult:nil];
+                                                             }];
+        [self setDownloadPriority:IMImojiSessionDownloadPriorityPrefetch forRenderOperation:renderOperation];
+
+        [preparationToken addCancellationHandler:^{
+            [renderOperation cancel];
+            [stickerTaskCompletionSource trySetCancelled];
         }];
-        
-        return self.cancellationTokenOperation;
-    }
 
+        return stickerTaskCompletionSource.task;
+    }] continueWithBlock:^id(BFTask *task) {
+        // failures only skip the imoji, the rest of the lane carries on
+        return [self prepareStickerFilesForImojis:imojis
+                                        fromIndex:index + stride
+                                           stride:stride
+                                          options:options
+                                 preparationToken:preparationToken];
+    }];
+}
+
+- (NSURL *)stickerFileKeyForImoji:(IMImojiObject *)imoji options:(IMImojiObjectRenderingOptions *)options {
+    // sticker files hold the exported contents, the extension has to match them for MSSticker to accept the file
+    return [self exportKeyForImoji:imoji
+                           options:options
+                         extension:imoji.supportsAnimation && options.renderAnimatedIfSupported ? @"gif" : @"png"];
+}
+
+- (NSOperation *)writeStickerFileForImoji:(IMImojiObject *)imoji
+                                  options:(IMImojiObjectRenderingOptions *)options
+                                 callback:(void (^)(NSString *filePath, NSError *error))callback {
+    NSURL *stickerFileKey = [self stickerFileKeyForImoji:imoji options:options];
 
     return [self renderImojiForExport:imoji
                               options:options
                              callback:^(UIImage *image, NSData *data, NSString *typeIdentifier, NSError *error) {
                                  [BFTask im_concurrentBackgroundTaskWithBlock:^id(BFTask *task) {
-                                     if (error) {
-                                         callback(nil, error);
-                                     } else {
-                                         [data writeToURL:url atomically:YES];
-                                         stickerCallback();
+                                     if (error || !data) {
+                                         if (callback) {
+                                             callback(nil, error);
+                                         }
+
+                                         return nil;
+                                     }
+
+                                     // another render of the same sticker may have stored it meanwhile
+                                     NSString *filePath = [self->_stickerDiskCache storedFilePathForURL:stickerFileKey];
+                                     if (filePath) {
+                                         if (callback) {
+                                             callback(filePath, nil);
+                                         }
+
+                                         return nil;
+                                     }
+
+                                     NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[self->_stickerDiskCache filePathForURL:stickerFileKey].lastPathComponent]];
+                                     NSError *writeError;
+                                     if (![data writeToURL:fileURL options:NSDataWritingAtomic error:&writeError]) {
+                                         if (callback) {
+                                             callback(nil, writeError);
+                                         }
+
+                                         return nil;
                                      }
-                                     
+
+                                     [self->_stickerDiskCache moveFileAtURL:fileURL
+                                                              toStoreForURL:stickerFileKey
+                                                                 completion:^(BOOL moved) {
+                                                                     // stickers too large for the store are handed out from the temporary directory
+                                                                     if (callback) {
+                                                                         callback(moved ? [self->_stickerDiskCache filePathForURL:stickerFileKey] : fileURL.path, nil);
+                                                                     }
+                                                                 }];
+
                                      return nil;
                                  }];
                              }];
-#else
-    [[NSException exceptionWithName:@"imoji runtime exception"
-                            reason:@"MSSticker rendering only supported with iOS 10 SDK and higher"
-                          userInfo:nil] raise];
-    
-    return self.cancellationTokenOperation;
-#endif
 }
 
 - (void)renderImoji:(IMMutableImojiObject *)imoji
@@ -812,9 +1504,20 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
            callback:(IMImojiSessionImojiRenderResponseCallback)callback
   cancellationToken:(NSOperation *)cancellationToken {
 
-    IMImojiObjectRenderingOptions *requestedRenderingOptions = options;
-    if (imoji.supportsAnimation && options.renderAnimatedIfSupported) {
-        requestedRenderingOptions = [imoji supportedAnimatedRenderingOptionFromOption:options];
+    IMImojiObjectRenderingOptions *requestedRenderingOptions = [self requestedRenderingOptionsForImoji:imoji options:options];
+
+    UIImage *cachedImage = [self.imageCache imageForImoji:imoji renderingOptions:requestedRenderingOptions];
+    if (cachedImage) {
+        [[BFTask taskWithResult:cachedImage] continueWithExecutor:[BFExecutor mainThreadExecutor] withBlock:^id(BFTask *task) {
+            if (cancellationToken.cancelled) {
+                return [BFTask cancelledTask];
+            }
+
+            callback(task.result, nil);
+            return nil;
+        }];
+
+        return;
     }
 
     [[self downloadImojiContents:imoji
@@ -828,6 +1531,7 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
                 if (task.error) {
                     callback(nil, task.error);
                 } else {
+                    [self.imageCache setImage:task.result forImoji:imoji renderingOptions:requestedRenderingOptions];
                     callback(task.result, nil);
                 }
 
@@ -835,6 +1539,148 @@ NSString *const IMImojiSessionErrorDomain = @"IMImojiSessionErrorDomain";
             }];
 }
 
+- (void)setDownloadPriority:(IMImojiSessionDownloadPriority)priority
+         forRenderOperation:(NSOperation *)operation {
+    // the scheduler reads priorities straight from the cancellation tokens whenever it picks the next download
+    switch (priority) {
+        case IMImojiSessionDownloadPriorityVisible:
+            operation.queuePriority = NSOperationQueuePriorityNormal;
+            break;
+
+        case IMImojiSessionDownloadPriorityNearVisible:
+            operation.queuePriority = NSOperationQueuePriorityLow;
+            break;
+
+        case IMImojiSessionDownloadPriorityPrefetch:
+            operation.queuePriority = NSOperationQueuePriorityVeryLow;
+            break;
+    }
+}
+
+- (NSOperation *)prefetchImojis:(NSArray<IMImojiObject *> *)imojis
+                        options:(IMImojiObjectRenderingOptions *)options {
+    IMImojiCancellationToken *prefetchToken = [IMImojiCancellationToken cancellationToken];
+    NSUInteger prefetchByteBudget = self.storagePolicy.prefetchByteBudget;
+
+    for (IMImojiObject *imoji in imojis) {
+        // imojis built outside of the SDK have no image urls to prefetch from
+        if (![imoji isKindOfClass:[IMMutableImojiObject class]]) {
+            continue;
+        }
+
+        IMImojiObjectRenderingOptions *requestedRenderingOptions = [self requestedRenderingOptionsForImoji:imoji options:options];
+        NSURL *url = requestedRenderingOptions ? [imoji getUrlForRenderingOptions:requestedRenderingOptions] : nil;
+        if (!url || url.isFileURL || [self.imageCache peekImageForImoji:imoji renderingOptions:requestedRenderingOptions]) {
+            continue;
+        }
+
+        NSUInteger fileSize = [self prefetchCostForImoji:imoji renderingOptions:requestedRenderingOptions];
+        IMImojiCancellationToken *imojiToken = [IMImojiCancellationToken cancellationToken];
+        imojiToken.queuePriority = NSOperationQueuePriorityVeryLow;
+
+        @synchronized (self->_prefetchOperations) {
+            if (self->_prefetchOperations[url]) {
+                continue;
+            }
+
+            // imojis are ordered by how soon they are displayed, anything past the budget is further out
+            if (self->_prefetchedBytes + fileSize > prefetchByteBudget) {
+                break;
+            }
+
+            self->_prefetchOperations[url] = imojiToken;
+            self->_prefetchedBytes += fileSize;
+        }
+
+        [prefetchToken addCancellationHandler:^{
+            [imojiToken cancel];
+        }];
+
+        // only the encoded bytes are fetched, into the session cache and the disk cache. Decoded images are kept for what
+        // is on screen, a prefetch must not spend the time decoding or evict them
+        [[[self validateSessionForImoji:(IMMutableImojiObject *) imoji url:url renderingOptions:requestedRenderingOptions] continueWithSuccessBlock:^id(BFTask *task) {
+            return [self downloadImojiImageDataAsync:(IMMutableImojiObject *) imoji
+                                    renderingOptions:requestedRenderingOptions
+                                   cancellationToken:imojiToken];
+        }] continueWithBlock:^id(BFTask *task) {
+            // the budget limits the bytes in flight, finished prefetches hand theirs back to later calls
+            @synchronized (self->_prefetchOperations) {
+                if (self->_prefetchOperations[url] == imojiToken) {
+                    [self->_prefetchOperations removeObjectForKey:url];
+                }
+
+                self->_prefetchedBytes -= fileSize;
+            }
+
+            return nil;
+        }];
+    }
+
+    return prefetchToken;
+}
+
+- (NSUInteger)prefetchCostForImoji:(IMImojiObject *)imoji
+                  renderingOptions:(IMImojiObjectRenderingOptions *)renderingOptions {
+    NSUInteger fileSize = [imoji getFileSizeForRenderingOptions:renderingOptions];
+    if (fileSize > 0) {
+        return fileSize;
+    }
+
+    // the server doesn't always report sizes, charge a generous estimate so those result sets still respect the budget
+    NSUInteger estimate;
+    switch (renderingOptions.renderSize) {
+        case IMImojiObjectRenderSizeThumbnail:
+            estimate = IMImojiSessionEstimatedThumbnailFileSize;
+            break;
+        case IMImojiObjectRenderSize320:
+            estimate = IMImojiSessionEstimatedThumbnailFileSize * 4;
+            break;
+        case IMImojiObjectRenderSize512:
+            estimate = IMImojiSessionEstimatedThumbnailFileSize * 10;
+            break;
+        case IMImojiObjectRenderSizeFullResolution:
+        default:
+            estimate = IMImojiSessionEstimatedFullResolutionFileSize;
+            break;
+    }
+
+    BOOL animated = renderingOptions.imageFormat == IMImojiObjectImageFormatAnimatedGif ||
+            renderingOptions.imageFormat == IMImojiObjectImageFormatAnimatedWebp;
+    return animated ? estimate * IMImojiSessionEstimatedAnimatedFileSizeMultiplier : estimate;
+}
+
+- (void)cancelPrefetchingImojis:(NSArray<IMImojiObject *> *)imojis
+                        options:(IMImojiObjectRenderingOptions *)options {
+    NSMutableArray *prefetchTokens = [NSMutableArray arrayWithCapacity:imojis.count];
+
+    @synchronized (self->_prefetchOperations) {
+        for (IMImojiObject *imoji in imojis) {
+            IMImojiObjectRenderingOptions *requestedRenderingOptions = [self requestedRenderingOptionsForImoji:imoji options:options];
+            NSURL *url = requestedRenderingOptions ? [imoji getUrlForRenderingOptions:requestedRenderingOptions] : nil;
+            NSOperation *prefetchToken = url ? self->_prefetchOperations[url] : nil;
+
+            if (prefetchToken) {
+                [prefetchTokens addObject:prefetchToken];
+                [self->_prefetchOperations removeObjectForKey:url];
+            }
+        }
+    }
+
+    // cancelling detaches the tokens from their downloads, keep that outside of the lock
+    for (NSOperation *prefetchToken in prefetchTokens) {
+        [prefetchToken cancel];
+    }
+}
+
+- (IMImojiObjectRenderingOptions *)requestedRenderingOptionsForImoji:(IMImojiObject *)imoji
+                                                             options:(IMImojiObjectRenderingOptions *)options {
+    if (imoji.supportsAnimation && options.renderAnimatedIfSupported) {
+        return [imoji supportedAnimatedRenderingOptionFromOption:options];
+    }
+
+    return options;
+}
+
 #pragma mark Static
 
 + (NSDictionary *)categoryClassifications {
@@ -51,6 +51,112 @@
  */
 @property(nonatomic, strong, readonly, nonnull) NSURL *persistentPath;
 
+/**
+ * @abstract Maximum number of bytes of decoded Imoji images to keep in memory for the session image cache.
+ * Defaults to 20MB. Set to 0 to disable caching of decoded images.
+ */
+@property(nonatomic) NSUInteger imageMemoryCacheSize;
+
+/**
+ * @abstract Maximum number of bytes of encoded Imoji image data to keep in memory for the session image cache. Encoded
+ * data is kept after the decoded image is evicted to avoid downloading the image again. Defaults to 10MB.
+ * Set to 0 to disable caching of encoded image data.
+ */
+@property(nonatomic) NSUInteger encodedImageMemoryCacheSize;
+
+/**
+ * @abstract Maximum number of bytes of downloaded Imoji images to keep on disk within cachePath. Images found on disk
+ * are rendered without making a network request. Defaults to 50MB. Set to 0 to disable the disk image cache.
+ */
+@property(nonatomic) NSUInteger imageDiskCacheSize;
+
+/**
+ * @abstract Maximum number of bytes of exported images, such as GIFs converted from animated WebP Imojis by
+ * renderImojiForExport, to keep on disk within cachePath. Repeated exports of the same Imoji with the same options are
+ * read back from disk instead of being converted again. The sticker files of renderImojiAsMSSticker and
+ * prepareStickerFilesForImojis are kept in a store of their own with the same limit. Defaults to 25MB.
+ */
+@property(nonatomic) NSUInteger exportDiskCacheSize;
+
+/**
+ * @abstract Number of seconds a sticker file written by renderImojiAsMSSticker or prepareStickerFilesForImojis is kept
+ * on disk after it was last used, even when exportDiskCacheSize is exceeded, so that the MSSticker objects handed out
+ * keep a valid file. Other exported images are evicted by size alone. Defaults to 1 day.
+ */
+@property(nonatomic) NSTimeInterval stickerFileLifetime;
+
+/**
+ * @abstract Maximum number of Imoji images downloaded at the same time. Additional downloads wait and are started by
+ * priority, most recently requested first. Defaults to 6.
+ */
+@property(nonatomic) NSUInteger maximumConcurrentImageDownloads;
+
+/**
+ * @abstract Maximum number of bytes of Imoji images in flight at the same time from prefetchImojis:options:. Sizes are
+ * taken from the file sizes reported by the server, imojis without a reported size are charged a conservative estimate
+ * for their render size and format. Imojis that would exceed the budget are not prefetched. The budget limits
+ * concurrent prefetching rather than the total, bytes are given back as prefetches finish or are cancelled and later
+ * calls can use them again. Prefetched images are kept encoded and only decoded when rendered. Defaults to 4MB. Set to
+ * 0 to disable prefetching.
+ */
+@property(nonatomic) NSUInteger prefetchByteBudget;
+
+/**
+ * @abstract Number of seconds search and featured results are considered fresh. Repeated requests within this time are
+ * answered from memory. Older results are still returned immediately and refreshed in the background for the next
+ * request. Defaults to 5 minutes. Set to 0 to disable caching of results.
+ */
+@property(nonatomic) NSTimeInterval resultCacheTimeToLive;
+
+/**
+ * @abstract Number of seconds category results are considered fresh, see resultCacheTimeToLive. The last response for
+ * each request is also kept within persistentPath and shown right away on the next launch while it is revalidated with
+ * the server. Defaults to 1 hour. Set to 0 to always wait for the server; the kept response is still used to make the
+ * request conditional, so an unchanged category tree isn't downloaded again.
+ */
+@property(nonatomic) NSTimeInterval categoriesCacheTimeToLive;
+
+/**
+ * @abstract Number of seconds after which cached results are no longer returned at all, even while refreshing.
+ * Defaults to 1 day.
+ */
+@property(nonatomic) NSTimeInterval resultCacheMaximumAge;
+
+/**
+ * @abstract Number of buffered usage events, such as those recorded with markImojiUsageWithIdentifier, that triggers
+ * sending them to the server. Events are kept within persistentPath until they are sent. Defaults to 20.
+ */
+@property(nonatomic) NSUInteger analyticsFlushEventCount;
+
+/**
+ * @abstract Maximum number of seconds a usage event stays buffered before it is sent, see analyticsFlushEventCount.
+ * Buffered events are also sent when the application enters the background. Defaults to 60 seconds.
+ */
+@property(nonatomic) NSTimeInterval analyticsFlushInterval;
+
+/**
+ * @abstract Whether the local copies of Imojis created with createImojiWithRawImage are stored as WebP rather than
+ * PNG, which takes considerably less space within cachePath. Their urls are keyed by IMImojiObjectImageFormatWebP,
+ * requests for PNG fall back to them. The image uploaded to the server is not affected, see uploadsCreatedImojisAsWebP.
+ * Defaults to NO.
+ */
+@property(nonatomic) BOOL encodesCreatedImojisAsWebP;
+
+/**
+ * @abstract Whether createImojiWithRawImage uploads the image to the upload url returned by the server once the Imoji
+ * is created and calls finishUploadCallback with the Imoji the server stored. The upload is streamed from the local
+ * copy and resumed after interruptions where the server supports it. Only enable this when the backend returns an
+ * upload url for created Imojis. Defaults to NO, which only creates the Imoji on the server.
+ */
+@property(nonatomic) BOOL uploadsCreatedImojis;
+
+/**
+ * @abstract Whether images of Imojis created with createImojiWithRawImage are uploaded as lossless WebP instead of PNG,
+ * which shortens uploads considerably. Only used with uploadsCreatedImojis, enable it only when the backend receiving
+ * the uploads accepts WebP. Defaults to NO.
+ */
+@property(nonatomic) BOOL uploadsCreatedImojisAsWebP;
+
 /**
 *  @abstract Generates a storage policy that writes assets to a temporary directory. Contents stored within the
 *  temporary directory are removed after one day of non-usage. Additionally, the operating system can remove the
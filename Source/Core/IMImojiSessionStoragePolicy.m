@@ -27,6 +27,21 @@
 
 const NSUInteger IMImojiSessionStoragePolicyMemoryCacheSize = 0;
 const NSUInteger IMImojiSessionStoragePolicyDiskCacheSize = 15 * 1024 * 1024;
+const NSUInteger IMImojiSessionStoragePolicyImageMemoryCacheSize = 20 * 1024 * 1024;
+const NSUInteger IMImojiSessionStoragePolicyEncodedImageMemoryCacheSize = 10 * 1024 * 1024;
+const NSUInteger IMImojiSessionStoragePolicyImageDiskCacheSize = 50 * 1024 * 1024;
+const NSUInteger IMImojiSessionStoragePolicyExportDiskCacheSize = 25 * 1024 * 1024;
+const NSTimeInterval IMImojiSessionStoragePolicyStickerFileLifetime = 24 * 60 * 60;
+const NSUInteger IMImojiSessionStoragePolicyMaximumConcurrentImageDownloads = 6;
+const NSUInteger IMImojiSessionStoragePolicyPrefetchByteBudget = 4 * 1024 * 1024;
+const NSTimeInterval IMImojiSessionStoragePolicyResultCacheTimeToLive = 5 * 60;
+const NSTimeInterval IMImojiSessionStoragePolicyCategoriesCacheTimeToLive = 60 * 60;
+const NSTimeInterval IMImojiSessionStoragePolicyResultCacheMaximumAge = 24 * 60 * 60;
+const NSUInteger IMImojiSessionStoragePolicyAnalyticsFlushEventCount = 20;
+const NSTimeInterval IMImojiSessionStoragePolicyAnalyticsFlushInterval = 60;
+const BOOL IMImojiSessionStoragePolicyEncodesCreatedImojisAsWebP = NO;
+const BOOL IMImojiSessionStoragePolicyUploadsCreatedImojis = NO;
+const BOOL IMImojiSessionStoragePolicyUploadsCreatedImojisAsWebP = NO;
 
 @interface IMImojiSessionStoragePolicy ()
 @end
@@ -40,6 +55,21 @@ const NSUInteger IMImojiSessionStoragePolicyDiskCacheSize = 15 * 1024 * 1024;
     if (self) {
         _cachePath = cachePath;
         _persistentPath = persistentPath;
+        _imageMemoryCacheSize = IMImojiSessionStoragePolicyImageMemoryCacheSize;
+        _encodedImageMemoryCacheSize = IMImojiSessionStoragePolicyEncodedImageMemoryCacheSize;
+        _imageDiskCacheSize = IMImojiSessionStoragePolicyImageDiskCacheSize;
+        _exportDiskCacheSize = IMImojiSessionStoragePolicyExportDiskCacheSize;
+        _stickerFileLifetime = IMImojiSessionStoragePolicyStickerFileLifetime;
+        _maximumConcurrentImageDownloads = IMImojiSessionStoragePolicyMaximumConcurrentImageDownloads;
+        _prefetchByteBudget = IMImojiSessionStoragePolicyPrefetchByteBudget;
+        _resultCacheTimeToLive = IMImojiSessionStoragePolicyResultCacheTimeToLive;
+        _categoriesCacheTimeToLive = IMImojiSessionStoragePolicyCategoriesCacheTimeToLive;
+        _resultCacheMaximumAge = IMImojiSessionStoragePolicyResultCacheMaximumAge;
+        _analyticsFlushEventCount = IMImojiSessionStoragePolicyAnalyticsFlushEventCount;
+        _analyticsFlushInterval = IMImojiSessionStoragePolicyAnalyticsFlushInterval;
+        _encodesCreatedImojisAsWebP = IMImojiSessionStoragePolicyEncodesCreatedImojisAsWebP;
+        _uploadsCreatedImojis = IMImojiSessionStoragePolicyUploadsCreatedImojis;
+        _uploadsCreatedImojisAsWebP = IMImojiSessionStoragePolicyUploadsCreatedImojisAsWebP;
 
         [self createDirectoriesIfNeeded];
     }
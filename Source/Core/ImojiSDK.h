@@ -29,6 +29,7 @@
 #import "IMCategoryAttribution.h"
 #import "IMCategoryFetchOptions.h"
 #import "IMImojiCategoryObject.h"
+#import "IMImojiImageCache.h"
 #import "IMImojiObject.h"
 #import "IMImojiObjectRenderingOptions.h"
 #import "IMImojiResultSetMetadata.h"
@@ -0,0 +1,77 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+@class BFTask;
+
+/**
+* Sends a batch of buffered events in order. The returned task resolves to an NSNumber with the count of leading events
+* that were delivered. Events past that count stay buffered and are sent again after a backoff.
+*/
+typedef BFTask *__nonnull (^IMImojiAnalyticsSendBlock)(NSArray<NSDictionary *> *__nonnull events);
+
+/**
+* Buffers analytics events in a bounded queue persisted to disk and sends them in batches. A batch is flushed once
+* flushEventCount events are buffered, once the oldest event is flushInterval seconds old or when the application
+* enters the background. Failed flushes are retried with exponential backoff, the oldest events are dropped when the
+* buffer is full.
+*/
+@interface IMImojiAnalyticsBuffer : NSObject
+
+@property(nonatomic, readonly) NSUInteger capacity;
+
+@property(nonatomic, readonly) NSUInteger flushEventCount;
+
+@property(nonatomic, readonly) NSTimeInterval flushInterval;
+
+/**
+* The events waiting to be sent, oldest first, each with the date it was recorded.
+*/
+@property(nonatomic, readonly, nonnull) NSArray<NSDictionary *> *bufferedEvents;
+
+/**
+* The date before which no batch is sent after a failed flush, nil when not backing off.
+*/
+@property(nonatomic, readonly, nullable) NSDate *nextAttemptDate;
+
+- (nonnull instancetype)initWithPath:(nonnull NSString *)path
+                            capacity:(NSUInteger)capacity
+                     flushEventCount:(NSUInteger)flushEventCount
+                       flushInterval:(NSTimeInterval)flushInterval
+                           sendBlock:(nonnull IMImojiAnalyticsSendBlock)sendBlock;
+
+/**
+* Appends event to the buffer. Keys that aren't strings and values that aren't property lists are dropped. Changes to
+* the buffer are written to disk in batches shortly after they're made and when the application enters the background.
+*/
+- (void)recordEvent:(nonnull NSDictionary *)event;
+
+/**
+* Sends all buffered events unless a flush is already running or backing off after a failure.
+*/
+- (void)flush;
+
+@end
@@ -0,0 +1,292 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <UIKit/UIKit.h>
+#import <Bolts/Bolts.h>
+#import "IMImojiAnalyticsBuffer.h"
+
+NSString *const IMImojiAnalyticsBufferEventDateKey = @"recordedAt";
+NSTimeInterval const IMImojiAnalyticsBufferInitialRetryInterval = 5.0;
+NSTimeInterval const IMImojiAnalyticsBufferMaximumRetryInterval = 30 * 60;
+NSTimeInterval const IMImojiAnalyticsBufferBackgroundFlushTimeout = 5.0;
+NSTimeInterval const IMImojiAnalyticsBufferWriteDelay = 1.0;
+
+@implementation IMImojiAnalyticsBuffer {
+    NSString *_path;
+    IMImojiAnalyticsSendBlock _sendBlock;
+    dispatch_queue_t _queue;
+    NSMutableArray *_events;
+    BFTask *_flushTask;
+    NSUInteger _failureCount;
+    NSDate *_nextAttemptDate;
+    BOOL _timerScheduled;
+    BOOL _writeScheduled;
+}
+
+- (instancetype)initWithPath:(NSString *)path
+                    capacity:(NSUInteger)capacity
+             flushEventCount:(NSUInteger)flushEventCount
+               flushInterval:(NSTimeInterval)flushInterval
+                   sendBlock:(IMImojiAnalyticsSendBlock)sendBlock {
+    self = [super init];
+    if (self) {
+        _path = path;
+        _capacity = MAX(capacity, 1u);
+        _flushEventCount = MIN(MAX(flushEventCount, 1u), _capacity);
+        _flushInterval = flushInterval;
+        _sendBlock = [sendBlock copy];
+        _queue = dispatch_queue_create("com.imoji.analytics", DISPATCH_QUEUE_SERIAL);
+
+        NSArray *storedEvents = [NSArray arrayWithContentsOfFile:path];
+        _events = storedEvents ? [storedEvents mutableCopy] : [NSMutableArray new];
+
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(applicationDidEnterBackground:)
+                                                     name:UIApplicationDidEnterBackgroundNotification
+                                                   object:nil];
+
+        // events left over from the previous launch
+        dispatch_async(_queue, ^{
+            [self scheduleFlushIfNeeded];
+        });
+    }
+
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+#pragma mark Recording
+
+- (void)recordEvent:(NSDictionary *)event {
+    // anything that can't be written to the property list would fail the write of the whole buffer
+    NSMutableDictionary *bufferedEvent = [NSMutableDictionary dictionaryWithCapacity:event.count + 1];
+    [event enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+        if ([key isKindOfClass:[NSString class]] &&
+                [NSPropertyListSerialization propertyList:value isValidForFormat:NSPropertyListBinaryFormat_v1_0]) {
+            bufferedEvent[key] = value;
+        }
+    }];
+    bufferedEvent[IMImojiAnalyticsBufferEventDateKey] = [NSDate date];
+
+    dispatch_async(_queue, ^{
+        [self->_events addObject:bufferedEvent];
+        if (self->_events.count > self->_capacity) {
+            [self->_events removeObjectsInRange:NSMakeRange(0, self->_events.count - self->_capacity)];
+        }
+
+        [self scheduleWrite];
+        [self scheduleFlushIfNeeded];
+    });
+}
+
+- (NSArray<NSDictionary *> *)bufferedEvents {
+    __block NSArray *events;
+    dispatch_sync(_queue, ^{
+        events = [self->_events copy];
+    });
+
+    return events;
+}
+
+- (NSDate *)nextAttemptDate {
+    __block NSDate *nextAttemptDate;
+    dispatch_sync(_queue, ^{
+        nextAttemptDate = self->_nextAttemptDate;
+    });
+
+    return nextAttemptDate;
+}
+
+#pragma mark Writing
+
+- (void)scheduleWrite {
+    if (_writeScheduled) {
+        return;
+    }
+
+    // coalesce the changes of a burst of events into a single write of the buffer
+    _writeScheduled = YES;
+
+    __weak IMImojiAnalyticsBuffer *weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t) (IMImojiAnalyticsBufferWriteDelay * NSEC_PER_SEC)), _queue, ^{
+        [weakSelf writeEventsIfNeeded];
+    });
+}
+
+- (void)writeEventsIfNeeded {
+    if (!_writeScheduled) {
+        return;
+    }
+
+    _writeScheduled = NO;
+
+    NSError *error;
+    NSData *data = [NSPropertyListSerialization dataWithPropertyList:_events
+                                                              format:NSPropertyListBinaryFormat_v1_0
+                                                             options:0
+                                                               error:&error];
+    if (!data || ![data writeToFile:_path options:NSDataWritingAtomic error:&error]) {
+        NSLog(@"WARNING: unable to store analytics events at %@: %@", _path, error);
+    }
+}
+
+#pragma mark Flushing
+
+- (void)flush {
+    dispatch_async(_queue, ^{
+        [self startFlush];
+    });
+}
+
+- (void)scheduleFlushIfNeeded {
+    if (_events.count == 0 || _flushTask) {
+        return;
+    }
+
+    NSDate *oldestEventDate = _events.firstObject[IMImojiAnalyticsBufferEventDateKey];
+    NSDate *flushDate = [oldestEventDate dateByAddingTimeInterval:_flushInterval];
+    if (_nextAttemptDate) {
+        // while backing off nothing is sent before the retry date, regardless of how many events pile up
+        flushDate = [flushDate laterDate:_nextAttemptDate];
+    } else if (_events.count >= _flushEventCount) {
+        flushDate = [NSDate date];
+    }
+
+    NSTimeInterval delay = flushDate.timeIntervalSinceNow;
+    if (delay <= 0) {
+        [self startFlush];
+    } else if (!_timerScheduled) {
+        _timerScheduled = YES;
+
+        __weak IMImojiAnalyticsBuffer *weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t) (delay * NSEC_PER_SEC)), _queue, ^{
+            IMImojiAnalyticsBuffer *strongSelf = weakSelf;
+            if (strongSelf) {
+                strongSelf->_timerScheduled = NO;
+                [strongSelf scheduleFlushIfNeeded];
+            }
+        });
+    }
+}
+
+- (BFTask *)startFlush {
+    if (_flushTask) {
+        return _flushTask;
+    }
+
+    if (_events.count == 0 || (_nextAttemptDate && _nextAttemptDate.timeIntervalSinceNow > 0)) {
+        return [BFTask taskWithResult:nil];
+    }
+
+    NSArray *batch = [_events copy];
+    NSMutableArray *events = [NSMutableArray arrayWithCapacity:batch.count];
+    for (NSDictionary *bufferedEvent in batch) {
+        NSMutableDictionary *event = [bufferedEvent mutableCopy];
+        [event removeObjectForKey:IMImojiAnalyticsBufferEventDateKey];
+        [events addObject:event];
+    }
+
+    BFTask *sendTask = _sendBlock(events);
+
+    BFTaskCompletionSource *flushCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+    _flushTask = flushCompletionSource.task;
+
+    [sendTask continueWithBlock:^id(BFTask *task) {
+        dispatch_async(self->_queue, ^{
+            // events may have been dropped or added while the batch was in flight, only remove the ones that were sent
+            NSUInteger sentCount = [task.result isKindOfClass:[NSNumber class]] ? MIN([task.result unsignedIntegerValue], batch.count) : 0;
+            for (NSUInteger i = 0; i < sentCount; ++i) {
+                [self->_events removeObjectIdenticalTo:batch[i]];
+            }
+            if (sentCount > 0) {
+                [self scheduleWrite];
+            }
+
+            if (sentCount < batch.count) {
+                self->_failureCount++;
+                NSTimeInterval retryInterval = MIN(IMImojiAnalyticsBufferInitialRetryInterval * pow(2.0, self->_failureCount - 1),
+                        IMImojiAnalyticsBufferMaximumRetryInterval);
+                // jitter spreads the retries of many devices recovering from the same outage
+                retryInterval *= 0.5 + (arc4random_uniform(1000) / 1000.0);
+                self->_nextAttemptDate = [NSDate dateWithTimeIntervalSinceNow:retryInterval];
+            } else {
+                self->_failureCount = 0;
+                self->_nextAttemptDate = nil;
+            }
+
+            self->_flushTask = nil;
+            flushCompletionSource.result = nil;
+
+            [self scheduleFlushIfNeeded];
+        });
+
+        return nil;
+    }];
+
+    return _flushTask;
+}
+
+#pragma mark Application State
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification {
+    // the process may not come back, store pending changes before anything else
+    dispatch_async(_queue, ^{
+        [self writeEventsIfNeeded];
+    });
+
+    dispatch_block_t flushBlock = ^{
+        dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+
+        dispatch_async(self->_queue, ^{
+            [[self startFlush] continueWithBlock:^id(BFTask *task) {
+                // the removal of the sent events would otherwise wait for the write delay
+                dispatch_async(self->_queue, ^{
+                    [self writeEventsIfNeeded];
+                    dispatch_semaphore_signal(semaphore);
+                });
+                return nil;
+            }];
+        });
+
+        dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t) (IMImojiAnalyticsBufferBackgroundFlushTimeout * NSEC_PER_SEC)));
+    };
+
+    // keep the process alive while the flush runs, expiring activities are also available to app extensions
+    NSProcessInfo *processInfo = [NSProcessInfo processInfo];
+    if ([processInfo respondsToSelector:@selector(performExpiringActivityWithReason:usingBlock:)]) {
+        [processInfo performExpiringActivityWithReason:@"Imoji analytics flush" usingBlock:^(BOOL expired) {
+            if (!expired) {
+                flushBlock();
+            }
+        }];
+    } else {
+        [self flush];
+    }
+}
+
+@end
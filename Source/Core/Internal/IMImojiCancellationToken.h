@@ -0,0 +1,48 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+* Operation handed back to callers of asynchronous session methods. Besides being polled through isCancelled, work
+* started on behalf of the caller registers handlers that are invoked as soon as the operation is cancelled, such as
+* aborting an in flight NSURLSessionTask.
+*/
+@interface IMImojiCancellationToken : NSOperation
+
+/**
+* Registers a handler invoked on the thread calling cancel. Handlers registered after the token was cancelled are
+* invoked immediately. Handlers are released once invoked.
+*/
+- (void)addCancellationHandler:(nonnull void (^)(void))cancellationHandler;
+
+/**
+* Registers the handler if operation is an IMImojiCancellationToken. Other operations can only be polled.
+*/
++ (void)addCancellationHandler:(nonnull void (^)(void))cancellationHandler toOperation:(nullable NSOperation *)operation;
+
++ (nonnull instancetype)cancellationToken;
+
+@end
@@ -0,0 +1,85 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import "IMImojiCancellationToken.h"
+
+@implementation IMImojiCancellationToken {
+    NSMutableArray *_cancellationHandlers;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _cancellationHandlers = [NSMutableArray new];
+    }
+
+    return self;
+}
+
+- (void)main {
+    // the token only tracks cancellation, there is no work to run if it ever ends up in a queue
+}
+
+- (void)cancel {
+    NSArray *cancellationHandlers;
+
+    @synchronized (self) {
+        if (self.isCancelled) {
+            return;
+        }
+
+        [super cancel];
+
+        cancellationHandlers = [_cancellationHandlers copy];
+        [_cancellationHandlers removeAllObjects];
+    }
+
+    for (void (^cancellationHandler)(void) in cancellationHandlers) {
+        cancellationHandler();
+    }
+}
+
+- (void)addCancellationHandler:(void (^)(void))cancellationHandler {
+    @synchronized (self) {
+        if (!self.isCancelled) {
+            [_cancellationHandlers addObject:[cancellationHandler copy]];
+            return;
+        }
+    }
+
+    cancellationHandler();
+}
+
++ (void)addCancellationHandler:(void (^)(void))cancellationHandler toOperation:(NSOperation *)operation {
+    if ([operation isKindOfClass:[IMImojiCancellationToken class]]) {
+        [(IMImojiCancellationToken *) operation addCancellationHandler:cancellationHandler];
+    }
+}
+
++ (instancetype)cancellationToken {
+    return [[IMImojiCancellationToken alloc] init];
+}
+
+@end
@@ -0,0 +1,58 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+* The last successful category response for a request along with the validators the server sent with it.
+*/
+@interface IMImojiCategorySnapshot : NSObject
+
+@property(nonatomic, strong, readonly, nonnull) NSDictionary *results;
+
+@property(nonatomic, copy, readonly, nullable) NSString *entityTag;
+
+@property(nonatomic, copy, readonly, nullable) NSString *lastModified;
+
+@end
+
+/**
+* Persists category responses across launches so category screens can be populated before the network responds. One
+* file is kept per request key. Reads and writes are synchronous, call them off the main thread.
+*/
+@interface IMImojiCategorySnapshotStore : NSObject
+
+@property(nonatomic, copy, readonly, nonnull) NSString *path;
+
+- (nonnull instancetype)initWithPath:(nonnull NSString *)path;
+
+- (nullable IMImojiCategorySnapshot *)snapshotForKey:(nonnull NSString *)key;
+
+- (void)storeResults:(nonnull NSDictionary *)results
+           entityTag:(nullable NSString *)entityTag
+        lastModified:(nullable NSString *)lastModified
+              forKey:(nonnull NSString *)key;
+
+@end
@@ -0,0 +1,112 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import "IMImojiCategorySnapshotStore.h"
+#import "NSString+Utils.h"
+
+NSString *const IMImojiCategorySnapshotResultsKey = @"results";
+NSString *const IMImojiCategorySnapshotEntityTagKey = @"etag";
+NSString *const IMImojiCategorySnapshotLastModifiedKey = @"lastModified";
+
+@interface IMImojiCategorySnapshot ()
+
+@property(nonatomic, strong, readwrite, nonnull) NSDictionary *results;
+@property(nonatomic, copy, readwrite, nullable) NSString *entityTag;
+@property(nonatomic, copy, readwrite, nullable) NSString *lastModified;
+
+@end
+
+@implementation IMImojiCategorySnapshot
+@end
+
+@implementation IMImojiCategorySnapshotStore
+
+- (instancetype)initWithPath:(NSString *)path {
+    self = [super init];
+    if (self) {
+        _path = [path copy];
+    }
+
+    return self;
+}
+
+- (NSString *)filePathForKey:(NSString *)key {
+    return [self.path stringByAppendingPathComponent:[NSString stringWithFormat:@"%@.json", [key im_md5]]];
+}
+
+- (IMImojiCategorySnapshot *)snapshotForKey:(NSString *)key {
+    NSData *data = [NSData dataWithContentsOfFile:[self filePathForKey:key]];
+    if (!data) {
+        return nil;
+    }
+
+    NSDictionary *contents = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+    if (![contents isKindOfClass:[NSDictionary class]] || ![contents[IMImojiCategorySnapshotResultsKey] isKindOfClass:[NSDictionary class]]) {
+        return nil;
+    }
+
+    IMImojiCategorySnapshot *snapshot = [IMImojiCategorySnapshot new];
+    snapshot.results = contents[IMImojiCategorySnapshotResultsKey];
+
+    if ([contents[IMImojiCategorySnapshotEntityTagKey] isKindOfClass:[NSString class]]) {
+        snapshot.entityTag = contents[IMImojiCategorySnapshotEntityTagKey];
+    }
+
+    if ([contents[IMImojiCategorySnapshotLastModifiedKey] isKindOfClass:[NSString class]]) {
+        snapshot.lastModified = contents[IMImojiCategorySnapshotLastModifiedKey];
+    }
+
+    return snapshot;
+}
+
+- (void)storeResults:(NSDictionary *)results
+           entityTag:(NSString *)entityTag
+        lastModified:(NSString *)lastModified
+              forKey:(NSString *)key {
+    NSMutableDictionary *contents = [NSMutableDictionary dictionaryWithObject:results forKey:IMImojiCategorySnapshotResultsKey];
+    if (entityTag) {
+        contents[IMImojiCategorySnapshotEntityTagKey] = entityTag;
+    }
+
+    if (lastModified) {
+        contents[IMImojiCategorySnapshotLastModifiedKey] = lastModified;
+    }
+
+    NSData *data = [NSJSONSerialization dataWithJSONObject:contents options:0 error:nil];
+    if (!data) {
+        return;
+    }
+
+    if (![[NSFileManager defaultManager] fileExistsAtPath:self.path]) {
+        [[NSFileManager defaultManager] createDirectoryAtPath:self.path
+                                  withIntermediateDirectories:YES
+                                                   attributes:nil
+                                                        error:nil];
+    }
+
+    [data writeToFile:[self filePathForKey:key] options:NSDataWritingAtomic error:nil];
+}
+
+@end
@@ -0,0 +1,51 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+* Result of a conditional request. Either the server confirmed that the cached copy is still current, or it sent new
+* results along with the validators to send next time.
+*/
+@interface IMImojiConditionalResponse : NSObject
+
+@property(nonatomic, readonly, getter=isNotModified) BOOL notModified;
+
+/**
+* The parsed response, nil when notModified is YES.
+*/
+@property(nonatomic, strong, readonly, nullable) NSDictionary *results;
+
+@property(nonatomic, copy, readonly, nullable) NSString *entityTag;
+
+@property(nonatomic, copy, readonly, nullable) NSString *lastModified;
+
++ (nonnull instancetype)notModifiedResponse;
+
++ (nonnull instancetype)responseWithResults:(nullable NSDictionary *)results
+                                  entityTag:(nullable NSString *)entityTag
+                               lastModified:(nullable NSString *)lastModified;
+
+@end
@@ -0,0 +1,54 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+@class BFTask;
+@class IMImojiImageDownload;
+
+/**
+* Limits the number of image transfers running at once. Pending downloads are started in order of their current
+* queuePriority, then most recently requested first, so that freshly visible imojis don't wait behind ones that have
+* scrolled off screen. Priorities are read whenever a slot frees up, so reprioritizing takes effect without
+* re-queueing. Pending downloads whose callers have all cancelled are dropped without ever starting.
+*/
+@interface IMImojiDownloadScheduler : NSObject
+
+@property(nonatomic, readonly) NSUInteger maximumConcurrentDownloads;
+
+@property(readonly) NSUInteger activeDownloadCount;
+
+@property(readonly) NSUInteger pendingDownloadCount;
+
+- (nonnull instancetype)initWithMaximumConcurrentDownloads:(NSUInteger)maximumConcurrentDownloads;
+
+/**
+* Queues a transfer. startBlock is invoked once the download is scheduled and returns a task for the transfer, the
+* returned task completes with its result.
+*/
+- (nonnull BFTask *)scheduleDownload:(nonnull IMImojiImageDownload *)download
+                           withBlock:(nonnull BFTask *__nonnull (^)(void))startBlock;
+
+@end
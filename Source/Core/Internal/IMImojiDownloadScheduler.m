@@ -0,0 +1,165 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Bolts/Bolts.h>
+#import "IMImojiDownloadScheduler.h"
+#import "IMImojiImageDownload.h"
+#import "IMImojiCancellationToken.h"
+
+@interface IMImojiScheduledDownload : NSObject
+
+@property(nonatomic, strong) IMImojiImageDownload *download;
+@property(nonatomic, copy) BFTask *(^startBlock)(void);
+@property(nonatomic, strong) BFTaskCompletionSource *taskCompletionSource;
+
+@end
+
+@implementation IMImojiScheduledDownload
+@end
+
+@implementation IMImojiDownloadScheduler {
+    NSMutableArray *_pendingDownloads;
+    NSUInteger _activeDownloadCount;
+
+    // downloads whose cancellation token already has a handler registered by the scheduler
+    NSHashTable *_observedDownloads;
+}
+
+- (instancetype)initWithMaximumConcurrentDownloads:(NSUInteger)maximumConcurrentDownloads {
+    self = [super init];
+    if (self) {
+        _maximumConcurrentDownloads = MAX(maximumConcurrentDownloads, 1u);
+        _pendingDownloads = [NSMutableArray new];
+        _observedDownloads = [NSHashTable weakObjectsHashTable];
+    }
+
+    return self;
+}
+
+- (NSUInteger)activeDownloadCount {
+    @synchronized (self) {
+        return _activeDownloadCount;
+    }
+}
+
+- (NSUInteger)pendingDownloadCount {
+    @synchronized (self) {
+        return _pendingDownloads.count;
+    }
+}
+
+- (BFTask *)scheduleDownload:(IMImojiImageDownload *)download withBlock:(BFTask *(^)(void))startBlock {
+    IMImojiScheduledDownload *scheduledDownload = [IMImojiScheduledDownload new];
+    scheduledDownload.download = download;
+    scheduledDownload.startBlock = startBlock;
+    scheduledDownload.taskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+
+    BOOL observed;
+    @synchronized (self) {
+        [_pendingDownloads addObject:scheduledDownload];
+
+        observed = [_observedDownloads containsObject:download];
+        [_observedDownloads addObject:download];
+    }
+
+    // drop the pending entry as soon as every caller gives up on the download rather than when a slot frees up. Retries
+    // schedule the same download once per attempt, the handler registered for the first one covers all of them
+    if (!observed) {
+        __weak IMImojiDownloadScheduler *weakSelf = self;
+        [IMImojiCancellationToken addCancellationHandler:^{
+            [weakSelf startPendingDownloads];
+        }                                    toOperation:download.cancellationToken];
+    }
+
+    [self startPendingDownloads];
+
+    return scheduledDownload.taskCompletionSource.task;
+}
+
+- (void)startPendingDownloads {
+    while (YES) {
+        IMImojiScheduledDownload *nextDownload;
+        NSMutableArray *cancelledDownloads = [NSMutableArray new];
+
+        @synchronized (self) {
+            for (IMImojiScheduledDownload *scheduledDownload in _pendingDownloads) {
+                if (scheduledDownload.download.isCancelled) {
+                    [cancelledDownloads addObject:scheduledDownload];
+                }
+            }
+
+            [_pendingDownloads removeObjectsInArray:cancelledDownloads];
+
+            if (_activeDownloadCount < _maximumConcurrentDownloads) {
+                NSOperationQueuePriority nextPriority = NSOperationQueuePriorityVeryLow;
+                uint64_t nextRequestOrder = 0;
+
+                for (IMImojiScheduledDownload *scheduledDownload in _pendingDownloads) {
+                    NSOperationQueuePriority priority = scheduledDownload.download.queuePriority;
+                    uint64_t requestOrder = scheduledDownload.download.requestOrder;
+
+                    if (!nextDownload || priority > nextPriority || (priority == nextPriority && requestOrder > nextRequestOrder)) {
+                        nextDownload = scheduledDownload;
+                        nextPriority = priority;
+                        nextRequestOrder = requestOrder;
+                    }
+                }
+            }
+
+            if (nextDownload) {
+                [_pendingDownloads removeObject:nextDownload];
+                _activeDownloadCount++;
+            }
+        }
+
+        for (IMImojiScheduledDownload *cancelledDownload in cancelledDownloads) {
+            [cancelledDownload.taskCompletionSource cancel];
+        }
+
+        if (!nextDownload) {
+            return;
+        }
+
+        [nextDownload.startBlock() continueWithBlock:^id(BFTask *task) {
+            @synchronized (self) {
+                self->_activeDownloadCount--;
+            }
+
+            if (task.cancelled) {
+                [nextDownload.taskCompletionSource cancel];
+            } else if (task.error) {
+                nextDownload.taskCompletionSource.error = task.error;
+            } else {
+                nextDownload.taskCompletionSource.result = task.result;
+            }
+
+            [self startPendingDownloads];
+
+            return nil;
+        }];
+    }
+}
+
+@end
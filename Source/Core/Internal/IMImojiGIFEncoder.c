@@ -0,0 +1,876 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#include "IMImojiGIFEncoder.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// GCC and Clang vector extensions lower to SSE2 on x86 and NEON on ARM without any platform specific intrinsics.
+// Define IM_NO_VECTOR_EXTENSIONS to build the scalar fallback instead
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(IM_NO_VECTOR_EXTENSIONS)
+#define IM_GIF_VECTOR_EXTENSIONS 1
+typedef int32_t IMGIFInt32x4 __attribute__((vector_size(16)));
+#endif
+
+#define IM_GIF_HISTOGRAM_BINS 32768
+#define IM_GIF_CACHE_EMPTY 0xFFFF
+#define IM_GIF_MAXIMUM_PALETTE 256
+#define IM_GIF_OUTPUT_BUFFER_SIZE 4096
+#define IM_GIF_LZW_MAXIMUM_CODE 4095
+#define IM_GIF_LZW_HASH_SIZE 5003
+
+#define IM_GIF_DISPOSAL_NONE 1
+#define IM_GIF_DISPOSAL_BACKGROUND 2
+
+typedef struct {
+    uint32_t count;
+    uint64_t red;
+    uint64_t green;
+    uint64_t blue;
+} IMGIFHistogramBin;
+
+typedef struct {
+    int start;
+    int end;
+    uint64_t count;
+    int axis;
+    int range;
+} IMGIFBox;
+
+typedef struct {
+    int count;
+    uint8_t colors[IM_GIF_MAXIMUM_PALETTE * 3];
+    // structure of arrays padded to a multiple of 4 so the nearest color search can compare 4 entries at a time
+    int32_t red[IM_GIF_MAXIMUM_PALETTE];
+    int32_t green[IM_GIF_MAXIMUM_PALETTE];
+    int32_t blue[IM_GIF_MAXIMUM_PALETTE];
+    // nearest palette index for each 15 bit color, filled lazily
+    uint16_t cache[IM_GIF_HISTOGRAM_BINS];
+} IMGIFPalette;
+
+typedef struct {
+    int left;
+    int top;
+    int width;
+    int height;
+} IMGIFRect;
+
+struct IMImojiGIFEncoder {
+    int width;
+    int height;
+    IMImojiGIFEncoderOptions options;
+    IMImojiGIFEncoderWriteFunction writeFunction;
+    void *context;
+    IMImojiGIFEncoderStatus status;
+    int headerWritten;
+    int finished;
+
+    IMGIFHistogramBin *histogram;
+    uint16_t *usedBins;
+    uint16_t *sortedBins;
+    int usedBinCount;
+    int hasPaletteSamples;
+    IMGIFPalette *palette;
+
+    // frames are stored normalized: straight alpha, fully transparent pixels zeroed and all other pixels opaque
+    uint8_t *previous;
+    uint8_t *pending;
+    uint8_t *incoming;
+    int hasPending;
+    int pendingKeyframe;
+    uint16_t pendingDelay;
+
+    uint8_t *changed;
+    uint8_t *indices;
+    int32_t *errors;
+
+    uint8_t output[IM_GIF_OUTPUT_BUFFER_SIZE];
+    size_t outputLength;
+
+    int32_t lzwKeys[IM_GIF_LZW_HASH_SIZE];
+    uint16_t lzwCodes[IM_GIF_LZW_HASH_SIZE];
+    uint8_t block[255];
+    int blockLength;
+    uint32_t bitBuffer;
+    int bitCount;
+};
+
+// MARK: Output
+
+static void IMGIFFlush(IMImojiGIFEncoder *encoder) {
+    if (encoder->outputLength > 0 && encoder->status == IMImojiGIFEncoderStatusSuccess) {
+        if (!encoder->writeFunction(encoder->context, encoder->output, encoder->outputLength)) {
+            encoder->status = IMImojiGIFEncoderStatusWriteFailed;
+        }
+    }
+
+    encoder->outputLength = 0;
+}
+
+static void IMGIFWrite(IMImojiGIFEncoder *encoder, const uint8_t *bytes, size_t length) {
+    while (length > 0) {
+        size_t available = IM_GIF_OUTPUT_BUFFER_SIZE - encoder->outputLength;
+        size_t chunk = length < available ? length : available;
+
+        memcpy(encoder->output + encoder->outputLength, bytes, chunk);
+        encoder->outputLength += chunk;
+        bytes += chunk;
+        length -= chunk;
+
+        if (encoder->outputLength == IM_GIF_OUTPUT_BUFFER_SIZE) {
+            IMGIFFlush(encoder);
+        }
+    }
+}
+
+static void IMGIFWriteByte(IMImojiGIFEncoder *encoder, uint8_t byte) {
+    IMGIFWrite(encoder, &byte, 1);
+}
+
+static void IMGIFWriteShort(IMImojiGIFEncoder *encoder, int value) {
+    uint8_t bytes[2] = {(uint8_t) (value & 0xFF), (uint8_t) ((value >> 8) & 0xFF)};
+    IMGIFWrite(encoder, bytes, 2);
+}
+
+// MARK: Pixels
+
+static uint32_t IMGIFPixelAt(const uint8_t *pixels, size_t index) {
+    uint32_t pixel;
+    memcpy(&pixel, pixels + index * 4, sizeof(pixel));
+    return pixel;
+}
+
+static int IMGIFBinForColor(int red, int green, int blue) {
+    return ((red >> 3) << 10) | ((green >> 3) << 5) | (blue >> 3);
+}
+
+static void IMGIFNormalizeFrame(const IMImojiGIFEncoder *encoder, const uint8_t *rgba, size_t bytesPerRow, uint8_t *destination) {
+    int threshold = encoder->options.alphaThreshold > 0 ? encoder->options.alphaThreshold : 1;
+
+    for (int y = 0; y < encoder->height; y++) {
+        const uint8_t *source = rgba + (size_t) y * bytesPerRow;
+        uint8_t *target = destination + (size_t) y * encoder->width * 4;
+
+        for (int x = 0; x < encoder->width; x++, source += 4, target += 4) {
+            int alpha = source[3];
+
+            if (alpha < threshold) {
+                target[0] = target[1] = target[2] = target[3] = 0;
+            } else if (encoder->options.premultipliedAlpha && alpha < 255) {
+                for (int c = 0; c < 3; c++) {
+                    int value = (source[c] * 255 + alpha / 2) / alpha;
+                    target[c] = (uint8_t) (value > 255 ? 255 : value);
+                }
+                target[3] = 255;
+            } else {
+                target[0] = source[0];
+                target[1] = source[1];
+                target[2] = source[2];
+                target[3] = 255;
+            }
+        }
+    }
+}
+
+// MARK: Histogram
+
+static void IMGIFResetHistogram(IMImojiGIFEncoder *encoder) {
+    for (int i = 0; i < encoder->usedBinCount; i++) {
+        memset(&encoder->histogram[encoder->usedBins[i]], 0, sizeof(IMGIFHistogramBin));
+    }
+
+    encoder->usedBinCount = 0;
+}
+
+static void IMGIFAddToHistogram(IMImojiGIFEncoder *encoder, const uint8_t *pixels, const uint8_t *mask, IMGIFRect rect) {
+    for (int y = rect.top; y < rect.top + rect.height; y++) {
+        size_t offset = (size_t) y * encoder->width + rect.left;
+        const uint8_t *pixel = pixels + offset * 4;
+        const uint8_t *maskRow = mask ? mask + offset : NULL;
+
+        for (int x = 0; x < rect.width; x++, pixel += 4) {
+            if (pixel[3] == 0 || (maskRow && !maskRow[x])) {
+                continue;
+            }
+
+            int index = IMGIFBinForColor(pixel[0], pixel[1], pixel[2]);
+            IMGIFHistogramBin *bin = &encoder->histogram[index];
+            if (bin->count == 0) {
+                encoder->usedBins[encoder->usedBinCount++] = (uint16_t) index;
+            }
+
+            bin->count++;
+            bin->red += pixel[0];
+            bin->green += pixel[1];
+            bin->blue += pixel[2];
+        }
+    }
+}
+
+// MARK: Median Cut
+
+static int IMGIFBinComponent(int bin, int axis) {
+    return (bin >> (10 - axis * 5)) & 0x1F;
+}
+
+static void IMGIFMeasureBox(const IMImojiGIFEncoder *encoder, IMGIFBox *box) {
+    int minimum[3] = {31, 31, 31};
+    int maximum[3] = {0, 0, 0};
+    box->count = 0;
+
+    for (int i = box->start; i < box->end; i++) {
+        int bin = encoder->usedBins[i];
+        box->count += encoder->histogram[bin].count;
+
+        for (int axis = 0; axis < 3; axis++) {
+            int component = IMGIFBinComponent(bin, axis);
+            if (component < minimum[axis]) minimum[axis] = component;
+            if (component > maximum[axis]) maximum[axis] = component;
+        }
+    }
+
+    box->axis = 0;
+    box->range = maximum[0] - minimum[0];
+    for (int axis = 1; axis < 3; axis++) {
+        if (maximum[axis] - minimum[axis] > box->range) {
+            box->axis = axis;
+            box->range = maximum[axis] - minimum[axis];
+        }
+    }
+}
+
+static void IMGIFSortBox(IMImojiGIFEncoder *encoder, const IMGIFBox *box) {
+    // counting sort on the 5 bit component, stable and free of the global state qsort would need
+    int offsets[33] = {0};
+
+    for (int i = box->start; i < box->end; i++) {
+        offsets[IMGIFBinComponent(encoder->usedBins[i], box->axis) + 1]++;
+    }
+
+    for (int i = 1; i < 33; i++) {
+        offsets[i] += offsets[i - 1];
+    }
+
+    for (int i = box->start; i < box->end; i++) {
+        uint16_t bin = encoder->usedBins[i];
+        encoder->sortedBins[offsets[IMGIFBinComponent(bin, box->axis)]++] = bin;
+    }
+
+    memcpy(encoder->usedBins + box->start, encoder->sortedBins, (size_t) (box->end - box->start) * sizeof(uint16_t));
+}
+
+static void IMGIFBuildPalette(IMImojiGIFEncoder *encoder, IMGIFPalette *palette) {
+    IMGIFBox boxes[IM_GIF_MAXIMUM_PALETTE];
+    int boxCount = 0;
+
+    if (encoder->usedBinCount > 0) {
+        boxes[0].start = 0;
+        boxes[0].end = encoder->usedBinCount;
+        IMGIFMeasureBox(encoder, &boxes[0]);
+        boxCount = 1;
+    }
+
+    while (boxCount < encoder->options.maximumColors) {
+        int selected = -1;
+        uint64_t bestScore = 0;
+
+        for (int i = 0; i < boxCount; i++) {
+            uint64_t score = boxes[i].count * (uint64_t) boxes[i].range;
+            if (boxes[i].end - boxes[i].start > 1 && score > bestScore) {
+                bestScore = score;
+                selected = i;
+            }
+        }
+
+        if (selected < 0) {
+            break;
+        }
+
+        IMGIFBox *box = &boxes[selected];
+        IMGIFSortBox(encoder, box);
+
+        // split at the pixel weighted median, keeping at least one bin on each side
+        uint64_t half = box->count / 2;
+        uint64_t accumulated = 0;
+        int split = box->start + 1;
+        for (int i = box->start; i < box->end - 1; i++) {
+            accumulated += encoder->histogram[encoder->usedBins[i]].count;
+            split = i + 1;
+            if (accumulated >= half) {
+                break;
+            }
+        }
+
+        IMGIFBox *upper = &boxes[boxCount++];
+        upper->start = split;
+        upper->end = box->end;
+        box->end = split;
+        IMGIFMeasureBox(encoder, box);
+        IMGIFMeasureBox(encoder, upper);
+    }
+
+    memset(palette->colors, 0, sizeof(palette->colors));
+    for (int i = 0; i < IM_GIF_MAXIMUM_PALETTE; i++) {
+        // padding entries sit far outside the color cube so they never win a search
+        palette->red[i] = palette->green[i] = palette->blue[i] = 1 << 14;
+    }
+
+    for (int i = 0; i < boxCount; i++) {
+        uint64_t red = 0, green = 0, blue = 0;
+        for (int j = boxes[i].start; j < boxes[i].end; j++) {
+            const IMGIFHistogramBin *bin = &encoder->histogram[encoder->usedBins[j]];
+            red += bin->red;
+            green += bin->green;
+            blue += bin->blue;
+        }
+
+        uint64_t count = boxes[i].count;
+        palette->colors[i * 3] = (uint8_t) ((red + count / 2) / count);
+        palette->colors[i * 3 + 1] = (uint8_t) ((green + count / 2) / count);
+        palette->colors[i * 3 + 2] = (uint8_t) ((blue + count / 2) / count);
+        palette->red[i] = palette->colors[i * 3];
+        palette->green[i] = palette->colors[i * 3 + 1];
+        palette->blue[i] = palette->colors[i * 3 + 2];
+    }
+
+    palette->count = boxCount;
+    memset(palette->cache, 0xFF, sizeof(palette->cache));
+}
+
+// MARK: Palette Mapping
+
+static int IMGIFNearestColor(const IMGIFPalette *palette, int red, int green, int blue) {
+    int paddedCount = (palette->count + 3) & ~3;
+
+#if IM_GIF_VECTOR_EXTENSIONS
+    IMGIFInt32x4 targetRed = {red, red, red, red};
+    IMGIFInt32x4 targetGreen = {green, green, green, green};
+    IMGIFInt32x4 targetBlue = {blue, blue, blue, blue};
+    IMGIFInt32x4 bestDistance = {INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX};
+    IMGIFInt32x4 bestIndex = {0, 0, 0, 0};
+    IMGIFInt32x4 index = {0, 1, 2, 3};
+    IMGIFInt32x4 step = {4, 4, 4, 4};
+
+    for (int i = 0; i < paddedCount; i += 4) {
+        IMGIFInt32x4 paletteRed, paletteGreen, paletteBlue;
+        memcpy(&paletteRed, palette->red + i, sizeof(paletteRed));
+        memcpy(&paletteGreen, palette->green + i, sizeof(paletteGreen));
+        memcpy(&paletteBlue, palette->blue + i, sizeof(paletteBlue));
+
+        IMGIFInt32x4 deltaRed = paletteRed - targetRed;
+        IMGIFInt32x4 deltaGreen = paletteGreen - targetGreen;
+        IMGIFInt32x4 deltaBlue = paletteBlue - targetBlue;
+        IMGIFInt32x4 distance = deltaRed * deltaRed + deltaGreen * deltaGreen + deltaBlue * deltaBlue;
+
+        IMGIFInt32x4 closer = (IMGIFInt32x4) (distance < bestDistance);
+        bestDistance = (distance & closer) | (bestDistance & ~closer);
+        bestIndex = (index & closer) | (bestIndex & ~closer);
+        index += step;
+    }
+
+    int32_t distances[4], indices[4];
+    memcpy(distances, &bestDistance, sizeof(distances));
+    memcpy(indices, &bestIndex, sizeof(indices));
+
+    int best = 0;
+    for (int lane = 1; lane < 4; lane++) {
+        if (distances[lane] < distances[best] || (distances[lane] == distances[best] && indices[lane] < indices[best])) {
+            best = lane;
+        }
+    }
+
+    return indices[best];
+#else
+    int32_t bestDistance = INT32_MAX;
+    int bestIndex = 0;
+
+    for (int i = 0; i < paddedCount; i++) {
+        int32_t deltaRed = palette->red[i] - red;
+        int32_t deltaGreen = palette->green[i] - green;
+        int32_t deltaBlue = palette->blue[i] - blue;
+        int32_t distance = deltaRed * deltaRed + deltaGreen * deltaGreen + deltaBlue * deltaBlue;
+
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            bestIndex = i;
+        }
+    }
+
+    return bestIndex;
+#endif
+}
+
+static int IMGIFPaletteIndex(IMGIFPalette *palette, int red, int green, int blue) {
+    int bin = IMGIFBinForColor(red, green, blue);
+    uint16_t index = palette->cache[bin];
+
+    if (index == IM_GIF_CACHE_EMPTY) {
+        // search from the center of the bin so the cached answer doesn't depend on which color filled it
+        index = (uint16_t) IMGIFNearestColor(palette,
+                                              (red & 0xF8) | 0x04,
+                                              (green & 0xF8) | 0x04,
+                                              (blue & 0xF8) | 0x04);
+        palette->cache[bin] = index;
+    }
+
+    return index;
+}
+
+static int IMGIFClamp(int value) {
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+static void IMGIFMapPixels(IMImojiGIFEncoder *encoder, IMGIFPalette *palette, IMGIFRect rect, int transparentIndex) {
+    // errors are kept in sixteenths for the current and next row, with a guard column on both ends
+    int32_t *currentErrors = encoder->errors;
+    int32_t *nextErrors = encoder->errors + (encoder->width + 2) * 3;
+    int dither = encoder->options.dither && palette->count > 1;
+
+    if (dither) {
+        memset(currentErrors, 0, (size_t) (rect.width + 2) * 3 * sizeof(int32_t));
+    }
+
+    for (int y = rect.top; y < rect.top + rect.height; y++) {
+        size_t offset = (size_t) y * encoder->width + rect.left;
+        const uint8_t *pixel = encoder->pending + offset * 4;
+        const uint8_t *changed = encoder->changed + offset;
+        uint8_t *output = encoder->indices + (size_t) (y - rect.top) * rect.width;
+
+        if (dither) {
+            memset(nextErrors, 0, (size_t) (rect.width + 2) * 3 * sizeof(int32_t));
+        }
+
+        for (int x = 0; x < rect.width; x++, pixel += 4) {
+            if (!changed[x] || pixel[3] == 0) {
+                output[x] = (uint8_t) transparentIndex;
+                continue;
+            }
+
+            if (!dither) {
+                output[x] = (uint8_t) IMGIFPaletteIndex(palette, pixel[0], pixel[1], pixel[2]);
+                continue;
+            }
+
+            int32_t *error = currentErrors + (x + 1) * 3;
+            int red = IMGIFClamp(pixel[0] + (error[0] + 8) / 16);
+            int green = IMGIFClamp(pixel[1] + (error[1] + 8) / 16);
+            int blue = IMGIFClamp(pixel[2] + (error[2] + 8) / 16);
+
+            int index = IMGIFPaletteIndex(palette, red, green, blue);
+            output[x] = (uint8_t) index;
+
+            int residual[3] = {
+                    red - palette->colors[index * 3],
+                    green - palette->colors[index * 3 + 1],
+                    blue - palette->colors[index * 3 + 2]
+            };
+
+            for (int c = 0; c < 3; c++) {
+                currentErrors[(x + 2) * 3 + c] += residual[c] * 7;
+                nextErrors[x * 3 + c] += residual[c] * 3;
+                nextErrors[(x + 1) * 3 + c] += residual[c] * 5;
+                nextErrors[(x + 2) * 3 + c] += residual[c];
+            }
+        }
+
+        int32_t *swap = currentErrors;
+        currentErrors = nextErrors;
+        nextErrors = swap;
+    }
+}
+
+// MARK: LZW
+
+static void IMGIFWriteBits(IMImojiGIFEncoder *encoder, int code, int codeSize) {
+    encoder->bitBuffer |= (uint32_t) code << encoder->bitCount;
+    encoder->bitCount += codeSize;
+
+    while (encoder->bitCount >= 8) {
+        encoder->block[encoder->blockLength++] = (uint8_t) (encoder->bitBuffer & 0xFF);
+        encoder->bitBuffer >>= 8;
+        encoder->bitCount -= 8;
+
+        if (encoder->blockLength == 255) {
+            IMGIFWriteByte(encoder, 255);
+            IMGIFWrite(encoder, encoder->block, 255);
+            encoder->blockLength = 0;
+        }
+    }
+}
+
+static void IMGIFResetLZWTable(IMImojiGIFEncoder *encoder) {
+    memset(encoder->lzwKeys, 0xFF, sizeof(encoder->lzwKeys));
+}
+
+static void IMGIFWriteImageData(IMImojiGIFEncoder *encoder, const uint8_t *indices, size_t count, int minimumCodeSize) {
+    int clearCode = 1 << minimumCodeSize;
+    int codeSize = minimumCodeSize + 1;
+    int lastCode = clearCode + 1;
+
+    IMGIFWriteByte(encoder, (uint8_t) minimumCodeSize);
+    encoder->bitBuffer = 0;
+    encoder->bitCount = 0;
+    encoder->blockLength = 0;
+
+    IMGIFResetLZWTable(encoder);
+    IMGIFWriteBits(encoder, clearCode, codeSize);
+
+    int prefix = indices[0];
+    for (size_t i = 1; i < count; i++) {
+        int value = indices[i];
+        int32_t key = (prefix << 8) | value;
+        int slot = ((value << 12) ^ prefix) % IM_GIF_LZW_HASH_SIZE;
+
+        while (encoder->lzwKeys[slot] != -1 && encoder->lzwKeys[slot] != key) {
+            slot = slot + 1 == IM_GIF_LZW_HASH_SIZE ? 0 : slot + 1;
+        }
+
+        if (encoder->lzwKeys[slot] == key) {
+            prefix = encoder->lzwCodes[slot];
+            continue;
+        }
+
+        IMGIFWriteBits(encoder, prefix, codeSize);
+
+        encoder->lzwKeys[slot] = key;
+        encoder->lzwCodes[slot] = (uint16_t) ++lastCode;
+        if (lastCode >= (1 << codeSize)) {
+            codeSize++;
+        }
+
+        if (lastCode == IM_GIF_LZW_MAXIMUM_CODE) {
+            IMGIFWriteBits(encoder, clearCode, codeSize);
+            IMGIFResetLZWTable(encoder);
+            codeSize = minimumCodeSize + 1;
+            lastCode = clearCode + 1;
+        }
+
+        prefix = value;
+    }
+
+    IMGIFWriteBits(encoder, prefix, codeSize);
+    IMGIFWriteBits(encoder, clearCode + 1, codeSize);
+
+    if (encoder->bitCount > 0) {
+        IMGIFWriteBits(encoder, 0, 8 - encoder->bitCount);
+    }
+
+    if (encoder->blockLength > 0) {
+        IMGIFWriteByte(encoder, (uint8_t) encoder->blockLength);
+        IMGIFWrite(encoder, encoder->block, (size_t) encoder->blockLength);
+    }
+
+    IMGIFWriteByte(encoder, 0);
+}
+
+// MARK: Frames
+
+static int IMGIFColorTableBits(int colorCount) {
+    int bits = 1;
+    while ((1 << bits) < colorCount) {
+        bits++;
+    }
+
+    return bits;
+}
+
+static void IMGIFWriteColorTable(IMImojiGIFEncoder *encoder, const IMGIFPalette *palette, int bits) {
+    IMGIFWrite(encoder, palette->colors, (size_t) palette->count * 3);
+
+    uint8_t black[3] = {0, 0, 0};
+    for (int i = palette->count; i < (1 << bits); i++) {
+        IMGIFWrite(encoder, black, 3);
+    }
+}
+
+static void IMGIFWriteHeader(IMImojiGIFEncoder *encoder) {
+    int shared = encoder->options.paletteMode == IMImojiGIFEncoderPaletteShared;
+
+    if (shared) {
+        if (!encoder->hasPaletteSamples) {
+            IMGIFRect canvas = {0, 0, encoder->width, encoder->height};
+            IMGIFAddToHistogram(encoder, encoder->pending, NULL, canvas);
+        }
+
+        IMGIFBuildPalette(encoder, encoder->palette);
+        IMGIFResetHistogram(encoder);
+    }
+
+    IMGIFWrite(encoder, (const uint8_t *) "GIF89a", 6);
+    IMGIFWriteShort(encoder, encoder->width);
+    IMGIFWriteShort(encoder, encoder->height);
+
+    if (shared) {
+        int bits = IMGIFColorTableBits(encoder->palette->count + 1);
+        IMGIFWriteByte(encoder, (uint8_t) (0x80 | ((bits - 1) << 4) | (bits - 1)));
+        IMGIFWriteByte(encoder, (uint8_t) encoder->palette->count);
+        IMGIFWriteByte(encoder, 0);
+        IMGIFWriteColorTable(encoder, encoder->palette, bits);
+    } else {
+        IMGIFWriteByte(encoder, 0x70);
+        IMGIFWriteByte(encoder, 0);
+        IMGIFWriteByte(encoder, 0);
+    }
+
+    if (encoder->options.loopCount >= 0) {
+        IMGIFWrite(encoder, (const uint8_t *) "\x21\xFF\x0BNETSCAPE2.0\x03\x01", 16);
+        IMGIFWriteShort(encoder, encoder->options.loopCount > 0xFFFF ? 0xFFFF : encoder->options.loopCount);
+        IMGIFWriteByte(encoder, 0);
+    }
+
+    encoder->headerWritten = 1;
+}
+
+static void IMGIFWritePendingFrame(IMImojiGIFEncoder *encoder, int disposal, int fullCanvas) {
+    if (!encoder->headerWritten) {
+        IMGIFWriteHeader(encoder);
+    }
+
+    // a keyframe follows a cleared canvas so only its visible pixels need drawing, otherwise only what changed
+    int minimumX = encoder->width, minimumY = encoder->height, maximumX = -1, maximumY = -1;
+    for (int y = 0; y < encoder->height; y++) {
+        size_t offset = (size_t) y * encoder->width;
+        uint8_t *changed = encoder->changed + offset;
+        int rowMinimum = -1, rowMaximum = -1;
+
+        for (int x = 0; x < encoder->width; x++) {
+            uint32_t pixel = IMGIFPixelAt(encoder->pending, offset + x);
+            changed[x] = (uint8_t) (encoder->pendingKeyframe ? pixel != 0 : pixel != IMGIFPixelAt(encoder->previous, offset + x));
+
+            if (changed[x]) {
+                if (rowMinimum < 0) rowMinimum = x;
+                rowMaximum = x;
+            }
+        }
+
+        if (rowMinimum >= 0) {
+            if (rowMinimum < minimumX) minimumX = rowMinimum;
+            if (rowMaximum > maximumX) maximumX = rowMaximum;
+            if (y < minimumY) minimumY = y;
+            maximumY = y;
+        }
+    }
+
+    IMGIFRect rect;
+    if (fullCanvas) {
+        rect = (IMGIFRect) {0, 0, encoder->width, encoder->height};
+    } else if (maximumX < 0) {
+        rect = (IMGIFRect) {0, 0, 1, 1};
+    } else {
+        rect = (IMGIFRect) {minimumX, minimumY, maximumX - minimumX + 1, maximumY - minimumY + 1};
+    }
+
+    int shared = encoder->options.paletteMode == IMImojiGIFEncoderPaletteShared;
+    if (!shared) {
+        IMGIFAddToHistogram(encoder, encoder->pending, encoder->changed, rect);
+        IMGIFBuildPalette(encoder, encoder->palette);
+        IMGIFResetHistogram(encoder);
+    }
+
+    int transparentIndex = encoder->palette->count;
+    int bits = IMGIFColorTableBits(transparentIndex + 1);
+
+    IMGIFMapPixels(encoder, encoder->palette, rect, transparentIndex);
+
+    uint8_t control[8] = {0x21, 0xF9, 0x04, (uint8_t) ((disposal << 2) | 0x01),
+                          (uint8_t) (encoder->pendingDelay & 0xFF), (uint8_t) (encoder->pendingDelay >> 8),
+                          (uint8_t) transparentIndex, 0x00};
+    IMGIFWrite(encoder, control, sizeof(control));
+
+    IMGIFWriteByte(encoder, 0x2C);
+    IMGIFWriteShort(encoder, rect.left);
+    IMGIFWriteShort(encoder, rect.top);
+    IMGIFWriteShort(encoder, rect.width);
+    IMGIFWriteShort(encoder, rect.height);
+
+    if (shared) {
+        IMGIFWriteByte(encoder, 0);
+    } else {
+        IMGIFWriteByte(encoder, (uint8_t) (0x80 | (bits - 1)));
+        IMGIFWriteColorTable(encoder, encoder->palette, bits);
+    }
+
+    IMGIFWriteImageData(encoder, encoder->indices, (size_t) rect.width * rect.height, bits < 2 ? 2 : bits);
+}
+
+// MARK: Public
+
+void IMImojiGIFEncoderGetDefaultOptions(IMImojiGIFEncoderOptions *options) {
+    options->paletteMode = IMImojiGIFEncoderPaletteShared;
+    options->maximumColors = 255;
+    options->dither = 1;
+    options->premultipliedAlpha = 0;
+    options->alphaThreshold = 128;
+    options->loopCount = 0;
+}
+
+IMImojiGIFEncoder *IMImojiGIFEncoderCreate(uint16_t width,
+                                           uint16_t height,
+                                           const IMImojiGIFEncoderOptions *options,
+                                           IMImojiGIFEncoderWriteFunction writeFunction,
+                                           void *context) {
+    if (width == 0 || height == 0 || !writeFunction) {
+        return NULL;
+    }
+
+    IMImojiGIFEncoder *encoder = calloc(1, sizeof(IMImojiGIFEncoder));
+    if (!encoder) {
+        return NULL;
+    }
+
+    if (options) {
+        encoder->options = *options;
+    } else {
+        IMImojiGIFEncoderGetDefaultOptions(&encoder->options);
+    }
+
+    if (encoder->options.maximumColors < 2) {
+        encoder->options.maximumColors = 2;
+    } else if (encoder->options.maximumColors > IM_GIF_MAXIMUM_PALETTE - 1) {
+        encoder->options.maximumColors = IM_GIF_MAXIMUM_PALETTE - 1;
+    }
+
+    size_t pixelCount = (size_t) width * height;
+    encoder->width = width;
+    encoder->height = height;
+    encoder->writeFunction = writeFunction;
+    encoder->context = context;
+
+    encoder->histogram = calloc(IM_GIF_HISTOGRAM_BINS, sizeof(IMGIFHistogramBin));
+    encoder->usedBins = malloc(IM_GIF_HISTOGRAM_BINS * sizeof(uint16_t));
+    encoder->sortedBins = malloc(IM_GIF_HISTOGRAM_BINS * sizeof(uint16_t));
+    encoder->palette = calloc(1, sizeof(IMGIFPalette));
+    encoder->previous = calloc(pixelCount, 4);
+    encoder->pending = calloc(pixelCount, 4);
+    encoder->incoming = calloc(pixelCount, 4);
+    encoder->changed = malloc(pixelCount);
+    encoder->indices = malloc(pixelCount);
+    encoder->errors = malloc((size_t) (width + 2) * 3 * 2 * sizeof(int32_t));
+
+    if (!encoder->histogram || !encoder->usedBins || !encoder->sortedBins || !encoder->palette ||
+            !encoder->previous || !encoder->pending || !encoder->incoming ||
+            !encoder->changed || !encoder->indices || !encoder->errors) {
+        IMImojiGIFEncoderDestroy(encoder);
+        return NULL;
+    }
+
+    return encoder;
+}
+
+IMImojiGIFEncoderStatus IMImojiGIFEncoderAddPaletteSample(IMImojiGIFEncoder *encoder,
+                                                         const uint8_t *rgba,
+                                                         size_t bytesPerRow) {
+    if (!encoder || !rgba || bytesPerRow < (size_t) encoder->width * 4 || encoder->finished) {
+        return IMImojiGIFEncoderStatusInvalidArgument;
+    }
+
+    if (encoder->headerWritten || encoder->options.paletteMode != IMImojiGIFEncoderPaletteShared) {
+        return encoder->status;
+    }
+
+    IMGIFRect canvas = {0, 0, encoder->width, encoder->height};
+    IMGIFNormalizeFrame(encoder, rgba, bytesPerRow, encoder->incoming);
+    IMGIFAddToHistogram(encoder, encoder->incoming, NULL, canvas);
+    encoder->hasPaletteSamples = 1;
+
+    return encoder->status;
+}
+
+IMImojiGIFEncoderStatus IMImojiGIFEncoderAddFrame(IMImojiGIFEncoder *encoder,
+                                                 const uint8_t *rgba,
+                                                 size_t bytesPerRow,
+                                                 uint16_t delay) {
+    if (!encoder || !rgba || bytesPerRow < (size_t) encoder->width * 4 || encoder->finished) {
+        return IMImojiGIFEncoderStatusInvalidArgument;
+    }
+
+    if (encoder->status != IMImojiGIFEncoderStatusSuccess) {
+        return encoder->status;
+    }
+
+    size_t pixelCount = (size_t) encoder->width * encoder->height;
+    IMGIFNormalizeFrame(encoder, rgba, bytesPerRow, encoder->incoming);
+
+    if (encoder->hasPending) {
+        if (memcmp(encoder->incoming, encoder->pending, pixelCount * 4) == 0) {
+            uint32_t combined = (uint32_t) encoder->pendingDelay + delay;
+            encoder->pendingDelay = (uint16_t) (combined > 0xFFFF ? 0xFFFF : combined);
+            return encoder->status;
+        }
+
+        // transparency can't be drawn over the previous frame, the canvas has to be cleared before the next frame
+        int needsClear = 0;
+        for (size_t i = 0; i < pixelCount && !needsClear; i++) {
+            needsClear = encoder->pending[i * 4 + 3] != 0 && encoder->incoming[i * 4 + 3] == 0;
+        }
+
+        IMGIFWritePendingFrame(encoder, needsClear ? IM_GIF_DISPOSAL_BACKGROUND : IM_GIF_DISPOSAL_NONE, needsClear);
+        encoder->pendingKeyframe = needsClear;
+    } else {
+        encoder->pendingKeyframe = 1;
+    }
+
+    uint8_t *recycled = encoder->previous;
+    encoder->previous = encoder->pending;
+    encoder->pending = encoder->incoming;
+    encoder->incoming = recycled;
+    encoder->pendingDelay = delay;
+    encoder->hasPending = 1;
+
+    return encoder->status;
+}
+
+IMImojiGIFEncoderStatus IMImojiGIFEncoderFinish(IMImojiGIFEncoder *encoder) {
+    if (!encoder || encoder->finished || !encoder->hasPending) {
+        return IMImojiGIFEncoderStatusInvalidArgument;
+    }
+
+    IMGIFWritePendingFrame(encoder, IM_GIF_DISPOSAL_NONE, 0);
+    IMGIFWriteByte(encoder, 0x3B);
+    IMGIFFlush(encoder);
+    encoder->finished = 1;
+
+    return encoder->status;
+}
+
+void IMImojiGIFEncoderDestroy(IMImojiGIFEncoder *encoder) {
+    if (!encoder) {
+        return;
+    }
+
+    free(encoder->histogram);
+    free(encoder->usedBins);
+    free(encoder->sortedBins);
+    free(encoder->palette);
+    free(encoder->previous);
+    free(encoder->pending);
+    free(encoder->incoming);
+    free(encoder->changed);
+    free(encoder->indices);
+    free(encoder->errors);
+    free(encoder);
+}
@@ -0,0 +1,119 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#ifndef IMImojiGIFEncoder_h
+#define IMImojiGIFEncoder_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Streaming animated GIF encoder written in portable C so it can be built and benchmarked outside of Xcode.
+ *
+ * Frames are handed over as 8 bit RGBA and quantized with a median cut palette, optionally Floyd-Steinberg dithered.
+ * Pixels that did not change from the previous frame are written as transparent and each frame is cropped to the
+ * region that changed. Consecutive identical frames are merged into one frame with their delays combined.
+ */
+typedef struct IMImojiGIFEncoder IMImojiGIFEncoder;
+
+typedef enum {
+    IMImojiGIFEncoderStatusSuccess = 0,
+    IMImojiGIFEncoderStatusInvalidArgument,
+    IMImojiGIFEncoderStatusOutOfMemory,
+    IMImojiGIFEncoderStatusWriteFailed
+} IMImojiGIFEncoderStatus;
+
+typedef enum {
+    /** One palette, built from the samples added with IMImojiGIFEncoderAddPaletteSample, is shared by all frames. */
+    IMImojiGIFEncoderPaletteShared = 0,
+    /** Every frame gets a local palette built from the pixels it changes. */
+    IMImojiGIFEncoderPalettePerFrame
+} IMImojiGIFEncoderPaletteMode;
+
+/**
+ * Receives encoded bytes. Returns non zero on success.
+ */
+typedef int (*IMImojiGIFEncoderWriteFunction)(void *context, const uint8_t *bytes, size_t length);
+
+typedef struct {
+    IMImojiGIFEncoderPaletteMode paletteMode;
+    /** Maximum number of opaque colors per palette, 2 to 255. One more entry is always reserved for transparency. */
+    int maximumColors;
+    /** Non zero to apply Floyd-Steinberg error diffusion when mapping pixels to the palette. */
+    int dither;
+    /** Non zero when the frames passed in have their color components premultiplied by alpha. */
+    int premultipliedAlpha;
+    /** Pixels with an alpha below this value are written as transparent. */
+    uint8_t alphaThreshold;
+    /** Number of times the animation repeats, 0 loops forever and -1 omits the loop extension. */
+    int loopCount;
+} IMImojiGIFEncoderOptions;
+
+void IMImojiGIFEncoderGetDefaultOptions(IMImojiGIFEncoderOptions *options);
+
+/**
+ * Creates an encoder for a canvas of width x height pixels. Nothing is written until the first frame is flushed.
+ * Returns NULL if the arguments are invalid or memory could not be allocated.
+ */
+IMImojiGIFEncoder *IMImojiGIFEncoderCreate(uint16_t width,
+                                           uint16_t height,
+                                           const IMImojiGIFEncoderOptions *options,
+                                           IMImojiGIFEncoderWriteFunction writeFunction,
+                                           void *context);
+
+/**
+ * Adds a frame's colors to the histogram the shared palette is built from. Sampling a handful of evenly spaced frames
+ * is usually enough. Samples added after the first frame has been written are ignored, and when no samples are added
+ * the shared palette is built from the first frame.
+ */
+IMImojiGIFEncoderStatus IMImojiGIFEncoderAddPaletteSample(IMImojiGIFEncoder *encoder,
+                                                         const uint8_t *rgba,
+                                                         size_t bytesPerRow);
+
+/**
+ * Adds a frame shown for delay hundredths of a second. The pixels are copied, so the buffer may be reused as soon as
+ * this returns. Frames are written one frame behind since the disposal of a frame depends on the frame after it.
+ */
+IMImojiGIFEncoderStatus IMImojiGIFEncoderAddFrame(IMImojiGIFEncoder *encoder,
+                                                 const uint8_t *rgba,
+                                                 size_t bytesPerRow,
+                                                 uint16_t delay);
+
+/**
+ * Writes the last pending frame and the trailer. No frames may be added afterwards.
+ */
+IMImojiGIFEncoderStatus IMImojiGIFEncoderFinish(IMImojiGIFEncoder *encoder);
+
+void IMImojiGIFEncoderDestroy(IMImojiGIFEncoder *encoder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IMImojiGIFEncoder_h */
@@ -0,0 +1,72 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+@class IMImojiObjectRenderingOptions;
+
+/**
+* Turns encoded Imoji image data into bitmaps that are ready to draw. Decoding happens up front on the calling thread
+* rather than lazily at first draw, and static images are downsampled to the requested pixel size so small cells don't
+* hold on to full resolution bitmaps. Padding to a requested aspect ratio is applied to the decoded bitmap as well, so
+* published image variants can stand in for custom renders. Animated images are returned as YYImage objects at their
+* downloaded size, which decode their frames as they are displayed, so sized or padded animations have to come from the
+* render service.
+*/
+@interface IMImojiImageDecoder : NSObject
+
+/**
+* Decodes the image data. Static images larger than maximumPixelSize along their longest side are downsampled to fit.
+* Pass 0 for maximumPixelSize to decode at the source resolution. Static images are then padded with transparent pixels
+* to match aspectRatio, pass CGSizeZero to keep their own. Animated images ignore both.
+*/
++ (nullable UIImage *)decodedImageWithData:(nonnull NSData *)data
+                          maximumPixelSize:(CGFloat)maximumPixelSize
+                               aspectRatio:(CGSize)aspectRatio
+                                     scale:(CGFloat)scale;
+
+/**
+* The longest side in pixels to decode images rendered with the given options at the given screen scale, 0 when the
+* options don't request a target size.
+*/
++ (CGFloat)maximumPixelSizeForRenderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions
+                                         scale:(CGFloat)scale;
+
+/**
+* The aspect ratio to pad images rendered with the given options to, CGSizeZero when the options don't request one.
+*/
++ (CGSize)aspectRatioForRenderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions;
+
+/**
+* Whether images decoded with one maximumPixelSize and aspectRatio are laid out the same as with another. Sizes are
+* compared in whole pixels and aspect ratios as ratios within a small tolerance, so 2x1 matches 4x2.
+*/
++ (BOOL)isMaximumPixelSize:(CGFloat)maximumPixelSize
+               aspectRatio:(CGSize)aspectRatio
+    equalToMaximumPixelSize:(CGFloat)otherMaximumPixelSize
+               aspectRatio:(CGSize)otherAspectRatio;
+
+@end
@@ -0,0 +1,211 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <ImageIO/ImageIO.h>
+#import <YYImage/YYImage.h>
+#import "IMImojiImageDecoder.h"
+#import "IMImojiObjectRenderingOptions.h"
+
+@implementation IMImojiImageDecoder
+
++ (UIImage *)decodedImageWithData:(NSData *)data
+                 maximumPixelSize:(CGFloat)maximumPixelSize
+                      aspectRatio:(CGSize)aspectRatio
+                            scale:(CGFloat)scale {
+    if (data.length == 0) {
+        return nil;
+    }
+
+    CGImageRef imageRef = NULL;
+
+    // ImageIO can't read WebP, fall back to YYImage's decoder for those
+    if (YYImageDetectType((__bridge CFDataRef) data) == YYImageTypeWebP) {
+        YYImageDecoder *decoder = [YYImageDecoder decoderWithData:data scale:scale];
+        if (decoder.frameCount > 1) {
+            return [YYImage imageWithData:data scale:scale];
+        }
+
+        CGImageRef frameRef = [decoder frameAtIndex:0 decodeForDisplay:YES].image.CGImage;
+        if (frameRef) {
+            imageRef = [self createDownsampledImage:frameRef maximumPixelSize:maximumPixelSize];
+        }
+    } else {
+        CGImageSourceRef source = CGImageSourceCreateWithData((__bridge CFDataRef) data, NULL);
+        if (!source) {
+            return nil;
+        }
+
+        if (CGImageSourceGetCount(source) > 1) {
+            CFRelease(source);
+            return [YYImage imageWithData:data scale:scale];
+        }
+
+        imageRef = [self createImageFromSource:source maximumPixelSize:maximumPixelSize];
+        CFRelease(source);
+    }
+
+    if (!imageRef) {
+        return nil;
+    }
+
+    if (aspectRatio.width > 0 && aspectRatio.height > 0) {
+        CGImageRef paddedImageRef = [self createPaddedImage:imageRef aspectRatio:aspectRatio];
+        CGImageRelease(imageRef);
+        imageRef = paddedImageRef;
+    }
+
+    if (!imageRef) {
+        return nil;
+    }
+
+    UIImage *image = [UIImage imageWithCGImage:imageRef scale:scale orientation:UIImageOrientationUp];
+    CGImageRelease(imageRef);
+
+    return image;
+}
+
++ (CGFloat)maximumPixelSizeForRenderingOptions:(IMImojiObjectRenderingOptions *)renderingOptions
+                                         scale:(CGFloat)scale {
+    if (!renderingOptions.targetSize) {
+        return 0;
+    }
+
+    CGSize targetSize = [renderingOptions.targetSize CGSizeValue];
+    return ceil(MAX(targetSize.width, targetSize.height) * scale);
+}
+
++ (CGSize)aspectRatioForRenderingOptions:(IMImojiObjectRenderingOptions *)renderingOptions {
+    return renderingOptions.aspectRatio ? [renderingOptions.aspectRatio CGSizeValue] : CGSizeZero;
+}
+
++ (BOOL)isMaximumPixelSize:(CGFloat)maximumPixelSize
+               aspectRatio:(CGSize)aspectRatio
+    equalToMaximumPixelSize:(CGFloat)otherMaximumPixelSize
+               aspectRatio:(CGSize)otherAspectRatio {
+    if (lround(maximumPixelSize) != lround(otherMaximumPixelSize)) {
+        return NO;
+    }
+
+    BOOL padded = aspectRatio.width > 0 && aspectRatio.height > 0;
+    BOOL otherPadded = otherAspectRatio.width > 0 && otherAspectRatio.height > 0;
+    if (!padded || !otherPadded) {
+        return padded == otherPadded;
+    }
+
+    // padding rounds to whole pixels, ratios this close produce the same image
+    CGFloat ratio = aspectRatio.width / aspectRatio.height;
+    CGFloat otherRatio = otherAspectRatio.width / otherAspectRatio.height;
+    return fabs(ratio - otherRatio) <= MAX(ratio, otherRatio) * 1e-4;
+}
+
+#pragma mark Decoding
+
++ (CGImageRef)createImageFromSource:(CGImageSourceRef)source maximumPixelSize:(CGFloat)maximumPixelSize {
+    // ShouldCacheImmediately makes ImageIO decode now instead of when the image is first drawn
+    if (maximumPixelSize <= 0) {
+        return CGImageSourceCreateImageAtIndex(source, 0, (__bridge CFDictionaryRef) @{
+                (__bridge NSString *) kCGImageSourceShouldCacheImmediately : @YES
+        });
+    }
+
+    // thumbnails are never scaled up, images already smaller than the requested size keep their resolution
+    return CGImageSourceCreateThumbnailAtIndex(source, 0, (__bridge CFDictionaryRef) @{
+            (__bridge NSString *) kCGImageSourceCreateThumbnailFromImageAlways : @YES,
+            (__bridge NSString *) kCGImageSourceCreateThumbnailWithTransform : @YES,
+            (__bridge NSString *) kCGImageSourceShouldCacheImmediately : @YES,
+            (__bridge NSString *) kCGImageSourceThumbnailMaxPixelSize : @(maximumPixelSize)
+    });
+}
+
++ (CGImageRef)createPaddedImage:(CGImageRef)imageRef aspectRatio:(CGSize)aspectRatio {
+    size_t width = CGImageGetWidth(imageRef);
+    size_t height = CGImageGetHeight(imageRef);
+    CGFloat ratio = aspectRatio.width / aspectRatio.height;
+
+    // grow whichever side is short of the ratio and center the image, same as the render service does
+    size_t paddedWidth = width;
+    size_t paddedHeight = height;
+    if ((CGFloat) width / height < ratio) {
+        paddedWidth = (size_t) round(height * ratio);
+    } else {
+        paddedHeight = (size_t) round(width / ratio);
+    }
+
+    if (paddedWidth == width && paddedHeight == height) {
+        return CGImageRetain(imageRef);
+    }
+
+    CGContextRef context = [self createBitmapContextWithWidth:paddedWidth height:paddedHeight];
+    if (!context) {
+        return CGImageRetain(imageRef);
+    }
+
+    CGContextClearRect(context, CGRectMake(0, 0, paddedWidth, paddedHeight));
+    CGContextDrawImage(context, CGRectMake(floor((paddedWidth - width) / 2.0), floor((paddedHeight - height) / 2.0), width, height), imageRef);
+
+    CGImageRef paddedImageRef = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+
+    return paddedImageRef;
+}
+
++ (CGContextRef)createBitmapContextWithWidth:(size_t)width height:(size_t)height {
+    // premultiplied BGRA is the format the display pipeline draws without converting
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(NULL, width, height, 8, 0, colorSpace,
+            kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedFirst);
+    CGColorSpaceRelease(colorSpace);
+
+    return context;
+}
+
++ (CGImageRef)createDownsampledImage:(CGImageRef)imageRef maximumPixelSize:(CGFloat)maximumPixelSize {
+    size_t width = CGImageGetWidth(imageRef);
+    size_t height = CGImageGetHeight(imageRef);
+    CGFloat longestSide = MAX(width, height);
+
+    if (maximumPixelSize <= 0 || longestSide <= maximumPixelSize) {
+        return CGImageRetain(imageRef);
+    }
+
+    CGFloat ratio = maximumPixelSize / longestSide;
+    size_t scaledWidth = MAX((size_t) round(width * ratio), 1u);
+    size_t scaledHeight = MAX((size_t) round(height * ratio), 1u);
+
+    CGContextRef context = [self createBitmapContextWithWidth:scaledWidth height:scaledHeight];
+    if (!context) {
+        return CGImageRetain(imageRef);
+    }
+
+    CGContextSetInterpolationQuality(context, kCGInterpolationHigh);
+    CGContextDrawImage(context, CGRectMake(0, 0, scaledWidth, scaledHeight), imageRef);
+
+    CGImageRef scaledImageRef = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+
+    return scaledImageRef;
+}
+
+@end
@@ -0,0 +1,98 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+* Size bounded on disk store of downloaded Imoji image data keyed by the resolved download URL. Files are evicted in
+* least recently used order once the total size of the store exceeds sizeLimit, and once they haven't been used for
+* maximumAge seconds if it is set. Files used within the last minimumAge seconds are never evicted.
+*/
+@interface IMImojiImageDiskCache : NSObject
+
+- (nonnull instancetype)initWithPath:(nonnull NSString *)path sizeLimit:(NSUInteger)sizeLimit;
+
+- (nonnull instancetype)initWithPath:(nonnull NSString *)path sizeLimit:(NSUInteger)sizeLimit maximumAge:(NSTimeInterval)maximumAge;
+
+@property(nonatomic, readonly, nonnull) NSString *path;
+
+@property(nonatomic) NSUInteger sizeLimit;
+
+/**
+* Number of seconds an unused file is kept, 0 keeps files until they are evicted by size. Expired files are removed
+* when the store is opened and whenever it is trimmed.
+*/
+@property(nonatomic) NSTimeInterval maximumAge;
+
+/**
+* Number of seconds a file is kept after it was last used regardless of sizeLimit, for files whose paths are handed out
+* to other processes. The store may grow past sizeLimit until they are old enough. Defaults to 0.
+*/
+@property(nonatomic) NSTimeInterval minimumAge;
+
+/**
+* Number of bytes allocated by the stored files once the writes queued so far have finished. Waits for the IO queue.
+*/
+@property(nonatomic, readonly) unsigned long long totalSize;
+
+/**
+* Reads the stored data for a URL synchronously, nil if the URL has not been stored. Callers should avoid calling
+* this on the main thread.
+*/
+- (nullable NSData *)dataForURL:(nonnull NSURL *)url;
+
+/**
+* Stores data for a URL. The write happens asynchronously on the cache's IO queue.
+*/
+- (void)setData:(nonnull NSData *)data forURL:(nonnull NSURL *)url;
+
+/**
+* Stores data for a URL unless the cancellation token has been cancelled by the time the IO queue gets to the write.
+*/
+- (void)setData:(nonnull NSData *)data forURL:(nonnull NSURL *)url cancellationToken:(nullable NSOperation *)cancellationToken;
+
+/**
+* Moves a file written outside of the store into it for a URL, so large contents can be streamed to disk instead of
+* being held in memory. The move happens asynchronously on the cache's IO queue, completion is called on a background
+* queue afterwards with whether the file was moved. Files that weren't moved are left where they are for the caller to
+* use or remove.
+*/
+- (void)moveFileAtURL:(nonnull NSURL *)fileURL
+        toStoreForURL:(nonnull NSURL *)url
+           completion:(nullable void (^)(BOOL moved))completion;
+
+- (BOOL)containsDataForURL:(nonnull NSURL *)url;
+
+/**
+* Path of the stored file for a URL without reading it, nil if the URL has not been stored. Counts as a use of the
+* file for eviction.
+*/
+- (nullable NSString *)storedFilePathForURL:(nonnull NSURL *)url;
+
+- (nonnull NSString *)filePathForURL:(nonnull NSURL *)url;
+
+- (void)removeAllData;
+
+@end
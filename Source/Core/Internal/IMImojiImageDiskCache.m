@@ -0,0 +1,258 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import "IMImojiImageDiskCache.h"
+#import "NSString+Utils.h"
+
+@implementation IMImojiImageDiskCache {
+    dispatch_queue_t _ioQueue;
+    unsigned long long _totalSize;
+}
+
+- (instancetype)initWithPath:(NSString *)path sizeLimit:(NSUInteger)sizeLimit {
+    return [self initWithPath:path sizeLimit:sizeLimit maximumAge:0];
+}
+
+- (instancetype)initWithPath:(NSString *)path sizeLimit:(NSUInteger)sizeLimit maximumAge:(NSTimeInterval)maximumAge {
+    self = [super init];
+    if (self) {
+        _path = [path copy];
+        _sizeLimit = sizeLimit;
+        _maximumAge = maximumAge;
+        _ioQueue = dispatch_queue_create("com.imoji.imagecache.io", DISPATCH_QUEUE_SERIAL);
+
+        dispatch_async(_ioQueue, ^{
+            if (![[NSFileManager defaultManager] fileExistsAtPath:self.path]) {
+                NSError *error;
+                [[NSFileManager defaultManager] createDirectoryAtPath:self.path
+                                          withIntermediateDirectories:YES
+                                                           attributes:nil
+                                                                error:&error];
+            }
+
+            [self trimToSizeLimit];
+        });
+    }
+
+    return self;
+}
+
+- (NSString *)filePathForURL:(NSURL *)url {
+    NSString *extension = url.pathExtension.length > 0 ? url.pathExtension : @"img";
+    return [self.path stringByAppendingPathComponent:[NSString stringWithFormat:@"%@.%@", [url.absoluteString im_md5], extension]];
+}
+
+- (BOOL)containsDataForURL:(NSURL *)url {
+    return [[NSFileManager defaultManager] fileExistsAtPath:[self filePathForURL:url]];
+}
+
+- (NSString *)storedFilePathForURL:(NSURL *)url {
+    NSString *filePath = [self filePathForURL:url];
+    if (![[NSFileManager defaultManager] fileExistsAtPath:filePath]) {
+        return nil;
+    }
+
+    dispatch_async(_ioQueue, ^{
+        [[NSFileManager defaultManager] setAttributes:@{NSFileModificationDate : [NSDate date]}
+                                         ofItemAtPath:filePath
+                                                error:nil];
+    });
+
+    return filePath;
+}
+
+- (NSData *)dataForURL:(NSURL *)url {
+    NSString *filePath = [self filePathForURL:url];
+    NSData *data = [NSData dataWithContentsOfFile:filePath options:NSDataReadingMappedIfSafe error:nil];
+
+    if (data) {
+        // touch the file so eviction happens in least recently used order
+        dispatch_async(_ioQueue, ^{
+            [[NSFileManager defaultManager] setAttributes:@{NSFileModificationDate : [NSDate date]}
+                                             ofItemAtPath:filePath
+                                                    error:nil];
+        });
+    }
+
+    return data;
+}
+
+- (void)setData:(NSData *)data forURL:(NSURL *)url {
+    [self setData:data forURL:url cancellationToken:nil];
+}
+
+- (void)setData:(NSData *)data forURL:(NSURL *)url cancellationToken:(NSOperation *)cancellationToken {
+    if (data.length == 0 || data.length > self.sizeLimit) {
+        return;
+    }
+
+    NSString *filePath = [self filePathForURL:url];
+    dispatch_async(_ioQueue, ^{
+        if (cancellationToken.isCancelled) {
+            return;
+        }
+
+        unsigned long long replacedSize = [self allocatedSizeOfFileAtPath:filePath];
+
+        NSError *error;
+        if (![data writeToFile:filePath options:NSDataWritingAtomic error:&error]) {
+            return;
+        }
+
+        [self addStoredFileAtPath:filePath replacingSize:replacedSize];
+    });
+}
+
+- (void)moveFileAtURL:(NSURL *)fileURL
+        toStoreForURL:(NSURL *)url
+           completion:(void (^)(BOOL moved))completion {
+    NSString *filePath = [self filePathForURL:url];
+
+    dispatch_async(_ioQueue, ^{
+        NSNumber *fileSize;
+        [fileURL getResourceValue:&fileSize forKey:NSURLFileSizeKey error:nil];
+
+        BOOL moved = NO;
+        if (fileSize.unsignedLongLongValue > 0 && fileSize.unsignedLongLongValue <= self.sizeLimit) {
+            unsigned long long replacedSize = [self allocatedSizeOfFileAtPath:filePath];
+
+            [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+            moved = [[NSFileManager defaultManager] moveItemAtURL:fileURL toURL:[NSURL fileURLWithPath:filePath] error:nil];
+
+            if (moved) {
+                [self addStoredFileAtPath:filePath replacingSize:replacedSize];
+            } else {
+                // the previous file was removed above whether or not the move succeeded
+                self->_totalSize -= MIN(self->_totalSize, replacedSize);
+            }
+        }
+
+        if (completion) {
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                completion(moved);
+            });
+        }
+    });
+}
+
+- (unsigned long long)totalSize {
+    __block unsigned long long totalSize;
+    dispatch_sync(_ioQueue, ^{
+        totalSize = self->_totalSize;
+    });
+
+    return totalSize;
+}
+
+// Must be called on _ioQueue. Sizes are allocated sizes to match what trimToSizeLimit counts, 0 for missing files.
+- (unsigned long long)allocatedSizeOfFileAtPath:(NSString *)filePath {
+    NSNumber *fileSize;
+    [[NSURL fileURLWithPath:filePath] getResourceValue:&fileSize forKey:NSURLTotalFileAllocatedSizeKey error:nil];
+    return fileSize.unsignedLongLongValue;
+}
+
+// Must be called on _ioQueue after a file has been written to filePath, replacing a file of replacedSize bytes if
+// there was one.
+- (void)addStoredFileAtPath:(NSString *)filePath replacingSize:(unsigned long long)replacedSize {
+    NSURL *fileURL = [NSURL fileURLWithPath:filePath];
+    [fileURL setResourceValue:@YES forKey:NSURLIsExcludedFromBackupKey error:nil];
+
+    _totalSize -= MIN(_totalSize, replacedSize);
+    _totalSize += [self allocatedSizeOfFileAtPath:filePath];
+    if (_totalSize > self.sizeLimit) {
+        [self trimToSizeLimit];
+    }
+}
+
+- (void)removeAllData {
+    dispatch_async(_ioQueue, ^{
+        NSError *error;
+        [[NSFileManager defaultManager] removeItemAtPath:self.path error:&error];
+        [[NSFileManager defaultManager] createDirectoryAtPath:self.path
+                                  withIntermediateDirectories:YES
+                                                   attributes:nil
+                                                        error:&error];
+        self->_totalSize = 0;
+    });
+}
+
+// Must be called on _ioQueue. Recomputes the size of the store, removes expired files and then the least recently used
+// files until the store is at half of its limit, which keeps trimming from running on every write once the limit is
+// reached. Files used more recently than minimumAge are skipped.
+- (void)trimToSizeLimit {
+    NSArray *resourceKeys = @[NSURLContentModificationDateKey, NSURLTotalFileAllocatedSizeKey, NSURLIsDirectoryKey];
+    NSArray *fileUrls = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:[NSURL fileURLWithPath:self.path]
+                                                      includingPropertiesForKeys:resourceKeys
+                                                                         options:NSDirectoryEnumerationSkipsHiddenFiles
+                                                                           error:nil];
+
+    NSMutableArray *files = [NSMutableArray arrayWithCapacity:fileUrls.count];
+    unsigned long long totalSize = 0;
+    NSDate *expirationDate = self.maximumAge > 0 ? [NSDate dateWithTimeIntervalSinceNow:-self.maximumAge] : nil;
+    NSDate *protectionDate = [NSDate dateWithTimeIntervalSinceNow:-self.minimumAge];
+    for (NSURL *fileUrl in fileUrls) {
+        NSDictionary *values = [fileUrl resourceValuesForKeys:resourceKeys error:nil];
+        if ([values[NSURLIsDirectoryKey] boolValue]) {
+            continue;
+        }
+
+        NSDate *modificationDate = values[NSURLContentModificationDateKey] ? values[NSURLContentModificationDateKey] : [NSDate distantPast];
+        NSNumber *fileSize = values[NSURLTotalFileAllocatedSizeKey] ? values[NSURLTotalFileAllocatedSizeKey] : @0;
+
+        if (expirationDate && [modificationDate compare:expirationDate] == NSOrderedAscending &&
+                [[NSFileManager defaultManager] removeItemAtURL:fileUrl error:nil]) {
+            continue;
+        }
+
+        totalSize += fileSize.unsignedLongLongValue;
+        [files addObject:@[fileUrl, modificationDate, fileSize]];
+    }
+
+    if (totalSize > self.sizeLimit) {
+        [files sortUsingComparator:^NSComparisonResult(NSArray *file1, NSArray *file2) {
+            return [(NSDate *) file1[1] compare:file2[1]];
+        }];
+
+        unsigned long long targetSize = self.sizeLimit / 2;
+        for (NSArray *file in files) {
+            if (totalSize <= targetSize) {
+                break;
+            }
+
+            // sorted oldest first, everything from here on is still protected
+            if (self.minimumAge > 0 && [(NSDate *) file[1] compare:protectionDate] == NSOrderedDescending) {
+                break;
+            }
+
+            if ([[NSFileManager defaultManager] removeItemAtURL:file[0] error:nil]) {
+                totalSize -= [file[2] unsignedLongLongValue];
+            }
+        }
+    }
+
+    _totalSize = totalSize;
+}
+
+@end
@@ -0,0 +1,99 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+@class BFTask;
+@class BFTaskCompletionSource;
+@class IMImojiCancellationToken;
+
+/**
+* An in flight download of an Imoji image shared by every caller requesting the same resolved URL. The image is
+* fetched and decoded once and handed to all attached callers. The download is only considered cancelled once every
+* attached caller has cancelled.
+*/
+@interface IMImojiImageDownload : NSObject
+
+@property(nonatomic, strong, readonly, nonnull) NSURL *url;
+
+/**
+* Completes with the decoded UIImage once the download finishes.
+*/
+@property(nonatomic, strong, readonly, nonnull) BFTaskCompletionSource *taskCompletionSource;
+
+/**
+* The longest side in pixels the downloaded image is decoded to, 0 for the source resolution. Set from the caller that
+* started the download, callers joining with a different size or aspect ratio decode data themselves.
+*/
+@property(nonatomic) CGFloat maximumPixelSize;
+
+/**
+* The aspect ratio the decoded image is padded to, CGSizeZero to keep the image's own.
+*/
+@property(nonatomic) CGSize aspectRatio;
+
+/**
+* Whether any attached caller needs the decoded image. Downloads only attached to by prefetches leave the contents
+* encoded and complete with a nil result.
+*/
+@property(nonatomic) BOOL decodesImage;
+
+/**
+* The encoded image contents, set once the download finishes successfully.
+*/
+@property(nonatomic, strong, nullable) NSData *data;
+
+/**
+* Whether or not all callers attached to the download have cancelled.
+*/
+@property(readonly, getter=isCancelled) BOOL cancelled;
+
+/**
+* Cancelled as soon as every attached caller has cancelled. Network, decoding and disk work for the download register
+* their cancellation handlers with it.
+*/
+@property(nonatomic, strong, readonly, nonnull) IMImojiCancellationToken *cancellationToken;
+
+/**
+* The highest queuePriority among the attached callers that haven't cancelled. Callers reprioritize a download by
+* changing the queuePriority of their cancellation token.
+*/
+@property(readonly) NSOperationQueuePriority queuePriority;
+
+/**
+* Increases every time a caller attaches, used to favor the most recently requested downloads.
+*/
+@property(readonly) uint64_t requestOrder;
+
+/**
+* Attaches a caller's cancellation token to the download. Returns NO if the download was already cancelled, in which
+* case the caller needs to start a new one.
+*/
+- (BOOL)addCancellationToken:(nonnull NSOperation *)cancellationToken;
+
++ (nonnull instancetype)downloadWithURL:(nonnull NSURL *)url;
+
+@end
@@ -0,0 +1,119 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Bolts/BFTaskCompletionSource.h>
+#import "IMImojiImageDownload.h"
+#import "IMImojiCancellationToken.h"
+
+static uint64_t IMImojiImageDownloadRequestCounter = 0;
+
+@implementation IMImojiImageDownload {
+    NSMutableArray *_cancellationTokens;
+}
+
+- (instancetype)initWithURL:(NSURL *)url {
+    self = [super init];
+    if (self) {
+        _url = url;
+        _taskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+        _cancellationTokens = [NSMutableArray new];
+        _cancellationToken = [IMImojiCancellationToken cancellationToken];
+    }
+
+    return self;
+}
+
+- (BOOL)addCancellationToken:(NSOperation *)cancellationToken {
+    @synchronized (self) {
+        if (_cancellationToken.isCancelled) {
+            return NO;
+        }
+
+        [_cancellationTokens addObject:cancellationToken];
+        @synchronized ([IMImojiImageDownload class]) {
+            _requestOrder = ++IMImojiImageDownloadRequestCounter;
+        }
+    }
+
+    __weak IMImojiImageDownload *weakSelf = self;
+    [IMImojiCancellationToken addCancellationHandler:^{
+        [weakSelf cancelIfAbandoned];
+    }                                    toOperation:cancellationToken];
+
+    return YES;
+}
+
+- (void)cancelIfAbandoned {
+    BOOL abandoned;
+    @synchronized (self) {
+        abandoned = [self allCancellationTokensCancelled];
+    }
+
+    // cancel outside of the lock, handlers reach into the scheduler and the URL session
+    if (abandoned) {
+        [_cancellationToken cancel];
+    }
+}
+
+- (BOOL)allCancellationTokensCancelled {
+    for (NSOperation *cancellationToken in _cancellationTokens) {
+        if (!cancellationToken.isCancelled) {
+            return NO;
+        }
+    }
+
+    return _cancellationTokens.count > 0;
+}
+
+- (uint64_t)requestOrder {
+    @synchronized (self) {
+        return _requestOrder;
+    }
+}
+
+- (NSOperationQueuePriority)queuePriority {
+    @synchronized (self) {
+        NSOperationQueuePriority queuePriority = NSOperationQueuePriorityVeryLow;
+        for (NSOperation *cancellationToken in _cancellationTokens) {
+            if (!cancellationToken.isCancelled && cancellationToken.queuePriority > queuePriority) {
+                queuePriority = cancellationToken.queuePriority;
+            }
+        }
+
+        return queuePriority;
+    }
+}
+
+- (BOOL)isCancelled {
+    @synchronized (self) {
+        return _cancellationToken.isCancelled || [self allCancellationTokensCancelled];
+    }
+}
+
++ (instancetype)downloadWithURL:(NSURL *)url {
+    return [[IMImojiImageDownload alloc] initWithURL:url];
+}
+
+@end
@@ -0,0 +1,371 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#include "IMImojiImageResampler.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// GCC and Clang vector extensions lower to SSE2 on x86 and NEON on ARM without any platform specific intrinsics.
+// Define IM_NO_VECTOR_EXTENSIONS to build the scalar fallback instead
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(IM_NO_VECTOR_EXTENSIONS)
+#define IM_RESAMPLER_VECTOR_EXTENSIONS 1
+typedef int32_t IMResamplerInt32x4 __attribute__((vector_size(16)));
+#endif
+
+#define IM_RESAMPLER_PRECISION 14
+#define IM_RESAMPLER_ONE (1 << IM_RESAMPLER_PRECISION)
+#define IM_RESAMPLER_HALF (1 << (IM_RESAMPLER_PRECISION - 1))
+#define IM_RESAMPLER_MAXIMUM_DIMENSION (INT_MAX / 16)
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+typedef struct {
+    int size;
+    int taps;
+    int *starts;
+    int *counts;
+    int32_t *weights;
+} IMResamplerKernel;
+
+// MARK: Accumulators
+
+#if IM_RESAMPLER_VECTOR_EXTENSIONS
+typedef IMResamplerInt32x4 IMResamplerAccumulator;
+
+static inline void IMResamplerAccumulatorReset(IMResamplerAccumulator *accumulator) {
+    IMResamplerInt32x4 half = {IM_RESAMPLER_HALF, IM_RESAMPLER_HALF, IM_RESAMPLER_HALF, IM_RESAMPLER_HALF};
+    *accumulator = half;
+}
+
+static inline void IMResamplerAccumulate(IMResamplerAccumulator *accumulator, const uint8_t *pixel, int32_t weight) {
+    IMResamplerInt32x4 value = {pixel[0], pixel[1], pixel[2], pixel[3]};
+    IMResamplerInt32x4 weights = {weight, weight, weight, weight};
+    *accumulator += value * weights;
+}
+
+static inline void IMResamplerAccumulatorGetLanes(const IMResamplerAccumulator *accumulator, int32_t lanes[4]) {
+    memcpy(lanes, accumulator, sizeof(int32_t) * 4);
+}
+#else
+typedef struct {
+    int32_t lanes[4];
+} IMResamplerAccumulator;
+
+static inline void IMResamplerAccumulatorReset(IMResamplerAccumulator *accumulator) {
+    for (int c = 0; c < 4; c++) {
+        accumulator->lanes[c] = IM_RESAMPLER_HALF;
+    }
+}
+
+static inline void IMResamplerAccumulate(IMResamplerAccumulator *accumulator, const uint8_t *pixel, int32_t weight) {
+    for (int c = 0; c < 4; c++) {
+        accumulator->lanes[c] += pixel[c] * weight;
+    }
+}
+
+static inline void IMResamplerAccumulatorGetLanes(const IMResamplerAccumulator *accumulator, int32_t lanes[4]) {
+    memcpy(lanes, accumulator->lanes, sizeof(int32_t) * 4);
+}
+#endif
+
+static inline void IMResamplerStorePixel(const IMResamplerAccumulator *accumulator, uint8_t *pixel, int premultiplied) {
+    int32_t lanes[4];
+    IMResamplerAccumulatorGetLanes(accumulator, lanes);
+
+    for (int c = 0; c < 4; c++) {
+        int32_t value = lanes[c] < 0 ? 0 : lanes[c] >> IM_RESAMPLER_PRECISION;
+        pixel[c] = (uint8_t) (value > 255 ? 255 : value);
+    }
+
+    // negative lobes can push a color past its alpha, which isn't a valid premultiplied pixel
+    if (premultiplied) {
+        for (int c = 0; c < 3; c++) {
+            if (pixel[c] > pixel[3]) {
+                pixel[c] = pixel[3];
+            }
+        }
+    }
+}
+
+// MARK: Filters
+
+static double IMResamplerFilterSupport(IMImojiImageResamplerFilter filter) {
+    switch (filter) {
+        case IMImojiImageResamplerFilterBox:
+            return 0.5;
+        case IMImojiImageResamplerFilterBilinear:
+            return 1.0;
+        case IMImojiImageResamplerFilterLanczos:
+            return 3.0;
+    }
+
+    return 1.0;
+}
+
+static double IMResamplerSinc(double x) {
+    if (x == 0.0) {
+        return 1.0;
+    }
+
+    x *= M_PI;
+    return sin(x) / x;
+}
+
+static double IMResamplerFilterWeight(IMImojiImageResamplerFilter filter, double x) {
+    switch (filter) {
+        case IMImojiImageResamplerFilterBox:
+            return x > -0.5 && x <= 0.5 ? 1.0 : 0.0;
+        case IMImojiImageResamplerFilterBilinear:
+            x = fabs(x);
+            return x < 1.0 ? 1.0 - x : 0.0;
+        case IMImojiImageResamplerFilterLanczos:
+            return x > -3.0 && x < 3.0 ? IMResamplerSinc(x) * IMResamplerSinc(x / 3.0) : 0.0;
+    }
+
+    return 0.0;
+}
+
+// MARK: Kernels
+
+static void IMResamplerKernelFree(IMResamplerKernel *kernel) {
+    free(kernel->starts);
+    free(kernel->counts);
+    free(kernel->weights);
+}
+
+static int IMResamplerKernelBuild(IMResamplerKernel *kernel, int inputSize, int outputSize, IMImojiImageResamplerFilter filter) {
+    double scale = (double) inputSize / outputSize;
+    // widen the filter when downscaling so it averages every input pixel instead of skipping some
+    double filterScale = scale < 1.0 ? 1.0 : scale;
+    double support = inputSize == outputSize ? 0.5 : IMResamplerFilterSupport(filter) * filterScale;
+
+    kernel->size = outputSize;
+    kernel->taps = (int) ceil(support) * 2 + 1;
+    kernel->starts = malloc(sizeof(int) * (size_t) outputSize);
+    kernel->counts = malloc(sizeof(int) * (size_t) outputSize);
+    kernel->weights = calloc((size_t) outputSize * kernel->taps, sizeof(int32_t));
+    double *weights = malloc(sizeof(double) * (size_t) kernel->taps);
+
+    if (!kernel->starts || !kernel->counts || !kernel->weights || !weights) {
+        free(weights);
+        IMResamplerKernelFree(kernel);
+        return 0;
+    }
+
+    for (int i = 0; i < outputSize; i++) {
+        double center = (i + 0.5) * scale;
+        int start = (int) floor(center - support + 0.5);
+        int end = (int) floor(center + support + 0.5);
+        start = start < 0 ? 0 : start;
+        end = end > inputSize ? inputSize : end;
+        if (end <= start) {
+            start = start >= inputSize ? inputSize - 1 : start;
+            end = start + 1;
+        }
+
+        int count = end - start;
+        double total = 0.0;
+        for (int j = 0; j < count; j++) {
+            weights[j] = inputSize == outputSize ?
+                    (start + j == i ? 1.0 : 0.0) :
+                    IMResamplerFilterWeight(filter, (start + j - center + 0.5) / filterScale);
+            total += weights[j];
+        }
+
+        if (total == 0.0) {
+            weights[count / 2] = total = 1.0;
+        }
+
+        // quantize so every row sums to exactly one, folding the rounding error into the largest tap
+        int32_t *fixedWeights = kernel->weights + (size_t) i * kernel->taps;
+        int32_t fixedTotal = 0;
+        int largest = 0;
+        for (int j = 0; j < count; j++) {
+            fixedWeights[j] = (int32_t) lround(weights[j] / total * IM_RESAMPLER_ONE);
+            fixedTotal += fixedWeights[j];
+            if (fixedWeights[j] > fixedWeights[largest]) {
+                largest = j;
+            }
+        }
+        fixedWeights[largest] += IM_RESAMPLER_ONE - fixedTotal;
+
+        kernel->starts[i] = start;
+        kernel->counts[i] = count;
+    }
+
+    free(weights);
+    return 1;
+}
+
+// MARK: Passes
+
+static void IMResamplerResampleRow(const uint8_t *source, uint8_t *output, const IMResamplerKernel *kernel) {
+    for (int x = 0; x < kernel->size; x++) {
+        const int32_t *weights = kernel->weights + (size_t) x * kernel->taps;
+        const uint8_t *pixel = source + (size_t) kernel->starts[x] * 4;
+        int count = kernel->counts[x];
+
+        IMResamplerAccumulator accumulator;
+        IMResamplerAccumulatorReset(&accumulator);
+        for (int t = 0; t < count; t++, pixel += 4) {
+            IMResamplerAccumulate(&accumulator, pixel, weights[t]);
+        }
+
+        IMResamplerStorePixel(&accumulator, output + (size_t) x * 4, 0);
+    }
+}
+
+// MARK: Public
+
+IMImojiImageResamplerStatus IMImojiImageResamplerResize(const uint8_t *source,
+                                                       size_t sourceWidth,
+                                                       size_t sourceHeight,
+                                                       size_t sourceBytesPerRow,
+                                                       uint8_t *destination,
+                                                       size_t destinationWidth,
+                                                       size_t destinationHeight,
+                                                       size_t destinationBytesPerRow,
+                                                       IMImojiImageResamplerFilter filter,
+                                                       IMImojiImageResamplerOrientation orientation) {
+    if (!source || !destination ||
+            sourceWidth == 0 || sourceHeight == 0 || destinationWidth == 0 || destinationHeight == 0 ||
+            sourceWidth > IM_RESAMPLER_MAXIMUM_DIMENSION || sourceHeight > IM_RESAMPLER_MAXIMUM_DIMENSION ||
+            destinationWidth > IM_RESAMPLER_MAXIMUM_DIMENSION || destinationHeight > IM_RESAMPLER_MAXIMUM_DIMENSION ||
+            sourceBytesPerRow < sourceWidth * 4 || destinationBytesPerRow < destinationWidth * 4 ||
+            filter < IMImojiImageResamplerFilterBox || filter > IMImojiImageResamplerFilterLanczos ||
+            orientation < IMImojiImageResamplerOrientationUp || orientation > IMImojiImageResamplerOrientationLeft) {
+        return IMImojiImageResamplerStatusInvalidArgument;
+    }
+
+    // resample in the source's own orientation, then write each pixel to its upright position
+    int transposed = orientation >= IMImojiImageResamplerOrientationLeftMirrored;
+    int width = (int) (transposed ? destinationHeight : destinationWidth);
+    int height = (int) (transposed ? destinationWidth : destinationHeight);
+
+    ptrdiff_t rowStride = (ptrdiff_t) destinationBytesPerRow;
+    ptrdiff_t lastColumn = (ptrdiff_t) (destinationWidth - 1) * 4;
+    ptrdiff_t lastRow = (ptrdiff_t) (destinationHeight - 1) * rowStride;
+    ptrdiff_t origin = 0, stepX = 4, stepY = rowStride;
+
+    switch (orientation) {
+        case IMImojiImageResamplerOrientationUp:
+            break;
+        case IMImojiImageResamplerOrientationUpMirrored:
+            origin = lastColumn, stepX = -4, stepY = rowStride;
+            break;
+        case IMImojiImageResamplerOrientationDown:
+            origin = lastColumn + lastRow, stepX = -4, stepY = -rowStride;
+            break;
+        case IMImojiImageResamplerOrientationDownMirrored:
+            origin = lastRow, stepX = 4, stepY = -rowStride;
+            break;
+        case IMImojiImageResamplerOrientationLeftMirrored:
+            origin = 0, stepX = rowStride, stepY = 4;
+            break;
+        case IMImojiImageResamplerOrientationRight:
+            origin = lastColumn, stepX = rowStride, stepY = -4;
+            break;
+        case IMImojiImageResamplerOrientationRightMirrored:
+            origin = lastColumn + lastRow, stepX = -rowStride, stepY = -4;
+            break;
+        case IMImojiImageResamplerOrientationLeft:
+            origin = lastRow, stepX = -rowStride, stepY = 4;
+            break;
+    }
+
+    IMResamplerKernel horizontal, vertical;
+    if (!IMResamplerKernelBuild(&horizontal, (int) sourceWidth, width, filter)) {
+        return IMImojiImageResamplerStatusOutOfMemory;
+    }
+
+    if (!IMResamplerKernelBuild(&vertical, (int) sourceHeight, height, filter)) {
+        IMResamplerKernelFree(&horizontal);
+        return IMImojiImageResamplerStatusOutOfMemory;
+    }
+
+    // only the source rows the vertical pass reads are resampled horizontally
+    int firstRow = vertical.starts[0];
+    int lastSourceRow = vertical.starts[height - 1] + vertical.counts[height - 1];
+    int resampleRows = (size_t) width != sourceWidth;
+    size_t intermediateBytesPerRow = resampleRows ? (size_t) width * 4 : sourceBytesPerRow;
+
+    uint8_t *intermediate = resampleRows ? malloc(intermediateBytesPerRow * (size_t) (lastSourceRow - firstRow)) : NULL;
+    IMResamplerAccumulator *accumulators = malloc(sizeof(IMResamplerAccumulator) * (size_t) width);
+
+    if ((resampleRows && !intermediate) || !accumulators) {
+        free(intermediate);
+        free(accumulators);
+        IMResamplerKernelFree(&horizontal);
+        IMResamplerKernelFree(&vertical);
+        return IMImojiImageResamplerStatusOutOfMemory;
+    }
+
+    const uint8_t *rows = source + (size_t) firstRow * sourceBytesPerRow;
+    if (resampleRows) {
+        for (int y = firstRow; y < lastSourceRow; y++) {
+            IMResamplerResampleRow(source + (size_t) y * sourceBytesPerRow,
+                                   intermediate + (size_t) (y - firstRow) * intermediateBytesPerRow,
+                                   &horizontal);
+        }
+
+        rows = intermediate;
+    }
+
+    // the vertical pass walks whole rows per tap, which keeps reads sequential
+    for (int y = 0; y < height; y++) {
+        const int32_t *weights = vertical.weights + (size_t) y * vertical.taps;
+        int start = vertical.starts[y] - firstRow;
+
+        for (int x = 0; x < width; x++) {
+            IMResamplerAccumulatorReset(&accumulators[x]);
+        }
+
+        for (int t = 0; t < vertical.counts[y]; t++) {
+            const uint8_t *pixel = rows + (size_t) (start + t) * intermediateBytesPerRow;
+            int32_t weight = weights[t];
+
+            for (int x = 0; x < width; x++, pixel += 4) {
+                IMResamplerAccumulate(&accumulators[x], pixel, weight);
+            }
+        }
+
+        uint8_t *output = destination + origin + stepY * y;
+        for (int x = 0; x < width; x++, output += stepX) {
+            IMResamplerStorePixel(&accumulators[x], output, 1);
+        }
+    }
+
+    free(intermediate);
+    free(accumulators);
+    IMResamplerKernelFree(&horizontal);
+    IMResamplerKernelFree(&vertical);
+
+    return IMImojiImageResamplerStatusSuccess;
+}
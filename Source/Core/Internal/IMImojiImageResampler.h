@@ -0,0 +1,90 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#ifndef IMImojiImageResampler_h
+#define IMImojiImageResampler_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Separable resampler for 8 bit premultiplied RGBA buffers, written in portable C so it can be built and benchmarked
+ * outside of Xcode. Both passes use fixed point weights, so the vectorized and scalar builds produce identical output.
+ */
+
+typedef enum {
+    IMImojiImageResamplerStatusSuccess = 0,
+    IMImojiImageResamplerStatusInvalidArgument,
+    IMImojiImageResamplerStatusOutOfMemory
+} IMImojiImageResamplerStatus;
+
+typedef enum {
+    /** Averages the source pixels covered by each destination pixel. Cheapest, and sharp for integer downscales. */
+    IMImojiImageResamplerFilterBox = 0,
+    /** Triangle filter, widened when downscaling so every source pixel contributes. */
+    IMImojiImageResamplerFilterBilinear,
+    /** Three lobe windowed sinc. Sharpest, at roughly three times the cost of bilinear. */
+    IMImojiImageResamplerFilterLanczos
+} IMImojiImageResamplerFilter;
+
+/**
+ * Orientation of the source pixels, numbered as in EXIF and named as in UIImageOrientation.
+ */
+typedef enum {
+    IMImojiImageResamplerOrientationUp = 1,
+    IMImojiImageResamplerOrientationUpMirrored = 2,
+    IMImojiImageResamplerOrientationDown = 3,
+    IMImojiImageResamplerOrientationDownMirrored = 4,
+    IMImojiImageResamplerOrientationLeftMirrored = 5,
+    IMImojiImageResamplerOrientationRight = 6,
+    IMImojiImageResamplerOrientationRightMirrored = 7,
+    IMImojiImageResamplerOrientationLeft = 8
+} IMImojiImageResamplerOrientation;
+
+/**
+ * Resamples source into destination and rotates or mirrors the result upright according to orientation.
+ * destinationWidth and destinationHeight are the upright dimensions, so they are the source's axes swapped for the
+ * Left and Right orientations. The buffers must not overlap.
+ */
+IMImojiImageResamplerStatus IMImojiImageResamplerResize(const uint8_t *source,
+                                                       size_t sourceWidth,
+                                                       size_t sourceHeight,
+                                                       size_t sourceBytesPerRow,
+                                                       uint8_t *destination,
+                                                       size_t destinationWidth,
+                                                       size_t destinationHeight,
+                                                       size_t destinationBytesPerRow,
+                                                       IMImojiImageResamplerFilter filter,
+                                                       IMImojiImageResamplerOrientation orientation);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IMImojiImageResampler_h */
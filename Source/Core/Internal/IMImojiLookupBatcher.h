@@ -0,0 +1,57 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+@class BFTask;
+
+/**
+* Fetches the identifiers of one batch. The returned task resolves to an NSArray of the imoji objects that were found.
+*/
+typedef BFTask *__nonnull (^IMImojiLookupBatchFetchBlock)(NSArray<NSString *> *__nonnull identifiers);
+
+/**
+* Coalesces single imoji lookups made within a short window into batched fetches. Lookups for an identifier that is
+* already pending or being fetched share the same task.
+*/
+@interface IMImojiLookupBatcher : NSObject
+
+@property(nonatomic, readonly) NSTimeInterval batchInterval;
+
+@property(nonatomic, readonly) NSUInteger maximumBatchSize;
+
+- (nonnull instancetype)initWithBatchInterval:(NSTimeInterval)batchInterval
+                             maximumBatchSize:(NSUInteger)maximumBatchSize
+                                   fetchBlock:(nonnull IMImojiLookupBatchFetchBlock)fetchBlock;
+
+/**
+* Resolves to the IMMutableImojiObject for identifier, or fails with IMImojiSessionErrorCodeImojiDoesNotExist when the
+* server doesn't return it. A batch is fetched once batchInterval has passed since its first lookup or as soon as it
+* holds maximumBatchSize identifiers. When the fetch of a batch fails, each of its identifiers is fetched once on its
+* own before its lookup fails.
+*/
+- (nonnull BFTask *)lookupIdentifier:(nonnull NSString *)identifier;
+
+@end
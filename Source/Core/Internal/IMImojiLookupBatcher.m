@@ -0,0 +1,155 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Bolts/Bolts.h>
+#import "IMImojiLookupBatcher.h"
+#import "IMImojiSession.h"
+#import "IMImojiObject.h"
+
+@implementation IMImojiLookupBatcher {
+    IMImojiLookupBatchFetchBlock _fetchBlock;
+    NSMutableDictionary *_lookups;
+    NSMutableArray *_pendingIdentifiers;
+    BOOL _flushScheduled;
+}
+
+- (instancetype)initWithBatchInterval:(NSTimeInterval)batchInterval
+                     maximumBatchSize:(NSUInteger)maximumBatchSize
+                           fetchBlock:(IMImojiLookupBatchFetchBlock)fetchBlock {
+    self = [super init];
+    if (self) {
+        _batchInterval = batchInterval;
+        _maximumBatchSize = MAX(maximumBatchSize, 1u);
+        _fetchBlock = [fetchBlock copy];
+        _lookups = [NSMutableDictionary new];
+        _pendingIdentifiers = [NSMutableArray new];
+    }
+
+    return self;
+}
+
+- (BFTask *)lookupIdentifier:(NSString *)identifier {
+    BFTaskCompletionSource *taskCompletionSource;
+    BOOL flushNow = NO;
+    BOOL scheduleFlush = NO;
+
+    @synchronized (self) {
+        taskCompletionSource = _lookups[identifier];
+        if (taskCompletionSource) {
+            return taskCompletionSource.task;
+        }
+
+        taskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+        _lookups[identifier] = taskCompletionSource;
+        [_pendingIdentifiers addObject:identifier];
+
+        if (_pendingIdentifiers.count >= _maximumBatchSize) {
+            flushNow = YES;
+        } else if (!_flushScheduled) {
+            _flushScheduled = YES;
+            scheduleFlush = YES;
+        }
+    }
+
+    if (flushNow) {
+        [self flush];
+    } else if (scheduleFlush) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t) (_batchInterval * NSEC_PER_SEC)),
+                dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                    [self flush];
+                });
+    }
+
+    return taskCompletionSource.task;
+}
+
+- (void)flush {
+    NSArray *identifiers;
+
+    @synchronized (self) {
+        identifiers = [_pendingIdentifiers copy];
+        [_pendingIdentifiers removeAllObjects];
+        _flushScheduled = NO;
+    }
+
+    if (identifiers.count == 0) {
+        return;
+    }
+
+    [_fetchBlock(identifiers) continueWithBlock:^id(BFTask *task) {
+        if (task.error && identifiers.count > 1) {
+            // one bad identifier shouldn't fail everyone waiting on the batch, fetch each identifier on its own once
+            for (NSString *identifier in identifiers) {
+                [self->_fetchBlock(@[identifier]) continueWithBlock:^id(BFTask *retryTask) {
+                    [self completeLookupsForIdentifiers:@[identifier] withTask:retryTask];
+                    return nil;
+                }];
+            }
+        } else {
+            [self completeLookupsForIdentifiers:identifiers withTask:task];
+        }
+
+        return nil;
+    }];
+}
+
+- (void)completeLookupsForIdentifiers:(NSArray *)identifiers withTask:(BFTask *)task {
+    NSMutableDictionary *fetchedImojis = [NSMutableDictionary dictionaryWithCapacity:identifiers.count];
+    if ([task.result isKindOfClass:[NSArray class]]) {
+        for (IMImojiObject *imoji in task.result) {
+            if (imoji.identifier) {
+                fetchedImojis[imoji.identifier] = imoji;
+            }
+        }
+    }
+
+    NSMutableArray *taskCompletionSources = [NSMutableArray arrayWithCapacity:identifiers.count];
+    @synchronized (self) {
+        for (NSString *identifier in identifiers) {
+            [taskCompletionSources addObject:_lookups[identifier]];
+            [_lookups removeObjectForKey:identifier];
+        }
+    }
+
+    [identifiers enumerateObjectsUsingBlock:^(NSString *identifier, NSUInteger idx, BOOL *stop) {
+        BFTaskCompletionSource *taskCompletionSource = taskCompletionSources[idx];
+
+        if (task.cancelled) {
+            [taskCompletionSource cancel];
+        } else if (task.error) {
+            taskCompletionSource.error = task.error;
+        } else if (fetchedImojis[identifier]) {
+            taskCompletionSource.result = fetchedImojis[identifier];
+        } else {
+            taskCompletionSource.error = [NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                             code:IMImojiSessionErrorCodeImojiDoesNotExist
+                                                         userInfo:@{
+                                                                 NSLocalizedDescriptionKey : [NSString stringWithFormat:@"Imoji %@ does not exist", identifier]
+                                                         }];
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,70 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+* In memory cache of decoded API responses keyed by endpoint and request parameters. Entries older than the time to
+* live are still returned but flagged as stale so callers can show them right away and refresh them in the background.
+* Entries past the maximum age are dropped.
+*/
+@interface IMImojiResultCache : NSObject
+
+@property(nonatomic, readonly) NSTimeInterval maximumAge;
+
+- (nonnull instancetype)initWithCountLimit:(NSUInteger)countLimit maximumAge:(NSTimeInterval)maximumAge;
+
+/**
+* Builds a cache key from the request path and parameters. Parameter order and null values don't affect the key, nor do
+* surrounding whitespace and letter case of the search phrase. Other values are used as is, they can be case sensitive.
+* The user's locale is included since responses are localized.
+*/
++ (nonnull NSString *)keyForPath:(nonnull NSString *)path parameters:(nonnull NSDictionary *)parameters;
+
+/**
+* Returns the cached object for key, or nil if there is none or it's past the maximum age. stale is set to YES when the
+* entry is older than timeToLive.
+*/
+- (nullable id)objectForKey:(nonnull NSString *)key
+                 timeToLive:(NSTimeInterval)timeToLive
+                      stale:(nullable BOOL *)stale;
+
+/**
+* Stores object for key. Dictionaries and arrays are stored as immutable copies, including the ones nested in them, so
+* callers can neither change a cached response nor see later changes to the object they stored.
+*/
+- (void)setObject:(nonnull id)object forKey:(nonnull NSString *)key;
+
+/**
+* Marks a background refresh for key as started. Returns NO if one is already running, in which case the caller should
+* not start another.
+*/
+- (BOOL)beginRefreshForKey:(nonnull NSString *)key;
+
+- (void)endRefreshForKey:(nonnull NSString *)key;
+
+- (void)removeAllObjects;
+
+@end
@@ -0,0 +1,156 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import "IMImojiResultCache.h"
+
+// the parameter carrying the user's search phrase, the only value whose case and whitespace don't matter to the server
+static NSString *const IMImojiResultCacheSearchPhraseParameter = @"query";
+
+@interface IMImojiResultCacheEntry : NSObject
+
+@property(nonatomic, strong) id object;
+@property(nonatomic) CFAbsoluteTime storedTime;
+
+@end
+
+@implementation IMImojiResultCacheEntry
+@end
+
+@implementation IMImojiResultCache {
+    NSCache *_entries;
+    NSMutableSet *_refreshingKeys;
+}
+
+- (instancetype)initWithCountLimit:(NSUInteger)countLimit maximumAge:(NSTimeInterval)maximumAge {
+    self = [super init];
+    if (self) {
+        _maximumAge = maximumAge;
+        _entries = [NSCache new];
+        _entries.countLimit = countLimit;
+        _refreshingKeys = [NSMutableSet new];
+    }
+
+    return self;
+}
+
++ (NSString *)keyForPath:(NSString *)path parameters:(NSDictionary *)parameters {
+    NSMutableString *key = [NSMutableString stringWithString:path];
+    [key appendFormat:@"|%@", [[NSLocale currentLocale] localeIdentifier]];
+
+    for (NSString *name in [parameters.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+        id value = parameters[name];
+        if ([value isEqual:[NSNull null]]) {
+            continue;
+        }
+
+        if ([value isKindOfClass:[NSArray class]]) {
+            value = [[value valueForKey:@"description"] componentsJoinedByString:@","];
+        }
+
+        NSString *normalizedValue = [value description];
+        if ([name isEqualToString:IMImojiResultCacheSearchPhraseParameter]) {
+            normalizedValue = [[normalizedValue stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]] lowercaseString];
+        }
+
+        [key appendFormat:@"|%@=%@", name, normalizedValue];
+    }
+
+    return key;
+}
+
+- (id)objectForKey:(NSString *)key timeToLive:(NSTimeInterval)timeToLive stale:(BOOL *)stale {
+    IMImojiResultCacheEntry *entry = [_entries objectForKey:key];
+    if (!entry) {
+        return nil;
+    }
+
+    NSTimeInterval age = CFAbsoluteTimeGetCurrent() - entry.storedTime;
+    if (age > MAX(timeToLive, self.maximumAge)) {
+        [_entries removeObjectForKey:key];
+        return nil;
+    }
+
+    if (stale) {
+        *stale = age > timeToLive;
+    }
+
+    return entry.object;
+}
+
+- (void)setObject:(id)object forKey:(NSString *)key {
+    IMImojiResultCacheEntry *entry = [IMImojiResultCacheEntry new];
+    entry.object = [IMImojiResultCache immutableCopyOfObject:object];
+    entry.storedTime = CFAbsoluteTimeGetCurrent();
+
+    [_entries setObject:entry forKey:key];
+}
+
++ (id)immutableCopyOfObject:(id)object {
+    if ([object isKindOfClass:[NSDictionary class]]) {
+        NSDictionary *dictionary = object;
+        NSMutableDictionary *copy = [NSMutableDictionary dictionaryWithCapacity:dictionary.count];
+        [dictionary enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+            copy[key] = [IMImojiResultCache immutableCopyOfObject:value];
+        }];
+
+        return [copy copy];
+    }
+
+    if ([object isKindOfClass:[NSArray class]]) {
+        NSArray *array = object;
+        NSMutableArray *copy = [NSMutableArray arrayWithCapacity:array.count];
+        for (id value in array) {
+            [copy addObject:[IMImojiResultCache immutableCopyOfObject:value]];
+        }
+
+        return [copy copy];
+    }
+
+    // strings and numbers from responses, imoji and category objects are stored as they are
+    return [object isKindOfClass:[NSString class]] ? [object copy] : object;
+}
+
+- (BOOL)beginRefreshForKey:(NSString *)key {
+    @synchronized (_refreshingKeys) {
+        if ([_refreshingKeys containsObject:key]) {
+            return NO;
+        }
+
+        [_refreshingKeys addObject:key];
+        return YES;
+    }
+}
+
+- (void)endRefreshForKey:(NSString *)key {
+    @synchronized (_refreshingKeys) {
+        [_refreshingKeys removeObject:key];
+    }
+}
+
+- (void)removeAllObjects {
+    [_entries removeAllObjects];
+}
+
+@end
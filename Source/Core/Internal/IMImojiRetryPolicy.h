@@ -0,0 +1,105 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+@class BFTask;
+
+/**
+* Starts a single attempt of a request, applying timeoutInterval to it.
+*/
+typedef BFTask *__nonnull (^IMImojiRetryPolicyRequestBlock)(NSTimeInterval timeoutInterval);
+
+/**
+* Runs a single attempt, e.g. once a transfer slot is available, and returns its task. Backoff delays between attempts
+* are spent outside of it.
+*/
+typedef BFTask *__nonnull (^IMImojiRetryPolicyAttemptScheduler)(BFTask *__nonnull (^__nonnull attempt)(void));
+
+/**
+* Retry policy shared by the requests of a session. Failed attempts are retried after an exponential backoff with full
+* jitter, timeouts follow the round trip times measured for each host and a per host circuit breaker fails requests
+* fast once a host keeps failing, letting a single trial request through after circuitOpenInterval.
+*/
+@interface IMImojiRetryPolicy : NSObject
+
+@property(nonatomic, readonly) NSTimeInterval initialBackoffInterval;
+
+@property(nonatomic, readonly) NSTimeInterval maximumBackoffInterval;
+
+@property(nonatomic, readonly) NSUInteger failureThreshold;
+
+@property(nonatomic, readonly) NSTimeInterval circuitOpenInterval;
+
+- (nonnull instancetype)initWithInitialBackoffInterval:(NSTimeInterval)initialBackoffInterval
+                                maximumBackoffInterval:(NSTimeInterval)maximumBackoffInterval
+                                      failureThreshold:(NSUInteger)failureThreshold
+                                   circuitOpenInterval:(NSTimeInterval)circuitOpenInterval;
+
+/**
+* Runs requestBlock until it succeeds, fails with an error that isn't worth retrying or maximumRetries retries have
+* been made. Fails immediately with IMImojiSessionErrorCodeServerError while the circuit for the host of url is open.
+* Errors caused by the device being offline don't count against the host.
+*/
+- (nonnull BFTask *)runRequestWithURL:(nonnull NSURL *)url
+                       maximumRetries:(NSUInteger)maximumRetries
+               minimumTimeoutInterval:(NSTimeInterval)minimumTimeoutInterval
+                    cancellationToken:(nullable NSOperation *)cancellationToken
+                         requestBlock:(nonnull IMImojiRetryPolicyRequestBlock)requestBlock;
+
+/**
+* Same as above, with every attempt started through attemptScheduler. Round trip times are measured from when the
+* scheduler starts the attempt, so time spent waiting for it isn't mistaken for a slow host.
+*/
+- (nonnull BFTask *)runRequestWithURL:(nonnull NSURL *)url
+                       maximumRetries:(NSUInteger)maximumRetries
+               minimumTimeoutInterval:(NSTimeInterval)minimumTimeoutInterval
+                    cancellationToken:(nullable NSOperation *)cancellationToken
+                     attemptScheduler:(nullable IMImojiRetryPolicyAttemptScheduler)attemptScheduler
+                         requestBlock:(nonnull IMImojiRetryPolicyRequestBlock)requestBlock;
+
+/**
+* Whether error means the device itself has no usable connection, rather than the host failing.
+*/
++ (BOOL)isConnectivityError:(nonnull NSError *)error;
+
+/**
+* Whether error is transient and worth another attempt: a timeout, a lost or refused connection, a failed DNS lookup,
+* no connection at all, or a server error, request timeout or rate limit status code. Anything else is not retried.
+*/
++ (BOOL)isRetryableError:(nonnull NSError *)error;
+
+/**
+* Random delay before the given retry, between zero and the exponential backoff for it.
+*/
+- (NSTimeInterval)backoffIntervalForRetry:(NSUInteger)retry;
+
+/**
+* Timeout derived from the smoothed round trip time and its variation measured for host, never below
+* minimumTimeoutInterval.
+*/
+- (NSTimeInterval)timeoutIntervalForHost:(nonnull NSString *)host minimumTimeoutInterval:(NSTimeInterval)minimumTimeoutInterval;
+
+@end
@@ -0,0 +1,311 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Bolts/Bolts.h>
+#import "IMImojiRetryPolicy.h"
+#import "IMImojiSession.h"
+
+NSTimeInterval const IMImojiRetryPolicyDefaultTimeoutInterval = 15.0;
+NSTimeInterval const IMImojiRetryPolicyMaximumTimeoutInterval = 60.0;
+
+@interface IMImojiHostHealth : NSObject
+
+@property(nonatomic) BOOL hasRoundTripTime;
+@property(nonatomic) NSTimeInterval smoothedRoundTripTime;
+@property(nonatomic) NSTimeInterval roundTripTimeVariation;
+@property(nonatomic) NSUInteger consecutiveFailures;
+@property(nonatomic) CFAbsoluteTime openUntil;
+@property(nonatomic) BOOL trialInFlight;
+
+@end
+
+@implementation IMImojiHostHealth
+@end
+
+@implementation IMImojiRetryPolicy {
+    NSMutableDictionary *_hosts;
+}
+
+- (instancetype)initWithInitialBackoffInterval:(NSTimeInterval)initialBackoffInterval
+                        maximumBackoffInterval:(NSTimeInterval)maximumBackoffInterval
+                              failureThreshold:(NSUInteger)failureThreshold
+                           circuitOpenInterval:(NSTimeInterval)circuitOpenInterval {
+    self = [super init];
+    if (self) {
+        _initialBackoffInterval = initialBackoffInterval;
+        _maximumBackoffInterval = maximumBackoffInterval;
+        _failureThreshold = MAX(failureThreshold, 1u);
+        _circuitOpenInterval = circuitOpenInterval;
+        _hosts = [NSMutableDictionary new];
+    }
+
+    return self;
+}
+
+#pragma mark Requests
+
+- (BFTask *)runRequestWithURL:(NSURL *)url
+               maximumRetries:(NSUInteger)maximumRetries
+       minimumTimeoutInterval:(NSTimeInterval)minimumTimeoutInterval
+            cancellationToken:(NSOperation *)cancellationToken
+                 requestBlock:(IMImojiRetryPolicyRequestBlock)requestBlock {
+    return [self runRequestWithURL:url
+                    maximumRetries:maximumRetries
+            minimumTimeoutInterval:minimumTimeoutInterval
+                 cancellationToken:cancellationToken
+                  attemptScheduler:nil
+                      requestBlock:requestBlock];
+}
+
+- (BFTask *)runRequestWithURL:(NSURL *)url
+               maximumRetries:(NSUInteger)maximumRetries
+       minimumTimeoutInterval:(NSTimeInterval)minimumTimeoutInterval
+            cancellationToken:(NSOperation *)cancellationToken
+             attemptScheduler:(IMImojiRetryPolicyAttemptScheduler)attemptScheduler
+                 requestBlock:(IMImojiRetryPolicyRequestBlock)requestBlock {
+    return [self runRequestToHost:url.host ?: @""
+                          attempt:0
+                   maximumRetries:maximumRetries
+           minimumTimeoutInterval:minimumTimeoutInterval
+                cancellationToken:cancellationToken
+                 attemptScheduler:attemptScheduler
+                     requestBlock:requestBlock];
+}
+
+- (BFTask *)runRequestToHost:(NSString *)host
+                     attempt:(NSUInteger)attempt
+              maximumRetries:(NSUInteger)maximumRetries
+      minimumTimeoutInterval:(NSTimeInterval)minimumTimeoutInterval
+           cancellationToken:(NSOperation *)cancellationToken
+            attemptScheduler:(IMImojiRetryPolicyAttemptScheduler)attemptScheduler
+                requestBlock:(IMImojiRetryPolicyRequestBlock)requestBlock {
+    if (cancellationToken.isCancelled) {
+        return [BFTask cancelledTask];
+    }
+
+    __block BOOL retryable = NO;
+    BFTask *(^runAttempt)(void) = ^BFTask * {
+        if (cancellationToken.isCancelled) {
+            return [BFTask cancelledTask];
+        }
+
+        if (![self beginRequestToHost:host]) {
+            return [BFTask taskWithError:[NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                             code:IMImojiSessionErrorCodeServerError
+                                                         userInfo:@{
+                                                                 NSLocalizedDescriptionKey : [NSString stringWithFormat:@"%@ is temporarily unavailable", host]
+                                                         }]];
+        }
+
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+        NSTimeInterval timeoutInterval = [self timeoutIntervalForHost:host minimumTimeoutInterval:minimumTimeoutInterval];
+
+        return [requestBlock(timeoutInterval) continueWithBlock:^id(BFTask *task) {
+            if (task.cancelled || cancellationToken.isCancelled) {
+                [self cancelRequestToHost:host];
+                return [BFTask cancelledTask];
+            }
+
+            if (!task.error) {
+                [self recordResponseFromHost:host roundTripTime:CFAbsoluteTimeGetCurrent() - startTime];
+            } else if ([IMImojiRetryPolicy isConnectivityError:task.error]) {
+                // says nothing about the host, the backoff gives the device a chance to get back online
+                [self cancelRequestToHost:host];
+                retryable = [IMImojiRetryPolicy isRetryableError:task.error];
+            } else if (![IMImojiRetryPolicy isRetryableError:task.error]) {
+                // the host answered, it is healthy even though the request itself was rejected
+                [self recordResponseFromHost:host roundTripTime:-1];
+            } else {
+                [self recordFailureForHost:host timedOut:[task.error.domain isEqualToString:NSURLErrorDomain] && task.error.code == NSURLErrorTimedOut];
+                retryable = YES;
+            }
+
+            return task;
+        }];
+    };
+
+    BFTask *attemptTask = attemptScheduler ? attemptScheduler(runAttempt) : runAttempt();
+
+    return [attemptTask continueWithBlock:^id(BFTask *task) {
+        if (task.cancelled || cancellationToken.isCancelled) {
+            return [BFTask cancelledTask];
+        }
+
+        if (!retryable || attempt >= maximumRetries) {
+            return task;
+        }
+
+        // the backoff is spent outside of the attempt, so a scheduled attempt gives its slot up while it waits
+        int delayInMilliseconds = (int) ([self backoffIntervalForRetry:attempt] * 1000);
+        return [[BFTask taskWithDelay:delayInMilliseconds] continueWithBlock:^id(BFTask *delayTask) {
+            return [self runRequestToHost:host
+                                  attempt:attempt + 1
+                           maximumRetries:maximumRetries
+                   minimumTimeoutInterval:minimumTimeoutInterval
+                        cancellationToken:cancellationToken
+                         attemptScheduler:attemptScheduler
+                             requestBlock:requestBlock];
+        }];
+    }];
+}
+
++ (BOOL)isConnectivityError:(NSError *)error {
+    if (![error.domain isEqualToString:NSURLErrorDomain]) {
+        return NO;
+    }
+
+    switch (error.code) {
+        case NSURLErrorNotConnectedToInternet:
+        case NSURLErrorNetworkConnectionLost:
+        case NSURLErrorDataNotAllowed:
+        case NSURLErrorInternationalRoamingOff:
+        case NSURLErrorCallIsActive:
+            return YES;
+        default:
+            return NO;
+    }
+}
+
++ (BOOL)isRetryableError:(NSError *)error {
+    if ([error.domain isEqualToString:NSURLErrorDomain]) {
+        switch (error.code) {
+            case NSURLErrorTimedOut:
+            case NSURLErrorNetworkConnectionLost:
+            case NSURLErrorCannotConnectToHost:
+            case NSURLErrorCannotFindHost:
+            case NSURLErrorDNSLookupFailed:
+            case NSURLErrorNotConnectedToInternet:
+                return YES;
+            default:
+                return NO;
+        }
+    }
+
+    // client errors won't go away by asking again, apart from timeouts and rate limiting
+    NSNumber *statusCode = error.userInfo[@"statusCode"];
+    if ([statusCode isKindOfClass:[NSNumber class]]) {
+        NSInteger code = statusCode.integerValue;
+        return code >= 500 || code == 408 || code == 429;
+    }
+
+    return NO;
+}
+
+#pragma mark Backoff and Timeouts
+
+- (NSTimeInterval)backoffIntervalForRetry:(NSUInteger)retry {
+    NSTimeInterval backoffInterval = MIN(_initialBackoffInterval * pow(2.0, MIN(retry, 31u)), _maximumBackoffInterval);
+    return backoffInterval * (arc4random_uniform(1001) / 1000.0);
+}
+
+- (NSTimeInterval)timeoutIntervalForHost:(NSString *)host minimumTimeoutInterval:(NSTimeInterval)minimumTimeoutInterval {
+    NSTimeInterval timeoutInterval = IMImojiRetryPolicyDefaultTimeoutInterval;
+
+    @synchronized (self) {
+        IMImojiHostHealth *health = _hosts[host];
+        if (health.hasRoundTripTime) {
+            // same estimate TCP uses for its retransmission timeout
+            timeoutInterval = health.smoothedRoundTripTime + 4 * health.roundTripTimeVariation;
+        }
+    }
+
+    return MIN(MAX(timeoutInterval, minimumTimeoutInterval), IMImojiRetryPolicyMaximumTimeoutInterval);
+}
+
+#pragma mark Circuit Breaker
+
+- (IMImojiHostHealth *)healthForHost:(NSString *)host {
+    IMImojiHostHealth *health = _hosts[host];
+    if (!health) {
+        health = [IMImojiHostHealth new];
+        _hosts[host] = health;
+    }
+
+    return health;
+}
+
+- (BOOL)beginRequestToHost:(NSString *)host {
+    @synchronized (self) {
+        IMImojiHostHealth *health = [self healthForHost:host];
+        if (health.openUntil == 0) {
+            return YES;
+        }
+
+        // once the circuit has been open long enough a single trial request decides whether it closes again
+        if (CFAbsoluteTimeGetCurrent() < health.openUntil || health.trialInFlight) {
+            return NO;
+        }
+
+        health.trialInFlight = YES;
+        return YES;
+    }
+}
+
+- (void)cancelRequestToHost:(NSString *)host {
+    @synchronized (self) {
+        [self healthForHost:host].trialInFlight = NO;
+    }
+}
+
+- (void)recordResponseFromHost:(NSString *)host roundTripTime:(NSTimeInterval)roundTripTime {
+    @synchronized (self) {
+        IMImojiHostHealth *health = [self healthForHost:host];
+        health.consecutiveFailures = 0;
+        health.openUntil = 0;
+        health.trialInFlight = NO;
+
+        if (roundTripTime < 0) {
+            return;
+        }
+
+        if (!health.hasRoundTripTime) {
+            health.hasRoundTripTime = YES;
+            health.smoothedRoundTripTime = roundTripTime;
+            health.roundTripTimeVariation = roundTripTime / 2;
+        } else {
+            health.roundTripTimeVariation = 0.75 * health.roundTripTimeVariation + 0.25 * fabs(health.smoothedRoundTripTime - roundTripTime);
+            health.smoothedRoundTripTime = 0.875 * health.smoothedRoundTripTime + 0.125 * roundTripTime;
+        }
+    }
+}
+
+- (void)recordFailureForHost:(NSString *)host timedOut:(BOOL)timedOut {
+    @synchronized (self) {
+        IMImojiHostHealth *health = [self healthForHost:host];
+        health.consecutiveFailures++;
+
+        // back the timeout off as well so a slow host gets more time on the next attempt
+        if (timedOut && health.hasRoundTripTime) {
+            health.smoothedRoundTripTime = MIN(health.smoothedRoundTripTime * 2, IMImojiRetryPolicyMaximumTimeoutInterval);
+        }
+
+        if (health.trialInFlight || health.consecutiveFailures >= _failureThreshold) {
+            health.openUntil = CFAbsoluteTimeGetCurrent() + _circuitOpenInterval;
+            health.trialInFlight = NO;
+        }
+    }
+}
+
+@end
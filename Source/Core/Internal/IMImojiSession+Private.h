@@ -6,6 +6,7 @@
 #import <Foundation/Foundation.h>
 #import "IMImojiSession.h"
 #import "IMImojiObject.h"
+#import "IMImojiStreamingJSONDecoder.h"
 
 @class IMImojiSessionCredentials;
 @class IMMutableImojiObject;
@@ -37,12 +38,44 @@
 
 - (nonnull BFTask *)runValidatedGetTaskWithPath:(nonnull NSString *)path andParameters:(nonnull NSDictionary *)parameters;
 
+- (nonnull BFTask *)runValidatedGetTaskWithPath:(nonnull NSString *)path
+                                     parameters:(nonnull NSDictionary *)parameters
+                              cancellationToken:(nullable NSOperation *)cancellationToken;
+
 - (nonnull BFTask *)runValidatedPutTaskWithPath:(nonnull NSString *)path andParameters:(nonnull NSDictionary *)parameters;
 
 - (nonnull BFTask *)runValidatedPostTaskWithPath:(nonnull NSString *)path andParameters:(nonnull NSDictionary *)parameters;
 
+- (nonnull BFTask *)runValidatedPostTaskWithPath:(nonnull NSString *)path
+                                      parameters:(nonnull NSDictionary *)parameters
+                               cancellationToken:(nullable NSOperation *)cancellationToken;
+
 - (nonnull BFTask *)runValidatedDeleteTaskWithPath:(nonnull NSString *)path andParameters:(nonnull NSDictionary *)parameters;
 
+- (nonnull BFTask *)runValidatedStreamingGetTaskWithPath:(nonnull NSString *)path
+                                              parameters:(nonnull NSDictionary *)parameters
+                                        streamedArrayKey:(nonnull NSString *)streamedArrayKey
+                                           recordHandler:(nonnull IMImojiStreamingJSONDecoderRecordHandler)recordHandler
+                                       cancellationToken:(nullable NSOperation *)cancellationToken;
+
+/**
+ * Runs a GET request with If-None-Match and If-Modified-Since set from the given validators. The task completes with an
+ * IMImojiConditionalResponse.
+ */
+- (nonnull BFTask *)runValidatedConditionalGetTaskWithPath:(nonnull NSString *)path
+                                                parameters:(nonnull NSDictionary *)parameters
+                                                 entityTag:(nullable NSString *)entityTag
+                                              lastModified:(nullable NSString *)lastModified
+                                         cancellationToken:(nullable NSOperation *)cancellationToken;
+
+/**
+ * Runs one GET request per parameter set, in order, on urlSession with a single session validation. The task resolves
+ * to an NSNumber with the count of requests that succeeded before the first failure.
+ */
+- (nonnull BFTask *)runValidatedGetTasksWithPath:(nonnull NSString *)path
+                                   parameterSets:(nonnull NSArray<NSDictionary *> *)parameterSets
+                                      URLSession:(nonnull NSURLSession *)urlSession;
+
 - (nonnull BFTask *)validateSession;
 
 #pragma mark Network Responses
@@ -58,20 +91,68 @@
           searchResponseCallback:(nullable IMImojiSessionResultSetResponseCallback)searchResponseCallback
            imojiResponseCallback:(nullable IMImojiSessionImojiFetchedResponseCallback)imojiResponseCallback;
 
+- (void)handleImojiResultSetTask:(nonnull BFTask *)getTask
+                    imojiObjects:(nullable NSArray *)imojiObjects
+               cancellationToken:(nonnull NSOperation *)cancellationToken
+       resultSetResponseCallback:(nullable IMImojiSessionResultSetResponseCallback)resultSetResponseCallback
+           imojiResponseCallback:(nullable IMImojiSessionImojiFetchedResponseCallback)imojiResponseCallback
+           batchResponseCallback:(nullable IMImojiSessionImojiBatchResponseCallback)batchResponseCallback;
+
+- (void)fetchImojiResultSetWithPath:(nonnull NSString *)path
+                         parameters:(nonnull NSDictionary *)parameters
+                  cancellationToken:(nonnull NSOperation *)cancellationToken
+          resultSetResponseCallback:(nullable IMImojiSessionResultSetResponseCallback)resultSetResponseCallback
+              imojiResponseCallback:(nullable IMImojiSessionImojiFetchedResponseCallback)imojiResponseCallback
+              batchResponseCallback:(nullable IMImojiSessionImojiBatchResponseCallback)batchResponseCallback;
+
 - (nonnull BFTask *)downloadImojiImageAsync:(nonnull IMMutableImojiObject *)imoji
                            renderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions
                                  imojiIndex:(NSUInteger)imojiIndex
                           cancellationToken:(nonnull NSOperation *)cancellationToken;
 
+/**
+* Downloads the encoded image without decoding it, leaving it in the session's encoded image cache and the image disk
+* cache. Completes with the encoded data, or nil for imojis whose images are local files.
+*/
+- (nonnull BFTask *)downloadImojiImageDataAsync:(nonnull IMMutableImojiObject *)imoji
+                               renderingOptions:(nonnull IMImojiObjectRenderingOptions *)renderingOptions
+                              cancellationToken:(nonnull NSOperation *)cancellationToken;
+
 - (nonnull IMMutableImojiObject *)readImojiObject:(nonnull NSDictionary *)result;
 
+/**
+ * Reads an imoji from a search, featured or fetch result and adds it to the metadata cache used for lookups by
+ * identifier. Only records carrying an imojiId are cached.
+ */
+- (nonnull IMMutableImojiObject *)readImojiRecord:(nonnull NSDictionary *)record;
+
 - (nonnull IMCategoryAttribution *)readAttribution:(nonnull NSDictionary *)attributionDictionary;
 
 - (nonnull NSArray<IMImojiCategoryObject *> *)readCategories:(nonnull NSArray *)categories;
 
+/**
+ * Reads the response of /imoji/create: the identifier of the new imoji in imojiId and the URL its full resolution
+ * unbordered image is PUT to in fullImageUrl. Returns nil when either field is missing, creation is not completed then.
+ */
+- (nullable NSURL *)readUploadUrlFromCreateResponse:(nonnull NSDictionary *)response
+                                            imojiId:(NSString *__nullable *__nonnull)imojiId;
+
+/**
+ * Encodes image as a PNG file once and uploads it with uploadImageFileInBackgroundWithRetries:.
+ */
 - (nonnull BFTask *)uploadImageInBackgroundWithRetries:(nonnull UIImage *)image
                                              uploadUrl:(nonnull NSURL *)uploadUrl
-                                            retryCount:(int)retryCount;
+                                            retryCount:(int)retryCount
+                                     cancellationToken:(nullable NSOperation *)cancellationToken;
+
+/**
+ * Uploads an already encoded PNG or WebP file, streaming it from disk. Failed attempts send the whole file again,
+ * cancelling the token aborts the transfer in flight and any pending retries.
+ */
+- (nonnull BFTask *)uploadImageFileInBackgroundWithRetries:(nonnull NSURL *)fileURL
+                                                 uploadUrl:(nonnull NSURL *)uploadUrl
+                                                retryCount:(int)retryCount
+                                         cancellationToken:(nullable NSOperation *)cancellationToken;
 
 #pragma mark Session State Management
 
@@ -79,6 +160,10 @@
 
 #pragma mark Imoji Creation
 
+/**
+ * Resizes, encodes and writes the thumbnail and full resolution variants of a new imoji in parallel. Resolves to a
+ * temporary IMMutableImojiObject backed by the written files.
+ */
 - (nonnull BFTask *)createLocalImojiWithRawImage:(nonnull UIImage *)rawImage
                                    borderedImage:(nonnull UIImage *)borderedImage
                                             tags:(nonnull NSArray *)tags;
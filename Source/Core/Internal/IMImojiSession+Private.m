@@ -18,6 +18,17 @@
 #import "IMMutableCategoryAttribution.h"
 #import "IMMutableArtist.h"
 #import "IMMutableCategoryObject.h"
+#import "IMImojiImageCache.h"
+#import "IMImojiImageDiskCache.h"
+#import "IMImojiImageDownload.h"
+#import "IMImojiVariantTable.h"
+#import "IMImojiStreamingURLSessionDelegate.h"
+#import "IMImojiDownloadScheduler.h"
+#import "IMImojiCancellationToken.h"
+#import "IMImojiImageDecoder.h"
+#import "IMImojiResultCache.h"
+#import "IMImojiConditionalResponse.h"
+#import "IMImojiRetryPolicy.h"
 
 NSString *const IMImojiSessionFileAccessTokenKey = @"at";
 NSString *const IMImojiSessionFileRefreshTokenKey = @"rt";
@@ -25,6 +36,10 @@ NSString *const IMImojiSessionFileExpirationKey = @"ex";
 NSString *const IMImojiSessionFileUserSynchronizedKey = @"sy";
 NSString *const IMImojiSessionFileClientIdKey = @"ci";
 NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
+NSTimeInterval const IMImojiSessionMinimumImojiDownloadTimeout = 5.0;
+NSTimeInterval const IMImojiSessionMinimumImageUploadTimeout = 15.0;
+NSString *const IMImojiSessionCachedResponseKey = @"response";
+NSString *const IMImojiSessionCachedImojisKey = @"imojis";
 
 @implementation IMImojiSession (Private)
 
@@ -92,8 +107,7 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
 #pragma mark Utilities
 
 - (NSOperation *)cancellationTokenOperation {
-    return [NSBlockOperation blockOperationWithBlock:^{
-    }];
+    return [IMImojiCancellationToken cancellationToken];
 }
 
 - (BFTask *)runPostTaskWithPath:(NSString *)path
@@ -101,15 +115,27 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                   andParameters:(NSDictionary *)parameters {
     return [self runImojiURLRequest:[NSMutableURLRequest POSTRequestWithURL:[NSURL URLWithString:[NSString stringWithFormat:@"%@%@", ImojiSDKServerURL, path]]
                                                                  parameters:parameters]
-                            headers:headers];
+                            headers:headers
+                  cancellationToken:nil];
 }
 
 - (BFTask *)runValidatedGetTaskWithPath:(NSString *)path
                           andParameters:(NSDictionary *)parameters {
+    return [self runValidatedGetTaskWithPath:path parameters:parameters cancellationToken:nil];
+}
+
+- (BFTask *)runValidatedGetTaskWithPath:(NSString *)path
+                             parameters:(NSDictionary *)parameters
+                      cancellationToken:(NSOperation *)cancellationToken {
     return [self runValidatedImojiURLRequest:[NSURL URLWithString:[NSString stringWithFormat:@"%@%@", ImojiSDKServerURL, path]]
                                   parameters:parameters
                                       method:@"GET"
-                                     headers:@{}];
+                                     headers:@{}
+                            streamedArrayKey:nil
+                               recordHandler:nil
+                                 conditional:NO
+                           cancellationToken:cancellationToken
+                         retryOnInvalidToken:YES];
 }
 
 - (BFTask *)runValidatedPutTaskWithPath:(NSString *)path
@@ -122,10 +148,21 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
 
 - (BFTask *)runValidatedPostTaskWithPath:(NSString *)path
                            andParameters:(NSDictionary *)parameters {
+    return [self runValidatedPostTaskWithPath:path parameters:parameters cancellationToken:nil];
+}
+
+- (BFTask *)runValidatedPostTaskWithPath:(NSString *)path
+                              parameters:(NSDictionary *)parameters
+                       cancellationToken:(NSOperation *)cancellationToken {
     return [self runValidatedImojiURLRequest:[NSURL URLWithString:[NSString stringWithFormat:@"%@%@", ImojiSDKServerURL, path]]
                                   parameters:parameters
                                       method:@"POST"
-                                     headers:@{}];
+                                     headers:@{}
+                            streamedArrayKey:nil
+                               recordHandler:nil
+                                 conditional:NO
+                           cancellationToken:cancellationToken
+                         retryOnInvalidToken:YES];
 }
 
 - (BFTask *)runValidatedDeleteTaskWithPath:(NSString *)path
@@ -136,6 +173,47 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                                      headers:@{}];
 }
 
+- (BFTask *)runValidatedStreamingGetTaskWithPath:(NSString *)path
+                                      parameters:(NSDictionary *)parameters
+                                streamedArrayKey:(NSString *)streamedArrayKey
+                                   recordHandler:(IMImojiStreamingJSONDecoderRecordHandler)recordHandler
+                               cancellationToken:(NSOperation *)cancellationToken {
+    return [self runValidatedImojiURLRequest:[NSURL URLWithString:[NSString stringWithFormat:@"%@%@", ImojiSDKServerURL, path]]
+                                  parameters:parameters
+                                      method:@"GET"
+                                     headers:@{}
+                            streamedArrayKey:streamedArrayKey
+                               recordHandler:recordHandler
+                                 conditional:NO
+                           cancellationToken:cancellationToken
+                         retryOnInvalidToken:YES];
+}
+
+- (BFTask *)runValidatedConditionalGetTaskWithPath:(NSString *)path
+                                        parameters:(NSDictionary *)parameters
+                                         entityTag:(NSString *)entityTag
+                                      lastModified:(NSString *)lastModified
+                                 cancellationToken:(NSOperation *)cancellationToken {
+    NSMutableDictionary *headers = [NSMutableDictionary dictionary];
+    if (entityTag) {
+        headers[@"If-None-Match"] = entityTag;
+    }
+
+    if (lastModified) {
+        headers[@"If-Modified-Since"] = lastModified;
+    }
+
+    return [self runValidatedImojiURLRequest:[NSURL URLWithString:[NSString stringWithFormat:@"%@%@", ImojiSDKServerURL, path]]
+                                  parameters:parameters
+                                      method:@"GET"
+                                     headers:headers
+                            streamedArrayKey:nil
+                               recordHandler:nil
+                                 conditional:YES
+                           cancellationToken:cancellationToken
+                         retryOnInvalidToken:YES];
+}
+
 - (NSDictionary *)getRequestHeaders:(NSDictionary *)additionalHeaders {
     NSMutableDictionary *headers = [NSMutableDictionary dictionary];
 
@@ -161,15 +239,39 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                              parameters:(NSDictionary *)parameters
                                  method:(NSString *)method
                                 headers:(NSDictionary *)headers {
+    return [self runValidatedImojiURLRequest:url
+                                  parameters:parameters
+                                      method:method
+                                     headers:headers
+                            streamedArrayKey:nil
+                               recordHandler:nil
+                                 conditional:NO
+                           cancellationToken:nil
+                         retryOnInvalidToken:YES];
+}
+
+- (BFTask *)runValidatedImojiURLRequest:(NSURL *)url
+                             parameters:(NSDictionary *)parameters
+                                 method:(NSString *)method
+                                headers:(NSDictionary *)headers
+                       streamedArrayKey:(NSString *)streamedArrayKey
+                          recordHandler:(IMImojiStreamingJSONDecoderRecordHandler)recordHandler
+                            conditional:(BOOL)conditional
+                      cancellationToken:(NSOperation *)cancellationToken
+                    retryOnInvalidToken:(BOOL)retryOnInvalidToken {
     BFTaskCompletionSource *taskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
 
+    // session validation is shared between requests and keeps running, only this request's work stops on cancellation
     [[self validateSession] continueWithBlock:^id(BFTask *task) {
-        if (task.error) {
+        if (cancellationToken.isCancelled) {
+            [taskCompletionSource cancel];
+        } else if (task.error) {
             taskCompletionSource.error = task.error;
         } else {
             NSMutableURLRequest *request;
+            NSString *accessToken = task.result;
             NSMutableDictionary *parametersWithAuth = [NSMutableDictionary dictionaryWithDictionary:parameters];
-            parametersWithAuth[@"access_token"] = task.result;
+            parametersWithAuth[@"access_token"] = accessToken;
 
             if ([@"GET" isEqualToString:method]) {
                 request = [NSMutableURLRequest GETRequestWithURL:url parameters:parametersWithAuth];
@@ -181,15 +283,36 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                 request = [NSMutableURLRequest PUTRequestWithURL:url parameters:parametersWithAuth];
             }
 
-            [[self runImojiURLRequest:request headers:headers] continueWithBlock:^id(BFTask *imojiRequest) {
-                if (imojiRequest.error) {
-                    if (imojiRequest.error.userInfo && [@"invalid_token" isEqualToString:imojiRequest.error.userInfo[@"status"]]) {
-                        [self renewCredentials:^(BOOL successful, NSError *error) {
+            BFTask *requestTask;
+            if (recordHandler) {
+                requestTask = [self runStreamingImojiURLRequest:request headers:headers streamedArrayKey:streamedArrayKey recordHandler:recordHandler cancellationToken:cancellationToken];
+            } else if (conditional) {
+                requestTask = [self runConditionalImojiURLRequest:request headers:headers cancellationToken:cancellationToken];
+            } else {
+                requestTask = [self runImojiURLRequest:request headers:headers cancellationToken:cancellationToken];
+            }
+
+            [requestTask continueWithBlock:^id(BFTask *imojiRequest) {
+                if (imojiRequest.cancelled) {
+                    [taskCompletionSource cancel];
+                } else if (imojiRequest.error) {
+                    if (retryOnInvalidToken && imojiRequest.error.userInfo && [@"invalid_token" isEqualToString:imojiRequest.error.userInfo[@"status"]]) {
+                        // wait on a single renewal shared with every other request that was rejected with the same
+                        // token, then replay once with the new one
+                        [[self renewCredentialsForAccessToken:accessToken] continueWithBlock:^id(BFTask *renewTask) {
+                            // rejected responses are never streamed, so no records were handed out before the replay
                             [[self runValidatedImojiURLRequest:url
                                                     parameters:parameters
                                                         method:method
-                                                       headers:headers] continueWithBlock:^id(BFTask *validationTask) {
-                                if (validationTask.error) {
+                                                       headers:headers
+                                              streamedArrayKey:streamedArrayKey
+                                                 recordHandler:recordHandler
+                                                   conditional:conditional
+                                             cancellationToken:cancellationToken
+                                           retryOnInvalidToken:NO] continueWithBlock:^id(BFTask *validationTask) {
+                                if (validationTask.cancelled) {
+                                    [taskCompletionSource cancel];
+                                } else if (validationTask.error) {
                                     taskCompletionSource.error = validationTask.error;
                                 } else {
                                     taskCompletionSource.result = validationTask.result;
@@ -197,6 +320,8 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
 
                                 return nil;
                             }];
+
+                            return nil;
                         }];
                     } else {
                         taskCompletionSource.error = imojiRequest.error;
@@ -216,12 +341,9 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
 }
 
 - (void)renewCredentials:(IMImojiSessionAsyncResponseCallback)callback {
-    [IMImojiSession credentials].accessToken = nil;
-    [IMImojiSession credentials].refreshToken = nil;
-    [IMImojiSession credentials].expirationDate = nil;
-    [IMImojiSession credentials].accountSynchronized = NO;
-
-    [[self validateSession] continueWithBlock:^id(BFTask *task) {
+    [[BFTask im_serialBackgroundTaskWithBlock:^id(BFTask *task) {
+        return [self renewCredentialsForAccessToken:[IMImojiSession credentials].accessToken];
+    }] continueWithBlock:^id(BFTask *task) {
         if (callback) {
             if (task.error) {
                 callback(NO, task.error);
@@ -234,63 +356,224 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
     }];
 }
 
+- (BFTask *)renewCredentialsForAccessToken:(NSString *)accessToken {
+    return [BFTask im_serialBackgroundTaskWithBlock:^id(BFTask *task) {
+        // only discard the credentials if nobody has renewed them since the rejected token was handed out, otherwise
+        // every rejected request would wipe the token obtained by the previous renewal
+        if (!self->_authenticationTask && accessToken && [accessToken isEqualToString:[IMImojiSession credentials].accessToken]) {
+            [IMImojiSession credentials].accessToken = nil;
+            [IMImojiSession credentials].refreshToken = nil;
+            [IMImojiSession credentials].expirationDate = nil;
+            [IMImojiSession credentials].accountSynchronized = NO;
+        }
+
+        return [self validateSession];
+    }];
+}
+
+- (BFTask *)runValidatedGetTasksWithPath:(NSString *)path
+                           parameterSets:(NSArray<NSDictionary *> *)parameterSets
+                              URLSession:(NSURLSession *)urlSession {
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@", ImojiSDKServerURL, path]];
+
+    return [[self validateSession] continueWithBlock:^id(BFTask *task) {
+        if (task.error) {
+            return [BFTask taskWithResult:@0];
+        }
+
+        NSString *accessToken = task.result;
+        __block NSUInteger succeededCount = 0;
+
+        BFTask *requestsTask = [BFTask taskWithResult:nil];
+        for (NSDictionary *parameters in parameterSets) {
+            requestsTask = [requestsTask continueWithSuccessBlock:^id(BFTask *previousTask) {
+                NSMutableDictionary *parametersWithAuth = [NSMutableDictionary dictionaryWithDictionary:parameters];
+                parametersWithAuth[@"access_token"] = accessToken;
+
+                return [[self runImojiURLRequest:[NSMutableURLRequest GETRequestWithURL:url parameters:parametersWithAuth]
+                                         headers:@{}
+                                      URLSession:urlSession
+                               cancellationToken:nil] continueWithSuccessBlock:^id(BFTask *requestTask) {
+                    succeededCount++;
+                    return nil;
+                }];
+            }];
+        }
+
+        return [requestsTask continueWithBlock:^id(BFTask *completedTask) {
+            if (completedTask.error.userInfo && [@"invalid_token" isEqualToString:completedTask.error.userInfo[@"status"]]) {
+                // renew now so the remaining requests go out with a valid token on the next attempt
+                [self renewCredentialsForAccessToken:accessToken];
+            }
+
+            return @(succeededCount);
+        }];
+    }];
+}
 
 - (BFTask *)runImojiURLRequest:(NSMutableURLRequest *)request
-                       headers:(NSDictionary *)headers {
+                       headers:(NSDictionary *)headers
+             cancellationToken:(NSOperation *)cancellationToken {
+    return [self runImojiURLRequest:request headers:headers URLSession:self->_urlSession cancellationToken:cancellationToken];
+}
+
+- (BFTask *)runImojiURLRequest:(NSMutableURLRequest *)request
+                       headers:(NSDictionary *)headers
+                    URLSession:(NSURLSession *)urlSession
+             cancellationToken:(NSOperation *)cancellationToken {
+
+    [request setAllHTTPHeaderFields:[self getRequestHeaders:headers]];
+    BFTaskCompletionSource *taskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+
+    NSURLSessionDataTask *dataTask = [urlSession dataTaskWithRequest:request
+                                                          completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+                                                              if (cancellationToken.isCancelled) {
+                                                                  [taskCompletionSource cancel];
+                                                              } else {
+                                                                  [self completeImojiURLRequest:taskCompletionSource withData:data response:response error:error];
+                                                              }
+                                                          }];
+
+    [self resumeDataTask:dataTask cancellationToken:cancellationToken];
+
+    return taskCompletionSource.task;
+}
+
+- (BFTask *)runConditionalImojiURLRequest:(NSMutableURLRequest *)request
+                                  headers:(NSDictionary *)headers
+                        cancellationToken:(NSOperation *)cancellationToken {
 
     [request setAllHTTPHeaderFields:[self getRequestHeaders:headers]];
+    // the snapshot is the cache, a response from NSURLCache would hide the 304
+    request.cachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
     BFTaskCompletionSource *taskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
 
-    [[self->_urlSession dataTaskWithRequest:request
-                          completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
-                              if (error) {
-                                  taskCompletionSource.error = error;
-                              } else {
-                                  NSError *jsonError;
-                                  NSDictionary *jsonInfo;
-
-                                  if (data.length > 0) {
-                                      jsonInfo = [NSJSONSerialization JSONObjectWithData:data
-                                                                                 options:NSJSONReadingAllowFragments
-                                                                                   error:&jsonError];
-                                  } else {
-                                      jsonInfo = nil;
-                                  }
-
-                                  if (jsonError) {
-                                      taskCompletionSource.error = jsonError;
-                                  } else {
-                                      if ([response isKindOfClass:[NSHTTPURLResponse class]] &&
-                                              ((NSHTTPURLResponse *) response).statusCode != 200) {
-                                          taskCompletionSource.error = [NSError errorWithDomain:IMImojiSessionErrorDomain
-                                                                                           code:IMImojiSessionErrorCodeServerError
-                                                                                       userInfo:jsonInfo];
-                                      } else {
-                                          taskCompletionSource.result = jsonInfo;
-                                      }
-                                  }
-                              }
-                          }] resume];
+    NSURLSessionDataTask *dataTask = [self->_urlSession dataTaskWithRequest:request
+                                                          completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+                                                              NSHTTPURLResponse *httpResponse = [response isKindOfClass:[NSHTTPURLResponse class]] ? (NSHTTPURLResponse *) response : nil;
+
+                                                              if (cancellationToken.isCancelled) {
+                                                                  [taskCompletionSource cancel];
+                                                              } else if (!error && httpResponse.statusCode == 304) {
+                                                                  taskCompletionSource.result = [IMImojiConditionalResponse notModifiedResponse];
+                                                              } else {
+                                                                  BFTaskCompletionSource *jsonCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+                                                                  [self completeImojiURLRequest:jsonCompletionSource withData:data response:response error:error];
+
+                                                                  if (jsonCompletionSource.task.error) {
+                                                                      taskCompletionSource.error = jsonCompletionSource.task.error;
+                                                                  } else {
+                                                                      taskCompletionSource.result = [IMImojiConditionalResponse responseWithResults:jsonCompletionSource.task.result
+                                                                                                                                          entityTag:httpResponse.allHeaderFields[@"ETag"]
+                                                                                                                                       lastModified:httpResponse.allHeaderFields[@"Last-Modified"]];
+                                                                  }
+                                                              }
+                                                          }];
+
+    [self resumeDataTask:dataTask cancellationToken:cancellationToken];
 
     return taskCompletionSource.task;
 }
 
+- (BFTask *)runStreamingImojiURLRequest:(NSMutableURLRequest *)request
+                                headers:(NSDictionary *)headers
+                       streamedArrayKey:(NSString *)streamedArrayKey
+                          recordHandler:(IMImojiStreamingJSONDecoderRecordHandler)recordHandler
+                      cancellationToken:(NSOperation *)cancellationToken {
+
+    [request setAllHTTPHeaderFields:[self getRequestHeaders:headers]];
+    BFTaskCompletionSource *taskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+
+    NSURLSessionDataTask *dataTask = [self->_urlSession dataTaskWithRequest:request];
+    [(IMImojiStreamingURLSessionDelegate *) self->_urlSession.delegate registerDataTask:dataTask
+                                                                               decoder:[[IMImojiStreamingJSONDecoder alloc] initWithStreamedArrayKey:streamedArrayKey
+                                                                                                                                       recordHandler:recordHandler]
+                                                                     completionHandler:^(NSDictionary *result, NSData *bufferedData, NSURLResponse *response, NSError *error) {
+                                                                         if (cancellationToken.isCancelled) {
+                                                                             [taskCompletionSource cancel];
+                                                                         } else if (result) {
+                                                                             taskCompletionSource.result = result;
+                                                                         } else {
+                                                                             [self completeImojiURLRequest:taskCompletionSource withData:bufferedData response:response error:error];
+                                                                         }
+                                                                     }];
+    [self resumeDataTask:dataTask cancellationToken:cancellationToken];
+
+    return taskCompletionSource.task;
+}
+
+- (void)completeImojiURLRequest:(BFTaskCompletionSource *)taskCompletionSource
+                       withData:(NSData *)data
+                       response:(NSURLResponse *)response
+                          error:(NSError *)error {
+    if (error) {
+        taskCompletionSource.error = error;
+    } else {
+        NSError *jsonError;
+        NSDictionary *jsonInfo;
+
+        if (data.length > 0) {
+            jsonInfo = [NSJSONSerialization JSONObjectWithData:data
+                                                       options:NSJSONReadingAllowFragments
+                                                         error:&jsonError];
+        } else {
+            jsonInfo = nil;
+        }
+
+        if (jsonError) {
+            taskCompletionSource.error = jsonError;
+        } else {
+            if ([response isKindOfClass:[NSHTTPURLResponse class]] &&
+                    ((NSHTTPURLResponse *) response).statusCode != 200) {
+                taskCompletionSource.error = [NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                                 code:IMImojiSessionErrorCodeServerError
+                                                             userInfo:jsonInfo];
+            } else {
+                taskCompletionSource.result = jsonInfo;
+            }
+        }
+    }
+}
+
 - (BFTask *)runExternalURLRequest:(NSMutableURLRequest *)request
-                          headers:(NSDictionary *)headers {
+                          headers:(NSDictionary *)headers
+                cancellationToken:(NSOperation *)cancellationToken {
 
     BFTaskCompletionSource *taskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
 
-    [[self->_urlSession dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
-        if (error) {
+    NSURLSessionDataTask *dataTask = [self->_urlSession dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        if (cancellationToken.isCancelled) {
+            [taskCompletionSource cancel];
+        } else if (error) {
             taskCompletionSource.error = error;
+        } else if ([response isKindOfClass:[NSHTTPURLResponse class]] && ((NSHTTPURLResponse *) response).statusCode >= 400) {
+            // avoid handing error pages back as image contents, they'd otherwise end up in the image caches
+            taskCompletionSource.error = [NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                             code:IMImojiSessionErrorCodeServerError
+                                                         userInfo:@{
+                                                                 NSLocalizedDescriptionKey : [NSString stringWithFormat:@"%@ returned status code %@", request.URL, @(((NSHTTPURLResponse *) response).statusCode)],
+                                                                 @"statusCode" : @(((NSHTTPURLResponse *) response).statusCode)
+                                                         }];
         } else {
             taskCompletionSource.result = data;
         }
-    }] resume];
+    }];
+
+    [self resumeDataTask:dataTask cancellationToken:cancellationToken];
 
     return taskCompletionSource.task;
 }
 
+- (void)resumeDataTask:(NSURLSessionTask *)dataTask cancellationToken:(NSOperation *)cancellationToken {
+    // abort the transfer as soon as the caller cancels, rather than letting it run to completion and polling afterwards
+    __weak NSURLSessionTask *weakDataTask = dataTask;
+    [IMImojiCancellationToken addCancellationHandler:^{
+        [weakDataTask cancel];
+    }                                    toOperation:cancellationToken];
+
+    [dataTask resume];
+}
+
 - (BFTask *)validateSession {
     BFTaskCompletionSource *taskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
 
@@ -302,6 +585,7 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                                                         NSLocalizedDescriptionKey : @"clientId not specified. Call [[ImojiSDK sharedInstance] setClientId:apiToken:] before making this call."
                                                 }];
             taskCompletionSource.error = apiError;
+            return nil;
 
         } else if (![ImojiSDK sharedInstance].apiToken) {
             NSError *apiError = [NSError errorWithDomain:IMImojiSessionErrorDomain
@@ -310,11 +594,29 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                                                         NSLocalizedDescriptionKey : @"apiToken not specified. Call [[ImojiSDK sharedInstance] setClientId:apiToken:] before making this call."
                                                 }];
             taskCompletionSource.error = apiError;
+            return nil;
+        }
+
+        // a token request is already in flight, wait on it rather than issuing another one
+        if (self->_authenticationTask) {
+            [self->_authenticationTask continueWithBlock:^id(BFTask *authenticationTask) {
+                if (authenticationTask.error) {
+                    taskCompletionSource.error = authenticationTask.error;
+                } else {
+                    taskCompletionSource.result = authenticationTask.result;
+                }
+
+                return nil;
+            }];
+
+            return nil;
         }
 
         if ([IMImojiSession credentials].accessToken) {
             // refresh
             if ([IMImojiSession credentials].expirationDate && [[IMImojiSession credentials].expirationDate compare:[NSDate date]] != NSOrderedDescending) {
+                [self beginAuthenticationWithCompletionSource:taskCompletionSource];
+
                 [[self runPostTaskWithPath:@"/oauth/token"
                                    headers:self.getOAuthBearerHeaders
                              andParameters:@{@"grant_type" : @"refresh_token", @"refresh_token" : [IMImojiSession credentials].refreshToken}]
@@ -342,6 +644,7 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
             } else {
                 // if the client id's changed, generate a new access token
                 if ([IMImojiSession credentials].clientId && ![[IMImojiSession credentials].clientId isEqualToString:[ImojiSDK sharedInstance].clientId.UUIDString]) {
+                    [self beginAuthenticationWithCompletionSource:taskCompletionSource];
                     [self getNewAccessTokenWithCompletionSource:taskCompletionSource];
                 } else {
                     taskCompletionSource.result = [IMImojiSession credentials].accessToken;
@@ -349,6 +652,7 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                 }
             }
         } else {
+            [self beginAuthenticationWithCompletionSource:taskCompletionSource];
             [self getNewAccessTokenWithCompletionSource:taskCompletionSource];
         }
 
@@ -358,6 +662,21 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
     return taskCompletionSource.task;
 }
 
+// Must be called on the serial background queue. Marks a token request as in flight until the completion source is
+// resolved so concurrent validations share it.
+- (void)beginAuthenticationWithCompletionSource:(BFTaskCompletionSource *)taskCompletionSource {
+    BFTask *authenticationTask = taskCompletionSource.task;
+    self->_authenticationTask = authenticationTask;
+
+    [authenticationTask continueWithExecutor:[BFTask im_serialBackgroundExecutor] withBlock:^id(BFTask *task) {
+        if (self->_authenticationTask == authenticationTask) {
+            self->_authenticationTask = nil;
+        }
+
+        return nil;
+    }];
+}
+
 - (void)getNewAccessTokenWithCompletionSource:(BFTaskCompletionSource *)taskCompletionSource {
     [[self runPostTaskWithPath:@"/oauth/token"
                        headers:self.getOAuthBearerHeaders
@@ -437,81 +756,118 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                                                                              tags:tags
                                                                              urls:@{}];
 
-    UIImage *resizedRawImage = [rawImage im_resizedImageToFitInSize:CGSizeMake(150.f, 150.f) scaleIfSmaller:NO];
-    if (!resizedRawImage) {
-        return [BFTask taskWithError:[NSError errorWithDomain:IMImojiSessionErrorDomain
-                                                         code:IMImojiSessionErrorCodeInvalidImage
-                                                     userInfo:@{
-                                                             NSLocalizedDescriptionKey : @"Unable to resize rawImage"
-                                                     }]];
-    }
+    IMImojiObjectRenderingOptions *fullResolutionRawOptions = [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeFullResolution
+                                                                                                       borderStyle:IMImojiObjectBorderStyleNone
+                                                                                                       imageFormat:IMImojiObjectImageFormatPNG];
+    NSArray *variants = @[
+            @[[IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeThumbnail
+                                                       borderStyle:IMImojiObjectBorderStyleNone
+                                                       imageFormat:IMImojiObjectImageFormatPNG], rawImage],
 
+            @[fullResolutionRawOptions, rawImage],
 
-    UIImage *resizedBorderImage = [borderedImage im_resizedImageToFitInSize:CGSizeMake(150.f, 150.f) scaleIfSmaller:NO];
-    if (!resizedBorderImage) {
-        return [BFTask taskWithError:[NSError errorWithDomain:IMImojiSessionErrorDomain
-                                                         code:IMImojiSessionErrorCodeInvalidImage
-                                                     userInfo:@{
-                                                             NSLocalizedDescriptionKey : @"Unable to resize bordered image"
-                                                     }]];
-    }
-
-    NSDictionary *renderingOptions = @{
-            [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeThumbnail
-                                                     borderStyle:IMImojiObjectBorderStyleNone
-                                                     imageFormat:IMImojiObjectImageFormatPNG] : resizedRawImage,
+            @[[IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeThumbnail
+                                                       borderStyle:IMImojiObjectBorderStyleSticker
+                                                       imageFormat:IMImojiObjectImageFormatPNG], borderedImage],
 
-            [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeFullResolution
-                                                     borderStyle:IMImojiObjectBorderStyleNone
-                                                     imageFormat:IMImojiObjectImageFormatPNG] : rawImage,
-
-            [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeThumbnail
-                                                     borderStyle:IMImojiObjectBorderStyleSticker
-                                                     imageFormat:IMImojiObjectImageFormatPNG] : resizedBorderImage,
-
-            [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeFullResolution
-                                                     borderStyle:IMImojiObjectBorderStyleSticker
-                                                     imageFormat:IMImojiObjectImageFormatPNG] : borderedImage
-    };
+            @[[IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeFullResolution
+                                                       borderStyle:IMImojiObjectBorderStyleSticker
+                                                       imageFormat:IMImojiObjectImageFormatPNG], borderedImage]
+    ];
 
-    NSMutableDictionary *urls = [NSMutableDictionary new];
+    // resize, encode and write every variant in parallel, full size camera images make each of these expensive
     NSMutableArray *tasks = [NSMutableArray new];
-    for (IMImojiObjectRenderingOptions *renderingOption in renderingOptions.allKeys) {
-        urls[renderingOption] = [NSURL URLWithString:[NSString stringWithFormat:@"file://%@", [self filePathFromImoji:imojiObject
-                                                                                                     renderingOptions:renderingOption]]];
-
-        [tasks addObject:[self writeImoji:imojiObject
-                         renderingOptions:renderingOption
-                            imageContents:UIImagePNGRepresentation(renderingOptions[renderingOption])
-                              synchronous:NO]];
+    for (NSArray *variant in variants) {
+        IMImojiObjectRenderingOptions *renderingOption = variant[0];
+        UIImage *image = variant[1];
+
+        // the full resolution raw image is uploaded as is later on, it is only transcoded when the backend accepts WebP
+        BOOL isUploadedVariant = self.storagePolicy.uploadsCreatedImojis && renderingOption == fullResolutionRawOptions;
+        BOOL allowWebP = isUploadedVariant ? self.storagePolicy.uploadsCreatedImojisAsWebP : self.storagePolicy.encodesCreatedImojisAsWebP;
+
+        [tasks addObject:[[self encodeCreatedImojiImage:image
+                                       renderingOptions:renderingOption
+                                              allowWebP:allowWebP
+                                               lossless:isUploadedVariant] continueWithSuccessBlock:^id(BFTask *task) {
+            // WebP encoding falls back to PNG when it isn't available, key and name the file by what was written
+            NSData *imageContents = task.result;
+            IMImojiObjectRenderingOptions *writtenOption = [IMImojiObjectRenderingOptions optionsWithRenderSize:renderingOption.renderSize
+                                                                                                    borderStyle:renderingOption.borderStyle
+                                                                                                    imageFormat:YYImageDetectType((__bridge CFDataRef) imageContents) == YYImageTypeWebP ?
+                                                                                                            IMImojiObjectImageFormatWebP : IMImojiObjectImageFormatPNG];
+
+            return [[self writeImoji:imojiObject
+                    renderingOptions:writtenOption
+                       imageContents:imageContents
+                         synchronous:NO] continueWithSuccessBlock:^id(BFTask *writeTask) {
+                return writtenOption;
+            }];
+        }]];
     }
 
     return [[BFTask taskForCompletionOfAllTasks:tasks] continueWithBlock:^id(BFTask *task) {
+        NSMutableDictionary *urls = [NSMutableDictionary new];
+        for (BFTask *variantTask in tasks) {
+            if (variantTask.error) {
+                return [BFTask taskWithError:variantTask.error];
+            }
+
+            IMImojiObjectRenderingOptions *writtenOption = variantTask.result;
+            urls[writtenOption] = [NSURL fileURLWithPath:[self filePathFromImoji:imojiObject renderingOptions:writtenOption]];
+        }
+
         return [IMMutableImojiObject imojiWithIdentifier:imojiObject.identifier tags:imojiObject.tags urls:urls];
     }];
 }
 
-- (void)removeLocalImoj:(IMImojiObject *)imoji {
-    NSArray *renderingOptions = @[
-            [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeThumbnail
-                                                     borderStyle:IMImojiObjectBorderStyleNone
-                                                     imageFormat:IMImojiObjectImageFormatPNG],
-
-            [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeFullResolution
-                                                     borderStyle:IMImojiObjectBorderStyleNone
-                                                     imageFormat:IMImojiObjectImageFormatPNG],
-
-            [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeThumbnail
-                                                     borderStyle:IMImojiObjectBorderStyleSticker
-                                                     imageFormat:IMImojiObjectImageFormatPNG],
-
-            [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeFullResolution
-                                                     borderStyle:IMImojiObjectBorderStyleSticker
-                                                     imageFormat:IMImojiObjectImageFormatPNG]
-    ];
+- (BFTask *)encodeCreatedImojiImage:(UIImage *)image
+                   renderingOptions:(IMImojiObjectRenderingOptions *)renderingOptions
+                          allowWebP:(BOOL)allowWebP
+                           lossless:(BOOL)lossless {
+    return [BFTask im_concurrentBackgroundTaskWithBlock:^id(BFTask *task) {
+        UIImage *variantImage = image;
+        if (renderingOptions.renderSize == IMImojiObjectRenderSizeThumbnail) {
+            // 150 points at the scale of the created image, so 150 pixels for camera and library images
+            variantImage = [image im_resizedImageToFitInSize:CGSizeMake(150.f, 150.f) scaleIfSmaller:NO];
+        }
+
+        NSData *imageContents = nil;
+        if (variantImage && allowWebP) {
+            // only available when YYImage was built with its bundled libwebp, fall back to PNG otherwise
+            YYImageEncoder *encoder = [[YYImageEncoder alloc] initWithType:YYImageTypeWebP];
+            encoder.lossless = lossless;
+            encoder.quality = lossless ? 1.0 : 0.9;
+            [encoder addImage:variantImage duration:0];
+            imageContents = [encoder encode];
+        }
+
+        if (variantImage && !imageContents) {
+            imageContents = UIImagePNGRepresentation(variantImage);
+        }
+
+        if (!imageContents) {
+            return [BFTask taskWithError:[NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                             code:IMImojiSessionErrorCodeInvalidImage
+                                                         userInfo:@{
+                                                                 NSLocalizedDescriptionKey : renderingOptions.borderStyle == IMImojiObjectBorderStyleNone ?
+                                                                         @"Unable to encode rawImage" : @"Unable to encode bordered image"
+                                                         }]];
+        }
+
+        return imageContents;
+    }];
+}
 
-    for (IMImojiObjectRenderingOptions *renderingOption in renderingOptions) {
-        [self removeImoji:imoji renderingOptions:renderingOption];
+- (void)removeLocalImoj:(IMImojiObject *)imoji {
+    // created variants are stored as PNG or WebP depending on the storage policy and encoder availability
+    for (NSNumber *imageFormat in @[@(IMImojiObjectImageFormatPNG), @(IMImojiObjectImageFormatWebP)]) {
+        for (NSNumber *renderSize in @[@(IMImojiObjectRenderSizeThumbnail), @(IMImojiObjectRenderSizeFullResolution)]) {
+            for (NSNumber *borderStyle in @[@(IMImojiObjectBorderStyleNone), @(IMImojiObjectBorderStyleSticker)]) {
+                [self removeImoji:imoji renderingOptions:[IMImojiObjectRenderingOptions optionsWithRenderSize:(IMImojiObjectRenderSize) renderSize.unsignedIntegerValue
+                                                                                                  borderStyle:(IMImojiObjectBorderStyle) borderStyle.unsignedIntegerValue
+                                                                                                  imageFormat:(IMImojiObjectImageFormat) imageFormat.unsignedIntegerValue]];
+            }
+        }
     }
 }
 
@@ -553,7 +909,7 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
     if (results.count != 0) {
         NSMutableArray *imojiObjectsArray = [NSMutableArray arrayWithCapacity:results.count];
         for (NSDictionary *result in results) {
-            [imojiObjectsArray addObject:[self readImojiObject:result]];
+            [imojiObjectsArray addObject:[self readImojiRecord:result]];
         }
 
         return imojiObjectsArray;
@@ -580,13 +936,170 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
         searchResponseCallback(resultSetMetadata, nil);
     }
 
-    for (IMMutableImojiObject *imoji in imojiObjects) {
-        if (imojiResponseCallback && !cancellationToken.isCancelled) {
-            imojiResponseCallback(imoji, [imojiObjects indexOfObject:imoji], nil);
+    if (imojiResponseCallback) {
+        [imojiObjects enumerateObjectsUsingBlock:^(IMMutableImojiObject *imoji, NSUInteger idx, BOOL *stop) {
+            if (cancellationToken.isCancelled) {
+                *stop = YES;
+                return;
+            }
+
+            imojiResponseCallback(imoji, idx, nil);
+        }];
+    }
+}
+
+- (void)handleImojiResultSetTask:(BFTask *)getTask
+                    imojiObjects:(NSArray *)imojiObjects
+               cancellationToken:(NSOperation *)cancellationToken
+       resultSetResponseCallback:(IMImojiSessionResultSetResponseCallback)resultSetResponseCallback
+           imojiResponseCallback:(IMImojiSessionImojiFetchedResponseCallback)imojiResponseCallback
+           batchResponseCallback:(IMImojiSessionImojiBatchResponseCallback)batchResponseCallback {
+    // validation and decoding stay off the main thread, the callbacks are then invoked in a single main thread hop
+    [getTask continueWithExecutor:[BFTask im_concurrentBackgroundExecutor] withBlock:^id(BFTask *task) {
+        if (cancellationToken.isCancelled) {
+            return [BFTask cancelledTask];
+        }
+
+        NSDictionary *results = task.result;
+        NSError *error = task.error;
+        NSArray *decodedImojiObjects;
+        NSString *relatedSearchTerm;
+        NSArray *relatedCategories;
+
+        if (!error && [self validateServerResponse:results error:&error]) {
+            decodedImojiObjects = imojiObjects ? imojiObjects : [self convertServerDataSetToImojiArray:results];
+            relatedSearchTerm = [results im_checkedStringForKey:@"followupSearchTerm"];
+            relatedCategories = [self readCategories:[results im_checkedArrayForKey:@"relatedCategories" defaultValue:@[]]];
+        }
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (cancellationToken.isCancelled) {
+                return;
+            }
+
+            if (error) {
+                if (batchResponseCallback) {
+                    batchResponseCallback(nil, nil, error);
+                } else if (resultSetResponseCallback) {
+                    resultSetResponseCallback(nil, error);
+                } else if (imojiResponseCallback) {
+                    imojiResponseCallback(nil, NSUIntegerMax, error);
+                }
+            } else if (batchResponseCallback) {
+                IMImojiResultSetMetadata *resultSetMetadata = [IMImojiResultSetMetadata new];
+                resultSetMetadata.relatedSearchTerm = relatedSearchTerm;
+                resultSetMetadata.relatedCategories = relatedCategories;
+                resultSetMetadata.resultCount = @(decodedImojiObjects.count);
+                batchResponseCallback(resultSetMetadata, decodedImojiObjects, nil);
+            } else {
+                [self handleImojiFetchResponse:decodedImojiObjects
+                             relatedSearchTerm:relatedSearchTerm
+                             relatedCategories:relatedCategories
+                             cancellationToken:cancellationToken
+                        searchResponseCallback:resultSetResponseCallback
+                         imojiResponseCallback:imojiResponseCallback];
+            }
+        });
+
+        return nil;
+    }];
+}
+
+- (void)fetchImojiResultSetWithPath:(NSString *)path
+                         parameters:(NSDictionary *)parameters
+                  cancellationToken:(NSOperation *)cancellationToken
+          resultSetResponseCallback:(IMImojiSessionResultSetResponseCallback)resultSetResponseCallback
+              imojiResponseCallback:(IMImojiSessionImojiFetchedResponseCallback)imojiResponseCallback
+              batchResponseCallback:(IMImojiSessionImojiBatchResponseCallback)batchResponseCallback {
+    NSString *cacheKey = [IMImojiResultCache keyForPath:path parameters:parameters];
+    NSTimeInterval timeToLive = self.storagePolicy.resultCacheTimeToLive;
+    BOOL stale = NO;
+    NSDictionary *cachedResultSet = timeToLive > 0 ? [self->_resultCache objectForKey:cacheKey timeToLive:timeToLive stale:&stale] : nil;
+
+    if (cachedResultSet) {
+        [self handleImojiResultSetTask:[BFTask taskWithResult:cachedResultSet[IMImojiSessionCachedResponseKey]]
+                          imojiObjects:cachedResultSet[IMImojiSessionCachedImojisKey]
+                     cancellationToken:cancellationToken
+             resultSetResponseCallback:resultSetResponseCallback
+                 imojiResponseCallback:imojiResponseCallback
+                 batchResponseCallback:batchResponseCallback];
+
+        // stale results are handed out as is, the refreshed ones are picked up by the next request
+        if (stale && [self->_resultCache beginRefreshForKey:cacheKey]) {
+            NSMutableArray *refreshedImojiObjects = [NSMutableArray new];
+            BFTask *refreshTask = [self runValidatedStreamingGetTaskWithPath:path
+                                                                  parameters:parameters
+                                                            streamedArrayKey:@"results"
+                                                               recordHandler:^(NSDictionary *record, NSUInteger index) {
+                                                                   [refreshedImojiObjects addObject:[self readImojiRecord:record]];
+                                                               }
+                                                           cancellationToken:nil];
+
+            [[self cacheResultSetTask:refreshTask imojiObjects:refreshedImojiObjects cacheKey:cacheKey] continueWithBlock:^id(BFTask *task) {
+                [self->_resultCache endRefreshForKey:cacheKey];
+                return nil;
+            }];
         }
+
+        return;
+    }
+
+    BOOL deliversResultsIncrementally = self.deliversResultsIncrementally && imojiResponseCallback && !batchResponseCallback;
+    NSMutableArray *imojiObjects = [NSMutableArray new];
+
+    // records are decoded on the session's delegate queue while the rest of the response is still downloading
+    BFTask *getTask = [self runValidatedStreamingGetTaskWithPath:path
+                                                      parameters:parameters
+                                                streamedArrayKey:@"results"
+                                                   recordHandler:^(NSDictionary *record, NSUInteger index) {
+                                                       if (cancellationToken.isCancelled) {
+                                                           return;
+                                                       }
+
+                                                       IMMutableImojiObject *imoji = [self readImojiRecord:record];
+                                                       [imojiObjects addObject:imoji];
+
+                                                       if (deliversResultsIncrementally) {
+                                                           dispatch_async(dispatch_get_main_queue(), ^{
+                                                               if (!cancellationToken.isCancelled) {
+                                                                   imojiResponseCallback(imoji, index, nil);
+                                                               }
+                                                           });
+                                                       }
+                                                   }
+                                               cancellationToken:cancellationToken];
+
+    // imojis handed out incrementally are already queued on the main thread ahead of the result set callback
+    [self handleImojiResultSetTask:getTask
+                      imojiObjects:imojiObjects
+                 cancellationToken:cancellationToken
+         resultSetResponseCallback:resultSetResponseCallback
+             imojiResponseCallback:deliversResultsIncrementally ? nil : imojiResponseCallback
+             batchResponseCallback:batchResponseCallback];
+
+    if (timeToLive > 0) {
+        [self cacheResultSetTask:getTask imojiObjects:imojiObjects cacheKey:cacheKey];
     }
 }
 
+- (BFTask *)cacheResultSetTask:(BFTask *)getTask
+                  imojiObjects:(NSArray *)imojiObjects
+                      cacheKey:(NSString *)cacheKey {
+    return [getTask continueWithSuccessBlock:^id(BFTask *task) {
+        NSDictionary *results = task.result;
+
+        // the streamed records are stripped from the response, keep the decoded imojis next to it
+        if ([self validateServerResponse:results error:nil]) {
+            [self->_resultCache setObject:@{
+                    IMImojiSessionCachedResponseKey : results,
+                    IMImojiSessionCachedImojisKey : [imojiObjects copy]
+            }                      forKey:cacheKey];
+        }
+
+        return nil;
+    }];
+}
+
 - (BFTask *)downloadImojiImageAsync:(IMMutableImojiObject *)imoji
                    renderingOptions:(IMImojiObjectRenderingOptions *)renderingOptions
                          imojiIndex:(NSUInteger)imojiIndex
@@ -603,54 +1116,245 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                         retriesLeft:(NSUInteger)retriesLeft
                          imojiIndex:(NSUInteger)imojiIndex
                   cancellationToken:(NSOperation *)cancellationToken {
-    BFTaskCompletionSource *taskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
     NSURL *url = [imoji getUrlForRenderingOptions:renderingOptions];
+    if (!url) {
+        return [BFTask taskWithError:[NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                         code:IMImojiSessionErrorCodeImojiDoesNotExist
+                                                     userInfo:@{
+                                                             NSLocalizedDescriptionKey : [NSString stringWithFormat:@"No image available for imoji %@", imoji.identifier]
+                                                     }]];
+    }
 
-    [BFTask im_concurrentBackgroundTaskWithBlock:^id(BFTask *task) {
+    CGFloat scale = [UIScreen mainScreen].scale;
+    CGFloat maximumPixelSize = [IMImojiImageDecoder maximumPixelSizeForRenderingOptions:renderingOptions scale:scale];
+    CGSize aspectRatio = [IMImojiImageDecoder aspectRatioForRenderingOptions:renderingOptions];
+
+    return [BFTask im_concurrentBackgroundTaskWithBlock:^id(BFTask *task) {
+        if (cancellationToken.isCancelled) {
+            return [BFTask cancelledTask];
+        }
+
+        // local PNG or WebP files written for temporary imojis during creation
+        if (url.isFileURL) {
+            return [IMImojiImageDecoder decodedImageWithData:[NSData dataWithContentsOfURL:url]
+                                            maximumPixelSize:maximumPixelSize
+                                                 aspectRatio:aspectRatio
+                                                       scale:scale];
+        }
+
+        // the decoded image was evicted from the session cache but the encoded bytes are still around. renderImoji:
+        // already counted this as an encoded hit, so don't count it again
+        NSData *cachedData = [self.imageCache peekImageDataForImoji:imoji renderingOptions:renderingOptions];
+        if (cachedData) {
+            return [IMImojiImageDecoder decodedImageWithData:cachedData
+                                            maximumPixelSize:maximumPixelSize
+                                                 aspectRatio:aspectRatio
+                                                       scale:scale];
+        }
+
+        IMImojiImageDownload *download = [self attachToImageDownloadWithURL:url
+                                                                retriesLeft:retriesLeft
+                                                           maximumPixelSize:maximumPixelSize
+                                                                aspectRatio:aspectRatio
+                                                                decodeImage:YES
+                                                          cancellationToken:cancellationToken];
+
+        return [download.taskCompletionSource.task continueWithBlock:^id(BFTask *downloadTask) {
+            if (cancellationToken.isCancelled) {
+                return [BFTask cancelledTask];
+            }
+
+            if (download.data) {
+                [self.imageCache setImageData:download.data forImoji:imoji renderingOptions:renderingOptions];
+
+                // published variants are shared between target sizes, lay the image out for this caller if needed
+                if (![IMImojiImageDecoder isMaximumPixelSize:download.maximumPixelSize
+                                                 aspectRatio:download.aspectRatio
+                                     equalToMaximumPixelSize:maximumPixelSize
+                                                 aspectRatio:aspectRatio]) {
+                    return [IMImojiImageDecoder decodedImageWithData:download.data
+                                                    maximumPixelSize:maximumPixelSize
+                                                         aspectRatio:aspectRatio
+                                                               scale:scale];
+                }
+            }
+
+            return downloadTask;
+        }];
+    }];
+}
+
+- (BFTask *)downloadImojiImageDataAsync:(IMMutableImojiObject *)imoji
+                       renderingOptions:(IMImojiObjectRenderingOptions *)renderingOptions
+                      cancellationToken:(NSOperation *)cancellationToken {
+    NSURL *url = [imoji getUrlForRenderingOptions:renderingOptions];
+    if (!url) {
+        return [BFTask taskWithError:[NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                         code:IMImojiSessionErrorCodeImojiDoesNotExist
+                                                     userInfo:@{
+                                                             NSLocalizedDescriptionKey : [NSString stringWithFormat:@"No image available for imoji %@", imoji.identifier]
+                                                     }]];
+    }
+
+    // sized the way a render with the same options decodes it, so renders joining the download can share the image
+    CGFloat maximumPixelSize = [IMImojiImageDecoder maximumPixelSizeForRenderingOptions:renderingOptions scale:[UIScreen mainScreen].scale];
+    CGSize aspectRatio = [IMImojiImageDecoder aspectRatioForRenderingOptions:renderingOptions];
+
+    return [BFTask im_concurrentBackgroundTaskWithBlock:^id(BFTask *task) {
         if (cancellationToken.isCancelled) {
             return [BFTask cancelledTask];
         }
 
-        // local files are stored as PNGs. Used in creation process for temporary Imojis
         if (url.isFileURL) {
-            taskCompletionSource.result = [YYImage imageWithData:[NSData dataWithContentsOfURL:url] scale:[UIScreen mainScreen].scale];
             return nil;
         }
 
-        [[self runExternalURLRequest:[NSMutableURLRequest GETRequestWithURL:url
-                                                                 parameters:@{}]
-                             headers:@{}] continueWithBlock:^id(BFTask *urlTask) {
-
-            if (urlTask.error) {
-                if (!cancellationToken.isCancelled) {
-                    dispatch_async(dispatch_get_main_queue(), ^{
-                        if (retriesLeft > 0) {
-                            [self downloadImojiImageAsync:imoji
-                                         renderingOptions:renderingOptions
-                                              retriesLeft:retriesLeft - 1
-                                               imojiIndex:imojiIndex
-                                        cancellationToken:cancellationToken
-                            ];
-                        } else {
-                            taskCompletionSource.error = [NSError errorWithDomain:IMImojiSessionErrorDomain
-                                                                             code:IMImojiSessionErrorCodeServerError
-                                                                         userInfo:@{
-                                                                                 NSLocalizedDescriptionKey : [NSString stringWithFormat:@"Unable to download %@ error code: %@", url, @(urlTask.error.code)]
-                                                                         }];
-                        }
-                    });
+        NSData *cachedData = [self.imageCache peekImageDataForImoji:imoji renderingOptions:renderingOptions];
+        if (cachedData) {
+            return cachedData;
+        }
+
+        IMImojiImageDownload *download = [self attachToImageDownloadWithURL:url
+                                                                retriesLeft:IMImojiSessionNumberOfRetriesForImojiDownload
+                                                           maximumPixelSize:maximumPixelSize
+                                                                aspectRatio:aspectRatio
+                                                                decodeImage:NO
+                                                          cancellationToken:cancellationToken];
+
+        return [download.taskCompletionSource.task continueWithBlock:^id(BFTask *downloadTask) {
+            if (cancellationToken.isCancelled) {
+                return [BFTask cancelledTask];
+            }
+
+            if (!download.data) {
+                return downloadTask;
+            }
+
+            [self.imageCache setImageData:download.data forImoji:imoji renderingOptions:renderingOptions];
+            return download.data;
+        }];
+    }];
+}
+
+- (IMImojiImageDownload *)attachToImageDownloadWithURL:(NSURL *)url
+                                           retriesLeft:(NSUInteger)retriesLeft
+                                      maximumPixelSize:(CGFloat)maximumPixelSize
+                                           aspectRatio:(CGSize)aspectRatio
+                                           decodeImage:(BOOL)decodeImage
+                                     cancellationToken:(NSOperation *)cancellationToken {
+    IMImojiImageDownload *download;
+    BOOL startDownload = NO;
+
+    @synchronized (self->_imageDownloads) {
+        download = self->_imageDownloads[url];
+
+        // a download abandoned by all of its callers has already been stopped, start over rather than joining it
+        if (!download || download.isCancelled || ![download addCancellationToken:cancellationToken]) {
+            download = [IMImojiImageDownload downloadWithURL:url];
+            download.maximumPixelSize = maximumPixelSize;
+            download.aspectRatio = aspectRatio;
+            self->_imageDownloads[url] = download;
+            startDownload = YES;
+
+            [download addCancellationToken:cancellationToken];
+        }
+
+        // read back under the same lock once the download completes, so every caller attached by then is honored
+        download.decodesImage = download.decodesImage || decodeImage;
+    }
+
+    if (startDownload) {
+        // transfers complete on the URL session's serial delegate queue, decode on the concurrent executor instead
+        [[self loadImageDataForDownload:download retriesLeft:retriesLeft] continueWithExecutor:[BFTask im_concurrentBackgroundExecutor]
+                                                                                    withBlock:^id(BFTask *task) {
+            BOOL decodeImage;
+            @synchronized (self->_imageDownloads) {
+                if (self->_imageDownloads[url] == download) {
+                    [self->_imageDownloads removeObjectForKey:url];
                 }
+
+                decodeImage = download.decodesImage;
+            }
+
+            if (task.cancelled || download.isCancelled) {
+                [download.taskCompletionSource cancel];
+            } else if (task.error) {
+                download.taskCompletionSource.error = task.error;
+            } else if (decodeImage) {
+                // decode once for every attached caller, skipped above when nobody is waiting for the image anymore
+                download.data = task.result;
+                download.taskCompletionSource.result = [IMImojiImageDecoder decodedImageWithData:download.data
+                                                                                maximumPixelSize:download.maximumPixelSize
+                                                                                     aspectRatio:download.aspectRatio
+                                                                                           scale:[UIScreen mainScreen].scale];
             } else {
-                taskCompletionSource.result = [YYImage imageWithData:(NSData *) urlTask.result scale:[UIScreen mainScreen].scale];
+                // only prefetches are attached, they keep the encoded bytes
+                download.data = task.result;
+                download.taskCompletionSource.result = nil;
             }
 
             return nil;
         }];
+    }
 
-        return nil;
+    return download;
+}
+
+- (BFTask *)loadImageDataForDownload:(IMImojiImageDownload *)download
+                         retriesLeft:(NSUInteger)retriesLeft {
+    // downloaded images persist across launches, keyed by the resolved URL so format and size fallbacks dedupe
+    NSData *storedData = [self->_imageDiskCache dataForURL:download.url];
+    if (storedData) {
+        return [BFTask taskWithResult:storedData];
+    }
+
+    return [[self downloadImageDataForDownload:download retriesLeft:retriesLeft] continueWithSuccessBlock:^id(BFTask *task) {
+        NSData *imageData = task.result;
+        if (imageData.length > 0) {
+            [self->_imageDiskCache setData:imageData forURL:download.url cancellationToken:download.cancellationToken];
+        }
+
+        return task;
     }];
+}
 
-    return taskCompletionSource.task;
+- (BFTask *)downloadImageDataForDownload:(IMImojiImageDownload *)download
+                             retriesLeft:(NSUInteger)retriesLeft {
+    if (download.isCancelled) {
+        return [BFTask cancelledTask];
+    }
+
+    return [[self->_retryPolicy runRequestWithURL:download.url
+                                   maximumRetries:retriesLeft
+                           minimumTimeoutInterval:IMImojiSessionMinimumImojiDownloadTimeout
+                                cancellationToken:download.cancellationToken
+                                 attemptScheduler:^BFTask *(BFTask *(^attempt)(void)) {
+                                     // only network transfers wait on the scheduler, disk hits are never held back by
+                                     // them, and each attempt gives its slot back before backing off
+                                     return [self->_downloadScheduler scheduleDownload:download withBlock:attempt];
+                                 }
+                                     requestBlock:^BFTask *(NSTimeInterval timeoutInterval) {
+                                         NSMutableURLRequest *request = [NSMutableURLRequest GETRequestWithURL:download.url parameters:@{}];
+                                         request.timeoutInterval = timeoutInterval;
+
+                                         return [self runExternalURLRequest:request
+                                                                    headers:@{}
+                                                          cancellationToken:download.cancellationToken];
+                                     }] continueWithBlock:^id(BFTask *urlTask) {
+        if (urlTask.cancelled || download.isCancelled) {
+            return [BFTask cancelledTask];
+        }
+
+        if (!urlTask.error) {
+            return urlTask;
+        }
+
+        return [BFTask taskWithError:[NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                         code:IMImojiSessionErrorCodeServerError
+                                                     userInfo:@{
+                                                             NSLocalizedDescriptionKey : [NSString stringWithFormat:@"Unable to download %@ error code: %@", download.url, @(urlTask.error.code)]
+                                                     }]];
+    }];
 }
 
 - (NSArray *)readCategories:(NSArray *)categories {
@@ -685,45 +1389,114 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
     return imojiCategories;
 }
 
+- (NSURL *)readUploadUrlFromCreateResponse:(NSDictionary *)response
+                                   imojiId:(NSString **)imojiId {
+    NSString *identifier = [response im_checkedStringForKey:@"imojiId"];
+    NSString *uploadUrl = [response im_checkedStringForKey:@"fullImageUrl"];
+    NSURL *url = uploadUrl ? [NSURL URLWithString:uploadUrl] : nil;
+
+    if (!identifier || !url) {
+        return nil;
+    }
+
+    *imojiId = identifier;
+    return url;
+}
+
 - (BFTask *)uploadImageInBackgroundWithRetries:(UIImage *)image
                                      uploadUrl:(NSURL *)uploadUrl
-                                    retryCount:(int)retryCount {
-    BFTaskCompletionSource *taskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+                                    retryCount:(int)retryCount
+                             cancellationToken:(NSOperation *)cancellationToken {
+    return [BFTask im_concurrentBackgroundTaskWithBlock:^id(BFTask *task) {
+        if (cancellationToken.isCancelled) {
+            return [BFTask cancelledTask];
+        }
 
-    [self uploadImageInBackgroundWithRetries:image uploadUrl:uploadUrl retryCount:retryCount taskCompletionSource:taskCompletionSource];
+        // encode once to disk, every attempt streams the same file
+        NSString *uploadsPath = [self.storagePolicy.cachePath.path stringByAppendingPathComponent:@"imoji-uploads"];
+        [[NSFileManager defaultManager] createDirectoryAtPath:uploadsPath withIntermediateDirectories:YES attributes:nil error:nil];
 
-    return taskCompletionSource.task;
+        NSURL *fileURL = [NSURL fileURLWithPath:[uploadsPath stringByAppendingPathComponent:[NSString im_stringWithRandomUUID]]];
+        NSError *error;
+        if (![UIImagePNGRepresentation(image) writeToURL:fileURL options:NSDataWritingAtomic error:&error]) {
+            return [BFTask taskWithError:error];
+        }
+
+        return [[self uploadImageFileInBackgroundWithRetries:fileURL
+                                                   uploadUrl:uploadUrl
+                                                  retryCount:retryCount
+                                           cancellationToken:cancellationToken] continueWithBlock:^id(BFTask *uploadTask) {
+            [self removeFile:fileURL.path];
+            return uploadTask;
+        }];
+    }];
 }
 
-- (void)uploadImageInBackgroundWithRetries:(UIImage *)image
-                                 uploadUrl:(NSURL *)uploadUrl
-                                retryCount:(int)retryCount
-                      taskCompletionSource:(BFTaskCompletionSource *)taskCompletionSource {
-    [BFTask im_concurrentBackgroundTaskWithBlock:^id(BFTask *task) {
-        NSMutableURLRequest *request = [NSMutableURLRequest new];
-
-        request.timeoutInterval = 15.0;
-        request.HTTPMethod = @"PUT";
-        request.URL = uploadUrl;
-
-        [request addValue:@"image/png" forHTTPHeaderField:@"Content-Type"];
-
-        [[self->_urlSession uploadTaskWithRequest:request
-                                         fromData:UIImagePNGRepresentation(image)
-                                completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
-                                    if (error) {
-                                        if (retryCount == 0) {
-                                            taskCompletionSource.error = error;
-                                        } else {
-                                            [self uploadImageInBackgroundWithRetries:image uploadUrl:uploadUrl retryCount:retryCount - 1 taskCompletionSource:taskCompletionSource];
-                                        }
-                                    } else {
-                                        taskCompletionSource.result = @YES;
-                                    }
-                                }] resume];
+- (BFTask *)uploadImageFileInBackgroundWithRetries:(NSURL *)fileURL
+                                         uploadUrl:(NSURL *)uploadUrl
+                                        retryCount:(int)retryCount
+                                 cancellationToken:(NSOperation *)cancellationToken {
+    NSString *contentType = [self contentTypeForImageFile:fileURL];
+
+    return [self->_retryPolicy runRequestWithURL:uploadUrl
+                                  maximumRetries:(NSUInteger) MAX(retryCount, 0)
+                          minimumTimeoutInterval:IMImojiSessionMinimumImageUploadTimeout
+                               cancellationToken:cancellationToken
+                                    requestBlock:^BFTask *(NSTimeInterval timeoutInterval) {
+                                        return [self uploadImageFile:fileURL
+                                                         contentType:contentType
+                                                           uploadUrl:uploadUrl
+                                                     timeoutInterval:timeoutInterval
+                                                   cancellationToken:cancellationToken];
+                                    }];
+}
 
-        return nil;
-    }];
+- (NSString *)contentTypeForImageFile:(NSURL *)fileURL {
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForReadingFromURL:fileURL error:nil];
+    NSData *header = [fileHandle readDataOfLength:16];
+    [fileHandle closeFile];
+
+    return header && YYImageDetectType((__bridge CFDataRef) header) == YYImageTypeWebP ? @"image/webp" : @"image/png";
+}
+
+- (BFTask *)uploadImageFile:(NSURL *)fileURL
+                contentType:(NSString *)contentType
+                  uploadUrl:(NSURL *)uploadUrl
+            timeoutInterval:(NSTimeInterval)timeoutInterval
+          cancellationToken:(NSOperation *)cancellationToken {
+    BFTaskCompletionSource *taskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:uploadUrl];
+
+    request.timeoutInterval = timeoutInterval;
+    request.HTTPMethod = @"PUT";
+    [request setValue:contentType forHTTPHeaderField:@"Content-Type"];
+
+    // streamed from disk, the payload is never loaded into memory. the upload endpoint has no way of reporting a
+    // partially received file, so every attempt sends the whole file
+    NSURLSessionUploadTask *uploadTask = [self->_urlSession uploadTaskWithRequest:request
+                                                                         fromFile:fileURL
+                                                                completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+                                                                    NSInteger statusCode = [response isKindOfClass:[NSHTTPURLResponse class]] ? ((NSHTTPURLResponse *) response).statusCode : 0;
+
+                                                                    if (error && [error.domain isEqualToString:NSURLErrorDomain] && error.code == NSURLErrorCancelled) {
+                                                                        [taskCompletionSource cancel];
+                                                                    } else if (error) {
+                                                                        taskCompletionSource.error = error;
+                                                                    } else if (statusCode >= 400) {
+                                                                        taskCompletionSource.error = [NSError errorWithDomain:IMImojiSessionErrorDomain
+                                                                                                                         code:IMImojiSessionErrorCodeServerError
+                                                                                                                     userInfo:@{
+                                                                                                                             NSLocalizedDescriptionKey : [NSString stringWithFormat:@"%@ returned status code %@", uploadUrl, @(statusCode)],
+                                                                                                                             @"statusCode" : @(statusCode)
+                                                                                                                     }];
+                                                                    } else {
+                                                                        taskCompletionSource.result = @YES;
+                                                                    }
+                                                                }];
+
+    [self resumeDataTask:uploadTask cancellationToken:cancellationToken];
+
+    return taskCompletionSource.task;
 }
 
 - (IMMutableImojiObject *)readImojiObject:(NSDictionary *)result {
@@ -737,17 +1510,15 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
 
         BOOL readLegacy = [result[@"urls"] isKindOfClass:[NSDictionary class]];
         NSDictionary *imagesDictionary = readLegacy ? result[@"urls"] : result[@"images"];
-        NSMutableDictionary *imageUrls = [NSMutableDictionary new];
-        NSMutableDictionary *fileSizes = [NSMutableDictionary new];
-        NSMutableDictionary *dimensions = [NSMutableDictionary new];
-        NSNull *nullValue = [NSNull null];
-
-        for (NSNumber *renderSize in @[@(IMImojiObjectRenderSizeThumbnail), @(IMImojiObjectRenderSizeFullResolution), @(IMImojiObjectRenderSize320), @(IMImojiObjectRenderSize512)]) {
-            for (NSNumber *borderStyle in @[@(IMImojiObjectBorderStyleSticker), @(IMImojiObjectBorderStyleNone)]) {
-                for (NSNumber *imageFormat in @[@(IMImojiObjectImageFormatWebP), @(IMImojiObjectImageFormatPNG), @(IMImojiObjectImageFormatAnimatedWebp), @(IMImojiObjectImageFormatAnimatedGif)]) {
-                    IMImojiObjectRenderingOptions *renderingOptions = [IMImojiObjectRenderingOptions optionsWithRenderSize:(IMImojiObjectRenderSize) renderSize.unsignedIntegerValue
-                                                                                                               borderStyle:(IMImojiObjectBorderStyle) borderStyle.unsignedIntegerValue
-                                                                                                               imageFormat:(IMImojiObjectImageFormat) imageFormat.unsignedIntegerValue];
+        IMImojiVariantTable *variants = [IMImojiVariantTable new];
+
+        // fill the table in place, missing variants are simply left empty
+        for (NSUInteger renderSizeValue = IMImojiObjectRenderSizeThumbnail; renderSizeValue <= IMImojiObjectRenderSize512; renderSizeValue++) {
+            for (NSUInteger borderStyleValue = IMImojiObjectBorderStyleSticker; borderStyleValue <= IMImojiObjectBorderStyleNone; borderStyleValue++) {
+                for (NSUInteger imageFormatValue = IMImojiObjectImageFormatPNG; imageFormatValue <= IMImojiObjectImageFormatAnimatedWebp; imageFormatValue++) {
+                    IMImojiObjectRenderSize renderSize = (IMImojiObjectRenderSize) renderSizeValue;
+                    IMImojiObjectBorderStyle borderStyle = (IMImojiObjectBorderStyle) borderStyleValue;
+                    IMImojiObjectImageFormat imageFormat = (IMImojiObjectImageFormat) imageFormatValue;
 
                     id path;
                     id url, width, height, fileSize;
@@ -755,7 +1526,7 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
 
                     // read the old response format, in cache some old results are fetched from NSCache
                     if (readLegacy) {
-                        switch (renderingOptions.imageFormat) {
+                        switch (imageFormat) {
                             case IMImojiObjectImageFormatPNG:
                                 path = imagesDictionary[@"png"];
                                 break;
@@ -776,12 +1547,11 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                         }
 
                         if (!path || ![path isKindOfClass:[NSDictionary class]]) {
-                            imageUrls[renderingOptions] = [NSNull null];
                             continue;
                         }
 
                         if (!animated) {
-                            switch (renderingOptions.borderStyle) {
+                            switch (borderStyle) {
                                 case IMImojiObjectBorderStyleSticker:
                                     break;
 
@@ -792,11 +1562,10 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                         }
 
                         if (!path || ![path isKindOfClass:[NSDictionary class]]) {
-                            imageUrls[renderingOptions] = [NSNull null];
                             continue;
                         }
 
-                        switch (renderingOptions.renderSize) {
+                        switch (renderSize) {
                             case IMImojiObjectRenderSizeThumbnail:
                                 if (animated) {
                                     url = path[@"150"][@"url"];
@@ -830,20 +1599,19 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                                 break;
                         }
                     } else {
-                        if (renderingOptions.imageFormat == IMImojiObjectImageFormatAnimatedGif || renderingOptions.imageFormat == IMImojiObjectImageFormatAnimatedWebp) {
+                        if (imageFormat == IMImojiObjectImageFormatAnimatedGif || imageFormat == IMImojiObjectImageFormatAnimatedWebp) {
                             path = imagesDictionary[@"animated"];
-                        } else if (renderingOptions.borderStyle == IMImojiObjectBorderStyleNone) {
+                        } else if (borderStyle == IMImojiObjectBorderStyleNone) {
                             path = imagesDictionary[@"unbordered"];
-                        } else if (renderingOptions.borderStyle == IMImojiObjectBorderStyleSticker) {
+                        } else if (borderStyle == IMImojiObjectBorderStyleSticker) {
                             path = imagesDictionary[@"bordered"];
                         }
 
                         if (!path || ![path isKindOfClass:[NSDictionary class]]) {
-                            imageUrls[renderingOptions] = fileSizes[renderingOptions] = dimensions[renderingOptions] = nullValue;
                             continue;
                         }
 
-                        switch (renderingOptions.imageFormat) {
+                        switch (imageFormat) {
                             case IMImojiObjectImageFormatPNG:
                                 path = path[@"png"];
                                 break;
@@ -859,7 +1627,7 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                                 break;
                         }
 
-                        switch (renderingOptions.renderSize) {
+                        switch (renderSize) {
                             case IMImojiObjectRenderSizeThumbnail:
                                 path = path[@"150"];
                                 break;
@@ -878,7 +1646,6 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                         }
 
                         if (!path || ![path isKindOfClass:[NSDictionary class]]) {
-                            imageUrls[renderingOptions] = fileSizes[renderingOptions] = dimensions[renderingOptions] = nullValue;
                             continue;
                         }
 
@@ -888,44 +1655,52 @@ NSUInteger const IMImojiSessionNumberOfRetriesForImojiDownload = 3;
                         fileSize = path[@"fileSize"];
                     }
 
-                    if ([url isKindOfClass:[NSString class]]) {
-                        imageUrls[renderingOptions] = [NSURL URLWithString:url];
-                    } else {
-                        imageUrls[renderingOptions] = nullValue;
+                    if (![url isKindOfClass:[NSString class]]) {
+                        continue;
                     }
 
+                    CGSize imageDimensions = CGSizeZero;
                     if ([width isKindOfClass:[NSNumber class]] && [height isKindOfClass:[NSNumber class]]) {
-                        NSNumber *widthValue = (NSNumber *) width;
-                        NSNumber *heightValue = (NSNumber *) height;
-                        if (widthValue.floatValue > 0 && heightValue.floatValue > 0) {
-                            dimensions[renderingOptions] = [NSValue valueWithCGSize:CGSizeMake(widthValue.floatValue, heightValue.floatValue)];
-                        } else {
-                            dimensions[renderingOptions] = nullValue;
-                        }
-                    } else {
-                        dimensions[renderingOptions] = nullValue;
+                        imageDimensions = CGSizeMake(((NSNumber *) width).floatValue, ((NSNumber *) height).floatValue);
                     }
 
+                    NSUInteger imageFileSize = 0;
                     if ([fileSize isKindOfClass:[NSNumber class]] && ((NSNumber *) fileSize).longValue > 0) {
-                        fileSizes[renderingOptions] = fileSize;
-                    } else {
-                        fileSizes[renderingOptions] = nullValue;
+                        imageFileSize = ((NSNumber *) fileSize).unsignedIntegerValue;
                     }
+
+                    [variants setURLString:url
+                                dimensions:imageDimensions
+                                  fileSize:imageFileSize
+                             forRenderSize:renderSize
+                               borderStyle:borderStyle
+                               imageFormat:imageFormat];
                 }
             }
         }
 
         return [IMMutableImojiObject imojiWithIdentifier:imojiId
                                                     tags:tags
-                                                    urls:imageUrls
-                                         imageDimensions:dimensions
-                                               fileSizes:fileSizes
+                                                variants:variants
                                             licenseStyle:licenseStyle];
     } else {
         return nil;
     }
 }
 
+- (IMMutableImojiObject *)readImojiRecord:(NSDictionary *)record {
+    IMMutableImojiObject *imoji = [self readImojiObject:record];
+
+    // remember imojis from search, featured and fetch results so lookups by identifier can skip the network. Other
+    // payloads such as artists reuse the imoji layout under their own identifiers and must not end up in here
+    NSString *imojiId = [record im_checkedStringForKey:@"imojiId"];
+    if (imoji && imojiId) {
+        [self->_imojiMetadataCache setObject:imoji forKey:imojiId];
+    }
+
+    return imoji;
+}
+
 - (nonnull IMCategoryAttribution *)readAttribution:(nonnull NSDictionary *)attributionDictionary {
     static NSDictionary *urlCategoryMappings;
     static dispatch_once_t token;
@@ -14,4 +14,15 @@
 
 - (BFTask *)randomAuthToken;
 
+/**
+ * Bytes of the prefetch budget held by prefetches in flight.
+ */
+- (NSUInteger)prefetchedBytes;
+
+/**
+ * Runs block while holding the lock prefetches take to give their bytes back, none of the prefetches started from
+ * block can finish before it returns.
+ */
+- (void)performWithPrefetchesHeld:(void (^)(void))block;
+
 @end
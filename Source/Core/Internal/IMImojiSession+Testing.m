@@ -19,4 +19,16 @@
     return [self writeAuthenticationCredentials];
 }
 
+- (NSUInteger)prefetchedBytes {
+    @synchronized (self->_prefetchOperations) {
+        return self->_prefetchedBytes;
+    }
+}
+
+- (void)performWithPrefetchesHeld:(void (^)(void))block {
+    @synchronized (self->_prefetchOperations) {
+        block();
+    }
+}
+
 @end
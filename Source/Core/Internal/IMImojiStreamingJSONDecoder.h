@@ -0,0 +1,58 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+* Called for every element of the streamed array as soon as its last byte has been received.
+*/
+typedef void (^IMImojiStreamingJSONDecoderRecordHandler)(NSDictionary *__nonnull record, NSUInteger index);
+
+/**
+* Incremental decoder for Imoji API responses shaped as a top level object holding one large array of records,
+* such as the results of /imoji/search and /imoji/featured/fetch. Bytes are fed in as they arrive from the network
+* and every element of the streamed array is handed to the record handler once complete, without waiting for the
+* rest of the payload. Only one record is ever buffered at a time. The remaining top level keys are decoded
+* individually and returned by finishWithError:.
+*/
+@interface IMImojiStreamingJSONDecoder : NSObject
+
+@property(nonatomic, readonly) NSUInteger recordCount;
+
+- (nonnull instancetype)initWithStreamedArrayKey:(nonnull NSString *)streamedArrayKey
+                                   recordHandler:(nonnull IMImojiStreamingJSONDecoderRecordHandler)recordHandler;
+
+/**
+* Consumes the next chunk of the payload. Record handlers are called synchronously from this method.
+* Returns NO if the payload is malformed, after which the decoder ignores any further input.
+*/
+- (BOOL)appendData:(nonnull NSData *)data error:(NSError *__nullable *__nullable)error;
+
+/**
+* Returns the top level object without the streamed array, or nil if the payload was truncated or malformed.
+*/
+- (nullable NSDictionary *)finishWithError:(NSError *__nullable *__nullable)error;
+
+@end
@@ -0,0 +1,346 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import "IMImojiStreamingJSONDecoder.h"
+#import "IMImojiSession.h"
+
+typedef NS_ENUM(NSUInteger, IMImojiStreamingJSONDecoderState) {
+    IMImojiStreamingJSONDecoderStateObjectStart,
+    IMImojiStreamingJSONDecoderStateKeyOrObjectEnd,
+    IMImojiStreamingJSONDecoderStateKey,
+    IMImojiStreamingJSONDecoderStateColon,
+    IMImojiStreamingJSONDecoderStateValueStart,
+    IMImojiStreamingJSONDecoderStateValue,
+    IMImojiStreamingJSONDecoderStateCommaOrObjectEnd,
+    IMImojiStreamingJSONDecoderStateElementOrArrayEnd,
+    IMImojiStreamingJSONDecoderStateElement,
+    IMImojiStreamingJSONDecoderStateCommaOrArrayEnd,
+    IMImojiStreamingJSONDecoderStateDone,
+    IMImojiStreamingJSONDecoderStateFailed
+};
+
+@implementation IMImojiStreamingJSONDecoder {
+    NSString *_streamedArrayKey;
+    IMImojiStreamingJSONDecoderRecordHandler _recordHandler;
+    NSMutableData *_buffer;
+    NSMutableDictionary *_topLevelObject;
+    NSString *_currentKey;
+    IMImojiStreamingJSONDecoderState _state;
+
+    // offset of the first unread byte and the byte where the value currently being captured begins, relative to _buffer
+    NSUInteger _scanOffset;
+    NSUInteger _captureOffset;
+    NSUInteger _captureNesting;
+    BOOL _captureInString;
+    BOOL _captureEscaped;
+    NSUInteger _consumedBytes;
+}
+
+- (instancetype)initWithStreamedArrayKey:(NSString *)streamedArrayKey
+                           recordHandler:(IMImojiStreamingJSONDecoderRecordHandler)recordHandler {
+    self = [super init];
+    if (self) {
+        _streamedArrayKey = [streamedArrayKey copy];
+        _recordHandler = [recordHandler copy];
+        _buffer = [NSMutableData new];
+        _topLevelObject = [NSMutableDictionary new];
+        _state = IMImojiStreamingJSONDecoderStateObjectStart;
+    }
+
+    return self;
+}
+
+- (BOOL)appendData:(NSData *)data error:(NSError **)error {
+    if (_state == IMImojiStreamingJSONDecoderStateFailed) {
+        [self fillError:error];
+        return NO;
+    }
+
+    [_buffer appendData:data];
+
+    const uint8_t *bytes = _buffer.bytes;
+    NSUInteger length = _buffer.length;
+
+    while (_scanOffset < length) {
+        uint8_t c = bytes[_scanOffset];
+        BOOL whitespace = c == ' ' || c == '\n' || c == '\r' || c == '\t';
+
+        switch (_state) {
+            case IMImojiStreamingJSONDecoderStateObjectStart:
+                if (c == '{') {
+                    _state = IMImojiStreamingJSONDecoderStateKeyOrObjectEnd;
+                } else if (!whitespace) {
+                    return [self failWithError:error];
+                }
+                _scanOffset++;
+                break;
+
+            case IMImojiStreamingJSONDecoderStateKeyOrObjectEnd:
+                if (c == '"') {
+                    [self beginCaptureWithState:IMImojiStreamingJSONDecoderStateKey];
+                } else if (c == '}') {
+                    _state = IMImojiStreamingJSONDecoderStateDone;
+                    _scanOffset++;
+                } else if (whitespace) {
+                    _scanOffset++;
+                } else {
+                    return [self failWithError:error];
+                }
+                break;
+
+            case IMImojiStreamingJSONDecoderStateColon:
+                if (c == ':') {
+                    _state = IMImojiStreamingJSONDecoderStateValueStart;
+                } else if (!whitespace) {
+                    return [self failWithError:error];
+                }
+                _scanOffset++;
+                break;
+
+            case IMImojiStreamingJSONDecoderStateValueStart:
+                if (whitespace) {
+                    _scanOffset++;
+                } else if (c == '[' && [_streamedArrayKey isEqualToString:_currentKey]) {
+                    _state = IMImojiStreamingJSONDecoderStateElementOrArrayEnd;
+                    _scanOffset++;
+                } else {
+                    [self beginCaptureWithState:IMImojiStreamingJSONDecoderStateValue];
+                }
+                break;
+
+            case IMImojiStreamingJSONDecoderStateCommaOrObjectEnd:
+                if (c == ',') {
+                    _state = IMImojiStreamingJSONDecoderStateKeyOrObjectEnd;
+                } else if (c == '}') {
+                    _state = IMImojiStreamingJSONDecoderStateDone;
+                } else if (!whitespace) {
+                    return [self failWithError:error];
+                }
+                _scanOffset++;
+                break;
+
+            case IMImojiStreamingJSONDecoderStateElementOrArrayEnd:
+                if (c == ']') {
+                    _state = IMImojiStreamingJSONDecoderStateCommaOrObjectEnd;
+                    _scanOffset++;
+                } else if (whitespace) {
+                    _scanOffset++;
+                } else {
+                    [self beginCaptureWithState:IMImojiStreamingJSONDecoderStateElement];
+                }
+                break;
+
+            case IMImojiStreamingJSONDecoderStateCommaOrArrayEnd:
+                if (c == ',') {
+                    _state = IMImojiStreamingJSONDecoderStateElementOrArrayEnd;
+                } else if (c == ']') {
+                    _state = IMImojiStreamingJSONDecoderStateCommaOrObjectEnd;
+                } else if (!whitespace) {
+                    return [self failWithError:error];
+                }
+                _scanOffset++;
+                break;
+
+            case IMImojiStreamingJSONDecoderStateKey:
+            case IMImojiStreamingJSONDecoderStateValue:
+            case IMImojiStreamingJSONDecoderStateElement:
+                if ([self scanCapturedByte:c] && ![self completeCapture]) {
+                    return [self failWithError:error];
+                }
+                break;
+
+            case IMImojiStreamingJSONDecoderStateDone:
+                if (!whitespace) {
+                    return [self failWithError:error];
+                }
+                _scanOffset++;
+                break;
+
+            case IMImojiStreamingJSONDecoderStateFailed:
+                return [self failWithError:error];
+        }
+    }
+
+    [self discardConsumedBytes];
+
+    return YES;
+}
+
+- (NSDictionary *)finishWithError:(NSError **)error {
+    if (_state != IMImojiStreamingJSONDecoderStateDone) {
+        // a scalar value at the very end of the payload has no terminator to complete it, which is never valid here
+        [self failWithError:error];
+        return nil;
+    }
+
+    return _topLevelObject;
+}
+
+#pragma mark Value Capturing
+
+- (void)beginCaptureWithState:(IMImojiStreamingJSONDecoderState)state {
+    _state = state;
+    _captureOffset = _scanOffset;
+    _captureNesting = 0;
+    _captureInString = NO;
+    _captureEscaped = NO;
+}
+
+/**
+* Advances over a byte belonging to the value being captured. Returns YES once the value is complete, in which case
+* _scanOffset points just past its last byte.
+*/
+- (BOOL)scanCapturedByte:(uint8_t)c {
+    if (_captureInString) {
+        _scanOffset++;
+
+        if (_captureEscaped) {
+            _captureEscaped = NO;
+        } else if (c == '\\') {
+            _captureEscaped = YES;
+        } else if (c == '"') {
+            _captureInString = NO;
+            return _captureNesting == 0;
+        }
+
+        return NO;
+    }
+
+    switch (c) {
+        case '"':
+            _captureInString = YES;
+            _scanOffset++;
+            return NO;
+
+        case '{':
+        case '[':
+            _captureNesting++;
+            _scanOffset++;
+            return NO;
+
+        case '}':
+        case ']':
+            if (_captureNesting == 0) {
+                // terminates a bare scalar, leave the byte for the enclosing state. An empty capture fails to decode
+                return YES;
+            }
+
+            _scanOffset++;
+            return --_captureNesting == 0;
+
+        case ',':
+        case ' ':
+        case '\n':
+        case '\r':
+        case '\t':
+            if (_captureNesting == 0) {
+                return YES;
+            }
+
+            _scanOffset++;
+            return NO;
+
+        default:
+            _scanOffset++;
+            return NO;
+    }
+}
+
+- (BOOL)completeCapture {
+    NSData *valueData = [NSData dataWithBytesNoCopy:(uint8_t *) _buffer.bytes + _captureOffset
+                                             length:_scanOffset - _captureOffset
+                                       freeWhenDone:NO];
+
+    id value = [NSJSONSerialization JSONObjectWithData:valueData options:NSJSONReadingAllowFragments error:nil];
+    if (!value) {
+        return NO;
+    }
+
+    switch (_state) {
+        case IMImojiStreamingJSONDecoderStateKey:
+            if (![value isKindOfClass:[NSString class]]) {
+                return NO;
+            }
+
+            _currentKey = value;
+            _state = IMImojiStreamingJSONDecoderStateColon;
+            break;
+
+        case IMImojiStreamingJSONDecoderStateValue:
+            _topLevelObject[_currentKey] = value;
+            _state = IMImojiStreamingJSONDecoderStateCommaOrObjectEnd;
+            break;
+
+        case IMImojiStreamingJSONDecoderStateElement:
+            if ([value isKindOfClass:[NSDictionary class]]) {
+                _recordHandler(value, _recordCount++);
+            }
+
+            _state = IMImojiStreamingJSONDecoderStateCommaOrArrayEnd;
+            break;
+
+        default:
+            return NO;
+    }
+
+    return YES;
+}
+
+- (void)discardConsumedBytes {
+    BOOL capturing = _state == IMImojiStreamingJSONDecoderStateKey ||
+            _state == IMImojiStreamingJSONDecoderStateValue ||
+            _state == IMImojiStreamingJSONDecoderStateElement;
+
+    NSUInteger discardLength = capturing ? _captureOffset : _scanOffset;
+    if (discardLength == 0) {
+        return;
+    }
+
+    [_buffer replaceBytesInRange:NSMakeRange(0, discardLength) withBytes:NULL length:0];
+    _consumedBytes += discardLength;
+    _scanOffset -= discardLength;
+    _captureOffset = capturing ? 0 : _captureOffset;
+}
+
+#pragma mark Errors
+
+- (BOOL)failWithError:(NSError **)error {
+    _state = IMImojiStreamingJSONDecoderStateFailed;
+    [self fillError:error];
+
+    return NO;
+}
+
+- (void)fillError:(NSError **)error {
+    if (error) {
+        *error = [NSError errorWithDomain:IMImojiSessionErrorDomain
+                                     code:IMImojiSessionErrorCodeServerError
+                                 userInfo:@{
+                                         NSLocalizedDescriptionKey : [NSString stringWithFormat:@"Malformed server response near byte %@", @(_consumedBytes + _scanOffset)]
+                                 }];
+    }
+}
+
+@end
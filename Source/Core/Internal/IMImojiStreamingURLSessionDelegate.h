@@ -0,0 +1,49 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+@class IMImojiStreamingJSONDecoder;
+
+/**
+* Called once the streamed request finishes. result is set when a successful response was decoded in full, bufferedData
+* holds the body of any other response so the caller can read the server's error from it.
+*/
+typedef void (^IMImojiStreamingURLSessionCompletionHandler)(NSDictionary *__nullable result, NSData *__nullable bufferedData, NSURLResponse *__nullable response, NSError *__nullable error);
+
+/**
+* Session delegate feeding the bytes of registered data tasks into an IMImojiStreamingJSONDecoder as they arrive.
+* Tasks created with a completion handler never reach the data delegate methods and are unaffected.
+*/
+@interface IMImojiStreamingURLSessionDelegate : NSObject <NSURLSessionDataDelegate>
+
+/**
+* Must be called before the task is resumed.
+*/
+- (void)registerDataTask:(nonnull NSURLSessionDataTask *)dataTask
+                 decoder:(nonnull IMImojiStreamingJSONDecoder *)decoder
+       completionHandler:(nonnull IMImojiStreamingURLSessionCompletionHandler)completionHandler;
+
+@end
@@ -0,0 +1,130 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import "IMImojiStreamingURLSessionDelegate.h"
+#import "IMImojiStreamingJSONDecoder.h"
+
+@interface IMImojiStreamingDataTask : NSObject
+
+@property(nonatomic, strong) IMImojiStreamingJSONDecoder *decoder;
+@property(nonatomic, copy) IMImojiStreamingURLSessionCompletionHandler completionHandler;
+@property(nonatomic, strong) NSMutableData *bufferedData;
+@property(nonatomic, strong) NSError *decodingError;
+
+@end
+
+@implementation IMImojiStreamingDataTask
+@end
+
+@implementation IMImojiStreamingURLSessionDelegate {
+    NSMutableDictionary *_dataTasks;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _dataTasks = [NSMutableDictionary new];
+    }
+
+    return self;
+}
+
+- (void)registerDataTask:(NSURLSessionDataTask *)dataTask
+                 decoder:(IMImojiStreamingJSONDecoder *)decoder
+       completionHandler:(IMImojiStreamingURLSessionCompletionHandler)completionHandler {
+    IMImojiStreamingDataTask *streamingDataTask = [IMImojiStreamingDataTask new];
+    streamingDataTask.decoder = decoder;
+    streamingDataTask.completionHandler = completionHandler;
+
+    @synchronized (_dataTasks) {
+        _dataTasks[@(dataTask.taskIdentifier)] = streamingDataTask;
+    }
+}
+
+- (IMImojiStreamingDataTask *)streamingDataTaskForTask:(NSURLSessionTask *)task remove:(BOOL)remove {
+    @synchronized (_dataTasks) {
+        IMImojiStreamingDataTask *streamingDataTask = _dataTasks[@(task.taskIdentifier)];
+        if (remove) {
+            [_dataTasks removeObjectForKey:@(task.taskIdentifier)];
+        }
+
+        return streamingDataTask;
+    }
+}
+
+#pragma mark NSURLSessionDataDelegate
+
+- (void)URLSession:(NSURLSession *)session
+          dataTask:(NSURLSessionDataTask *)dataTask
+didReceiveResponse:(NSURLResponse *)response
+ completionHandler:(void (^)(NSURLSessionResponseDisposition disposition))completionHandler {
+    IMImojiStreamingDataTask *streamingDataTask = [self streamingDataTaskForTask:dataTask remove:NO];
+
+    // only successful responses are streamed, anything else is buffered for the caller to inspect
+    if (streamingDataTask &&
+            [response isKindOfClass:[NSHTTPURLResponse class]] && ((NSHTTPURLResponse *) response).statusCode != 200) {
+        streamingDataTask.bufferedData = [NSMutableData data];
+    }
+
+    completionHandler(NSURLSessionResponseAllow);
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    IMImojiStreamingDataTask *streamingDataTask = [self streamingDataTaskForTask:dataTask remove:NO];
+    if (!streamingDataTask || streamingDataTask.decodingError) {
+        return;
+    }
+
+    if (streamingDataTask.bufferedData) {
+        [streamingDataTask.bufferedData appendData:data];
+        return;
+    }
+
+    NSError *error;
+    if (![streamingDataTask.decoder appendData:data error:&error]) {
+        streamingDataTask.decodingError = error;
+        [dataTask cancel];
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
+    IMImojiStreamingDataTask *streamingDataTask = [self streamingDataTaskForTask:task remove:YES];
+    if (!streamingDataTask) {
+        return;
+    }
+
+    if (streamingDataTask.decodingError) {
+        streamingDataTask.completionHandler(nil, nil, task.response, streamingDataTask.decodingError);
+    } else if (error || streamingDataTask.bufferedData) {
+        streamingDataTask.completionHandler(nil, streamingDataTask.bufferedData, task.response, error);
+    } else {
+        NSError *decodingError;
+        NSDictionary *result = [streamingDataTask.decoder finishWithError:&decodingError];
+
+        streamingDataTask.completionHandler(result, nil, task.response, decodingError);
+    }
+}
+
+@end
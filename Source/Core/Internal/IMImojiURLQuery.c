@@ -0,0 +1,147 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#include "IMImojiURLQuery.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+static const char IMURLQueryHexDigits[] = "0123456789ABCDEF";
+
+// non zero for the RFC 3986 unreserved characters, which are the only ones written as is
+static const unsigned char IMURLQueryUnreserved[256] = {
+        ['-'] = 1, ['.'] = 1, ['_'] = 1, ['~'] = 1,
+        ['0'] = 1, ['1'] = 1, ['2'] = 1, ['3'] = 1, ['4'] = 1, ['5'] = 1, ['6'] = 1, ['7'] = 1, ['8'] = 1, ['9'] = 1,
+        ['A'] = 1, ['B'] = 1, ['C'] = 1, ['D'] = 1, ['E'] = 1, ['F'] = 1, ['G'] = 1, ['H'] = 1, ['I'] = 1, ['J'] = 1,
+        ['K'] = 1, ['L'] = 1, ['M'] = 1, ['N'] = 1, ['O'] = 1, ['P'] = 1, ['Q'] = 1, ['R'] = 1, ['S'] = 1, ['T'] = 1,
+        ['U'] = 1, ['V'] = 1, ['W'] = 1, ['X'] = 1, ['Y'] = 1, ['Z'] = 1,
+        ['a'] = 1, ['b'] = 1, ['c'] = 1, ['d'] = 1, ['e'] = 1, ['f'] = 1, ['g'] = 1, ['h'] = 1, ['i'] = 1, ['j'] = 1,
+        ['k'] = 1, ['l'] = 1, ['m'] = 1, ['n'] = 1, ['o'] = 1, ['p'] = 1, ['q'] = 1, ['r'] = 1, ['s'] = 1, ['t'] = 1,
+        ['u'] = 1, ['v'] = 1, ['w'] = 1, ['x'] = 1, ['y'] = 1, ['z'] = 1
+};
+
+static IMImojiURLQueryStatus IMURLQueryReserve(IMImojiURLQuery *query, size_t additional) {
+    if (additional <= query->capacity - query->length) {
+        return IMImojiURLQueryStatusSuccess;
+    }
+
+    size_t capacity = query->capacity > 0 ? query->capacity : 64;
+    while (capacity - query->length < additional) {
+        if (capacity > SIZE_MAX / 2) {
+            return IMImojiURLQueryStatusOutOfMemory;
+        }
+        capacity *= 2;
+    }
+
+    char *bytes = realloc(query->bytes, capacity);
+    if (!bytes) {
+        return IMImojiURLQueryStatusOutOfMemory;
+    }
+
+    query->bytes = bytes;
+    query->capacity = capacity;
+    return IMImojiURLQueryStatusSuccess;
+}
+
+IMImojiURLQueryStatus IMImojiURLQueryInit(IMImojiURLQuery *query, size_t capacity) {
+    if (!query) {
+        return IMImojiURLQueryStatusInvalidArgument;
+    }
+
+    query->bytes = NULL;
+    query->length = 0;
+    query->capacity = 0;
+
+    return capacity > 0 ? IMURLQueryReserve(query, capacity) : IMImojiURLQueryStatusSuccess;
+}
+
+size_t IMImojiURLPercentEncode(char *dst, const char *src, size_t length) {
+    const unsigned char *bytes = (const unsigned char *) src;
+    char *out = dst;
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = bytes[i];
+        if (IMURLQueryUnreserved[c]) {
+            *out++ = (char) c;
+        } else {
+            out[0] = '%';
+            out[1] = IMURLQueryHexDigits[c >> 4];
+            out[2] = IMURLQueryHexDigits[c & 0xF];
+            out += 3;
+        }
+    }
+
+    return (size_t) (out - dst);
+}
+
+IMImojiURLQueryStatus IMImojiURLQueryAppend(IMImojiURLQuery *query,
+                                            const char *key,
+                                            size_t keyLength,
+                                            const char *value,
+                                            size_t valueLength,
+                                            int arraySyntax) {
+    if (!query || (!key && keyLength > 0) || (!value && valueLength > 0)) {
+        return IMImojiURLQueryStatusInvalidArgument;
+    }
+
+    // worst case every byte is escaped, plus the separators
+    const size_t maximumLength = (SIZE_MAX - 8) / 3;
+    if (valueLength > maximumLength || keyLength > maximumLength - valueLength) {
+        return IMImojiURLQueryStatusOutOfMemory;
+    }
+
+    IMImojiURLQueryStatus status = IMURLQueryReserve(query, (keyLength + valueLength) * 3 + 8);
+    if (status != IMImojiURLQueryStatusSuccess) {
+        return status;
+    }
+
+    char *out = query->bytes + query->length;
+    if (query->length > 0) {
+        *out++ = '&';
+    }
+
+    out += IMImojiURLPercentEncode(out, key, keyLength);
+    if (arraySyntax) {
+        // the brackets are written as is, as the Objective-C implementation always did
+        *out++ = '[';
+        *out++ = ']';
+    }
+    *out++ = '=';
+    out += IMImojiURLPercentEncode(out, value, valueLength);
+
+    query->length = (size_t) (out - query->bytes);
+    return IMImojiURLQueryStatusSuccess;
+}
+
+void IMImojiURLQueryDestroy(IMImojiURLQuery *query) {
+    if (!query) {
+        return;
+    }
+
+    free(query->bytes);
+    query->bytes = NULL;
+    query->length = 0;
+    query->capacity = 0;
+}
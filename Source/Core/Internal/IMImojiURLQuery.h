@@ -0,0 +1,80 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#ifndef IMImojiURLQuery_h
+#define IMImojiURLQuery_h
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Builds URL query strings from UTF-8 keys and values, written in portable C so it can be built and benchmarked outside
+ * of Xcode. Everything except ASCII letters, digits and -._~ is percent encoded with uppercase hex digits, the same
+ * output CFURLCreateStringByAddingPercentEscapes produces for the escape set used by RequestUtils.
+ */
+typedef struct {
+    /** Encoded query, not NUL terminated. Owned by the query until IMImojiURLQueryDestroy or taken by the caller. */
+    char *bytes;
+    size_t length;
+    size_t capacity;
+} IMImojiURLQuery;
+
+typedef enum {
+    IMImojiURLQueryStatusSuccess = 0,
+    IMImojiURLQueryStatusInvalidArgument,
+    IMImojiURLQueryStatusOutOfMemory
+} IMImojiURLQueryStatus;
+
+/**
+ * Starts an empty query. capacity is a hint for the encoded length, pass 0 to grow on demand.
+ */
+IMImojiURLQueryStatus IMImojiURLQueryInit(IMImojiURLQuery *query, size_t capacity);
+
+/**
+ * Appends key=value, separated from the previous pair with &. Both are percent encoded. With arraySyntax the key is
+ * written as key[].
+ */
+IMImojiURLQueryStatus IMImojiURLQueryAppend(IMImojiURLQuery *query,
+                                            const char *key,
+                                            size_t keyLength,
+                                            const char *value,
+                                            size_t valueLength,
+                                            int arraySyntax);
+
+/**
+ * Percent encodes length bytes of src into dst, which must hold at least 3 * length bytes. Returns the encoded length.
+ */
+size_t IMImojiURLPercentEncode(char *dst, const char *src, size_t length);
+
+void IMImojiURLQueryDestroy(IMImojiURLQuery *query);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IMImojiURLQuery_h */
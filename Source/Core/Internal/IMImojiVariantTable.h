@@ -0,0 +1,90 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+#import "IMImojiObjectRenderingOptions.h"
+
+/**
+* Number of renderSize, borderStyle and imageFormat combinations published for an Imoji.
+*/
+extern NSUInteger const IMImojiVariantTableCount;
+
+/**
+* Fixed layout table of the image variants published for an Imoji, indexed directly by the
+* (renderSize, borderStyle, imageFormat) triple. URLs are stored as strings and only converted to NSURL's when
+* requested. Missing variants have a nil URL, CGSizeZero dimensions and a file size of 0.
+*/
+@interface IMImojiVariantTable : NSObject <NSCopying>
+
+/**
+* Returns NSNotFound if any of the values are out of range.
+*/
++ (NSUInteger)indexForRenderSize:(IMImojiObjectRenderSize)renderSize
+                     borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                     imageFormat:(IMImojiObjectImageFormat)imageFormat;
+
+- (void)setURLString:(nullable NSString *)urlString
+          dimensions:(CGSize)dimensions
+            fileSize:(NSUInteger)fileSize
+       forRenderSize:(IMImojiObjectRenderSize)renderSize
+         borderStyle:(IMImojiObjectBorderStyle)borderStyle
+         imageFormat:(IMImojiObjectImageFormat)imageFormat;
+
+- (nullable NSString *)urlStringForRenderSize:(IMImojiObjectRenderSize)renderSize
+                                  borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                                  imageFormat:(IMImojiObjectImageFormat)imageFormat;
+
+- (nullable NSURL *)urlForRenderSize:(IMImojiObjectRenderSize)renderSize
+                         borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                         imageFormat:(IMImojiObjectImageFormat)imageFormat;
+
+- (CGSize)dimensionsForRenderSize:(IMImojiObjectRenderSize)renderSize
+                      borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                      imageFormat:(IMImojiObjectImageFormat)imageFormat;
+
+- (NSUInteger)fileSizeForRenderSize:(IMImojiObjectRenderSize)renderSize
+                        borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                        imageFormat:(IMImojiObjectImageFormat)imageFormat;
+
+/**
+* Dictionary representations keyed by IMImojiObjectRenderingOptions with NSNull for missing values, as exposed by
+* IMImojiObject's urls, imageDimensions and fileSizes properties. Each one is built the first time it's requested and
+* kept until a variant is set.
+*/
+- (nonnull NSDictionary *)urlsDictionary;
+
+- (nonnull NSDictionary *)imageDimensionsDictionary;
+
+- (nonnull NSDictionary *)fileSizesDictionary;
+
+/**
+* Builds a table from the dictionary representations.
+*/
++ (nonnull instancetype)tableWithURLs:(nullable NSDictionary *)urls
+                      imageDimensions:(nullable NSDictionary *)imageDimensions
+                            fileSizes:(nullable NSDictionary *)fileSizes;
+
+@end
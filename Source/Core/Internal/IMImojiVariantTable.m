@@ -0,0 +1,231 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+#import <CoreGraphics/CoreGraphics.h>
+#import "IMImojiVariantTable.h"
+
+// IMImojiObjectRenderSize512 + 1, IMImojiObjectBorderStyleNone + 1, IMImojiObjectImageFormatAnimatedWebp + 1
+#define IMImojiVariantTableRenderSizes 4
+#define IMImojiVariantTableBorderStyles 2
+#define IMImojiVariantTableImageFormats 4
+#define IMImojiVariantTableEntries (IMImojiVariantTableRenderSizes * IMImojiVariantTableBorderStyles * IMImojiVariantTableImageFormats)
+
+NSUInteger const IMImojiVariantTableCount = IMImojiVariantTableEntries;
+
+typedef struct {
+    float width;
+    float height;
+    uint32_t fileSize;
+} IMImojiVariantMetrics;
+
+@implementation IMImojiVariantTable {
+    __strong NSString *_urlStrings[IMImojiVariantTableEntries];
+    IMImojiVariantMetrics _metrics[IMImojiVariantTableEntries];
+
+    // dictionary representations built on first use, cleared whenever a variant is set
+    NSDictionary *_urlsDictionary;
+    NSDictionary *_imageDimensionsDictionary;
+    NSDictionary *_fileSizesDictionary;
+}
+
++ (NSUInteger)indexForRenderSize:(IMImojiObjectRenderSize)renderSize
+                     borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                     imageFormat:(IMImojiObjectImageFormat)imageFormat {
+    if (renderSize >= IMImojiVariantTableRenderSizes ||
+            borderStyle >= IMImojiVariantTableBorderStyles ||
+            imageFormat >= IMImojiVariantTableImageFormats) {
+        return NSNotFound;
+    }
+
+    return (renderSize * IMImojiVariantTableBorderStyles + borderStyle) * IMImojiVariantTableImageFormats + imageFormat;
+}
+
+- (void)setURLString:(NSString *)urlString
+          dimensions:(CGSize)dimensions
+            fileSize:(NSUInteger)fileSize
+       forRenderSize:(IMImojiObjectRenderSize)renderSize
+         borderStyle:(IMImojiObjectBorderStyle)borderStyle
+         imageFormat:(IMImojiObjectImageFormat)imageFormat {
+    NSUInteger index = [IMImojiVariantTable indexForRenderSize:renderSize borderStyle:borderStyle imageFormat:imageFormat];
+    if (index == NSNotFound) {
+        return;
+    }
+
+    @synchronized (self) {
+        _urlsDictionary = nil;
+        _imageDimensionsDictionary = nil;
+        _fileSizesDictionary = nil;
+    }
+
+    _urlStrings[index] = [urlString copy];
+    _metrics[index].width = dimensions.width > 0 && dimensions.height > 0 ? (float) dimensions.width : 0;
+    _metrics[index].height = dimensions.width > 0 && dimensions.height > 0 ? (float) dimensions.height : 0;
+    _metrics[index].fileSize = fileSize > UINT32_MAX ? UINT32_MAX : (uint32_t) fileSize;
+}
+
+- (NSString *)urlStringForRenderSize:(IMImojiObjectRenderSize)renderSize
+                         borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                         imageFormat:(IMImojiObjectImageFormat)imageFormat {
+    NSUInteger index = [IMImojiVariantTable indexForRenderSize:renderSize borderStyle:borderStyle imageFormat:imageFormat];
+    return index != NSNotFound ? _urlStrings[index] : nil;
+}
+
+- (NSURL *)urlForRenderSize:(IMImojiObjectRenderSize)renderSize
+                borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                imageFormat:(IMImojiObjectImageFormat)imageFormat {
+    NSString *urlString = [self urlStringForRenderSize:renderSize borderStyle:borderStyle imageFormat:imageFormat];
+    return urlString ? [NSURL URLWithString:urlString] : nil;
+}
+
+- (CGSize)dimensionsForRenderSize:(IMImojiObjectRenderSize)renderSize
+                      borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                      imageFormat:(IMImojiObjectImageFormat)imageFormat {
+    NSUInteger index = [IMImojiVariantTable indexForRenderSize:renderSize borderStyle:borderStyle imageFormat:imageFormat];
+    return index != NSNotFound ? CGSizeMake(_metrics[index].width, _metrics[index].height) : CGSizeZero;
+}
+
+- (NSUInteger)fileSizeForRenderSize:(IMImojiObjectRenderSize)renderSize
+                        borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                        imageFormat:(IMImojiObjectImageFormat)imageFormat {
+    NSUInteger index = [IMImojiVariantTable indexForRenderSize:renderSize borderStyle:borderStyle imageFormat:imageFormat];
+    return index != NSNotFound ? _metrics[index].fileSize : 0;
+}
+
+#pragma mark Dictionary Representations
+
+- (NSDictionary *)dictionaryWithValueBlock:(id (^)(NSUInteger index))valueBlock {
+    NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithCapacity:IMImojiVariantTableEntries];
+    NSNull *nullValue = [NSNull null];
+
+    for (NSUInteger renderSize = 0; renderSize < IMImojiVariantTableRenderSizes; renderSize++) {
+        for (NSUInteger borderStyle = 0; borderStyle < IMImojiVariantTableBorderStyles; borderStyle++) {
+            for (NSUInteger imageFormat = 0; imageFormat < IMImojiVariantTableImageFormats; imageFormat++) {
+                NSUInteger index = (renderSize * IMImojiVariantTableBorderStyles + borderStyle) * IMImojiVariantTableImageFormats + imageFormat;
+                id value = valueBlock(index);
+
+                dictionary[[IMImojiObjectRenderingOptions optionsWithRenderSize:(IMImojiObjectRenderSize) renderSize
+                                                                    borderStyle:(IMImojiObjectBorderStyle) borderStyle
+                                                                    imageFormat:(IMImojiObjectImageFormat) imageFormat]] = value ? value : nullValue;
+            }
+        }
+    }
+
+    return [dictionary copy];
+}
+
+- (NSDictionary *)urlsDictionary {
+    @synchronized (self) {
+        if (!_urlsDictionary) {
+            _urlsDictionary = [self dictionaryWithValueBlock:^id(NSUInteger index) {
+                return self->_urlStrings[index] ? [NSURL URLWithString:self->_urlStrings[index]] : nil;
+            }];
+        }
+
+        return _urlsDictionary;
+    }
+}
+
+- (NSDictionary *)imageDimensionsDictionary {
+    @synchronized (self) {
+        if (!_imageDimensionsDictionary) {
+            _imageDimensionsDictionary = [self dictionaryWithValueBlock:^id(NSUInteger index) {
+                IMImojiVariantMetrics metrics = self->_metrics[index];
+                if (metrics.width <= 0 || metrics.height <= 0) {
+                    return nil;
+                }
+
+                // the same value [NSValue valueWithCGSize:] creates, without depending on UIKit
+                CGSize dimensions = CGSizeMake(metrics.width, metrics.height);
+                return [NSValue valueWithBytes:&dimensions objCType:@encode(CGSize)];
+            }];
+        }
+
+        return _imageDimensionsDictionary;
+    }
+}
+
+- (NSDictionary *)fileSizesDictionary {
+    @synchronized (self) {
+        if (!_fileSizesDictionary) {
+            _fileSizesDictionary = [self dictionaryWithValueBlock:^id(NSUInteger index) {
+                return self->_metrics[index].fileSize > 0 ? @(self->_metrics[index].fileSize) : nil;
+            }];
+        }
+
+        return _fileSizesDictionary;
+    }
+}
+
++ (instancetype)tableWithURLs:(NSDictionary *)urls
+              imageDimensions:(NSDictionary *)imageDimensions
+                    fileSizes:(NSDictionary *)fileSizes {
+    IMImojiVariantTable *table = [IMImojiVariantTable new];
+
+    for (IMImojiObjectRenderingOptions *options in urls) {
+        id url = urls[options];
+        id dimensions = imageDimensions[options];
+        id fileSize = fileSizes[options];
+
+        if (![options isKindOfClass:[IMImojiObjectRenderingOptions class]] || ![url isKindOfClass:[NSURL class]]) {
+            continue;
+        }
+
+        CGSize size = CGSizeZero;
+        if ([dimensions isKindOfClass:[NSValue class]] && strcmp(((NSValue *) dimensions).objCType, @encode(CGSize)) == 0) {
+            [(NSValue *) dimensions getValue:&size];
+        }
+
+        [table setURLString:((NSURL *) url).absoluteString
+                 dimensions:size
+                   fileSize:[fileSize isKindOfClass:[NSNumber class]] ? ((NSNumber *) fileSize).unsignedIntegerValue : 0
+              forRenderSize:options.renderSize
+                borderStyle:options.borderStyle
+                imageFormat:options.imageFormat];
+    }
+
+    return table;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    IMImojiVariantTable *copy = [[IMImojiVariantTable allocWithZone:zone] init];
+
+    if (copy != nil) {
+        for (NSUInteger i = 0; i < IMImojiVariantTableEntries; i++) {
+            copy->_urlStrings[i] = _urlStrings[i];
+            copy->_metrics[i] = _metrics[i];
+        }
+
+        // immutable, so the copy can share whatever has been built already
+        @synchronized (self) {
+            copy->_urlsDictionary = _urlsDictionary;
+            copy->_imageDimensionsDictionary = _imageDimensionsDictionary;
+            copy->_fileSizesDictionary = _fileSizesDictionary;
+        }
+    }
+
+    return copy;
+}
+
+@end
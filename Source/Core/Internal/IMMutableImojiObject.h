@@ -26,13 +26,13 @@
 #import <Foundation/Foundation.h>
 #import "IMImojiObject.h"
 
+@class IMImojiVariantTable;
+
 @interface IMMutableImojiObject : IMImojiObject {
 @private
     NSString *__nonnull _identifier;
     NSArray *__nonnull _tags;
-    NSDictionary *__nonnull _urls;
-    NSDictionary *__nonnull _fileSizes;
-    NSDictionary *__nonnull _imageDimensions;
+    IMImojiVariantTable *__nonnull _variants;
     BOOL _supportsAnimation;
     IMImojiObjectLicenseStyle _licenseStyle;
 }
@@ -48,4 +48,9 @@
                                   fileSizes:(nonnull NSDictionary *)fileSizes
                                licenseStyle:(IMImojiObjectLicenseStyle)licenseStyle;
 
++ (nonnull instancetype)imojiWithIdentifier:(nonnull NSString *)identifier
+                                       tags:(nonnull NSArray *)tags
+                                   variants:(nonnull IMImojiVariantTable *)variants
+                               licenseStyle:(IMImojiObjectLicenseStyle)licenseStyle;
+
 @end
@@ -24,6 +24,7 @@
 //
 
 #import "IMMutableImojiObject.h"
+#import "IMImojiVariantTable.h"
 
 @interface IMMutableImojiObject ()
 @end
@@ -33,21 +34,17 @@
 }
 - (instancetype)initWWithIdentifier:(nonnull NSString *)identifier
                                tags:(nonnull NSArray *)tags
-                               urls:(nonnull NSDictionary *)urls
-                    imageDimensions:(nonnull NSDictionary *)imageDimensions
-                          fileSizes:(nonnull NSDictionary *)fileSizes
+                           variants:(nonnull IMImojiVariantTable *)variants
                        licenseStyle:(IMImojiObjectLicenseStyle)licenseStyle {
     self = [super init];
     if (self) {
         _identifier = identifier;
-        _urls = urls;
-        _fileSizes = fileSizes;
-        _imageDimensions = imageDimensions;
+        _variants = variants;
         _tags = tags;
         _licenseStyle = licenseStyle;
-        _supportsAnimation = urls && [urls[[IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeThumbnail
-                                                                                    borderStyle:IMImojiObjectBorderStyleNone
-                                                                                    imageFormat:IMImojiObjectImageFormatAnimatedGif]] isKindOfClass:[NSURL class]];
+        _supportsAnimation = [variants urlStringForRenderSize:IMImojiObjectRenderSizeThumbnail
+                                                  borderStyle:IMImojiObjectBorderStyleNone
+                                                  imageFormat:IMImojiObjectImageFormatAnimatedGif] != nil;
     }
 
     return self;
@@ -58,9 +55,9 @@
     if (self) {
         _identifier = [coder decodeObjectForKey:@"identifier"];
         _tags = [coder decodeObjectForKey:@"tags"];
-        _urls = [coder decodeObjectForKey:@"urls"];
-        _fileSizes = [coder decodeObjectForKey:@"fileSizes"];
-        _imageDimensions = [coder decodeObjectForKey:@"imageDimensions"];
+        _variants = [IMImojiVariantTable tableWithURLs:[coder decodeObjectForKey:@"urls"]
+                                       imageDimensions:[coder decodeObjectForKey:@"imageDimensions"]
+                                             fileSizes:[coder decodeObjectForKey:@"fileSizes"]];
         _supportsAnimation = [coder decodeBoolForKey:@"supportsAnimation"];
         _licenseStyle = (IMImojiObjectLicenseStyle) [coder decodeIntForKey:@"licenseStyle"];
     }
@@ -69,11 +66,12 @@
 }
 
 - (void)encodeWithCoder:(NSCoder *)coder {
+    // archived in the dictionary form so IMImojiObject and older versions of the SDK can still decode it
     [coder encodeObject:_identifier forKey:@"identifier"];
     [coder encodeObject:_tags forKey:@"tags"];
-    [coder encodeObject:_urls forKey:@"urls"];
-    [coder encodeObject:_fileSizes forKey:@"fileSizes"];
-    [coder encodeObject:_imageDimensions forKey:@"imageDimensions"];
+    [coder encodeObject:[_variants urlsDictionary] forKey:@"urls"];
+    [coder encodeObject:[_variants fileSizesDictionary] forKey:@"fileSizes"];
+    [coder encodeObject:[_variants imageDimensionsDictionary] forKey:@"imageDimensions"];
     [coder encodeBool:_supportsAnimation forKey:@"supportsAnimation"];
     [coder encodeInt:_licenseStyle forKey:@"licenseStyle"];
 }
@@ -87,15 +85,15 @@
 }
 
 - (NSDictionary *)urls {
-    return _urls;
+    return [_variants urlsDictionary];
 }
 
 - (NSDictionary *)fileSizes {
-    return _fileSizes;
+    return [_variants fileSizesDictionary];
 }
 
 - (NSDictionary *)imageDimensions {
-    return _imageDimensions;
+    return [_variants imageDimensionsDictionary];
 }
 
 - (BOOL)supportsAnimation {
@@ -106,14 +104,32 @@
     return _licenseStyle;
 }
 
+#pragma mark Variant Lookups
+
+- (NSURL *)variantUrlForRenderSize:(IMImojiObjectRenderSize)renderSize
+                       borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                       imageFormat:(IMImojiObjectImageFormat)imageFormat {
+    return [_variants urlForRenderSize:renderSize borderStyle:borderStyle imageFormat:imageFormat];
+}
+
+- (CGSize)variantDimensionsForRenderSize:(IMImojiObjectRenderSize)renderSize
+                             borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                             imageFormat:(IMImojiObjectImageFormat)imageFormat {
+    return [_variants dimensionsForRenderSize:renderSize borderStyle:borderStyle imageFormat:imageFormat];
+}
+
+- (NSUInteger)variantFileSizeForRenderSize:(IMImojiObjectRenderSize)renderSize
+                               borderStyle:(IMImojiObjectBorderStyle)borderStyle
+                               imageFormat:(IMImojiObjectImageFormat)imageFormat {
+    return [_variants fileSizeForRenderSize:renderSize borderStyle:borderStyle imageFormat:imageFormat];
+}
+
 + (nonnull instancetype)imojiWithIdentifier:(nonnull NSString *)identifier
                                        tags:(nonnull NSArray *)tags
                                        urls:(nonnull NSDictionary *)urls {
     return [[IMMutableImojiObject alloc] initWWithIdentifier:identifier
                                                         tags:tags
-                                                        urls:urls
-                                             imageDimensions:@{}
-                                                   fileSizes:@{}
+                                                    variants:[IMImojiVariantTable tableWithURLs:urls imageDimensions:nil fileSizes:nil]
                                                 licenseStyle:IMImojiObjectLicenseStyleNonCommercial];
 }
 
@@ -125,9 +141,17 @@
                                licenseStyle:(IMImojiObjectLicenseStyle)licenseStyle {
     return [[IMMutableImojiObject alloc] initWWithIdentifier:identifier
                                                         tags:tags
-                                                        urls:urls
-                                             imageDimensions:imageDimensions
-                                                   fileSizes:fileSizes
+                                                    variants:[IMImojiVariantTable tableWithURLs:urls imageDimensions:imageDimensions fileSizes:fileSizes]
+                                                licenseStyle:licenseStyle];
+}
+
++ (nonnull instancetype)imojiWithIdentifier:(nonnull NSString *)identifier
+                                       tags:(nonnull NSArray *)tags
+                                   variants:(nonnull IMImojiVariantTable *)variants
+                               licenseStyle:(IMImojiObjectLicenseStyle)licenseStyle {
+    return [[IMMutableImojiObject alloc] initWWithIdentifier:identifier
+                                                        tags:tags
+                                                    variants:variants
                                                 licenseStyle:licenseStyle];
 }
 
@@ -11,6 +11,9 @@
 //
 //  https://github.com/nicklockwood/RequestUtils
 //
+//  Altered for ImojiSDK: URL encoding and query strings are built by the
+//  portable C code in IMImojiURLQuery.c
+//
 //  This software is provided 'as-is', without any express or implied
 //  warranty.  In no event will the authors be held liable for any damages
 //  arising from the use of this software.
@@ -31,6 +34,7 @@
 //
 
 #import "RequestUtils.h"
+#import "IMImojiURLQuery.h"
 
 
 #import <Availability.h>
@@ -54,18 +58,30 @@
 @end
 
 
+static BOOL RequestUtilsAppendQueryPair(IMImojiURLQuery *query, NSString *key, id value, BOOL useArraySyntax)
+{
+    const char *keyString = [key UTF8String] ?: "";
+    const char *valueString = [[value description] UTF8String] ?: "";
+    return IMImojiURLQueryAppend(query, keyString, strlen(keyString), valueString, strlen(valueString), useArraySyntax) == IMImojiURLQueryStatusSuccess;
+}
+
+
 @implementation NSString (RequestUtils)
 
 #pragma mark URLEncoding
 
 - (NSString *)URLEncodedString
 {
-    CFStringRef encoded = CFURLCreateStringByAddingPercentEscapes(kCFAllocatorDefault,
-                                                                  (__bridge CFStringRef)[self description],
-                                                                  NULL,
-                                                                  CFSTR("!*'\"();:@&=+$,/?%#[]% "),
-                                                                  kCFStringEncodingUTF8);
-    return CFBridgingRelease(encoded);
+    const char *string = [[self description] UTF8String] ?: "";
+    size_t length = strlen(string);
+    char *encoded = malloc(length * 3 + 1);
+    if (!encoded)
+    {
+        return nil;
+    }
+    
+    size_t encodedLength = IMImojiURLPercentEncode(encoded, string, length);
+    return [[NSString alloc] initWithBytesNoCopy:encoded length:encodedLength encoding:NSASCIIStringEncoding freeWhenDone:YES];
 }
 
 - (NSString *)URLDecodedString:(BOOL)decodePlusAsSpace
@@ -196,68 +212,47 @@
                  @"URLQueryOptionUseArraySyntax has no effect unless combined with URLQueryOptionUseArrays or URLQueryOptionAlwaysUseArrays option");
     }
   
-    NSMutableString *result = [NSMutableString string];
+    IMImojiURLQuery query;
+    IMImojiURLQueryInit(&query, 0);
+    
+    BOOL appended = YES;
     NSArray *keys = [parameters allKeys];
     if (sortKeys) keys = [keys sortedArrayUsingSelector:@selector(compare:)];
     for (NSString *key in keys)
     {
         id value = parameters[key];
-        NSString *encodedKey = [[key description] URLEncodedString];
+        NSString *keyString = [key description];
         if ([value isKindOfClass:[NSArray class]])
         {
             if (options == URLQueryOptionKeepFirstValue && [value count])
             {
-                if ([result length])
-                {
-                    [result appendString:@"&"];
-                }
-                [result appendFormat:@"%@=%@", encodedKey, [[[value firstObject] description] URLEncodedString]];
+                appended &= RequestUtilsAppendQueryPair(&query, keyString, [value firstObject], NO);
             }
             else if (options == URLQueryOptionKeepLastValue && [value count])
             {
-                if ([result length])
-                {
-                    [result appendString:@"&"];
-                }
-                [result appendFormat:@"%@=%@", encodedKey, [[[value lastObject] description] URLEncodedString]];
+                appended &= RequestUtilsAppendQueryPair(&query, keyString, [value lastObject], NO);
             }
             else
             {
-                for (NSString *element in value)
+                for (id element in value)
                 {
-                    if ([result length])
-                    {
-                        [result appendString:@"&"];
-                    }
-                    if (useArraySyntax)
-                    {
-                        [result appendFormat:@"%@[]=%@", encodedKey, [[element description] URLEncodedString]];
-                    }
-                    else
-                    {
-                        [result appendFormat:@"%@=%@", encodedKey, [[element description] URLEncodedString]];
-                    }
+                    appended &= RequestUtilsAppendQueryPair(&query, keyString, element, useArraySyntax);
                 }
             }
         }
         else
         {
-            if ([result length])
-            {
-                [result appendString:@"&"];
-            }
-            if (useArraySyntax && options == URLQueryOptionAlwaysUseArrays)
-            {
-                [result appendFormat:@"%@[]=%@", encodedKey, [[value description] URLEncodedString]];
-            }
-            else
-            {
-                [result appendFormat:@"%@=%@", encodedKey, [[value description] URLEncodedString]];
-            }
+            appended &= RequestUtilsAppendQueryPair(&query, keyString, value, useArraySyntax && options == URLQueryOptionAlwaysUseArrays);
         }
     }
     
-    return result;
+    if (!appended || !query.length)
+    {
+        IMImojiURLQueryDestroy(&query);
+        return appended ? @"" : nil;
+    }
+    
+    return [[NSString alloc] initWithBytesNoCopy:query.bytes length:query.length encoding:NSASCIIStringEncoding freeWhenDone:YES];
 }
 
 - (NSRange)rangeOfURLQuery
@@ -8,11 +8,52 @@
 
 #import <UIKit/UIKit.h>
 #import <XCTest/XCTest.h>
+#import <mach/mach_time.h>
+#import <pthread.h>
 #import "ImojiSyncSDK.h"
 #import "IMImojiSession+Testing.h"
+#import "IMImojiSession+Private.h"
+#import "IMImojiImageCache.h"
+#import "IMImojiImageDiskCache.h"
+#import "IMImojiVariantTable.h"
+#import "IMImojiStreamingJSONDecoder.h"
+#import "IMImojiDownloadScheduler.h"
+#import "IMImojiImageDownload.h"
+#import "IMImojiCancellationToken.h"
+#import "IMImojiImageDecoder.h"
+#import "IMImojiResultCache.h"
+#import "IMImojiAnalyticsBuffer.h"
+#import "IMImojiLookupBatcher.h"
+#import "IMImojiRetryPolicy.h"
+#import "IMMutableImojiObject.h"
+#import "RequestUtils.h"
 #import "BFTask.h"
 #import "BFTaskCompletionSource.h"
 
+#pragma mark Benchmark Allocation Counting
+
+// libmalloc calls malloc_logger for every allocation, reallocation and free when it is set, it's the hook
+// MallocStackLogging is built on. The benchmarks install their own logger to count the allocations made on the thread
+// they run on, whether or not the memory is still alive when the benchmark finishes
+typedef void (ImojiSDKMallocLogger)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numberOfFramesToSkip);
+extern ImojiSDKMallocLogger *malloc_logger;
+
+static uint32_t const ImojiSDKMallocLogTypeAllocate = 2;
+
+static ImojiSDKMallocLogger *ImojiSDKPreviousMallocLogger;
+static pthread_t ImojiSDKCountedThread;
+static volatile uint64_t ImojiSDKAllocationCount;
+
+static void ImojiSDKCountingMallocLogger(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numberOfFramesToSkip) {
+    if ((type & ImojiSDKMallocLogTypeAllocate) && pthread_equal(pthread_self(), ImojiSDKCountedThread)) {
+        ImojiSDKAllocationCount++;
+    }
+
+    if (ImojiSDKPreviousMallocLogger) {
+        ImojiSDKPreviousMallocLogger(type, arg1, arg2, arg3, result, numberOfFramesToSkip + 1);
+    }
+}
+
 @interface ImojiSDKTestData : NSObject
 
 @property(nonatomic, strong) IMImojiSession *imojiSession;
@@ -23,6 +64,77 @@
 @implementation ImojiSDKTestData
 @end
 
+@interface IMImojiRetryPolicy (Testing)
+
+- (void)recordResponseFromHost:(NSString *)host roundTripTime:(NSTimeInterval)roundTripTime;
+
+- (void)recordFailureForHost:(NSString *)host timedOut:(BOOL)timedOut;
+
+@end
+
+#pragma mark Stubbed Category Responses
+
+static NSString *const ImojiSDKStubbedCategoriesEntityTag = @"\"categories-1\"";
+static NSMutableArray *ImojiSDKStubbedCategoriesRequests;
+static NSData *ImojiSDKStubbedCategoriesData;
+
+/**
+ * Answers /imoji/categories/fetch with ImojiSDKStubbedCategoriesData and an ETag, or a 304 when the request carries that
+ * ETag in If-None-Match. Every request it answers is recorded. Other requests go to the network.
+ */
+@interface ImojiSDKStubbedCategoriesProtocol : NSURLProtocol
+@end
+
+@implementation ImojiSDKStubbedCategoriesProtocol
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request {
+    return [request.URL.path hasSuffix:@"/imoji/categories/fetch"];
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request {
+    return request;
+}
+
+- (void)startLoading {
+    @synchronized ([ImojiSDKStubbedCategoriesProtocol class]) {
+        [ImojiSDKStubbedCategoriesRequests addObject:self.request];
+    }
+
+    BOOL notModified = [[self.request valueForHTTPHeaderField:@"If-None-Match"] isEqualToString:ImojiSDKStubbedCategoriesEntityTag];
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.request.URL
+                                                              statusCode:notModified ? 304 : 200
+                                                             HTTPVersion:@"HTTP/1.1"
+                                                            headerFields:@{
+                                                                    @"Content-Type" : @"application/json",
+                                                                    @"ETag" : ImojiSDKStubbedCategoriesEntityTag
+                                                            }];
+
+    [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    if (!notModified) {
+        [self.client URLProtocol:self didLoadData:ImojiSDKStubbedCategoriesData];
+    }
+    [self.client URLProtocolDidFinishLoading:self];
+}
+
+- (void)stopLoading {
+}
+
+@end
+
+@interface ImojiSDKStubbedStoragePolicy : IMImojiSessionStoragePolicy
+@end
+
+@implementation ImojiSDKStubbedStoragePolicy
+
+- (NSURLSessionConfiguration *)generateURLSessionConfiguration {
+    NSURLSessionConfiguration *sessionConfiguration = [super generateURLSessionConfiguration];
+    sessionConfiguration.protocolClasses = [@[[ImojiSDKStubbedCategoriesProtocol class]] arrayByAddingObjectsFromArray:sessionConfiguration.protocolClasses];
+
+    return sessionConfiguration;
+}
+
+@end
+
 @interface ImojiSDKTests : XCTestCase
 @property(nonatomic, strong) ImojiSDKTestData *testData;
 @end
@@ -268,6 +380,1209 @@
     }];
 }
 
+- (void)test_3_1_ParseSearchResultsBenchmark {
+    NSArray *results = [self loadFixture:@"imoji-search"][@"results"];
+
+    [self runBenchmark:@"search results" iterations:50 block:^id {
+        IMImojiObject *imoji;
+        for (NSDictionary *result in results) {
+            imoji = [self.testData.imojiSession readImojiObject:result];
+        }
+        return imoji;
+    }];
+}
+
+- (void)test_3_2_ParseFeaturedResultsBenchmark {
+    NSArray *results = [self loadFixture:@"imoji-featured-fetch"][@"results"];
+
+    [self runBenchmark:@"featured results" iterations:50 block:^id {
+        IMImojiObject *imoji;
+        for (NSDictionary *result in results) {
+            imoji = [self.testData.imojiSession readImojiObject:result];
+        }
+        return imoji;
+    }];
+}
+
+- (void)test_3_3_ParseCategoriesBenchmark {
+    NSArray *categories = [self loadFixture:@"imoji-categories-fetch"][@"categories"];
+
+    [self runBenchmark:@"categories" iterations:50 block:^id {
+        return [self.testData.imojiSession readCategories:categories];
+    }];
+}
+
+- (void)test_3_4_ReadAttributionBenchmark {
+    NSDictionary *artist;
+    for (NSDictionary *category in [self loadFixture:@"imoji-categories-fetch"][@"categories"]) {
+        if ([category[@"artist"] isKindOfClass:[NSDictionary class]]) {
+            artist = category[@"artist"];
+            break;
+        }
+    }
+
+    XCTAssertNotNil(artist, @"categories fixture artist");
+
+    [self runBenchmark:@"attribution" iterations:1000 block:^id {
+        return [self.testData.imojiSession readAttribution:artist];
+    }];
+}
+
+- (void)test_3_5_RenderingURLBenchmark {
+    IMImojiObject *imoji = [self.testData.imojiSession readImojiObject:[[self loadFixture:@"imoji-featured-fetch"][@"results"] firstObject]];
+
+    NSMutableArray *renderingOptions = [NSMutableArray array];
+    for (NSUInteger renderSize = IMImojiObjectRenderSizeThumbnail; renderSize <= IMImojiObjectRenderSize512; renderSize++) {
+        for (NSUInteger borderStyle = IMImojiObjectBorderStyleSticker; borderStyle <= IMImojiObjectBorderStyleNone; borderStyle++) {
+            for (NSUInteger imageFormat = IMImojiObjectImageFormatPNG; imageFormat <= IMImojiObjectImageFormatAnimatedWebp; imageFormat++) {
+                [renderingOptions addObject:[IMImojiObjectRenderingOptions optionsWithRenderSize:(IMImojiObjectRenderSize) renderSize
+                                                                                     borderStyle:(IMImojiObjectBorderStyle) borderStyle
+                                                                                     imageFormat:(IMImojiObjectImageFormat) imageFormat]];
+            }
+        }
+    }
+
+    XCTAssertNotNil([imoji getUrlForRenderingOptions:renderingOptions.firstObject], @"rendering url");
+
+    [self runBenchmark:@"rendering urls" iterations:1000 block:^id {
+        NSURL *url;
+        for (IMImojiObjectRenderingOptions *options in renderingOptions) {
+            url = [imoji getUrlForRenderingOptions:options] ?: url;
+        }
+        return url;
+    }];
+}
+
+- (void)test_3_6_URLQueryBenchmark {
+    NSDictionary *parameters = @{
+            @"query" : @"happy birthday & congrats",
+            @"numResults" : @50,
+            @"offset" : @100,
+            @"locale" : @"en_US",
+            @"contentRating" : @"G",
+            @"imageExtension" : @"webp",
+            @"hasAnimated" : @YES,
+            @"ids" : @"a1b2c3,d4e5f6,0a9b8c"
+    };
+
+    [self runBenchmark:@"url query" iterations:1000 block:^id {
+        return [NSString URLQueryWithParameters:parameters];
+    }];
+}
+
+- (void)test_4_1_ImageCacheEvictsLeastRecentlyUsedFirst {
+    IMImojiObjectRenderingOptions *options = [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeThumbnail];
+    UIImage *image = [self imageWithPixelSize:CGSizeMake(16, 16)];
+    NSUInteger cost = [IMImojiImageCache costForImage:image];
+    IMImojiImageCache *cache = [[IMImojiImageCache alloc] initWithTotalCostLimit:cost * 3 encodedCostLimit:0];
+
+    IMImojiObject *first = [self imojiWithIdentifier:@"first"];
+    IMImojiObject *second = [self imojiWithIdentifier:@"second"];
+    IMImojiObject *third = [self imojiWithIdentifier:@"third"];
+    IMImojiObject *fourth = [self imojiWithIdentifier:@"fourth"];
+    IMImojiObject *fifth = [self imojiWithIdentifier:@"fifth"];
+
+    [cache setImage:image forImoji:first renderingOptions:options];
+    [cache setImage:image forImoji:second renderingOptions:options];
+    [cache setImage:image forImoji:third renderingOptions:options];
+    XCTAssertEqual(cache.totalCost, cost * 3, @"cache filled to its limit");
+    XCTAssertEqual(cache.evictionCount, 0, @"nothing evicted within the limit");
+
+    // using the first image makes the second one the least recently used
+    XCTAssertNotNil([cache imageForImoji:first renderingOptions:options], @"first image");
+    [cache setImage:image forImoji:fourth renderingOptions:options];
+
+    XCTAssertNotNil([cache peekImageForImoji:first renderingOptions:options], @"recently used image kept");
+    XCTAssertNil([cache peekImageForImoji:second renderingOptions:options], @"least recently used image evicted");
+    XCTAssertNotNil([cache peekImageForImoji:third renderingOptions:options], @"third image kept");
+    XCTAssertNotNil([cache peekImageForImoji:fourth renderingOptions:options], @"new image stored");
+    XCTAssertEqual(cache.evictionCount, 1, @"one eviction");
+
+    [cache setImage:image forImoji:fifth renderingOptions:options];
+    XCTAssertNil([cache peekImageForImoji:third renderingOptions:options], @"next least recently used image evicted");
+    XCTAssertNotNil([cache peekImageForImoji:first renderingOptions:options], @"first image kept");
+    XCTAssertEqual(cache.totalCost, cost * 3, @"cost stays within the limit");
+    XCTAssertEqual(cache.evictionCount, 2, @"two evictions");
+
+    // an image larger than the whole limit is never stored and doesn't evict anything
+    [cache setImage:[self imageWithPixelSize:CGSizeMake(64, 64)] forImoji:second renderingOptions:options];
+    XCTAssertNil([cache peekImageForImoji:second renderingOptions:options], @"oversized image not stored");
+    XCTAssertEqual(cache.evictionCount, 2, @"oversized image evicts nothing");
+}
+
+- (void)test_4_2_ImageCachePeeksDontPromote {
+    IMImojiObjectRenderingOptions *options = [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeThumbnail];
+    UIImage *image = [self imageWithPixelSize:CGSizeMake(16, 16)];
+    NSData *imageData = [NSMutableData dataWithLength:100];
+    IMImojiImageCache *cache = [[IMImojiImageCache alloc] initWithTotalCostLimit:[IMImojiImageCache costForImage:image] * 2
+                                                                encodedCostLimit:imageData.length * 2];
+
+    IMImojiObject *first = [self imojiWithIdentifier:@"first"];
+    IMImojiObject *second = [self imojiWithIdentifier:@"second"];
+    IMImojiObject *third = [self imojiWithIdentifier:@"third"];
+
+    [cache setImage:image forImoji:first renderingOptions:options];
+    [cache setImage:image forImoji:second renderingOptions:options];
+    [cache setImageData:imageData forImoji:first renderingOptions:options];
+    [cache setImageData:imageData forImoji:second renderingOptions:options];
+
+    XCTAssertNotNil([cache peekImageForImoji:first renderingOptions:options], @"peeked image");
+    XCTAssertNotNil([cache peekImageDataForImoji:first renderingOptions:options], @"peeked image data");
+    XCTAssertEqual(cache.hitCount, 0, @"peeks aren't counted as hits");
+    XCTAssertEqual(cache.encodedHitCount, 0, @"peeks aren't counted as encoded hits");
+    XCTAssertEqual(cache.missCount, 0, @"peeks aren't counted as misses");
+
+    [cache setImage:image forImoji:third renderingOptions:options];
+    [cache setImageData:imageData forImoji:third renderingOptions:options];
+
+    XCTAssertNil([cache peekImageForImoji:first renderingOptions:options], @"peeked image still evicted first");
+    XCTAssertNil([cache peekImageDataForImoji:first renderingOptions:options], @"peeked image data still evicted first");
+    XCTAssertNotNil([cache peekImageForImoji:second renderingOptions:options], @"second image kept");
+    XCTAssertNotNil([cache peekImageDataForImoji:second renderingOptions:options], @"second image data kept");
+}
+
+- (void)test_4_3_ImageCacheMemoryWarningClearsDecodedTierOnly {
+    IMImojiObjectRenderingOptions *options = [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeThumbnail];
+    UIImage *image = [self imageWithPixelSize:CGSizeMake(16, 16)];
+    NSData *imageData = [NSMutableData dataWithLength:100];
+    IMImojiImageCache *cache = [[IMImojiImageCache alloc] initWithTotalCostLimit:[IMImojiImageCache costForImage:image] * 4
+                                                                encodedCostLimit:imageData.length * 4];
+    IMImojiObject *imoji = [self imojiWithIdentifier:@"imoji"];
+
+    [cache setImage:image forImoji:imoji renderingOptions:options];
+    [cache setImageData:imageData forImoji:imoji renderingOptions:options];
+
+    [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationDidReceiveMemoryWarningNotification
+                                                        object:[UIApplication sharedApplication]];
+
+    XCTAssertEqual(cache.totalCost, 0, @"decoded tier cleared");
+    XCTAssertNil([cache peekImageForImoji:imoji renderingOptions:options], @"decoded image removed");
+    XCTAssertEqual(cache.encodedCost, imageData.length, @"encoded tier kept");
+    XCTAssertEqualObjects([cache peekImageDataForImoji:imoji renderingOptions:options], imageData, @"image data kept");
+
+    XCTAssertNil([cache imageForImoji:imoji renderingOptions:options], @"decoded lookup after the warning");
+    XCTAssertEqual(cache.encodedHitCount, 1, @"lookup satisfied by the encoded tier");
+    XCTAssertEqual(cache.missCount, 0, @"lookup not counted as a miss");
+}
+
+- (void)test_5_1_DiskCacheOverwritesReplaceTheirSize {
+    NSUInteger blockSize = 4096;
+    IMImojiImageDiskCache *cache = [[IMImojiImageDiskCache alloc] initWithPath:[self temporaryDirectoryPath]
+                                                                     sizeLimit:blockSize * 8];
+    NSURL *url = [NSURL URLWithString:@"https://imoji.io/imoji/overwritten.png"];
+
+    [cache setData:[NSMutableData dataWithLength:blockSize * 2] forURL:url];
+    XCTAssertEqual(cache.totalSize, blockSize * 2, @"first write");
+
+    for (NSUInteger i = 0; i < 10; i++) {
+        [cache setData:[NSMutableData dataWithLength:blockSize] forURL:url];
+    }
+    XCTAssertEqual(cache.totalSize, blockSize, @"overwrites replace the size of the previous file");
+
+    NSURL *fileURL = [NSURL fileURLWithPath:[[self temporaryDirectoryPath] stringByAppendingPathExtension:@"png"]];
+    [[NSMutableData dataWithLength:blockSize * 3] writeToURL:fileURL atomically:YES];
+
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    __block BOOL fileMoved = NO;
+    [cache moveFileAtURL:fileURL toStoreForURL:url completion:^(BOOL moved) {
+        fileMoved = moved;
+        dispatch_semaphore_signal(semaphore);
+    }];
+    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+
+    XCTAssertTrue(fileMoved, @"file moved into the store");
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:fileURL.path], @"moved file removed from its location");
+    XCTAssertEqual(cache.totalSize, blockSize * 3, @"moves replace the size of the previous file");
+    XCTAssertEqual([cache dataForURL:url].length, blockSize * 3, @"moved contents stored");
+
+    [[NSFileManager defaultManager] removeItemAtPath:cache.path error:nil];
+}
+
+- (void)test_5_2_DiskCacheTrimsToHalfOfItsLimit {
+    NSUInteger blockSize = 4096;
+    IMImojiImageDiskCache *cache = [[IMImojiImageDiskCache alloc] initWithPath:[self temporaryDirectoryPath]
+                                                                     sizeLimit:blockSize * 10];
+
+    NSMutableArray *urls = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 11; i++) {
+        NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"https://imoji.io/imoji/%@.png", @(i)]];
+        [urls addObject:url];
+
+        [cache setData:[NSMutableData dataWithLength:blockSize] forURL:url];
+
+        // waits for the write so each file is last used after the previous one
+        XCTAssertEqual(cache.totalSize, i < 10 ? blockSize * (i + 1) : blockSize * 5, @"size after write %@", @(i));
+    }
+
+    for (NSUInteger i = 0; i < urls.count; i++) {
+        if (i < 6) {
+            XCTAssertFalse([cache containsDataForURL:urls[i]], @"least recently used file %@ evicted", @(i));
+        } else {
+            XCTAssertTrue([cache containsDataForURL:urls[i]], @"recently used file %@ kept", @(i));
+        }
+    }
+
+    [[NSFileManager defaultManager] removeItemAtPath:cache.path error:nil];
+}
+
+- (void)test_6_1_VariantTableCachesDictionaries {
+    IMImojiObjectRenderingOptions *options = [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSize320
+                                                                                      borderStyle:IMImojiObjectBorderStyleNone
+                                                                                      imageFormat:IMImojiObjectImageFormatWebP];
+    IMImojiVariantTable *table = [IMImojiVariantTable new];
+    [table setURLString:@"https://imoji.io/imoji/320.webp"
+             dimensions:CGSizeMake(320, 240)
+               fileSize:1024
+          forRenderSize:options.renderSize
+            borderStyle:options.borderStyle
+            imageFormat:options.imageFormat];
+
+    NSDictionary *urls = [table urlsDictionary];
+    XCTAssertTrue([table urlsDictionary] == urls, @"urls built once");
+    XCTAssertTrue([table imageDimensionsDictionary] == [table imageDimensionsDictionary], @"dimensions built once");
+    XCTAssertTrue([table fileSizesDictionary] == [table fileSizesDictionary], @"file sizes built once");
+
+    XCTAssertEqualObjects(urls[options], [NSURL URLWithString:@"https://imoji.io/imoji/320.webp"], @"url");
+    XCTAssertTrue(CGSizeEqualToSize([[table imageDimensionsDictionary][options] CGSizeValue], CGSizeMake(320, 240)), @"dimensions");
+    XCTAssertEqualObjects([table fileSizesDictionary][options], @1024, @"file size");
+    XCTAssertEqual(urls.count, IMImojiVariantTableCount, @"every variant keyed");
+
+    [table setURLString:nil
+             dimensions:CGSizeZero
+               fileSize:0
+          forRenderSize:options.renderSize
+            borderStyle:options.borderStyle
+            imageFormat:options.imageFormat];
+
+    XCTAssertEqualObjects([table urlsDictionary][options], [NSNull null], @"setting a variant rebuilds the urls");
+    XCTAssertEqualObjects([table imageDimensionsDictionary][options], [NSNull null], @"setting a variant rebuilds the dimensions");
+    XCTAssertEqualObjects([table fileSizesDictionary][options], [NSNull null], @"setting a variant rebuilds the file sizes");
+}
+
+- (void)test_7_1_StreamingDecoderMatchesJSONSerializationForAnyChunking {
+    NSDictionary *streamedArrayKeys = @{
+            @"imoji-search" : @"results",
+            @"imoji-featured-fetch" : @"results",
+            @"imoji-categories-fetch" : @"categories"
+    };
+
+    for (NSString *name in streamedArrayKeys) {
+        NSString *streamedArrayKey = streamedArrayKeys[name];
+        NSData *data = [self fixtureData:name];
+        NSMutableDictionary *expected = [[self loadFixture:name] mutableCopy];
+        NSArray *expectedRecords = expected[streamedArrayKey];
+        [expected removeObjectForKey:streamedArrayKey];
+
+        // one byte at a time, the whole payload at once and random sizes from a fixed seed so failures reproduce
+        srand48(1);
+        NSArray *chunkSizes = @[
+                ^NSUInteger { return 1; },
+                [^NSUInteger { return data.length; } copy],
+                ^NSUInteger { return (NSUInteger) (lrand48() % 512) + 1; }
+        ];
+
+        for (NSUInteger (^chunkSize)(void) in chunkSizes) {
+            NSMutableArray *records = [NSMutableArray array];
+            NSError *error;
+            NSDictionary *topLevelObject = [self decodeStreamedData:data
+                                                   streamedArrayKey:streamedArrayKey
+                                                            records:records
+                                                          chunkSize:chunkSize
+                                                              error:&error];
+
+            XCTAssertNil(error, @"%@ decoding error", name);
+            XCTAssertEqualObjects(records, expectedRecords, @"%@ records", name);
+            XCTAssertEqualObjects(topLevelObject, expected, @"%@ remaining keys", name);
+        }
+    }
+}
+
+- (void)test_7_2_StreamingDecoderSkipsEscapesAndBracesInStrings {
+    NSString *payload = @"{\"status\" : \"SUCCESS\", \"note\": \"a } \\\" ] {\", \"results\": [ "
+            "{\"id\":\"1\",\"tags\":[\"\\\"quoted\\\"\",\"{brace}\",\"[bracket]\",\"back\\\\slash\\\\\"]},"
+            "{\"id\":\"2\",\"nested\":{\"value\":\"}],{\\\"\"},\"unicode\":\"\\u00e9\\ud83d\\ude00\"}\n"
+            "],\n\"meta\":{\"next\":\"]\"},\"count\":2}";
+    NSData *data = [payload dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSMutableDictionary *expected = [[NSJSONSerialization JSONObjectWithData:data options:0 error:nil] mutableCopy];
+    NSArray *expectedRecords = expected[@"results"];
+    [expected removeObjectForKey:@"results"];
+    XCTAssertEqual(expectedRecords.count, 2, @"payload is valid JSON");
+
+    NSMutableArray *records = [NSMutableArray array];
+    NSError *error;
+    NSDictionary *topLevelObject = [self decodeStreamedData:data
+                                           streamedArrayKey:@"results"
+                                                    records:records
+                                                  chunkSize:^NSUInteger { return 1; }
+                                                      error:&error];
+
+    XCTAssertNil(error, @"decoding error");
+    XCTAssertEqualObjects(records, expectedRecords, @"records");
+    XCTAssertEqualObjects(topLevelObject, expected, @"remaining keys");
+}
+
+- (void)test_7_3_StreamingDecoderRejectsTruncatedAndTrailingGarbage {
+    NSData *data = [self fixtureData:@"imoji-search"];
+
+    // every strict prefix is accepted while streaming but never finishes
+    for (NSUInteger length = 0; length < data.length; length += 7) {
+        NSError *error;
+        NSDictionary *topLevelObject = [self decodeStreamedData:[data subdataWithRange:NSMakeRange(0, length)]
+                                               streamedArrayKey:@"results"
+                                                        records:[NSMutableArray array]
+                                                      chunkSize:^NSUInteger { return 64; }
+                                                          error:&error];
+
+        XCTAssertNil(topLevelObject, @"truncated at %@", @(length));
+        XCTAssertEqualObjects(error.domain, IMImojiSessionErrorDomain, @"truncated at %@ error", @(length));
+    }
+
+    NSMutableData *trailingWhitespace = [data mutableCopy];
+    [trailingWhitespace appendData:[@" \r\n\t" dataUsingEncoding:NSUTF8StringEncoding]];
+    XCTAssertNotNil([self decodeStreamedData:trailingWhitespace
+                            streamedArrayKey:@"results"
+                                     records:[NSMutableArray array]
+                                   chunkSize:^NSUInteger { return 1; }
+                                       error:nil], @"trailing whitespace");
+
+    for (NSString *garbage in @[@"x", @"}", @",{}", @"\n{\"a\":1}"]) {
+        NSMutableData *trailingGarbage = [data mutableCopy];
+        [trailingGarbage appendData:[garbage dataUsingEncoding:NSUTF8StringEncoding]];
+
+        NSError *error;
+        XCTAssertNil([self decodeStreamedData:trailingGarbage
+                             streamedArrayKey:@"results"
+                                      records:[NSMutableArray array]
+                                    chunkSize:^NSUInteger { return 1; }
+                                        error:&error], @"trailing %@", garbage);
+        XCTAssertEqual(error.code, IMImojiSessionErrorCodeServerError, @"trailing %@ error", garbage);
+    }
+}
+
+- (void)test_8_1_SchedulerStartsHighestPriorityNewestFirst {
+    IMImojiDownloadScheduler *scheduler = [[IMImojiDownloadScheduler alloc] initWithMaximumConcurrentDownloads:1];
+    NSMutableArray *startedDownloads = [NSMutableArray array];
+    BFTaskCompletionSource *activeTaskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+
+    [scheduler scheduleDownload:[self downloadWithCancellationToken:[IMImojiCancellationToken cancellationToken]]
+                      withBlock:^BFTask * {
+                          [startedDownloads addObject:@"active"];
+                          return activeTaskCompletionSource.task;
+                      }];
+
+    NSMutableDictionary *cancellationTokens = [NSMutableDictionary dictionary];
+    NSArray *pendingDownloads = @[
+            @[@"older high", @(NSOperationQueuePriorityHigh)],
+            @[@"newer low", @(NSOperationQueuePriorityLow)],
+            @[@"newer high", @(NSOperationQueuePriorityHigh)],
+            @[@"newest normal", @(NSOperationQueuePriorityNormal)],
+            @[@"newest low", @(NSOperationQueuePriorityLow)]
+    ];
+
+    for (NSArray *pendingDownload in pendingDownloads) {
+        NSString *name = pendingDownload[0];
+        IMImojiCancellationToken *cancellationToken = [IMImojiCancellationToken cancellationToken];
+        cancellationToken.queuePriority = (NSOperationQueuePriority) [pendingDownload[1] integerValue];
+        cancellationTokens[name] = cancellationToken;
+
+        [scheduler scheduleDownload:[self downloadWithCancellationToken:cancellationToken]
+                          withBlock:^BFTask * {
+                              @synchronized (startedDownloads) {
+                                  [startedDownloads addObject:name];
+                              }
+                              return [BFTask taskWithResult:name];
+                          }];
+    }
+
+    XCTAssertEqualObjects(startedDownloads, @[@"active"], @"pending downloads wait for the slot");
+    XCTAssertEqual(scheduler.pendingDownloadCount, pendingDownloads.count, @"pending downloads");
+
+    // priorities are read when the slot frees up, raising one after it was queued still moves it ahead
+    ((NSOperation *) cancellationTokens[@"newer low"]).queuePriority = NSOperationQueuePriorityVeryHigh;
+    [activeTaskCompletionSource setResult:@"active"];
+
+    [self waitForCondition:^BOOL {
+        @synchronized (startedDownloads) {
+            return startedDownloads.count == pendingDownloads.count + 1;
+        }
+    }];
+
+    NSArray *expectedOrder = @[@"active", @"newer low", @"newer high", @"older high", @"newest normal", @"newest low"];
+    XCTAssertEqualObjects(startedDownloads, expectedOrder, @"start order");
+}
+
+- (void)test_8_2_SchedulerDropsCancelledPendingDownloads {
+    IMImojiDownloadScheduler *scheduler = [[IMImojiDownloadScheduler alloc] initWithMaximumConcurrentDownloads:1];
+    BFTaskCompletionSource *activeTaskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+    __block BOOL cancelledDownloadStarted = NO;
+    __block BOOL keptDownloadStarted = NO;
+
+    [scheduler scheduleDownload:[self downloadWithCancellationToken:[IMImojiCancellationToken cancellationToken]]
+                      withBlock:^BFTask * {
+                          return activeTaskCompletionSource.task;
+                      }];
+
+    IMImojiCancellationToken *cancellationToken = [IMImojiCancellationToken cancellationToken];
+    IMImojiImageDownload *cancelledDownload = [self downloadWithCancellationToken:cancellationToken];
+
+    // a retried download is scheduled again for each attempt
+    BFTask *firstAttemptTask = [scheduler scheduleDownload:cancelledDownload
+                                                 withBlock:^BFTask * {
+                                                     cancelledDownloadStarted = YES;
+                                                     return [BFTask taskWithResult:nil];
+                                                 }];
+    BFTask *secondAttemptTask = [scheduler scheduleDownload:cancelledDownload
+                                                  withBlock:^BFTask * {
+                                                      cancelledDownloadStarted = YES;
+                                                      return [BFTask taskWithResult:nil];
+                                                  }];
+
+    BFTask *keptTask = [scheduler scheduleDownload:[self downloadWithCancellationToken:[IMImojiCancellationToken cancellationToken]]
+                                         withBlock:^BFTask * {
+                                             keptDownloadStarted = YES;
+                                             return [BFTask taskWithResult:@"kept"];
+                                         }];
+
+    XCTAssertEqual(scheduler.pendingDownloadCount, 3, @"pending downloads");
+
+    [cancellationToken cancel];
+
+    XCTAssertEqual(scheduler.pendingDownloadCount, 1, @"cancelled download dropped without waiting for the slot");
+    XCTAssertTrue(firstAttemptTask.cancelled, @"first attempt cancelled");
+    XCTAssertTrue(secondAttemptTask.cancelled, @"second attempt cancelled");
+    XCTAssertEqual(scheduler.activeDownloadCount, 1, @"active download keeps its slot");
+
+    [activeTaskCompletionSource setResult:@"active"];
+    [self runTestWithTask:keptTask];
+
+    XCTAssertFalse(cancelledDownloadStarted, @"cancelled download never started");
+    XCTAssertTrue(keptDownloadStarted, @"remaining download started");
+    XCTAssertEqualObjects(keptTask.result, @"kept", @"remaining download result");
+    XCTAssertEqual(scheduler.pendingDownloadCount, 0, @"nothing left pending");
+}
+
+- (void)test_9_1_PrefetchStopsAtTheByteBudget {
+    IMImojiSessionStoragePolicy *storagePolicy = [IMImojiSessionStoragePolicy temporaryDiskStoragePolicy];
+    IMImojiSession *session = [IMImojiSession imojiSessionWithStoragePolicy:storagePolicy];
+    IMImojiObjectRenderingOptions *options = [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeThumbnail];
+
+    NSMutableArray *imojis = [NSMutableArray array];
+    for (NSDictionary *result in [self loadFixture:@"imoji-search"][@"results"]) {
+        [imojis addObject:[session readImojiObject:result]];
+    }
+
+    NSUInteger budgetedImojiCount = 5;
+    NSUInteger budget = 0;
+    for (NSUInteger i = 0; i < budgetedImojiCount; i++) {
+        budget += [imojis[i] getFileSizeForRenderingOptions:options];
+    }
+    XCTAssertGreaterThan([imojis[budgetedImojiCount] getFileSizeForRenderingOptions:options], 0, @"fixture file sizes");
+
+    // room for the first five imojis but not the sixth
+    storagePolicy.prefetchByteBudget = budget + [imojis[budgetedImojiCount] getFileSizeForRenderingOptions:options] - 1;
+
+    __block NSOperation *prefetchOperation;
+    __block NSUInteger prefetchedBytes;
+    __block NSUInteger prefetchedBytesAfterSecondCall;
+    [session performWithPrefetchesHeld:^{
+        prefetchOperation = [session prefetchImojis:imojis options:options];
+        prefetchedBytes = session.prefetchedBytes;
+
+        // the budget is still held by the prefetches in flight
+        [session prefetchImojis:[imojis subarrayWithRange:NSMakeRange(budgetedImojiCount, imojis.count - budgetedImojiCount)]
+                        options:options];
+        prefetchedBytesAfterSecondCall = session.prefetchedBytes;
+    }];
+
+    XCTAssertEqual(prefetchedBytes, budget, @"prefetching stops at the first imoji past the budget");
+    XCTAssertEqual(prefetchedBytesAfterSecondCall, budget, @"no budget left for a second call");
+
+    [prefetchOperation cancel];
+    [self waitForCondition:^BOOL {
+        return session.prefetchedBytes == 0;
+    }];
+}
+
+- (void)test_10_1_DecoderDownsamplesAndPadsToPixelSize {
+    NSData *data = UIImagePNGRepresentation([self imageWithPixelSize:CGSizeMake(400, 200)]);
+
+    UIImage *image = [IMImojiImageDecoder decodedImageWithData:data maximumPixelSize:0 aspectRatio:CGSizeZero scale:2.0f];
+    XCTAssertEqual(CGImageGetWidth(image.CGImage), 400, @"source width");
+    XCTAssertEqual(CGImageGetHeight(image.CGImage), 200, @"source height");
+
+    image = [IMImojiImageDecoder decodedImageWithData:data maximumPixelSize:100 aspectRatio:CGSizeZero scale:2.0f];
+    XCTAssertEqual(CGImageGetWidth(image.CGImage), 100, @"downsampled width");
+    XCTAssertEqual(CGImageGetHeight(image.CGImage), 50, @"downsampled height");
+    XCTAssertTrue(CGSizeEqualToSize(image.size, CGSizeMake(50, 25)), @"downsampled size in points");
+
+    image = [IMImojiImageDecoder decodedImageWithData:data maximumPixelSize:100 aspectRatio:CGSizeMake(1, 1) scale:2.0f];
+    XCTAssertEqual(CGImageGetWidth(image.CGImage), 100, @"padded width");
+    XCTAssertEqual(CGImageGetHeight(image.CGImage), 100, @"padded height");
+
+    image = [IMImojiImageDecoder decodedImageWithData:data maximumPixelSize:800 aspectRatio:CGSizeMake(4, 3) scale:2.0f];
+    XCTAssertEqual(CGImageGetWidth(image.CGImage), 400, @"never scaled up");
+    XCTAssertEqual(CGImageGetHeight(image.CGImage), 300, @"padded to 4:3");
+}
+
+- (void)test_10_2_TargetSizesUsePublishedVariantsBySize {
+    IMImojiObject *imoji = [self.testData.imojiSession readImojiObject:[[self loadFixture:@"imoji-search"][@"results"] firstObject]];
+    CGFloat scale = [UIScreen mainScreen].scale;
+    IMImojiObjectRenderingOptions *options = [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeThumbnail];
+
+    // 200 pixels are more than the thumbnail has, the 320 variant is the smallest that covers them
+    options.targetSize = [NSValue valueWithCGSize:CGSizeMake(200 / scale, 100 / scale)];
+    XCTAssertEqualObjects([imoji getUrlForRenderingOptions:options].lastPathComponent, @"320.webp", @"smallest covering variant");
+
+    options.targetSize = [NSValue valueWithCGSize:CGSizeMake(600 / scale, 600 / scale)];
+    XCTAssertEqualObjects([imoji getUrlForRenderingOptions:options].lastPathComponent, @"1200.webp", @"full resolution covers larger targets");
+
+    options.targetSize = [NSValue valueWithCGSize:CGSizeMake(1500 / scale, 1500 / scale)];
+    XCTAssertEqualObjects([imoji getUrlForRenderingOptions:options].host, @"render.imoji.io", @"rendered when no variant is large enough");
+
+    IMImojiObject *animatedImoji = [self.testData.imojiSession readImojiObject:[[self loadFixture:@"imoji-featured-fetch"][@"results"] firstObject]];
+    IMImojiObjectRenderingOptions *animatedOptions = [IMImojiObjectRenderingOptions optionsWithRenderSize:IMImojiObjectRenderSizeThumbnail
+                                                                                              borderStyle:IMImojiObjectBorderStyleSticker
+                                                                                              imageFormat:IMImojiObjectImageFormatAnimatedWebp];
+    XCTAssertNotEqualObjects([animatedImoji getUrlForRenderingOptions:animatedOptions].host, @"render.imoji.io", @"published animation");
+
+    animatedOptions.targetSize = [NSValue valueWithCGSize:CGSizeMake(100 / scale, 100 / scale)];
+    XCTAssertEqualObjects([animatedImoji getUrlForRenderingOptions:animatedOptions].host, @"render.imoji.io", @"sized animations are rendered");
+}
+
+- (void)test_10_3_DecodedLayoutsCompareInPixelsAndRatios {
+    XCTAssertTrue([IMImojiImageDecoder isMaximumPixelSize:100 aspectRatio:CGSizeMake(2, 1)
+                                  equalToMaximumPixelSize:100 aspectRatio:CGSizeMake(4, 2)], @"equivalent ratios");
+    XCTAssertTrue([IMImojiImageDecoder isMaximumPixelSize:100 aspectRatio:CGSizeMake(16, 9)
+                                  equalToMaximumPixelSize:100 aspectRatio:CGSizeMake(16.0 / 3, 3)], @"ratios from inexact arithmetic");
+    XCTAssertTrue([IMImojiImageDecoder isMaximumPixelSize:100.0000001 aspectRatio:CGSizeZero
+                                  equalToMaximumPixelSize:100 aspectRatio:CGSizeZero], @"whole pixel sizes");
+    XCTAssertFalse([IMImojiImageDecoder isMaximumPixelSize:100 aspectRatio:CGSizeZero
+                                   equalToMaximumPixelSize:100 aspectRatio:CGSizeMake(1, 1)], @"padded and unpadded");
+    XCTAssertFalse([IMImojiImageDecoder isMaximumPixelSize:100 aspectRatio:CGSizeMake(4, 3)
+                                   equalToMaximumPixelSize:100 aspectRatio:CGSizeMake(16, 9)], @"different ratios");
+    XCTAssertFalse([IMImojiImageDecoder isMaximumPixelSize:100 aspectRatio:CGSizeZero
+                                   equalToMaximumPixelSize:200 aspectRatio:CGSizeZero], @"different sizes");
+}
+
+- (void)test_11_1_ResultCacheKeysOnlyNormalizeTheSearchPhrase {
+    NSString *key = [IMImojiResultCache keyForPath:@"/imoji/search" parameters:@{@"query" : @"Happy ", @"offset" : @"AbC", @"numResults" : @50}];
+
+    XCTAssertEqualObjects(key, [IMImojiResultCache keyForPath:@"/imoji/search" parameters:@{@"numResults" : @50, @"offset" : @"AbC", @"query" : @" happy", @"locale" : [NSNull null]}],
+            @"search phrase case, whitespace, parameter order and nulls are ignored");
+    XCTAssertNotEqualObjects(key, [IMImojiResultCache keyForPath:@"/imoji/search" parameters:@{@"query" : @"happy", @"offset" : @"abc", @"numResults" : @50}],
+            @"other values keep their case");
+    XCTAssertNotEqualObjects(key, [IMImojiResultCache keyForPath:@"/imoji/featured/fetch" parameters:@{@"query" : @"happy", @"offset" : @"AbC", @"numResults" : @50}],
+            @"paths are part of the key");
+}
+
+- (void)test_11_2_ResultCacheStoresImmutableCopies {
+    IMImojiResultCache *cache = [[IMImojiResultCache alloc] initWithCountLimit:10 maximumAge:60];
+    NSMutableArray *results = [NSMutableArray arrayWithObject:[NSMutableDictionary dictionaryWithObject:@"1" forKey:@"id"]];
+    NSMutableDictionary *response = [NSMutableDictionary dictionaryWithObject:results forKey:@"results"];
+
+    [cache setObject:response forKey:@"key"];
+    [results addObject:@{@"id" : @"2"}];
+    results[0][@"id"] = @"changed";
+
+    NSDictionary *cachedResponse = [cache objectForKey:@"key" timeToLive:60 stale:nil];
+    XCTAssertEqualObjects(cachedResponse, @{@"results" : @[@{@"id" : @"1"}]}, @"later changes aren't cached");
+    XCTAssertFalse([cachedResponse isKindOfClass:[NSMutableDictionary class]], @"immutable response");
+    XCTAssertFalse([cachedResponse[@"results"] isKindOfClass:[NSMutableArray class]], @"immutable nested array");
+    XCTAssertFalse([cachedResponse[@"results"][0] isKindOfClass:[NSMutableDictionary class]], @"immutable nested dictionary");
+}
+
+- (void)test_11_3_ResultCacheTimeToLiveAndMaximumAge {
+    IMImojiResultCache *cache = [[IMImojiResultCache alloc] initWithCountLimit:10 maximumAge:0.2];
+    BOOL stale = YES;
+
+    [cache setObject:@[@"categories"] forKey:@"key"];
+    XCTAssertNotNil([cache objectForKey:@"key" timeToLive:10 stale:&stale], @"fresh entry");
+    XCTAssertFalse(stale, @"within the time to live");
+
+    [NSThread sleepForTimeInterval:0.05];
+    XCTAssertNotNil([cache objectForKey:@"key" timeToLive:0.01 stale:&stale], @"stale entries are still returned");
+    XCTAssertTrue(stale, @"past the time to live");
+
+    [NSThread sleepForTimeInterval:0.25];
+    XCTAssertNotNil([cache objectForKey:@"key" timeToLive:10 stale:&stale], @"a longer time to live extends the maximum age");
+    XCTAssertFalse(stale, @"within the longer time to live");
+    XCTAssertNil([cache objectForKey:@"key" timeToLive:0.01 stale:&stale], @"dropped past the maximum age");
+    XCTAssertNil([cache objectForKey:@"key" timeToLive:10 stale:&stale], @"dropped entries are gone");
+}
+
+- (void)test_11_4_ResultCacheRefreshesEachKeyOnce {
+    IMImojiResultCache *cache = [[IMImojiResultCache alloc] initWithCountLimit:10 maximumAge:60];
+    __block NSUInteger startedRefreshes = 0;
+
+    dispatch_apply(64, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        if ([cache beginRefreshForKey:@"key"]) {
+            @synchronized (cache) {
+                startedRefreshes++;
+            }
+        }
+    });
+
+    XCTAssertEqual(startedRefreshes, 1, @"one refresh for concurrent stale reads");
+    XCTAssertTrue([cache beginRefreshForKey:@"other key"], @"keys refresh independently");
+
+    [cache endRefreshForKey:@"key"];
+    XCTAssertTrue([cache beginRefreshForKey:@"key"], @"refreshes again once the previous one ended");
+}
+
+- (void)test_12_1_CategoriesRevalidateWithoutTimeToLive {
+    NSString *path = [self temporaryDirectoryPath];
+    ImojiSDKStubbedStoragePolicy *storagePolicy = [[ImojiSDKStubbedStoragePolicy alloc] initWithCachePath:[NSURL fileURLWithPath:[path stringByAppendingPathComponent:@"cache"]]
+                                                                                           persistentPath:[NSURL fileURLWithPath:[path stringByAppendingPathComponent:@"persistent"]]];
+    storagePolicy.categoriesCacheTimeToLive = 0;
+
+    ImojiSDKStubbedCategoriesRequests = [NSMutableArray array];
+    ImojiSDKStubbedCategoriesData = [self fixtureData:@"imoji-categories-fetch"];
+
+    IMImojiSession *session = [IMImojiSession imojiSessionWithStoragePolicy:storagePolicy];
+    NSMutableArray *responses = [NSMutableArray array];
+
+    for (NSUInteger i = 0; i < 2; i++) {
+        BFTaskCompletionSource *categoriesTaskCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+        [session getImojiCategoriesWithClassification:IMImojiSessionCategoryClassificationGeneric
+                                             callback:^(NSArray *imojiCategories, NSError *error) {
+                                                 XCTAssertNil(error, @"categories error");
+                                                 [responses addObject:imojiCategories ? imojiCategories : @[]];
+                                                 [categoriesTaskCompletionSource setResult:nil];
+                                             }];
+
+        [self runTestWithTask:categoriesTaskCompletionSource.task];
+    }
+
+    XCTAssertEqual(ImojiSDKStubbedCategoriesRequests.count, 2, @"both requests reach the server");
+    XCTAssertNil([ImojiSDKStubbedCategoriesRequests[0] valueForHTTPHeaderField:@"If-None-Match"], @"nothing to revalidate at first");
+    XCTAssertEqualObjects([ImojiSDKStubbedCategoriesRequests[1] valueForHTTPHeaderField:@"If-None-Match"], ImojiSDKStubbedCategoriesEntityTag,
+            @"revalidated with the stored ETag");
+
+    XCTAssertGreaterThan([responses[0] count], 0, @"categories from the full response");
+    XCTAssertEqual([responses[1] count], [responses[0] count], @"categories from the snapshot after a 304");
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)test_13_1_AnalyticsBufferDropsOldestEvents {
+    NSString *path = [self temporaryDirectoryPath];
+    NSMutableArray *batches = [NSMutableArray array];
+    BFTaskCompletionSource *sendCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+
+    IMImojiAnalyticsBuffer *buffer = [[IMImojiAnalyticsBuffer alloc] initWithPath:path
+                                                                         capacity:3
+                                                                  flushEventCount:3
+                                                                    flushInterval:3600
+                                                                        sendBlock:^BFTask *(NSArray *events) {
+                                                                            @synchronized (batches) {
+                                                                                [batches addObject:events];
+                                                                            }
+                                                                            return sendCompletionSource.task;
+                                                                        }];
+
+    for (NSUInteger i = 0; i < 5; i++) {
+        [buffer recordEvent:@{@"id" : @(i)}];
+    }
+
+    XCTAssertEqualObjects([buffer.bufferedEvents valueForKey:@"id"], (@[@2, @3, @4]), @"oldest events dropped");
+    @synchronized (batches) {
+        XCTAssertEqual(batches.count, 1, @"one flush in flight");
+        XCTAssertEqualObjects([batches.firstObject valueForKey:@"id"], (@[@0, @1, @2]), @"flushed once full");
+    }
+
+    [sendCompletionSource setResult:@3];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)test_13_2_AnalyticsBufferRemovesSentEvents {
+    NSString *path = [self temporaryDirectoryPath];
+    BFTaskCompletionSource *sendCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+
+    IMImojiAnalyticsBuffer *buffer = [[IMImojiAnalyticsBuffer alloc] initWithPath:path
+                                                                         capacity:10
+                                                                  flushEventCount:3
+                                                                    flushInterval:3600
+                                                                        sendBlock:^BFTask *(NSArray *events) {
+                                                                            return sendCompletionSource.task;
+                                                                        }];
+
+    for (NSUInteger i = 0; i < 4; i++) {
+        [buffer recordEvent:@{@"id" : @(i)}];
+    }
+
+    // two of the three events in flight are delivered, the event recorded meanwhile stays
+    [sendCompletionSource setResult:@2];
+    [self waitForCondition:^BOOL {
+        return buffer.nextAttemptDate != nil;
+    }];
+
+    XCTAssertEqualObjects([buffer.bufferedEvents valueForKey:@"id"], (@[@2, @3]), @"only sent events removed");
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)test_13_3_AnalyticsBufferBacksOffAfterFailure {
+    NSString *path = [self temporaryDirectoryPath];
+    __block NSUInteger sendCount = 0;
+
+    IMImojiAnalyticsBuffer *buffer = [[IMImojiAnalyticsBuffer alloc] initWithPath:path
+                                                                         capacity:10
+                                                                  flushEventCount:1
+                                                                    flushInterval:3600
+                                                                        sendBlock:^BFTask *(NSArray *events) {
+                                                                            sendCount++;
+                                                                            return [BFTask taskWithResult:@0];
+                                                                        }];
+
+    [buffer recordEvent:@{@"id" : @0}];
+    [self waitForCondition:^BOOL {
+        return buffer.nextAttemptDate != nil;
+    }];
+
+    // the first retry is 5 seconds with up to 50% jitter either way
+    NSTimeInterval retryInterval = buffer.nextAttemptDate.timeIntervalSinceNow;
+    XCTAssertGreaterThan(retryInterval, 2.0, @"retry interval lower bound");
+    XCTAssertLessThanOrEqual(retryInterval, 7.5, @"retry interval upper bound");
+
+    [buffer flush];
+    [buffer recordEvent:@{@"id" : @1}];
+
+    XCTAssertEqual(buffer.bufferedEvents.count, 2, @"failed events kept");
+    XCTAssertEqual(sendCount, 1, @"nothing sent while backing off");
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)test_13_4_AnalyticsBufferStoresPropertyLists {
+    NSString *path = [self temporaryDirectoryPath];
+
+    IMImojiAnalyticsBuffer *buffer = [[IMImojiAnalyticsBuffer alloc] initWithPath:path
+                                                                         capacity:10
+                                                                  flushEventCount:10
+                                                                    flushInterval:3600
+                                                                        sendBlock:^BFTask *(NSArray *events) {
+                                                                            return [BFTask taskWithResult:@(events.count)];
+                                                                        }];
+
+    [buffer recordEvent:@{@"id" : @0, @"url" : [NSURL URLWithString:@"https://imoji.io"]}];
+    [buffer recordEvent:@{@"id" : @1}];
+
+    XCTAssertNil(buffer.bufferedEvents.firstObject[@"url"], @"non property list value dropped");
+
+    // both events are stored by a single delayed write
+    [self waitForCondition:^BOOL {
+        return [[NSFileManager defaultManager] fileExistsAtPath:path];
+    }];
+    XCTAssertEqualObjects([[NSArray arrayWithContentsOfFile:path] valueForKey:@"id"], (@[@0, @1]), @"events stored");
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)test_14_1_LookupBatcherSharesPendingLookups {
+    NSMutableArray *batches = [NSMutableArray array];
+    IMImojiLookupBatcher *batcher = [[IMImojiLookupBatcher alloc] initWithBatchInterval:0.05
+                                                                       maximumBatchSize:10
+                                                                             fetchBlock:^BFTask *(NSArray *identifiers) {
+                                                                                 @synchronized (batches) {
+                                                                                     [batches addObject:identifiers];
+                                                                                 }
+                                                                                 return [BFTask taskWithResult:@[
+                                                                                         [self imojiWithIdentifier:@"a"],
+                                                                                         [self imojiWithIdentifier:@"b"]
+                                                                                 ]];
+                                                                             }];
+
+    BFTask *firstTask = [batcher lookupIdentifier:@"a"];
+    BFTask *secondTask = [batcher lookupIdentifier:@"a"];
+    BFTask *otherTask = [batcher lookupIdentifier:@"b"];
+
+    XCTAssertEqual(firstTask, secondTask, @"lookups of the same identifier share a task");
+
+    [self waitForCondition:^BOOL {
+        return firstTask.completed && otherTask.completed;
+    }];
+
+    XCTAssertEqualObjects([firstTask.result identifier], @"a", @"first lookup");
+    XCTAssertEqualObjects([otherTask.result identifier], @"b", @"second lookup");
+    @synchronized (batches) {
+        XCTAssertEqualObjects(batches, (@[@[@"a", @"b"]]), @"one batch without duplicates");
+    }
+}
+
+- (void)test_14_2_LookupBatcherFlushesFullBatches {
+    NSMutableArray *batches = [NSMutableArray array];
+    IMImojiLookupBatcher *batcher = [[IMImojiLookupBatcher alloc] initWithBatchInterval:3600
+                                                                       maximumBatchSize:2
+                                                                             fetchBlock:^BFTask *(NSArray *identifiers) {
+                                                                                 @synchronized (batches) {
+                                                                                     [batches addObject:identifiers];
+                                                                                 }
+                                                                                 return [BFTask taskWithResult:@[]];
+                                                                             }];
+
+    [batcher lookupIdentifier:@"a"];
+    [batcher lookupIdentifier:@"b"];
+    [batcher lookupIdentifier:@"c"];
+
+    @synchronized (batches) {
+        XCTAssertEqualObjects(batches, (@[@[@"a", @"b"]]), @"full batch fetched without waiting for the interval");
+    }
+}
+
+- (void)test_14_3_LookupBatcherFailsMissingImojis {
+    IMImojiLookupBatcher *batcher = [[IMImojiLookupBatcher alloc] initWithBatchInterval:3600
+                                                                       maximumBatchSize:2
+                                                                             fetchBlock:^BFTask *(NSArray *identifiers) {
+                                                                                 return [BFTask taskWithResult:@[[self imojiWithIdentifier:@"a"]]];
+                                                                             }];
+
+    BFTask *foundTask = [batcher lookupIdentifier:@"a"];
+    BFTask *missingTask = [batcher lookupIdentifier:@"b"];
+
+    [self waitForCondition:^BOOL {
+        return foundTask.completed && missingTask.completed;
+    }];
+
+    XCTAssertEqualObjects([foundTask.result identifier], @"a", @"returned imoji");
+    XCTAssertEqualObjects(missingTask.error.domain, IMImojiSessionErrorDomain, @"missing imoji error domain");
+    XCTAssertEqual(missingTask.error.code, IMImojiSessionErrorCodeImojiDoesNotExist, @"missing imoji error code");
+}
+
+- (void)test_14_4_LookupBatcherRetriesFailedBatchesIndividually {
+    NSError *batchError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorBadServerResponse userInfo:nil];
+    NSMutableArray *batches = [NSMutableArray array];
+    IMImojiLookupBatcher *batcher = [[IMImojiLookupBatcher alloc] initWithBatchInterval:3600
+                                                                       maximumBatchSize:2
+                                                                             fetchBlock:^BFTask *(NSArray *identifiers) {
+                                                                                 @synchronized (batches) {
+                                                                                     [batches addObject:identifiers];
+                                                                                 }
+
+                                                                                 // the request fails whenever it carries b
+                                                                                 if ([identifiers containsObject:@"b"]) {
+                                                                                     return [BFTask taskWithError:batchError];
+                                                                                 }
+
+                                                                                 return [BFTask taskWithResult:@[[self imojiWithIdentifier:@"a"]]];
+                                                                             }];
+
+    BFTask *recoveredTask = [batcher lookupIdentifier:@"a"];
+    BFTask *failedTask = [batcher lookupIdentifier:@"b"];
+
+    [self waitForCondition:^BOOL {
+        return recoveredTask.completed && failedTask.completed;
+    }];
+
+    XCTAssertEqualObjects([recoveredTask.result identifier], @"a", @"identifier recovered on its own");
+    XCTAssertEqualObjects(failedTask.error, batchError, @"identifier failed on its own");
+    @synchronized (batches) {
+        XCTAssertEqualObjects([NSSet setWithArray:batches], ([NSSet setWithArray:@[@[@"a", @"b"], @[@"a"], @[@"b"]]]), @"each identifier retried once");
+        XCTAssertEqual(batches.count, 3, @"no further retries");
+    }
+}
+
+- (void)test_15_1_RetryPolicyRetriesTransientErrorsOnly {
+    for (NSNumber *code in @[@(NSURLErrorTimedOut), @(NSURLErrorNetworkConnectionLost), @(NSURLErrorCannotConnectToHost),
+            @(NSURLErrorCannotFindHost), @(NSURLErrorDNSLookupFailed), @(NSURLErrorNotConnectedToInternet)]) {
+        NSError *error = [NSError errorWithDomain:NSURLErrorDomain code:code.integerValue userInfo:nil];
+        XCTAssertTrue([IMImojiRetryPolicy isRetryableError:error], @"transient error %@", code);
+    }
+
+    for (NSNumber *code in @[@(NSURLErrorCancelled), @(NSURLErrorBadURL), @(NSURLErrorUserAuthenticationRequired),
+            @(NSURLErrorSecureConnectionFailed), @(NSURLErrorCannotDecodeContentData)]) {
+        NSError *error = [NSError errorWithDomain:NSURLErrorDomain code:code.integerValue userInfo:nil];
+        XCTAssertFalse([IMImojiRetryPolicy isRetryableError:error], @"permanent error %@", code);
+    }
+
+    XCTAssertTrue([IMImojiRetryPolicy isRetryableError:[NSError errorWithDomain:IMImojiSessionErrorDomain code:IMImojiSessionErrorCodeServerError userInfo:@{@"statusCode" : @503}]], @"server error");
+    XCTAssertTrue([IMImojiRetryPolicy isRetryableError:[NSError errorWithDomain:IMImojiSessionErrorDomain code:IMImojiSessionErrorCodeServerError userInfo:@{@"statusCode" : @429}]], @"rate limited");
+    XCTAssertFalse([IMImojiRetryPolicy isRetryableError:[NSError errorWithDomain:IMImojiSessionErrorDomain code:IMImojiSessionErrorCodeServerError userInfo:@{@"statusCode" : @404}]], @"client error");
+    XCTAssertFalse([IMImojiRetryPolicy isRetryableError:[NSError errorWithDomain:IMImojiSessionErrorDomain code:IMImojiSessionErrorCodeServerError userInfo:nil]], @"unknown error");
+}
+
+- (void)test_15_2_RetryPolicyBackoffRange {
+    IMImojiRetryPolicy *retryPolicy = [[IMImojiRetryPolicy alloc] initWithInitialBackoffInterval:0.5
+                                                                          maximumBackoffInterval:30
+                                                                                failureThreshold:5
+                                                                             circuitOpenInterval:30];
+
+    for (NSUInteger retry = 0; retry < 12; retry++) {
+        NSTimeInterval maximumInterval = MIN(0.5 * pow(2.0, retry), 30.0);
+        NSTimeInterval longestInterval = 0;
+
+        for (NSUInteger i = 0; i < 200; i++) {
+            NSTimeInterval backoffInterval = [retryPolicy backoffIntervalForRetry:retry];
+            XCTAssertGreaterThanOrEqual(backoffInterval, 0, @"backoff of retry %lu", (unsigned long) retry);
+            XCTAssertLessThanOrEqual(backoffInterval, maximumInterval, @"backoff of retry %lu", (unsigned long) retry);
+            longestInterval = MAX(longestInterval, backoffInterval);
+        }
+
+        // full jitter spreads the delays over the whole range
+        XCTAssertGreaterThan(longestInterval, maximumInterval / 2, @"jitter of retry %lu", (unsigned long) retry);
+    }
+}
+
+- (void)test_15_3_RetryPolicyTimeoutFollowsRoundTripTimes {
+    IMImojiRetryPolicy *retryPolicy = [[IMImojiRetryPolicy alloc] initWithInitialBackoffInterval:0.5
+                                                                          maximumBackoffInterval:30
+                                                                                failureThreshold:5
+                                                                             circuitOpenInterval:30];
+
+    XCTAssertEqualWithAccuracy([retryPolicy timeoutIntervalForHost:@"imoji.io" minimumTimeoutInterval:0], 15.0, 1e-9, @"default before any measurement");
+
+    // the first sample sets SRTT = R and RTTVAR = R / 2
+    [retryPolicy recordResponseFromHost:@"imoji.io" roundTripTime:1.0];
+    XCTAssertEqualWithAccuracy([retryPolicy timeoutIntervalForHost:@"imoji.io" minimumTimeoutInterval:0], 3.0, 1e-9, @"first sample");
+
+    // then RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R| and SRTT = 7/8 SRTT + 1/8 R
+    [retryPolicy recordResponseFromHost:@"imoji.io" roundTripTime:2.0];
+    XCTAssertEqualWithAccuracy([retryPolicy timeoutIntervalForHost:@"imoji.io" minimumTimeoutInterval:0], 1.125 + 4 * 0.625, 1e-9, @"second sample");
+    XCTAssertEqualWithAccuracy([retryPolicy timeoutIntervalForHost:@"imoji.io" minimumTimeoutInterval:5], 5.0, 1e-9, @"minimum timeout");
+
+    // a timeout backs the smoothed round trip time off
+    [retryPolicy recordFailureForHost:@"imoji.io" timedOut:YES];
+    XCTAssertEqualWithAccuracy([retryPolicy timeoutIntervalForHost:@"imoji.io" minimumTimeoutInterval:0], 2.25 + 4 * 0.625, 1e-9, @"after a timeout");
+
+    XCTAssertEqualWithAccuracy([retryPolicy timeoutIntervalForHost:@"other.imoji.io" minimumTimeoutInterval:0], 15.0, 1e-9, @"measured per host");
+}
+
+- (void)test_15_4_RetryPolicyCircuitBreaker {
+    IMImojiRetryPolicy *retryPolicy = [[IMImojiRetryPolicy alloc] initWithInitialBackoffInterval:0.5
+                                                                          maximumBackoffInterval:30
+                                                                                failureThreshold:2
+                                                                             circuitOpenInterval:0.2];
+    NSURL *url = [NSURL URLWithString:@"https://media.imoji.io/sticker.png"];
+    NSError *timeoutError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorTimedOut userInfo:nil];
+    __block NSUInteger attemptCount = 0;
+
+    BFTask *(^runRequest)(BFTask *) = ^BFTask *(BFTask *attemptTask) {
+        return [retryPolicy runRequestWithURL:url
+                               maximumRetries:0
+                       minimumTimeoutInterval:0
+                            cancellationToken:nil
+                                 requestBlock:^BFTask *(NSTimeInterval timeoutInterval) {
+                                     attemptCount++;
+                                     return attemptTask;
+                                 }];
+    };
+
+    // closed until the threshold is reached
+    for (NSUInteger i = 0; i < 2; i++) {
+        BFTask *failedTask = runRequest([BFTask taskWithError:timeoutError]);
+        [self waitForCondition:^BOOL {
+            return failedTask.completed;
+        }];
+    }
+    XCTAssertEqual(attemptCount, 2, @"requests go through while closed");
+
+    // open, requests fail without reaching the host
+    BFTask *openTask = runRequest([BFTask taskWithResult:nil]);
+    [self waitForCondition:^BOOL {
+        return openTask.completed;
+    }];
+    XCTAssertEqual(attemptCount, 2, @"no request while open");
+    XCTAssertEqual(openTask.error.code, IMImojiSessionErrorCodeServerError, @"fails fast while open");
+
+    // half open, a single trial goes through
+    [NSThread sleepForTimeInterval:0.25];
+    BFTaskCompletionSource *trialCompletionSource = [BFTaskCompletionSource taskCompletionSource];
+    BFTask *trialTask = runRequest(trialCompletionSource.task);
+    BFTask *concurrentTask = runRequest([BFTask taskWithResult:nil]);
+    [self waitForCondition:^BOOL {
+        return concurrentTask.completed;
+    }];
+    XCTAssertEqual(attemptCount, 3, @"only the trial goes through while half open");
+    XCTAssertEqual(concurrentTask.error.code, IMImojiSessionErrorCodeServerError, @"fails fast during the trial");
+
+    // a successful trial closes the circuit again
+    [trialCompletionSource setResult:@YES];
+    [self waitForCondition:^BOOL {
+        return trialTask.completed;
+    }];
+    BFTask *closedTask = runRequest([BFTask taskWithResult:@YES]);
+    [self waitForCondition:^BOOL {
+        return closedTask.completed;
+    }];
+    XCTAssertEqual(attemptCount, 4, @"requests go through once closed");
+    XCTAssertNil(closedTask.error, @"closed request succeeds");
+}
+
+- (void)test_16_1_CreatedImojiVariantsKeyedByWrittenFormat {
+    for (NSNumber *encodesAsWebP in @[@NO, @YES]) {
+        IMImojiSessionStoragePolicy *storagePolicy = [IMImojiSessionStoragePolicy temporaryDiskStoragePolicy];
+        storagePolicy.encodesCreatedImojisAsWebP = encodesAsWebP.boolValue;
+        IMImojiSession *session = [IMImojiSession imojiSessionWithStoragePolicy:storagePolicy];
+
+        BFTask *createTask = [session createLocalImojiWithRawImage:[self imageWithPixelSize:CGSizeMake(300, 300)]
+                                                     borderedImage:[self imageWithPixelSize:CGSizeMake(320, 320)]
+                                                              tags:@[]];
+        [self waitForCondition:^BOOL {
+            return createTask.completed;
+        }];
+
+        XCTAssertNil(createTask.error, @"created imoji");
+        IMImojiObject *imoji = createTask.result;
+        XCTAssertEqual(imoji.urls.count, 4, @"every variant written");
+
+        NSUInteger webPCount = 0;
+        for (IMImojiObjectRenderingOptions *renderingOptions in imoji.urls) {
+            NSURL *url = imoji.urls[renderingOptions];
+            NSData *data = [NSData dataWithContentsOfURL:url];
+            XCTAssertNotNil(data, @"variant file exists");
+
+            // RIFF....WEBP
+            BOOL isWebP = data.length >= 12 &&
+                    memcmp(data.bytes, "RIFF", 4) == 0 &&
+                    memcmp((const uint8_t *) data.bytes + 8, "WEBP", 4) == 0;
+            XCTAssertEqual(renderingOptions.imageFormat == IMImojiObjectImageFormatWebP, isWebP, @"variant keyed by the written format");
+            XCTAssertTrue([url.pathExtension isEqualToString:[@(renderingOptions.imageFormat) stringValue]],
+                    @"variant named by the written format");
+
+            webPCount += isWebP ? 1 : 0;
+        }
+
+        if (!encodesAsWebP.boolValue) {
+            XCTAssertEqual(webPCount, 0, @"PNG unless WebP is enabled");
+        }
+
+        [session removeLocalImoj:imoji];
+    }
+}
+
+/**
+ * Reads Test/Fixtures/<name>.json, recorded responses of the endpoint the file is named after. Parsing happens here,
+ * outside of the measured blocks, so the benchmarks only time the SDK.
+ */
+- (NSDictionary *)loadFixture:(NSString *)name {
+    NSData *data = [self fixtureData:name];
+    NSDictionary *fixture = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+
+    XCTAssertTrue([fixture isKindOfClass:[NSDictionary class]], @"%@ fixture", name);
+    return fixture;
+}
+
+- (NSData *)fixtureData:(NSString *)name {
+    NSURL *url = [[NSBundle bundleForClass:[self class]] URLForResource:name withExtension:@"json"];
+    NSData *data = url ? [NSData dataWithContentsOfURL:url] : nil;
+
+    XCTAssertNotNil(data, @"%@ fixture data", name);
+    return data;
+}
+
+/**
+ * Feeds data to a streaming decoder in chunks of the sizes chunkSize returns, collecting the records it hands out in
+ * order. Returns what finishWithError: does, or nil as soon as a chunk is rejected.
+ */
+- (NSDictionary *)decodeStreamedData:(NSData *)data
+                    streamedArrayKey:(NSString *)streamedArrayKey
+                             records:(NSMutableArray *)records
+                           chunkSize:(NSUInteger (^)(void))chunkSize
+                               error:(NSError **)error {
+    IMImojiStreamingJSONDecoder *decoder = [[IMImojiStreamingJSONDecoder alloc] initWithStreamedArrayKey:streamedArrayKey
+                                                                                           recordHandler:^(NSDictionary *record, NSUInteger index) {
+                                                                                               XCTAssertEqual(index, records.count, @"records in order");
+                                                                                               [records addObject:record];
+                                                                                           }];
+
+    for (NSUInteger offset = 0; offset < data.length;) {
+        NSUInteger length = MIN(chunkSize(), data.length - offset);
+        if (![decoder appendData:[data subdataWithRange:NSMakeRange(offset, length)] error:error]) {
+            return nil;
+        }
+
+        offset += length;
+    }
+
+    XCTAssertEqual(decoder.recordCount, records.count, @"record count");
+    return [decoder finishWithError:error];
+}
+
+/**
+ * Measures block with XCTest and logs nanoseconds and allocations per call. Every malloc, calloc and realloc made on
+ * the calling thread while block runs is counted, including memory that is freed again before it returns.
+ */
+- (void)runBenchmark:(NSString *)name iterations:(NSUInteger)iterations block:(id (^)(void))block {
+    // lazily initialized statics and caches shouldn't be billed to the first iteration
+    XCTAssertNotNil(block(), @"%@ benchmark result", name);
+
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+
+    [self measureBlock:^{
+        uint64_t elapsed = 0;
+        uint64_t allocations = 0;
+
+        for (NSUInteger i = 0; i < iterations; i++) {
+            @autoreleasepool {
+                ImojiSDKCountedThread = pthread_self();
+                ImojiSDKAllocationCount = 0;
+                ImojiSDKPreviousMallocLogger = malloc_logger;
+                malloc_logger = ImojiSDKCountingMallocLogger;
+                uint64_t start = mach_absolute_time();
+
+                id result = block();
+
+                elapsed += mach_absolute_time() - start;
+                malloc_logger = ImojiSDKPreviousMallocLogger;
+                allocations += ImojiSDKAllocationCount;
+
+                // released outside of the measured region
+                result = nil;
+            }
+        }
+
+        NSLog(@"%@: %.0f ns/op, %.1f allocations/op", name,
+                (double) elapsed * timebase.numer / timebase.denom / iterations,
+                (double) allocations / iterations);
+    }];
+}
+
+/**
+ * Creates a download with one caller attached through cancellationToken, which sets its priority.
+ */
+- (IMImojiImageDownload *)downloadWithCancellationToken:(NSOperation *)cancellationToken {
+    IMImojiImageDownload *download = [IMImojiImageDownload downloadWithURL:[NSURL URLWithString:[NSString stringWithFormat:@"https://imoji.io/imoji/%@.webp", [[NSUUID UUID] UUIDString]]]];
+    [download addCancellationToken:cancellationToken];
+
+    return download;
+}
+
+/**
+ * Runs the run loop until condition returns YES.
+ */
+- (void)waitForCondition:(BOOL (^)(void))condition {
+    while (!condition()) {
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode
+                                 beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+}
+
+/**
+ * A unique path in the temporary directory for stores the test removes when it's done.
+ */
+- (NSString *)temporaryDirectoryPath {
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+}
+
+/**
+ * Creates an imoji with no urls, enough to key cache entries with.
+ */
+- (IMImojiObject *)imojiWithIdentifier:(NSString *)identifier {
+    return [IMMutableImojiObject imojiWithIdentifier:identifier tags:@[] urls:@{}];
+}
+
+/**
+ * Draws an opaque image of size pixels at a scale of 1.
+ */
+- (UIImage *)imageWithPixelSize:(CGSize)size {
+    UIGraphicsBeginImageContextWithOptions(size, YES, 1.0f);
+    [[UIColor redColor] setFill];
+    UIRectFill(CGRectMake(0, 0, size.width, size.height));
+    UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+
+    return image;
+}
+
 - (void)runTestWithTask:(BFTask *)task {
     dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
 
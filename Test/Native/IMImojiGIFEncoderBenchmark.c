@@ -0,0 +1,122 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+// Timing driver for IMImojiGIFEncoder. Encodes a synthetic sticker sized animation with every palette and dither
+// combination and reports the time per frame and the output size. Pass the number of iterations as the only argument.
+
+#include "IMImojiGIFEncoder.h"
+#include "IMImojiNativeTesting.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_SIZE 408
+#define BENCHMARK_FRAME_COUNT 24
+
+static int CountBytes(void *context, const uint8_t *bytes, size_t length) {
+    (void) bytes;
+    *(size_t *) context += length;
+    return 1;
+}
+
+// a soft shaded disc moving and changing color over a transparent background, roughly what a converted sticker holds
+static void DrawBenchmarkFrame(int frame, uint8_t *rgba) {
+    int centerX = BENCHMARK_SIZE / 2 + (frame % 8 - 4) * 6;
+    int centerY = BENCHMARK_SIZE / 2 + (frame % 6 - 3) * 4;
+    int radius = BENCHMARK_SIZE * 2 / 5;
+
+    for (int y = 0; y < BENCHMARK_SIZE; y++) {
+        for (int x = 0; x < BENCHMARK_SIZE; x++) {
+            uint8_t *pixel = rgba + ((size_t) y * BENCHMARK_SIZE + x) * 4;
+            int dx = x - centerX, dy = y - centerY;
+            int distance = dx * dx + dy * dy;
+            if (distance > radius * radius) {
+                memset(pixel, 0, 4);
+                continue;
+            }
+
+            int shade = 255 - distance * 160 / (radius * radius);
+            pixel[0] = (uint8_t) (shade * (128 + frame * 5) / 255);
+            pixel[1] = (uint8_t) (shade * (x * 255 / BENCHMARK_SIZE) / 255);
+            pixel[2] = (uint8_t) (shade * (y * 255 / BENCHMARK_SIZE) / 255);
+            pixel[3] = 255;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 5;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    size_t frameSize = (size_t) BENCHMARK_SIZE * BENCHMARK_SIZE * 4;
+    uint8_t *frames = malloc(frameSize * BENCHMARK_FRAME_COUNT);
+    for (int frame = 0; frame < BENCHMARK_FRAME_COUNT; frame++) {
+        DrawBenchmarkFrame(frame, frames + frameSize * frame);
+    }
+
+    printf("%dx%d, %d frames, %d iterations\n", BENCHMARK_SIZE, BENCHMARK_SIZE, BENCHMARK_FRAME_COUNT, iterations);
+
+    for (int paletteMode = IMImojiGIFEncoderPaletteShared; paletteMode <= IMImojiGIFEncoderPalettePerFrame; paletteMode++) {
+        for (int dither = 0; dither <= 1; dither++) {
+            IMImojiGIFEncoderOptions options;
+            IMImojiGIFEncoderGetDefaultOptions(&options);
+            options.paletteMode = (IMImojiGIFEncoderPaletteMode) paletteMode;
+            options.dither = dither;
+
+            size_t outputLength = 0;
+            double start = IMBenchmarkSeconds();
+            for (int iteration = 0; iteration < iterations; iteration++) {
+                outputLength = 0;
+                IMImojiGIFEncoder *encoder = IMImojiGIFEncoderCreate(BENCHMARK_SIZE, BENCHMARK_SIZE, &options, CountBytes, &outputLength);
+                if (paletteMode == IMImojiGIFEncoderPaletteShared) {
+                    for (int frame = 0; frame < BENCHMARK_FRAME_COUNT; frame += BENCHMARK_FRAME_COUNT / 8) {
+                        IMImojiGIFEncoderAddPaletteSample(encoder, frames + frameSize * frame, BENCHMARK_SIZE * 4);
+                    }
+                }
+
+                for (int frame = 0; frame < BENCHMARK_FRAME_COUNT; frame++) {
+                    IMImojiGIFEncoderAddFrame(encoder, frames + frameSize * frame, BENCHMARK_SIZE * 4, 4);
+                }
+
+                if (IMImojiGIFEncoderFinish(encoder) != IMImojiGIFEncoderStatusSuccess) {
+                    fprintf(stderr, "encoding failed\n");
+                    return 1;
+                }
+                IMImojiGIFEncoderDestroy(encoder);
+            }
+            double elapsed = IMBenchmarkSeconds() - start;
+
+            printf("%-9s palette, dither %d: %8.3f ms/frame %9.3f ms/animation %8zu bytes\n",
+                    paletteMode == IMImojiGIFEncoderPaletteShared ? "shared" : "per frame", dither,
+                    elapsed * 1000.0 / ((double) iterations * BENCHMARK_FRAME_COUNT),
+                    elapsed * 1000.0 / iterations, outputLength);
+        }
+    }
+
+    free(frames);
+    return 0;
+}
@@ -0,0 +1,589 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+// Round trip tests for IMImojiGIFEncoder. Every animation is encoded, decoded again by the minimal GIF decoder below
+// and composited frame by frame, then compared with the frames that were passed in.
+
+#include "IMImojiGIFEncoder.h"
+#include "IMImojiNativeTesting.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_WIDTH 97
+#define TEST_HEIGHT 61
+#define TEST_FRAME_COUNT 12
+#define TEST_ROW_PADDING 12
+
+// MARK: Output Buffer
+
+typedef struct {
+    uint8_t *bytes;
+    size_t length;
+    size_t capacity;
+} TestBuffer;
+
+static int TestBufferWrite(void *context, const uint8_t *bytes, size_t length) {
+    TestBuffer *buffer = context;
+    if (buffer->length + length > buffer->capacity) {
+        size_t capacity = (buffer->capacity + length) * 2;
+        uint8_t *grown = realloc(buffer->bytes, capacity);
+        if (!grown) {
+            return 0;
+        }
+
+        buffer->bytes = grown;
+        buffer->capacity = capacity;
+    }
+
+    memcpy(buffer->bytes + buffer->length, bytes, length);
+    buffer->length += length;
+    return 1;
+}
+
+// MARK: Decoder
+
+typedef struct {
+    int width;
+    int height;
+    int frameCount;
+    uint8_t *frames;        // frameCount composited RGBA canvases, alpha is 0 or 255
+    int delays[64];
+    int loopCount;          // -1 when the loop extension is missing
+    int lzwResets;          // clear codes found after the first code of a frame
+} DecodedGIF;
+
+typedef struct {
+    const uint8_t *bytes;
+    size_t length;
+    size_t position;
+    int failed;
+} Reader;
+
+static int ReadByte(Reader *reader) {
+    if (reader->position >= reader->length) {
+        reader->failed = 1;
+        return 0;
+    }
+
+    return reader->bytes[reader->position++];
+}
+
+static int ReadShort(Reader *reader) {
+    int low = ReadByte(reader);
+    return low | ReadByte(reader) << 8;
+}
+
+// concatenates a chain of data sub-blocks, returns the number of bytes read
+static size_t ReadSubBlocks(Reader *reader, uint8_t *data, size_t capacity) {
+    size_t length = 0;
+    int blockLength;
+    while ((blockLength = ReadByte(reader)) > 0 && !reader->failed) {
+        for (int i = 0; i < blockLength; i++) {
+            uint8_t value = (uint8_t) ReadByte(reader);
+            if (data && length < capacity) {
+                data[length] = value;
+            }
+            length++;
+        }
+    }
+
+    return length;
+}
+
+static int DecodeLZW(const uint8_t *data, size_t length, int minimumCodeSize, uint8_t *indices, size_t pixelCount, int *resets) {
+    static uint16_t prefixes[4096];
+    static uint8_t suffixes[4096];
+    static uint8_t stack[4097];
+
+    int clearCode = 1 << minimumCodeSize;
+    int endCode = clearCode + 1;
+    int codeSize = minimumCodeSize + 1;
+    int nextCode = endCode + 1;
+    int previousCode = -1;
+    uint8_t firstByte = 0;
+    uint32_t bits = 0;
+    int bitCount = 0;
+    size_t position = 0;
+    size_t written = 0;
+    int codesRead = 0;
+
+    for (int code = 0; code < clearCode; code++) {
+        prefixes[code] = 0xFFFF;
+        suffixes[code] = (uint8_t) code;
+    }
+
+    while (1) {
+        while (bitCount < codeSize) {
+            if (position >= length) {
+                return 0;
+            }
+            bits |= (uint32_t) data[position++] << bitCount;
+            bitCount += 8;
+        }
+
+        int code = (int) (bits & ((1u << codeSize) - 1));
+        bits >>= codeSize;
+        bitCount -= codeSize;
+
+        if (code == clearCode) {
+            if (codesRead > 0) {
+                (*resets)++;
+            }
+            codesRead++;
+            codeSize = minimumCodeSize + 1;
+            nextCode = endCode + 1;
+            previousCode = -1;
+            continue;
+        }
+
+        codesRead++;
+        if (code == endCode) {
+            break;
+        }
+
+        if (previousCode < 0) {
+            if (code >= clearCode || written >= pixelCount) {
+                return 0;
+            }
+            indices[written++] = suffixes[code];
+            firstByte = suffixes[code];
+            previousCode = code;
+            continue;
+        }
+
+        int stackLength = 0;
+        int current = code;
+        if (code > nextCode || (code == nextCode && nextCode >= 4096)) {
+            return 0;
+        } else if (code == nextCode) {
+            stack[stackLength++] = firstByte;
+            current = previousCode;
+        }
+
+        while (current >= clearCode) {
+            stack[stackLength++] = suffixes[current];
+            current = prefixes[current];
+        }
+        stack[stackLength++] = suffixes[current];
+        firstByte = suffixes[current];
+
+        while (stackLength > 0) {
+            if (written >= pixelCount) {
+                return 0;
+            }
+            indices[written++] = stack[--stackLength];
+        }
+
+        if (nextCode < 4096) {
+            prefixes[nextCode] = (uint16_t) previousCode;
+            suffixes[nextCode] = firstByte;
+            nextCode++;
+            if (nextCode == 1 << codeSize && codeSize < 12) {
+                codeSize++;
+            }
+        }
+
+        previousCode = code;
+    }
+
+    return written == pixelCount;
+}
+
+static int DecodeGIF(const uint8_t *bytes, size_t length, DecodedGIF *gif) {
+    Reader reader = {bytes, length, 0, 0};
+    memset(gif, 0, sizeof(*gif));
+    gif->loopCount = -1;
+
+    if (length < 13 || memcmp(bytes, "GIF89a", 6) != 0) {
+        return 0;
+    }
+    reader.position = 6;
+
+    gif->width = ReadShort(&reader);
+    gif->height = ReadShort(&reader);
+    int packed = ReadByte(&reader);
+    ReadByte(&reader);
+    ReadByte(&reader);
+
+    uint8_t globalColors[768];
+    int globalColorCount = 0;
+    if (packed & 0x80) {
+        globalColorCount = 2 << (packed & 7);
+        for (int i = 0; i < globalColorCount * 3; i++) {
+            globalColors[i] = (uint8_t) ReadByte(&reader);
+        }
+    }
+
+    size_t canvasSize = (size_t) gif->width * gif->height * 4;
+    uint8_t *canvas = calloc(canvasSize, 1);
+    uint8_t *indices = malloc((size_t) gif->width * gif->height);
+    uint8_t *data = malloc(length);
+    int disposal = 0, transparentIndex = -1, delay = 0;
+
+    while (!reader.failed) {
+        int introducer = ReadByte(&reader);
+        if (introducer == 0x3B) {
+            break;
+        }
+
+        if (introducer == 0x21) {
+            int label = ReadByte(&reader);
+            uint8_t extension[32];
+            size_t extensionLength = ReadSubBlocks(&reader, extension, sizeof(extension));
+            if (label == 0xF9 && extensionLength >= 4) {
+                disposal = (extension[0] >> 2) & 7;
+                transparentIndex = extension[0] & 1 ? extension[3] : -1;
+                delay = extension[1] | extension[2] << 8;
+            } else if (label == 0xFF && extensionLength >= 14 && memcmp(extension, "NETSCAPE2.0", 11) == 0) {
+                gif->loopCount = extension[12] | extension[13] << 8;
+            }
+            continue;
+        }
+
+        if (introducer != 0x2C || gif->frameCount >= 64) {
+            reader.failed = 1;
+            break;
+        }
+
+        int left = ReadShort(&reader), top = ReadShort(&reader);
+        int width = ReadShort(&reader), height = ReadShort(&reader);
+        int imagePacked = ReadByte(&reader);
+        if (left + width > gif->width || top + height > gif->height || (imagePacked & 0x40)) {
+            reader.failed = 1;
+            break;
+        }
+
+        uint8_t localColors[768];
+        const uint8_t *colors = globalColors;
+        int colorCount = globalColorCount;
+        if (imagePacked & 0x80) {
+            colorCount = 2 << (imagePacked & 7);
+            for (int i = 0; i < colorCount * 3; i++) {
+                localColors[i] = (uint8_t) ReadByte(&reader);
+            }
+            colors = localColors;
+        }
+
+        int minimumCodeSize = ReadByte(&reader);
+        size_t dataLength = ReadSubBlocks(&reader, data, length);
+        if (!DecodeLZW(data, dataLength, minimumCodeSize, indices, (size_t) width * height, &gif->lzwResets)) {
+            reader.failed = 1;
+            break;
+        }
+
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                int index = indices[y * width + x];
+                if (index == transparentIndex) {
+                    continue;
+                }
+                if (index >= colorCount) {
+                    reader.failed = 1;
+                    break;
+                }
+
+                uint8_t *pixel = canvas + ((size_t) (top + y) * gif->width + left + x) * 4;
+                memcpy(pixel, colors + index * 3, 3);
+                pixel[3] = 255;
+            }
+        }
+
+        gif->frames = realloc(gif->frames, canvasSize * (gif->frameCount + 1));
+        memcpy(gif->frames + canvasSize * gif->frameCount, canvas, canvasSize);
+        gif->delays[gif->frameCount++] = delay;
+
+        if (disposal == 2) {
+            for (int y = 0; y < height; y++) {
+                memset(canvas + ((size_t) (top + y) * gif->width + left) * 4, 0, (size_t) width * 4);
+            }
+        }
+        disposal = 0;
+        transparentIndex = -1;
+        delay = 0;
+    }
+
+    free(canvas);
+    free(indices);
+    free(data);
+    return !reader.failed;
+}
+
+// MARK: Test Animations
+
+// a gradient with a moving block, areas turning transparent and opaque again, a half transparent strip and frame 5
+// repeating frame 4
+static void DrawTestFrame(int frame, int premultiplied, uint8_t *rgba, size_t bytesPerRow) {
+    int source = frame == 5 ? 4 : frame;
+    for (int y = 0; y < TEST_HEIGHT; y++) {
+        for (int x = 0; x < TEST_WIDTH; x++) {
+            uint8_t *pixel = rgba + y * bytesPerRow + x * 4;
+            int alpha = 255;
+            if (x < 10 && source % 3 == 0) {
+                alpha = 0;
+            }
+            if (y > 50 && source >= 8) {
+                alpha = 0;
+            }
+            if (x > 80 && y < 5) {
+                alpha = 100;
+            }
+            if (x > 60 && x < 70 && y > 40 && (source == 2 || source == 3 || source == 9)) {
+                alpha = 180;
+            }
+
+            int red = x * 255 / TEST_WIDTH, green = y * 255 / TEST_HEIGHT, blue = (x + y) * 3 % 256;
+            if (x >= source * 6 && x < source * 6 + 10 && y > 20 && y < 35) {
+                red = 255;
+                green = blue = 0;
+            }
+
+            if (premultiplied) {
+                red = red * alpha / 255;
+                green = green * alpha / 255;
+                blue = blue * alpha / 255;
+            }
+
+            pixel[0] = (uint8_t) red;
+            pixel[1] = (uint8_t) green;
+            pixel[2] = (uint8_t) blue;
+            pixel[3] = (uint8_t) alpha;
+        }
+    }
+}
+
+typedef struct {
+    int maximumError;
+    double meanError;
+    int alphaMismatches;
+} FrameComparison;
+
+// compares a decoded canvas with the frame it was encoded from, the way the encoder is expected to normalize it
+static void CompareFrame(const uint8_t *decoded, const uint8_t *rgba, size_t bytesPerRow, int width, int height,
+        int premultiplied, uint8_t alphaThreshold, FrameComparison *comparison) {
+    long totalError = 0;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const uint8_t *expected = rgba + y * bytesPerRow + x * 4;
+            const uint8_t *actual = decoded + ((size_t) y * width + x) * 4;
+            int opaque = expected[3] >= alphaThreshold;
+            if (opaque != (actual[3] == 255)) {
+                comparison->alphaMismatches++;
+                continue;
+            }
+            if (!opaque) {
+                continue;
+            }
+
+            for (int c = 0; c < 3; c++) {
+                int value = expected[c];
+                if (premultiplied && expected[3] < 255) {
+                    value = (value * 255 + expected[3] / 2) / expected[3];
+                    value = value > 255 ? 255 : value;
+                }
+
+                int error = abs(value - actual[c]);
+                totalError += error;
+                if (error > comparison->maximumError) {
+                    comparison->maximumError = error;
+                }
+            }
+        }
+    }
+
+    double mean = (double) totalError / ((double) width * height * 3);
+    if (mean > comparison->meanError) {
+        comparison->meanError = mean;
+    }
+}
+
+static uint8_t *EncodeTestAnimation(const IMImojiGIFEncoderOptions *options, TestBuffer *buffer) {
+    size_t bytesPerRow = TEST_WIDTH * 4 + TEST_ROW_PADDING;
+    uint8_t *frames = malloc(bytesPerRow * TEST_HEIGHT * TEST_FRAME_COUNT);
+
+    IMImojiGIFEncoder *encoder = IMImojiGIFEncoderCreate(TEST_WIDTH, TEST_HEIGHT, options, TestBufferWrite, buffer);
+    IM_CHECK(encoder != NULL, "encoder created");
+    if (!encoder) {
+        free(frames);
+        return NULL;
+    }
+
+    for (int frame = 0; frame < TEST_FRAME_COUNT; frame++) {
+        DrawTestFrame(frame, options->premultipliedAlpha, frames + bytesPerRow * TEST_HEIGHT * frame, bytesPerRow);
+        if (options->paletteMode == IMImojiGIFEncoderPaletteShared && frame % 4 == 0) {
+            IM_CHECK(IMImojiGIFEncoderAddPaletteSample(encoder, frames + bytesPerRow * TEST_HEIGHT * frame, bytesPerRow) == IMImojiGIFEncoderStatusSuccess,
+                    "palette sample %d added", frame);
+        }
+    }
+
+    for (int frame = 0; frame < TEST_FRAME_COUNT; frame++) {
+        IM_CHECK(IMImojiGIFEncoderAddFrame(encoder, frames + bytesPerRow * TEST_HEIGHT * frame, bytesPerRow, (uint16_t) (5 + frame)) == IMImojiGIFEncoderStatusSuccess,
+                "frame %d added", frame);
+    }
+
+    IM_CHECK(IMImojiGIFEncoderFinish(encoder) == IMImojiGIFEncoderStatusSuccess, "encoder finished");
+    IMImojiGIFEncoderDestroy(encoder);
+    return frames;
+}
+
+// MARK: Tests
+
+static void TestRoundTrip(IMImojiGIFEncoderPaletteMode paletteMode, int dither, int premultiplied,
+        int maximumError, double maximumMeanError) {
+    IMImojiGIFEncoderOptions options;
+    IMImojiGIFEncoderGetDefaultOptions(&options);
+    options.paletteMode = paletteMode;
+    options.dither = dither;
+    options.premultipliedAlpha = premultiplied;
+    options.loopCount = 3;
+
+    IM_TEST_BEGIN("round trip, %s palette, dither %d, premultiplied %d",
+            paletteMode == IMImojiGIFEncoderPaletteShared ? "shared" : "per frame", dither, premultiplied);
+
+    TestBuffer buffer = {0};
+    uint8_t *frames = EncodeTestAnimation(&options, &buffer);
+    DecodedGIF gif;
+    int decoded = frames && DecodeGIF(buffer.bytes, buffer.length, &gif);
+    IM_CHECK(decoded, "output decodes");
+
+    if (decoded) {
+        size_t bytesPerRow = TEST_WIDTH * 4 + TEST_ROW_PADDING;
+        size_t canvasSize = (size_t) TEST_WIDTH * TEST_HEIGHT * 4;
+
+        IM_CHECK(gif.width == TEST_WIDTH && gif.height == TEST_HEIGHT, "canvas is %dx%d", gif.width, gif.height);
+        IM_CHECK(gif.loopCount == 3, "loop count is %d", gif.loopCount);
+        // frame 5 repeats frame 4 and is merged into it
+        IM_CHECK(gif.frameCount == TEST_FRAME_COUNT - 1, "%d frames decoded", gif.frameCount);
+
+        FrameComparison comparison = {0};
+        for (int frame = 0, decodedFrame = 0; frame < TEST_FRAME_COUNT && decodedFrame < gif.frameCount; frame++) {
+            if (frame == 5) {
+                continue;
+            }
+
+            int expectedDelay = frame == 4 ? (5 + 4) + (5 + 5) : 5 + frame;
+            IM_CHECK(gif.delays[decodedFrame] == expectedDelay, "frame %d delay %d, expected %d", decodedFrame, gif.delays[decodedFrame], expectedDelay);
+
+            CompareFrame(gif.frames + canvasSize * decodedFrame, frames + bytesPerRow * TEST_HEIGHT * frame, bytesPerRow,
+                    TEST_WIDTH, TEST_HEIGHT, premultiplied, options.alphaThreshold, &comparison);
+            decodedFrame++;
+        }
+
+        IM_CHECK(comparison.alphaMismatches == 0, "%d pixels with the wrong transparency", comparison.alphaMismatches);
+        IM_CHECK(comparison.maximumError <= maximumError, "maximum error %d, allowed %d", comparison.maximumError, maximumError);
+        IM_CHECK(comparison.meanError <= maximumMeanError, "mean error %.2f, allowed %.2f", comparison.meanError, maximumMeanError);
+        free(gif.frames);
+    }
+
+    free(frames);
+    free(buffer.bytes);
+    IM_TEST_END();
+}
+
+// a frame of noise over exactly representable colors needs far more than 4095 codes, so the encoder has to reset the
+// LZW table mid frame. the palette holds every color, so the image has to come back unchanged
+static void TestLZWReset(void) {
+    IM_TEST_BEGIN("LZW table reset");
+
+    enum { width = 256, height = 256, colorCount = 200 };
+    uint8_t *rgba = malloc(width * height * 4);
+    uint32_t seed = 12345;
+    for (int i = 0; i < width * height; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int color = (int) ((seed >> 16) % colorCount);
+        // spread over distinct 5 bit per channel histogram bins
+        rgba[i * 4] = (uint8_t) ((color % 8) * 32 + 8);
+        rgba[i * 4 + 1] = (uint8_t) ((color / 8 % 5) * 48 + 8);
+        rgba[i * 4 + 2] = (uint8_t) ((color / 40) * 48 + 8);
+        rgba[i * 4 + 3] = 255;
+    }
+
+    IMImojiGIFEncoderOptions options;
+    IMImojiGIFEncoderGetDefaultOptions(&options);
+    options.dither = 0;
+    options.loopCount = -1;
+
+    TestBuffer buffer = {0};
+    IMImojiGIFEncoder *encoder = IMImojiGIFEncoderCreate(width, height, &options, TestBufferWrite, &buffer);
+    IM_CHECK(IMImojiGIFEncoderAddFrame(encoder, rgba, width * 4, 10) == IMImojiGIFEncoderStatusSuccess, "frame added");
+    IM_CHECK(IMImojiGIFEncoderFinish(encoder) == IMImojiGIFEncoderStatusSuccess, "encoder finished");
+    IMImojiGIFEncoderDestroy(encoder);
+
+    DecodedGIF gif;
+    int decoded = DecodeGIF(buffer.bytes, buffer.length, &gif);
+    IM_CHECK(decoded, "output decodes");
+    if (decoded) {
+        IM_CHECK(gif.frameCount == 1, "%d frames decoded", gif.frameCount);
+        IM_CHECK(gif.loopCount == -1, "loop extension omitted");
+        IM_CHECK(gif.lzwResets > 0, "%d table resets", gif.lzwResets);
+
+        FrameComparison comparison = {0};
+        CompareFrame(gif.frames, rgba, width * 4, width, height, 0, options.alphaThreshold, &comparison);
+        IM_CHECK(comparison.alphaMismatches == 0 && comparison.maximumError == 0, "image unchanged, maximum error %d", comparison.maximumError);
+        free(gif.frames);
+    }
+
+    free(rgba);
+    free(buffer.bytes);
+    IM_TEST_END();
+}
+
+static void TestInvalidArguments(void) {
+    IM_TEST_BEGIN("invalid arguments");
+
+    IMImojiGIFEncoderOptions options;
+    IMImojiGIFEncoderGetDefaultOptions(&options);
+    TestBuffer buffer = {0};
+
+    IM_CHECK(IMImojiGIFEncoderCreate(0, 10, &options, TestBufferWrite, &buffer) == NULL, "empty canvas rejected");
+    IM_CHECK(IMImojiGIFEncoderCreate(10, 10, &options, NULL, &buffer) == NULL, "missing writer rejected");
+
+    IMImojiGIFEncoder *encoder = IMImojiGIFEncoderCreate(4, 4, &options, TestBufferWrite, &buffer);
+    uint8_t rgba[4 * 4 * 4] = {0};
+    IM_CHECK(IMImojiGIFEncoderAddFrame(encoder, rgba, 8, 1) == IMImojiGIFEncoderStatusInvalidArgument, "short rows rejected");
+    IM_CHECK(IMImojiGIFEncoderFinish(encoder) == IMImojiGIFEncoderStatusInvalidArgument, "finishing without frames rejected");
+    IM_CHECK(IMImojiGIFEncoderAddFrame(encoder, rgba, 16, 1) == IMImojiGIFEncoderStatusSuccess, "frame added");
+    IM_CHECK(IMImojiGIFEncoderFinish(encoder) == IMImojiGIFEncoderStatusSuccess, "encoder finished");
+    IM_CHECK(IMImojiGIFEncoderAddFrame(encoder, rgba, 16, 1) != IMImojiGIFEncoderStatusSuccess, "frames after finishing rejected");
+    IMImojiGIFEncoderDestroy(encoder);
+
+    free(buffer.bytes);
+    IM_TEST_END();
+}
+
+int main(void) {
+    for (int premultiplied = 0; premultiplied <= 1; premultiplied++) {
+        TestRoundTrip(IMImojiGIFEncoderPaletteShared, 0, premultiplied, 32, 6.0);
+        TestRoundTrip(IMImojiGIFEncoderPaletteShared, 1, premultiplied, 64, 7.0);
+        TestRoundTrip(IMImojiGIFEncoderPalettePerFrame, 0, premultiplied, 32, 6.0);
+        TestRoundTrip(IMImojiGIFEncoderPalettePerFrame, 1, premultiplied, 64, 7.0);
+    }
+
+    TestLZWReset();
+    TestInvalidArguments();
+
+    return IM_TEST_SUMMARY();
+}
@@ -0,0 +1,116 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+// Timing driver for IMImojiImageResampler. Resizes camera sized and sticker sized images with every filter, through
+// both the vectorized and the scalar build. Pass the number of iterations as the only argument.
+
+#include "IMImojiImageResampler.h"
+#include "IMImojiNativeTesting.h"
+
+#include <stdlib.h>
+
+IMImojiImageResamplerStatus IMImojiImageResamplerResizeScalar(const uint8_t *source,
+                                                             size_t sourceWidth,
+                                                             size_t sourceHeight,
+                                                             size_t sourceBytesPerRow,
+                                                             uint8_t *destination,
+                                                             size_t destinationWidth,
+                                                             size_t destinationHeight,
+                                                             size_t destinationBytesPerRow,
+                                                             IMImojiImageResamplerFilter filter,
+                                                             IMImojiImageResamplerOrientation orientation);
+
+typedef IMImojiImageResamplerStatus (*ResizeFunction)(const uint8_t *, size_t, size_t, size_t, uint8_t *, size_t, size_t,
+        size_t, IMImojiImageResamplerFilter, IMImojiImageResamplerOrientation);
+
+typedef struct {
+    const char *name;
+    int sourceWidth;
+    int sourceHeight;
+    int width;
+    int height;
+    IMImojiImageResamplerOrientation orientation;
+} BenchmarkCase;
+
+static const BenchmarkCase BenchmarkCases[] = {
+        {"12MP photo to screen", 4032, 3024, 1024, 768, IMImojiImageResamplerOrientationUp},
+        {"12MP portrait photo to screen", 4032, 3024, 768, 1024, IMImojiImageResamplerOrientationRight},
+        {"12MP photo to thumbnail", 4032, 3024, 150, 113, IMImojiImageResamplerOrientationUp},
+        {"sticker to 320", 1024, 1024, 320, 320, IMImojiImageResamplerOrientationUp},
+        {"sticker upscaled", 320, 320, 640, 640, IMImojiImageResamplerOrientationUp},
+};
+
+static const char *const FilterNames[] = {"box", "bilinear", "lanczos"};
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 5;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    uint8_t *source = malloc((size_t) 4032 * 3024 * 4);
+    uint8_t *destination = malloc((size_t) 1024 * 1024 * 4);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < (size_t) 4032 * 3024 * 4; i += 4) {
+        seed = seed * 1103515245u + 12345u;
+        source[i + 3] = (uint8_t) (seed >> 24 | 0x80);
+        source[i] = (uint8_t) ((seed >> 8) % (source[i + 3] + 1u));
+        source[i + 1] = (uint8_t) ((seed >> 12) % (source[i + 3] + 1u));
+        source[i + 2] = (uint8_t) ((seed >> 16) % (source[i + 3] + 1u));
+    }
+
+    static const ResizeFunction functions[2] = {IMImojiImageResamplerResize, IMImojiImageResamplerResizeScalar};
+    static const char *const functionNames[2] = {"vector", "scalar"};
+
+    printf("%d iterations\n", iterations);
+    for (size_t c = 0; c < sizeof(BenchmarkCases) / sizeof(BenchmarkCases[0]); c++) {
+        const BenchmarkCase *benchmarkCase = &BenchmarkCases[c];
+        printf("%s, %dx%d to %dx%d\n", benchmarkCase->name, benchmarkCase->sourceWidth, benchmarkCase->sourceHeight,
+                benchmarkCase->width, benchmarkCase->height);
+
+        for (int filter = IMImojiImageResamplerFilterBox; filter <= IMImojiImageResamplerFilterLanczos; filter++) {
+            for (int function = 0; function < 2; function++) {
+                double start = IMBenchmarkSeconds();
+                for (int iteration = 0; iteration < iterations; iteration++) {
+                    if (functions[function](source, (size_t) benchmarkCase->sourceWidth, (size_t) benchmarkCase->sourceHeight,
+                            (size_t) benchmarkCase->sourceWidth * 4, destination, (size_t) benchmarkCase->width,
+                            (size_t) benchmarkCase->height, (size_t) benchmarkCase->width * 4,
+                            (IMImojiImageResamplerFilter) filter, benchmarkCase->orientation) != IMImojiImageResamplerStatusSuccess) {
+                        fprintf(stderr, "resize failed\n");
+                        return 1;
+                    }
+                }
+                double elapsed = (IMBenchmarkSeconds() - start) / iterations;
+
+                printf("  %-8s %s: %9.3f ms %8.1f source MP/s\n", FilterNames[filter], functionNames[function], elapsed * 1000.0,
+                        (double) benchmarkCase->sourceWidth * benchmarkCase->sourceHeight / elapsed / 1e6);
+            }
+        }
+    }
+
+    free(source);
+    free(destination);
+    return 0;
+}
@@ -0,0 +1,405 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+// Tests for IMImojiImageResampler: golden outputs for every filter and orientation, orientation and filter invariants,
+// and identical output from the vectorized and the scalar build. Pass the golden file as the first argument, or
+// --update-golden followed by its path to write it again after an intended change of output.
+
+#include "IMImojiImageResampler.h"
+#include "IMImojiNativeTesting.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+IMImojiImageResamplerStatus IMImojiImageResamplerResizeScalar(const uint8_t *source,
+                                                             size_t sourceWidth,
+                                                             size_t sourceHeight,
+                                                             size_t sourceBytesPerRow,
+                                                             uint8_t *destination,
+                                                             size_t destinationWidth,
+                                                             size_t destinationHeight,
+                                                             size_t destinationBytesPerRow,
+                                                             IMImojiImageResamplerFilter filter,
+                                                             IMImojiImageResamplerOrientation orientation);
+
+#define GOLDEN_SOURCE_WIDTH 9
+#define GOLDEN_SOURCE_HEIGHT 6
+#define GOLDEN_TOLERANCE 1
+
+static const char *const FilterNames[] = {"box", "bilinear", "lanczos"};
+
+// MARK: Helpers
+
+static uint32_t NextRandom(uint32_t *seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return *seed >> 8;
+}
+
+// premultiplied RGBA with edges, gradients and varying alpha
+static void DrawTestImage(uint8_t *rgba, int width, int height, size_t bytesPerRow, uint32_t seed) {
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t *pixel = rgba + y * bytesPerRow + x * 4;
+            int alpha = (x + y) % 4 == 0 ? 255 : (int) (NextRandom(&seed) % 256);
+            int red = x * 255 / (width > 1 ? width - 1 : 1);
+            int green = (x / 2 + y) % 2 ? 255 : 0;
+            int blue = (int) (NextRandom(&seed) % 256);
+
+            pixel[0] = (uint8_t) (red * alpha / 255);
+            pixel[1] = (uint8_t) (green * alpha / 255);
+            pixel[2] = (uint8_t) (blue * alpha / 255);
+            pixel[3] = (uint8_t) alpha;
+        }
+    }
+}
+
+static int IsTransposed(IMImojiImageResamplerOrientation orientation) {
+    return orientation >= IMImojiImageResamplerOrientationLeftMirrored;
+}
+
+// the source pixel shown at upright position x, y for an image of width x height pixels in its stored orientation
+static void SourcePosition(IMImojiImageResamplerOrientation orientation, int width, int height, int x, int y,
+        int *sourceX, int *sourceY) {
+    switch (orientation) {
+        case IMImojiImageResamplerOrientationUp:
+            *sourceX = x, *sourceY = y;
+            break;
+        case IMImojiImageResamplerOrientationUpMirrored:
+            *sourceX = width - 1 - x, *sourceY = y;
+            break;
+        case IMImojiImageResamplerOrientationDown:
+            *sourceX = width - 1 - x, *sourceY = height - 1 - y;
+            break;
+        case IMImojiImageResamplerOrientationDownMirrored:
+            *sourceX = x, *sourceY = height - 1 - y;
+            break;
+        case IMImojiImageResamplerOrientationLeftMirrored:
+            *sourceX = y, *sourceY = x;
+            break;
+        case IMImojiImageResamplerOrientationRight:
+            *sourceX = y, *sourceY = height - 1 - x;
+            break;
+        case IMImojiImageResamplerOrientationRightMirrored:
+            *sourceX = width - 1 - y, *sourceY = height - 1 - x;
+            break;
+        case IMImojiImageResamplerOrientationLeft:
+            *sourceX = width - 1 - y, *sourceY = x;
+            break;
+    }
+}
+
+// MARK: Golden Outputs
+
+typedef struct {
+    IMImojiImageResamplerFilter filter;
+    IMImojiImageResamplerOrientation orientation;
+    int width;
+    int height;
+    uint8_t *pixels;
+} GoldenCase;
+
+// every filter and orientation, downscaled and upscaled
+static int MakeGoldenCases(GoldenCase *cases) {
+    uint8_t source[GOLDEN_SOURCE_WIDTH * GOLDEN_SOURCE_HEIGHT * 4];
+    DrawTestImage(source, GOLDEN_SOURCE_WIDTH, GOLDEN_SOURCE_HEIGHT, GOLDEN_SOURCE_WIDTH * 4, 7);
+
+    static const int sizes[2][2] = {{6, 4}, {13, 8}};
+    int count = 0;
+    for (int filter = IMImojiImageResamplerFilterBox; filter <= IMImojiImageResamplerFilterLanczos; filter++) {
+        for (int orientation = IMImojiImageResamplerOrientationUp; orientation <= IMImojiImageResamplerOrientationLeft; orientation++) {
+            for (int size = 0; size < 2; size++) {
+                GoldenCase *goldenCase = &cases[count++];
+                goldenCase->filter = (IMImojiImageResamplerFilter) filter;
+                goldenCase->orientation = (IMImojiImageResamplerOrientation) orientation;
+                goldenCase->width = sizes[size][IsTransposed(goldenCase->orientation) ? 1 : 0];
+                goldenCase->height = sizes[size][IsTransposed(goldenCase->orientation) ? 0 : 1];
+                goldenCase->pixels = malloc((size_t) goldenCase->width * goldenCase->height * 4);
+
+                IM_CHECK(IMImojiImageResamplerResize(source, GOLDEN_SOURCE_WIDTH, GOLDEN_SOURCE_HEIGHT, GOLDEN_SOURCE_WIDTH * 4,
+                        goldenCase->pixels, (size_t) goldenCase->width, (size_t) goldenCase->height, (size_t) goldenCase->width * 4,
+                        goldenCase->filter, goldenCase->orientation) == IMImojiImageResamplerStatusSuccess,
+                        "%s orientation %d resized", FilterNames[filter], orientation);
+            }
+        }
+    }
+
+    return count;
+}
+
+static int WriteGolden(const char *path) {
+    GoldenCase cases[48];
+    int count = MakeGoldenCases(cases);
+
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "unable to write %s\n", path);
+        return 1;
+    }
+
+    fprintf(file, "# filter orientation width height RGBA, generated by resampler-tests --update-golden\n");
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "%s %d %d %d ", FilterNames[cases[i].filter], cases[i].orientation, cases[i].width, cases[i].height);
+        for (int j = 0; j < cases[i].width * cases[i].height * 4; j++) {
+            fprintf(file, "%02x", cases[i].pixels[j]);
+        }
+        fprintf(file, "\n");
+        free(cases[i].pixels);
+    }
+
+    fclose(file);
+    printf("wrote %d cases to %s\n", count, path);
+    return 0;
+}
+
+static void TestGoldenOutputs(const char *path) {
+    IM_TEST_BEGIN("golden outputs, 3 filters x 8 orientations, down and upscaled");
+
+    GoldenCase cases[48];
+    int count = MakeGoldenCases(cases);
+
+    FILE *file = fopen(path, "r");
+    IM_CHECK(file != NULL, "golden file %s opened", path);
+
+    char line[4096];
+    int matched = 0;
+    while (file && fgets(line, sizeof(line), file)) {
+        if (line[0] == '#') {
+            continue;
+        }
+
+        char filterName[16];
+        int orientation, width, height, offset;
+        if (sscanf(line, "%15s %d %d %d %n", filterName, &orientation, &width, &height, &offset) != 4) {
+            continue;
+        }
+
+        for (int i = 0; i < count; i++) {
+            GoldenCase *goldenCase = &cases[i];
+            if (strcmp(filterName, FilterNames[goldenCase->filter]) != 0 || orientation != (int) goldenCase->orientation ||
+                    width != goldenCase->width || height != goldenCase->height) {
+                continue;
+            }
+
+            // a step of one is allowed so rounding differences between math libraries don't fail the test
+            int maximumError = 0;
+            const char *hex = line + offset;
+            for (int j = 0; j < width * height * 4; j++) {
+                unsigned int value;
+                if (sscanf(hex + j * 2, "%2x", &value) != 1) {
+                    maximumError = 256;
+                    break;
+                }
+
+                int error = abs((int) value - goldenCase->pixels[j]);
+                maximumError = error > maximumError ? error : maximumError;
+            }
+
+            IM_CHECK(maximumError <= GOLDEN_TOLERANCE, "%s orientation %d %dx%d differs by %d",
+                    filterName, orientation, width, height, maximumError);
+            matched++;
+        }
+    }
+
+    IM_CHECK(matched == count, "%d of %d cases found in the golden file", matched, count);
+
+    if (file) {
+        fclose(file);
+    }
+    for (int i = 0; i < count; i++) {
+        free(cases[i].pixels);
+    }
+
+    IM_TEST_END();
+}
+
+// MARK: Invariants
+
+// resampling happens in the stored orientation, so every orientation is exactly the upright output moved around
+static void TestOrientations(void) {
+    IM_TEST_BEGIN("orientations match the rotated upright output");
+
+    enum { sourceWidth = 37, sourceHeight = 23, width = 17, height = 11 };
+    uint8_t *source = malloc(sourceWidth * sourceHeight * 4);
+    uint8_t upright[width * height * 4];
+    uint8_t oriented[width * height * 4];
+    DrawTestImage(source, sourceWidth, sourceHeight, sourceWidth * 4, 99);
+
+    for (int filter = IMImojiImageResamplerFilterBox; filter <= IMImojiImageResamplerFilterLanczos; filter++) {
+        IMImojiImageResamplerResize(source, sourceWidth, sourceHeight, sourceWidth * 4, upright, width, height, width * 4,
+                (IMImojiImageResamplerFilter) filter, IMImojiImageResamplerOrientationUp);
+
+        for (int orientation = IMImojiImageResamplerOrientationUp; orientation <= IMImojiImageResamplerOrientationLeft; orientation++) {
+            int transposed = IsTransposed((IMImojiImageResamplerOrientation) orientation);
+            int orientedWidth = transposed ? height : width;
+            int orientedHeight = transposed ? width : height;
+
+            IMImojiImageResamplerResize(source, sourceWidth, sourceHeight, sourceWidth * 4, oriented,
+                    (size_t) orientedWidth, (size_t) orientedHeight, (size_t) orientedWidth * 4,
+                    (IMImojiImageResamplerFilter) filter, (IMImojiImageResamplerOrientation) orientation);
+
+            int mismatches = 0;
+            for (int y = 0; y < orientedHeight; y++) {
+                for (int x = 0; x < orientedWidth; x++) {
+                    int sourceX, sourceY;
+                    SourcePosition((IMImojiImageResamplerOrientation) orientation, width, height, x, y, &sourceX, &sourceY);
+                    mismatches += memcmp(oriented + (y * orientedWidth + x) * 4, upright + (sourceY * width + sourceX) * 4, 4) != 0;
+                }
+            }
+
+            IM_CHECK(mismatches == 0, "%s orientation %d, %d pixels misplaced", FilterNames[filter], orientation, mismatches);
+        }
+    }
+
+    free(source);
+    IM_TEST_END();
+}
+
+static void TestUnchangedSize(void) {
+    IM_TEST_BEGIN("resizing to the same size copies the image");
+
+    enum { width = 31, height = 19 };
+    uint8_t source[width * height * 4];
+    uint8_t destination[width * height * 4];
+    DrawTestImage(source, width, height, width * 4, 3);
+
+    for (int filter = IMImojiImageResamplerFilterBox; filter <= IMImojiImageResamplerFilterLanczos; filter++) {
+        IMImojiImageResamplerResize(source, width, height, width * 4, destination, width, height, width * 4,
+                (IMImojiImageResamplerFilter) filter, IMImojiImageResamplerOrientationUp);
+        IM_CHECK(memcmp(source, destination, sizeof(source)) == 0, "%s copies the image", FilterNames[filter]);
+    }
+
+    IM_TEST_END();
+}
+
+// weights are normalized in fixed point, so flat areas must stay exactly flat, Lanczos' negative lobes included
+static void TestConstantColor(void) {
+    IM_TEST_BEGIN("constant colors are preserved");
+
+    static const uint8_t colors[3][4] = {{200, 100, 50, 255}, {60, 30, 0, 128}, {0, 0, 0, 0}};
+    static const int sizes[4][2] = {{1, 1}, {7, 5}, {40, 40}, {113, 77}};
+    enum { width = 50, height = 41 };
+    uint8_t *source = malloc(width * height * 4);
+    uint8_t *destination = malloc(113 * 77 * 4);
+
+    for (int color = 0; color < 3; color++) {
+        for (int i = 0; i < width * height; i++) {
+            memcpy(source + i * 4, colors[color], 4);
+        }
+
+        for (int filter = IMImojiImageResamplerFilterBox; filter <= IMImojiImageResamplerFilterLanczos; filter++) {
+            for (int size = 0; size < 4; size++) {
+                int destinationWidth = sizes[size][0], destinationHeight = sizes[size][1];
+                IMImojiImageResamplerResize(source, width, height, width * 4, destination,
+                        (size_t) destinationWidth, (size_t) destinationHeight, (size_t) destinationWidth * 4,
+                        (IMImojiImageResamplerFilter) filter, IMImojiImageResamplerOrientationUp);
+
+                int changed = 0;
+                for (int i = 0; i < destinationWidth * destinationHeight; i++) {
+                    changed += memcmp(destination + i * 4, colors[color], 4) != 0;
+                }
+
+                IM_CHECK(changed == 0, "%s to %dx%d changed %d pixels of color %d", FilterNames[filter],
+                        destinationWidth, destinationHeight, changed, color);
+            }
+        }
+    }
+
+    free(source);
+    free(destination);
+    IM_TEST_END();
+}
+
+static void TestScalarIdentity(void) {
+    IM_TEST_BEGIN("vectorized and scalar builds produce identical output");
+
+    uint32_t seed = 2024;
+    int cases = 0, mismatches = 0;
+    for (int iteration = 0; iteration < 200; iteration++) {
+        int sourceWidth = 1 + (int) (NextRandom(&seed) % 90), sourceHeight = 1 + (int) (NextRandom(&seed) % 90);
+        int width = 1 + (int) (NextRandom(&seed) % 90), height = 1 + (int) (NextRandom(&seed) % 90);
+        size_t sourceBytesPerRow = (size_t) sourceWidth * 4 + NextRandom(&seed) % 3 * 4;
+        size_t destinationBytesPerRow = (size_t) width * 4 + NextRandom(&seed) % 3 * 4;
+        IMImojiImageResamplerFilter filter = (IMImojiImageResamplerFilter) (iteration % 3);
+        IMImojiImageResamplerOrientation orientation = (IMImojiImageResamplerOrientation) (1 + iteration / 3 % 8);
+
+        uint8_t *source = malloc(sourceBytesPerRow * sourceHeight);
+        uint8_t *vector = calloc(destinationBytesPerRow * height, 1);
+        uint8_t *scalar = calloc(destinationBytesPerRow * height, 1);
+        DrawTestImage(source, sourceWidth, sourceHeight, sourceBytesPerRow, NextRandom(&seed));
+
+        IMImojiImageResamplerStatus vectorStatus = IMImojiImageResamplerResize(source, (size_t) sourceWidth, (size_t) sourceHeight, sourceBytesPerRow,
+                vector, (size_t) width, (size_t) height, destinationBytesPerRow, filter, orientation);
+        IMImojiImageResamplerStatus scalarStatus = IMImojiImageResamplerResizeScalar(source, (size_t) sourceWidth, (size_t) sourceHeight, sourceBytesPerRow,
+                scalar, (size_t) width, (size_t) height, destinationBytesPerRow, filter, orientation);
+
+        IM_CHECK(vectorStatus == IMImojiImageResamplerStatusSuccess && scalarStatus == IMImojiImageResamplerStatusSuccess,
+                "%dx%d to %dx%d resized", sourceWidth, sourceHeight, width, height);
+        if (memcmp(vector, scalar, destinationBytesPerRow * height) != 0) {
+            mismatches++;
+            printf("  %s orientation %d, %dx%d to %dx%d differs\n", FilterNames[filter], orientation, sourceWidth, sourceHeight, width, height);
+        }
+        cases++;
+
+        free(source);
+        free(vector);
+        free(scalar);
+    }
+
+    IM_CHECK(mismatches == 0, "%d of %d cases differ", mismatches, cases);
+    IM_TEST_END();
+}
+
+static void TestInvalidArguments(void) {
+    IM_TEST_BEGIN("invalid arguments");
+
+    uint8_t source[16 * 4] = {0}, destination[16 * 4];
+    IM_CHECK(IMImojiImageResamplerResize(NULL, 4, 4, 16, destination, 4, 4, 16, IMImojiImageResamplerFilterBox,
+            IMImojiImageResamplerOrientationUp) == IMImojiImageResamplerStatusInvalidArgument, "missing source rejected");
+    IM_CHECK(IMImojiImageResamplerResize(source, 4, 4, 12, destination, 4, 4, 16, IMImojiImageResamplerFilterBox,
+            IMImojiImageResamplerOrientationUp) == IMImojiImageResamplerStatusInvalidArgument, "short source rows rejected");
+    IM_CHECK(IMImojiImageResamplerResize(source, 4, 4, 16, destination, 0, 4, 16, IMImojiImageResamplerFilterBox,
+            IMImojiImageResamplerOrientationUp) == IMImojiImageResamplerStatusInvalidArgument, "empty destination rejected");
+    IM_CHECK(IMImojiImageResamplerResize(source, 4, 4, 16, destination, 4, 4, 16, (IMImojiImageResamplerFilter) 3,
+            IMImojiImageResamplerOrientationUp) == IMImojiImageResamplerStatusInvalidArgument, "unknown filter rejected");
+    IM_CHECK(IMImojiImageResamplerResize(source, 4, 4, 16, destination, 4, 4, 16, IMImojiImageResamplerFilterBox,
+            (IMImojiImageResamplerOrientation) 0) == IMImojiImageResamplerStatusInvalidArgument, "unknown orientation rejected");
+
+    IM_TEST_END();
+}
+
+int main(int argc, char **argv) {
+    if (argc > 2 && strcmp(argv[1], "--update-golden") == 0) {
+        return WriteGolden(argv[2]);
+    }
+
+    TestGoldenOutputs(argc > 1 ? argv[1] : "IMImojiImageResamplerGolden.txt");
+    TestOrientations();
+    TestUnchangedSize();
+    TestConstantColor();
+    TestScalarIdentity();
+    TestInvalidArguments();
+
+    return IM_TEST_SUMMARY();
+}
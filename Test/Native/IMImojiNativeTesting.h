@@ -0,0 +1,73 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+// Minimal checks and timing shared by the tests and benchmarks of the portable C sources, which build with any C99
+// compiler and don't need Xcode or XCTest.
+
+#ifndef IMImojiNativeTesting_h
+#define IMImojiNativeTesting_h
+
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define IM_TEST_UNUSED __attribute__((unused))
+#else
+#define IM_TEST_UNUSED
+#endif
+
+static int IMTestFailures IM_TEST_UNUSED = 0;
+static int IMTestCaseFailures IM_TEST_UNUSED = 0;
+static int IMTestCount IM_TEST_UNUSED = 0;
+
+#define IM_TEST_BEGIN(...) do { \
+    IMTestCaseFailures = 0; \
+    IMTestCount++; \
+    printf("[ RUN  ] "); \
+    printf(__VA_ARGS__); \
+    printf("\n"); \
+} while (0)
+
+#define IM_TEST_END() printf(IMTestCaseFailures ? "[ FAIL ]\n" : "[  OK  ]\n")
+
+#define IM_CHECK(condition, ...) do { \
+    if (!(condition)) { \
+        IMTestFailures++; \
+        IMTestCaseFailures++; \
+        printf("%s:%d: check failed: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+    } \
+} while (0)
+
+#define IM_TEST_SUMMARY() (printf("%d tests, %d failed checks\n", IMTestCount, IMTestFailures), IMTestFailures ? 1 : 0)
+
+static inline double IMBenchmarkSeconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+#endif /* IMImojiNativeTesting_h */
@@ -0,0 +1,117 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+// Timing driver for IMImojiURLQuery. Builds the query strings of search, featured and lookup requests and reports the
+// time and the number of buffer allocations per query. Pass the number of iterations, in thousands, as the only argument.
+
+#include "IMImojiURLQuery.h"
+#include "IMImojiNativeTesting.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const char *name;
+    const char *const *pairs;
+    size_t count;
+} BenchmarkCase;
+
+static const char *const SearchPairs[] = {
+        "query", "happy birthday & congrats",
+        "numResults", "50",
+        "offset", "100",
+        "locale", "en_US",
+        "contentRating", "G",
+        "imageExtension", "webp",
+        "hasAnimated", "1",
+        "clientId", "748cddd4-460d-420a-bd42-fcba7f6c031b",
+        "access_token", "c8fb5a3b3f1d4c6fa3e4a2d1b0c9e8f7",
+};
+
+static const char *const FeaturedPairs[] = {
+        "numResults", "60",
+        "locale", "pt_BR",
+        "contentRating", "PG13",
+        "clientId", "748cddd4-460d-420a-bd42-fcba7f6c031b",
+        "access_token", "c8fb5a3b3f1d4c6fa3e4a2d1b0c9e8f7",
+};
+
+static const char *const LookupPairs[] = {
+        "ids", "0ab3f2e4-8f1c-4c5e-9d2a-000000000001,1bc4e3f5-8f1c-4c5e-9d2a-000000000002,"
+                "2cd5f406-8f1c-4c5e-9d2a-000000000003,3de60517-8f1c-4c5e-9d2a-000000000004,"
+                "4ef71628-8f1c-4c5e-9d2a-000000000005,5f082739-8f1c-4c5e-9d2a-000000000006",
+        "query", "caf\xC3\xA9 \xF0\x9F\x98\x80",
+        "clientId", "748cddd4-460d-420a-bd42-fcba7f6c031b",
+        "access_token", "c8fb5a3b3f1d4c6fa3e4a2d1b0c9e8f7",
+};
+
+static const BenchmarkCase BenchmarkCases[] = {
+        {"search", SearchPairs, sizeof(SearchPairs) / sizeof(SearchPairs[0]) / 2},
+        {"featured", FeaturedPairs, sizeof(FeaturedPairs) / sizeof(FeaturedPairs[0]) / 2},
+        {"lookup", LookupPairs, sizeof(LookupPairs) / sizeof(LookupPairs[0]) / 2},
+};
+
+int main(int argc, char **argv) {
+    int iterations = (argc > 1 ? atoi(argv[1]) : 5) * 1000;
+    if (iterations < 1000) {
+        iterations = 1000;
+    }
+
+    printf("%d iterations\n", iterations);
+    for (size_t c = 0; c < sizeof(BenchmarkCases) / sizeof(BenchmarkCases[0]); c++) {
+        const BenchmarkCase *benchmarkCase = &BenchmarkCases[c];
+        size_t lengths[32];
+        for (size_t i = 0; i < benchmarkCase->count * 2; i++) {
+            lengths[i] = strlen(benchmarkCase->pairs[i]);
+        }
+
+        // the builder only allocates when it grows its buffer, so every change of capacity is one allocation
+        size_t allocations = 0, queryLength = 0;
+        double start = IMBenchmarkSeconds();
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            IMImojiURLQuery query;
+            IMImojiURLQueryInit(&query, 0);
+
+            for (size_t i = 0; i < benchmarkCase->count; i++) {
+                size_t capacity = query.capacity;
+                if (IMImojiURLQueryAppend(&query, benchmarkCase->pairs[i * 2], lengths[i * 2], benchmarkCase->pairs[i * 2 + 1],
+                        lengths[i * 2 + 1], 0) != IMImojiURLQueryStatusSuccess) {
+                    fprintf(stderr, "append failed\n");
+                    return 1;
+                }
+                allocations += query.capacity != capacity;
+            }
+
+            queryLength = query.length;
+            IMImojiURLQueryDestroy(&query);
+        }
+        double elapsed = (IMBenchmarkSeconds() - start) / iterations;
+
+        printf("  %-8s %4zu bytes: %8.1f ns/op %6.2f allocations/op\n", benchmarkCase->name, queryLength, elapsed * 1e9,
+                (double) allocations / iterations);
+    }
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+//
+//  ImojiSDK
+//
+//  Created by Nima Khoshini
+//  Copyright (C) 2015 Imoji
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+//
+
+// Checks the encoding of IMImojiURLQuery against the output of the CFURLCreateStringByAddingPercentEscapes based
+// implementation it replaced in RequestUtils.
+
+#include "IMImojiURLQuery.h"
+#include "IMImojiNativeTesting.h"
+
+#include <string.h>
+
+static int QueryEquals(const IMImojiURLQuery *query, const char *expected) {
+    return query->length == strlen(expected) && memcmp(query->bytes, expected, query->length) == 0;
+}
+
+static void TestPercentEncoding(void) {
+    static const struct {
+        const char *input;
+        const char *expected;
+    } cases[] = {
+            {"", ""},
+            {"AZaz09-._~", "AZaz09-._~"},
+            {"!*'\"();:@&=+$,/?%#[] ", "%21%2A%27%22%28%29%3B%3A%40%26%3D%2B%24%2C%2F%3F%25%23%5B%5D%20"},
+            {"<>\\^`{|}", "%3C%3E%5C%5E%60%7B%7C%7D"},
+            {"\t\r\n\x7f", "%09%0D%0A%7F"},
+            {"caf\xC3\xA9", "caf%C3%A9"},
+            {"\xF0\x9F\x98\x80 smile", "%F0%9F%98%80%20smile"},
+    };
+
+    IM_TEST_BEGIN("percent encoding");
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        char encoded[128];
+        size_t length = IMImojiURLPercentEncode(encoded, cases[i].input, strlen(cases[i].input));
+        IM_CHECK(length == strlen(cases[i].expected) && memcmp(encoded, cases[i].expected, length) == 0,
+                "\"%s\" encoded as \"%.*s\"", cases[i].input, (int) length, encoded);
+    }
+
+    // every byte value, only the unreserved characters may come through unescaped
+    char input[256], encoded[256 * 3];
+    for (int c = 0; c < 256; c++) {
+        input[c] = (char) c;
+    }
+    size_t length = IMImojiURLPercentEncode(encoded, input, sizeof(input));
+    IM_CHECK(length == 66 + (256 - 66) * 3, "encoded length %zu", length);
+    IM_TEST_END();
+}
+
+static void TestQueryBuilding(void) {
+    IMImojiURLQuery query;
+
+    IM_TEST_BEGIN("query building");
+    IM_CHECK(IMImojiURLQueryInit(&query, 0) == IMImojiURLQueryStatusSuccess, "init");
+    IM_CHECK(query.length == 0 && query.bytes == NULL, "empty query allocates nothing");
+
+    IM_CHECK(IMImojiURLQueryAppend(&query, "query", 5, "happy birthday & congrats", 25, 0) == IMImojiURLQueryStatusSuccess, "append");
+    IM_CHECK(IMImojiURLQueryAppend(&query, "numResults", 10, "50", 2, 0) == IMImojiURLQueryStatusSuccess, "append");
+    IM_CHECK(IMImojiURLQueryAppend(&query, "ids", 3, "a1,b2", 5, 1) == IMImojiURLQueryStatusSuccess, "append");
+    IM_CHECK(IMImojiURLQueryAppend(&query, "empty", 5, "", 0, 0) == IMImojiURLQueryStatusSuccess, "append");
+    IM_CHECK(QueryEquals(&query, "query=happy%20birthday%20%26%20congrats&numResults=50&ids[]=a1%2Cb2&empty="),
+            "query \"%.*s\"", (int) query.length, query.bytes);
+    IMImojiURLQueryDestroy(&query);
+    IM_CHECK(query.bytes == NULL && query.length == 0, "destroy resets the query");
+    IM_TEST_END();
+
+    IM_TEST_BEGIN("query growth");
+    IM_CHECK(IMImojiURLQueryInit(&query, 16) == IMImojiURLQueryStatusSuccess, "init with capacity");
+    IM_CHECK(query.capacity >= 16, "capacity %zu", query.capacity);
+
+    char expected[4096] = "";
+    size_t expectedLength = 0;
+    for (int i = 0; i < 200; i++) {
+        char key[16], value[16];
+        int keyLength = snprintf(key, sizeof(key), "key%d", i);
+        int valueLength = snprintf(value, sizeof(value), "v %d", i);
+        IM_CHECK(IMImojiURLQueryAppend(&query, key, (size_t) keyLength, value, (size_t) valueLength, 0) == IMImojiURLQueryStatusSuccess, "append %d", i);
+        expectedLength += (size_t) snprintf(expected + expectedLength, sizeof(expected) - expectedLength, "%skey%d=v%%20%d",
+                i > 0 ? "&" : "", i, i);
+    }
+    IM_CHECK(QueryEquals(&query, expected), "%zu bytes built, %zu expected", query.length, expectedLength);
+    IMImojiURLQueryDestroy(&query);
+    IM_TEST_END();
+}
+
+static void TestInvalidArguments(void) {
+    IMImojiURLQuery query;
+
+    IM_TEST_BEGIN("invalid arguments");
+    IM_CHECK(IMImojiURLQueryInit(NULL, 0) == IMImojiURLQueryStatusInvalidArgument, "NULL query");
+    IMImojiURLQueryInit(&query, 0);
+    IM_CHECK(IMImojiURLQueryAppend(NULL, "a", 1, "b", 1, 0) == IMImojiURLQueryStatusInvalidArgument, "NULL query");
+    IM_CHECK(IMImojiURLQueryAppend(&query, NULL, 1, "b", 1, 0) == IMImojiURLQueryStatusInvalidArgument, "NULL key");
+    IM_CHECK(IMImojiURLQueryAppend(&query, "a", 1, NULL, 1, 0) == IMImojiURLQueryStatusInvalidArgument, "NULL value");
+    IM_CHECK(IMImojiURLQueryAppend(&query, "a", (size_t) -1, "b", 1, 0) == IMImojiURLQueryStatusOutOfMemory, "overflowing length");
+    IM_CHECK(query.length == 0, "failed appends leave the query untouched");
+    IMImojiURLQueryDestroy(&query);
+    IMImojiURLQueryDestroy(NULL);
+    IM_TEST_END();
+}
+
+int main(void) {
+    TestPercentEncoding();
+    TestQueryBuilding();
+    TestInvalidArguments();
+
+    return IM_TEST_SUMMARY();
+}